@@ -35,6 +35,9 @@ FetchContent_Declare(asio
 )
 FetchContent_MakeAvailable(asio)
 
+# ---------- sqlite3 ----------
+find_package(SQLite3 REQUIRED)
+
 # ---------- mysql ----------
 find_package(OpenSSL REQUIRED)
 find_package(unofficial-mysql-connector-cpp CONFIG REQUIRED)
@@ -44,7 +47,20 @@ set(LIB_SRC
         cfl/config.cc
         cfl/shm/shmpage.cc
         cfl/shm/shmpool.cc
+        cfl/shm/shmcheckpoint.cc
+        cfl/shm/crc32c.cc
+        cfl/shm/shmchangelog.cc
         cfl/db/db_mysql.cc
+        cfl/db/db_sqlite.cc
+        cfl/db/db_async.cc
+        cfl/db/db_batch.cc
+        cfl/simple_manager.cc
+        cfl/simple_store.cc
+        cfl/rank_list.cc
+        cfl/guid_allocator.cc
+        cfl/mail/group_mail_list.cc
+        cfl/mail/mail_expiry_index.cc
+        cfl/id_table.cc
 )
 
 add_library(cfl SHARED ${LIB_SRC})
@@ -55,6 +71,7 @@ target_link_libraries(cfl
         yaml-cpp
         OpenSSL::SSL
         unofficial::mysql-connector-cpp::connector
+        SQLite::SQLite3
 )
 
 target_include_directories(cfl PUBLIC
@@ -69,6 +86,9 @@ set(TEST_TARGETS
         test_log test_config test_asio test_asio_tcp
         test_asio_udp test_asio_async
         test_ssm_creator test_ssm_attacher test_mysql
+        test_shm_snapshot test_shm_checkpoint test_shm_crc test_shm_changelog test_shm_global_restart
+        test_simple_store test_rank_list test_guid_allocator test_mail_expiry_index test_player_pool test_module_store
+        test_db_async test_db_batch test_sqlite_result test_db_row test_simple_loader test_group_mail_list test_role_dirty
 )
 
 foreach (target_name IN LISTS TEST_TARGETS)
@@ -76,6 +96,31 @@ foreach (target_name IN LISTS TEST_TARGETS)
     target_link_libraries(${target_name} PRIVATE cfl)
 endforeach ()
 
+# ---------- 性能对比 ----------
+# 新旧实现的耗时对比，不属于测试，需要时单独运行
+set(BENCH_TARGETS
+        bench_group_mail_list
+        bench_db_batch
+        bench_sqlite_result
+        bench_db_row
+        bench_simple_loader
+        bench_simple_store
+        bench_rank_list
+        bench_guid_allocator
+        bench_mail_expiry_index
+        bench_player_pool
+        bench_module_store
+)
+
+foreach (target_name IN LISTS BENCH_TARGETS)
+    add_executable(${target_name} bench/${target_name}.cc)
+    target_link_libraries(${target_name} PRIVATE cfl)
+endforeach ()
+
+# ---------- 工具 ----------
+add_executable(shm_inspect tools/shm_inspect.cc)
+target_link_libraries(shm_inspect PRIVATE cfl)
+
 set(EXECUTABLE_OUTPUT_PATH ${PROJECT_SOURCE_DIR}/bin)
 set(LIBRARY_OUTPUT_PATH ${PROJECT_SOURCE_DIR}/lib)
 
@@ -131,8 +131,13 @@ set(LIB_SRC
         cfl/config.cc
         cfl/shm/shmpage.cc
         cfl/shm/shmpool.cc
+        cfl/shm/shmcheckpoint.cc
+        cfl/shm/crc32c.cc
+        cfl/shm/shmchangelog.cc
         cfl/db/db_mysql.cc
         cfl/db/db_sqlite.cc
+        cfl/db/db_async.cc
+        cfl/db/db_batch.cc
         cfl/playerobj.cc
         cfl/modules/module_base.cc
         cfl/connection.cc
@@ -141,9 +146,17 @@ set(LIB_SRC
         cfl/modules/role_module.cc
         cfl/static_data.cc
         cfl/simple_manager.cc
+        cfl/simple_store.cc
+        cfl/rank_list.cc
         cfl/mail/mail_manager.cc
+        cfl/mail/group_mail_list.cc
+        cfl/mail/mail_expiry_index.cc
         cfl/modules/mail_module.cc
+        cfl/modules/module_registry.cc
         cfl/global_data_manager.cc
+        cfl/guid_allocator.cc
+        cfl/player_manager.cc
+        cfl/id_table.cc
         ${GENERATED_SRC}
 )
 
@@ -187,7 +200,7 @@ set(TEST_TARGETS
         test_role_creator test_role_attacher
         test_sqlite3 test_handler test_proto test_connection
         test_net_engine test_role_module test_static_data
-        test_simple_manager test_mail
+        test_simple_manager test_mail test_shm_snapshot test_shm_checkpoint test_shm_crc test_shm_changelog test_shm_global_restart test_db_async test_db_batch test_sqlite_result test_db_row test_simple_loader test_simple_store test_rank_list test_guid_allocator test_group_mail_list test_mail_expiry_index test_player_pool test_module_store test_role_dirty
 )
 
 foreach (target_name IN LISTS TEST_TARGETS)
@@ -199,11 +212,37 @@ foreach (target_name IN LISTS TEST_TARGETS)
     add_dependencies(${target_name} cfl)
 endforeach ()
 
+# ---------- 性能对比 ----------
+# 新旧实现的耗时对比，不属于测试，需要时单独运行
+set(BENCH_TARGETS
+        bench_group_mail_list
+        bench_db_batch
+        bench_sqlite_result
+        bench_db_row
+        bench_simple_loader
+        bench_simple_store
+        bench_rank_list
+        bench_guid_allocator
+        bench_mail_expiry_index
+        bench_player_pool
+        bench_module_store
+)
+
+foreach (target_name IN LISTS BENCH_TARGETS)
+    add_executable(${target_name} bench/${target_name}.cc)
+    target_link_libraries(${target_name} PRIVATE cfl)
+    add_dependencies(${target_name} cfl)
+endforeach ()
+
+# ---------- 工具 ----------
+add_executable(shm_inspect tools/shm_inspect.cc)
+target_link_libraries(shm_inspect PRIVATE cfl)
+
 set(EXECUTABLE_OUTPUT_PATH ${PROJECT_SOURCE_DIR}/bin)
 set(LIBRARY_OUTPUT_PATH ${PROJECT_SOURCE_DIR}/lib)
 
 # 自动复制 DLL
-foreach (EXE_TARGET IN LISTS TEST_TARGETS)
+foreach (EXE_TARGET IN LISTS TEST_TARGETS BENCH_TARGETS)
     add_custom_command(TARGET ${EXE_TARGET} POST_BUILD
             COMMAND ${CMAKE_COMMAND} -E copy_if_different
             $<TARGET_RUNTIME_DLLS:${EXE_TARGET}> $<TARGET_FILE_DIR:${EXE_TARGET}>
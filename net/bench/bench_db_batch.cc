@@ -0,0 +1,66 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include "cfl/db/db_batch.h"
+#include "cfl/db/db_sqlite.h"
+
+using namespace cfl::db;
+
+namespace {
+    std::shared_ptr<SQLite> open_memory_db() {
+        auto db = std::make_shared<SQLite>(std::unordered_map<std::string, std::string>{{"dbname", ":memory:"}});
+        if (!db->connect() ||
+            db->execute("CREATE TABLE role (id INTEGER PRIMARY KEY, name TEXT, level INTEGER, exp INTEGER);") < 0) {
+            std::cerr << "[Batch] open memory db failed" << std::endl;
+            return nullptr;
+        }
+        return db;
+    }
+}
+
+/// 逐行写入与 BatchWriter 批量写入的耗时对比
+int main() {
+    const int rows = 20000;
+
+    {
+        auto db = open_memory_db();
+        if (!db) {
+            return 1;
+        }
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 1; i <= rows; ++i) {
+            auto name = "role_" + std::to_string(i);
+            if (db->execStmt("INSERT OR REPLACE INTO role (id, name, level, exp) VALUES (?, ?, ?, ?);",
+                             i, std::string_view(name), 1, int64_t{0}) < 0) {
+                std::cerr << "[Batch] insert failed: " << db->error_message() << std::endl;
+                return 1;
+            }
+        }
+        auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+        std::cout << "[Batch] row by row " << rows << " rows cost " << cost.count() << "ms" << std::endl;
+    }
+
+    {
+        auto db = open_memory_db();
+        if (!db) {
+            return 1;
+        }
+        BatchWriter writer(db, SqlDialect::SQLite, "role", {"id", "name", "level", "exp"});
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 1; i <= rows; ++i) {
+            auto name = "role_" + std::to_string(i);
+            if (!writer.add_row(i, name, 1, int64_t{0})) {
+                std::cerr << "[Batch] add_row " << i << " failed" << std::endl;
+                return 1;
+            }
+        }
+        if (!writer.commit()) {
+            std::cerr << "[Batch] commit failed" << std::endl;
+            return 1;
+        }
+        auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+        std::cout << "[Batch] batched " << rows << " rows in " << writer.statement_count() << " statements cost "
+                  << cost.count() << "ms" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include "cfl/db/db_row.h"
+#include "cfl/db/db_sqlite.h"
+
+using namespace cfl::db;
+
+struct RoleRow {
+    std::uint64_t id = 0;
+    std::uint32_t level = 0;
+    std::int64_t exp = 0;
+    std::string name;
+};
+
+CFL_ROW(RoleRow, CFL_COL(id, "id"), CFL_COL(level, "level"), CFL_COL(exp, "exp"), CFL_COL(name, "name"));
+
+/// 逐字段按名字读取与 CFL_ROW 绑定读取的耗时对比
+int main() {
+    auto db = std::make_shared<SQLite>(std::unordered_map<std::string, std::string>{{"dbname", ":memory:"}});
+    if (!db->connect()) {
+        std::cerr << "[Row] connect failed" << std::endl;
+        return 1;
+    }
+    const int rows = 100000;
+    if (db->execute("CREATE TABLE role (id INTEGER, level INTEGER, exp INTEGER, name TEXT);") < 0) {
+        std::cerr << "[Row] create table failed" << std::endl;
+        return 1;
+    }
+    if (db->execute("BEGIN;") < 0) {
+        std::cerr << "[Row] begin failed" << std::endl;
+        return 1;
+    }
+    for (int i = 0; i < rows; ++i) {
+        auto name = "role_" + std::to_string(i);
+        if (db->execStmt("INSERT INTO role VALUES (?, ?, ?, ?);", i, i % 100, int64_t{i} * 10, std::string_view(name)) < 0) {
+            std::cerr << "[Row] insert role failed" << std::endl;
+            return 1;
+        }
+    }
+    if (db->execute("COMMIT;") < 0) {
+        std::cerr << "[Row] commit failed" << std::endl;
+        return 1;
+    }
+
+    auto data = db->query("SELECT * FROM role;");
+    auto start = std::chrono::steady_clock::now();
+    std::int64_t by_name = 0;
+    while (data->next()) {
+        RoleRow row;
+        row.id = data->get_uint64("id");
+        row.level = data->get_uint32("level");
+        row.exp = data->get_int64("exp");
+        row.name = data->get_string("name");
+        by_name += row.exp + row.level;
+    }
+    auto name_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    data = db->query("SELECT * FROM role;");
+    start = std::chrono::steady_clock::now();
+    std::int64_t bound = 0;
+    read_rows<RoleRow>(*data, [&](RoleRow &&row) { bound += row.exp + row.level; });
+    auto bound_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cout << "[Row] " << rows << " rows by name: " << name_ms.count() << "ms, CFL_ROW: " << bound_ms.count()
+              << "ms (checksum " << (bound == by_name ? "match" : "MISMATCH") << ")" << std::endl;
+    return 0;
+}
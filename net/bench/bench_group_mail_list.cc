@@ -0,0 +1,47 @@
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include "cfl/mail/group_mail_list.h"
+
+using namespace cfl::shm;
+
+/// 登录查询耗时：10 万封群邮件，每个角色只差最近几封；对照按 GUID 哈希表全量扫描
+int main() {
+    const std::uint64_t mails = 100000;
+    const int scan_logins = 100;
+    const int logins = 10000;
+    GroupMailList list;
+    std::unordered_map<std::uint64_t, GroupMailList::MailPtr> map;
+    for (std::uint64_t i = 1; i <= mails; ++i) {
+        auto mail = std::make_shared<GroupMailDataObject>();
+        mail->guid = i;
+        mail->time = 1700000000000 + i * 1000;
+        map.emplace(i, mail);
+        list.add(mail);
+    }
+    const auto since = 1700000000000 + (mails - 5) * 1000;
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t scanned = 0;
+    for (int i = 0; i < scan_logins; ++i) {
+        for (auto &[guid, mail]: map) {
+            scanned += mail->time > since;
+        }
+    }
+    auto scan_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::size_t found = 0;
+    for (int i = 0; i < logins; ++i) {
+        found += list.for_each_after(since, [](const GroupMailList::MailPtr &) {});
+    }
+    auto index_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "login over " << mails << " group mails: scan " << scan_us / scan_logins << "us, index "
+              << static_cast<double>(index_us) / logins << "us (found " << scanned / scan_logins << " / "
+              << found / logins << ")" << std::endl;
+    return 0;
+}
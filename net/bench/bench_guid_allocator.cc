@@ -0,0 +1,57 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "cfl/guid_allocator.h"
+
+using namespace cfl;
+
+/// 多线程取号：加锁自增与 GuidAllocator 的耗时对比
+int main() {
+    const int threads = 4;
+    const int per_thread = 1000000;
+    std::mutex mutex;
+    std::uint64_t counter = 0;
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&]() {
+                for (int i = 0; i < per_thread; ++i) {
+                    std::scoped_lock lock(mutex);
+                    ++counter;
+                }
+            });
+        }
+    }
+    auto mutex_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    GuidAllocator alloc([](std::uint64_t) { return true; });
+    if (!alloc.start(0)) {
+        std::cerr << "[Guid] start failed" << std::endl;
+        return 1;
+    }
+    std::atomic<std::uint64_t> sum{0};
+    start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&]() {
+                std::uint64_t local = 0;
+                for (int i = 0; i < per_thread; ++i) {
+                    local += alloc.next();
+                }
+                sum += local;
+            });
+        }
+    }
+    auto alloc_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[Guid] " << threads * per_thread << " ids: mutex " << mutex_us << "us (" << counter
+              << "), allocator " << alloc_us << "us (checksum " << sum << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,37 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include "cfl/mail/mail_expiry_index.h"
+
+using namespace cfl::shm;
+using Kind = MailExpiryIndex::Kind;
+
+/// 稳定收发：每帧新增 200 封、有效期 60 秒，统计每帧清理的耗时
+int main() {
+    const std::uint64_t frame_ms = 50;
+    const std::uint64_t expire_ms = 60 * 1000;
+    const std::size_t per_frame = 200;
+    const std::size_t budget = 256;
+    MailExpiryIndex index(10 * 1000);
+    std::uint64_t guid = 0;
+    std::size_t expired = 0;
+    std::int64_t sweep_us = 0;
+    std::int64_t max_frame_us = 0;
+    const auto frames = 10 * expire_ms / frame_ms;
+    for (std::uint64_t now = 0; now < 10 * expire_ms; now += frame_ms) {
+        for (std::size_t i = 0; i < per_frame; ++i) {
+            index.add(Kind::Personal, ++guid, 1, now + expire_ms);
+        }
+        auto start = std::chrono::steady_clock::now();
+        expired += index.sweep(now, budget, [](const MailExpiryIndex::Entry &) {});
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        sweep_us += us;
+        max_frame_us = std::max(max_frame_us, us);
+    }
+
+    std::cout << "[Expiry] " << guid << " mails over " << frames << " frames: expired " << expired
+              << ", sweep " << sweep_us << "us total, " << sweep_us / static_cast<std::int64_t>(frames)
+              << "us avg, " << max_frame_us << "us max per frame" << std::endl;
+    return 0;
+}
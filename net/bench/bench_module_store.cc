@@ -0,0 +1,93 @@
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "cfl/modules/module_store.h"
+
+using namespace cfl;
+
+namespace {
+    // 批量处理的热数据直接存放在状态数组中
+    struct DayState {
+        std::uint64_t role_id = 0;
+        std::uint64_t logoff_time = 0;
+    };
+
+    // 模拟模块：保存在 ModuleStore 中的下标
+    struct FakeModule {
+        std::uint32_t slot = ModuleStore<DayState>::kNoSlot;
+        std::uint64_t role_id = 0;
+    };
+
+    // 旧方式：每个玩家一个模块数组，逐个虚调用，未实现的类型为空
+    struct VirtualModule {
+        virtual ~VirtualModule() = default;
+        virtual bool on_new_day(std::uint64_t now) = 0;
+    };
+
+    struct VirtualRole : VirtualModule {
+        std::uint64_t logoff_time = 0;
+
+        bool on_new_day(std::uint64_t now) override {
+            logoff_time = now + 1;
+            return true;
+        }
+    };
+
+    struct VirtualMail : VirtualModule {
+        bool on_new_day(std::uint64_t) override { return true; }
+    };
+
+    constexpr std::size_t kModuleTypes = 15;
+}
+
+/// 跨天处理：逐玩家遍历模块数组（虚调用 + 空检查）对比按模块批量遍历状态数组
+int main() {
+    const int players = 100000;
+    const int rounds = 20;
+    std::vector<std::vector<std::shared_ptr<VirtualModule>>> player_modules(players);
+    std::vector<std::unique_ptr<FakeModule>> roles;
+    ModuleStore<DayState> store;
+    for (int i = 0; i < players; ++i) {
+        auto &modules = player_modules[i];
+        modules.resize(kModuleTypes);
+        modules[0] = std::make_shared<VirtualRole>();
+        modules[13] = std::make_shared<VirtualMail>();
+        roles.push_back(std::make_unique<FakeModule>());
+        roles.back()->role_id = static_cast<std::uint64_t>(i);
+        store.add(roles.back()->slot, {roles.back()->role_id, 0});
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (auto &modules: player_modules) {
+            for (auto &module: modules) {
+                if (module) {
+                    module->on_new_day(static_cast<std::uint64_t>(r));
+                }
+            }
+        }
+    }
+    auto per_player_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (auto &state: store.states()) {
+            state.logoff_time = static_cast<std::uint64_t>(r) + 1;
+        }
+    }
+    auto batch_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    bool match = true;
+    for (int i = 0; i < players; ++i) {
+        match = match && store.at(roles[i]->slot).logoff_time == rounds &&
+                static_cast<VirtualRole &>(*player_modules[i][0]).logoff_time == rounds;
+    }
+    std::cout << "[ModuleStore] " << players << " players new day: per-player modules " << per_player_us / rounds
+              << "us, module store " << batch_us / rounds << "us ("
+              << (match ? "match" : "MISMATCH") << ")" << std::endl;
+    return 0;
+}
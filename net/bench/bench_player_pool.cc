@@ -0,0 +1,94 @@
+#include <iostream>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "cfl/id_table.h"
+#include "cfl/slab_pool.h"
+
+using namespace cfl;
+
+namespace {
+    // 模拟玩家对象：若干属性加一个需要析构的成员
+    struct FakePlayer {
+        std::uint64_t role_id = 0;
+        std::array<std::int64_t, 16> properties{};
+        std::vector<int> modules;
+
+        explicit FakePlayer(std::uint64_t id) : role_id(id), modules(4, 1) {}
+    };
+}
+
+/// 20 万玩家：对象池 + 开放寻址表 + 在线数组与 unordered_map<id, shared_ptr> 的查找和遍历耗时
+int main() {
+    const std::uint64_t players = 200000;
+    const std::uint64_t base = std::uint64_t{1} << 48;
+    std::unordered_map<std::uint64_t, std::shared_ptr<FakePlayer>> map;
+    SlabPool<FakePlayer> pool;
+    IdTable table;
+    std::vector<FakePlayer *> online;
+    for (std::uint64_t i = 0; i < players; ++i) {
+        auto id = base + i * 7;
+        map.emplace(id, std::make_shared<FakePlayer>(id));
+        auto handle = pool.emplace(id);
+        table.insert(id, handle.index);
+        if (i % 2 == 0) {
+            online.push_back(pool.get(handle));
+        }
+    }
+
+    std::mt19937_64 rng(11);
+    std::vector<std::uint64_t> lookups(1000000);
+    for (auto &id: lookups) {
+        id = base + (rng() % players) * 7;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::int64_t sum_map = 0;
+    for (auto id: lookups) {
+        sum_map += map.find(id)->second->properties[0] + 1;
+    }
+    auto map_lookup_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::int64_t sum_pool = 0;
+    for (auto id: lookups) {
+        sum_pool += pool.at(table.find(id))->properties[0] + 1;
+    }
+    auto pool_lookup_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    const int rounds = 20;
+    start = std::chrono::steady_clock::now();
+    std::uint64_t visited_map = 0;
+    for (int r = 0; r < rounds; ++r) {
+        for (auto &[id, player]: map) {
+            if (id % 14 == base % 14) {   // 与在线数组相同的一半玩家
+                player->properties[1] += 1;
+                ++visited_map;
+            }
+        }
+    }
+    auto map_iter_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::uint64_t visited_online = 0;
+    for (int r = 0; r < rounds; ++r) {
+        for (auto player: online) {
+            player->properties[1] += 1;
+            ++visited_online;
+        }
+    }
+    auto online_iter_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[PlayerPool] " << players << " players: lookup map " << map_lookup_us << "us, table "
+              << pool_lookup_us << "us; iterate online map " << map_iter_us / rounds << "us, dense "
+              << online_iter_us / rounds << "us (checksum "
+              << (sum_map == sum_pool && visited_map == visited_online ? "match" : "MISMATCH") << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "cfl/rank_list.h"
+
+using namespace cfl;
+
+/// 20 万角色：逐个插入与批量建表、更新并查名次、取前 100 名的耗时
+int main() {
+    const std::uint64_t count = 200000;
+    RankList list;
+    std::mt19937_64 rng(7);
+    std::vector<RankItem> items;
+    items.reserve(count);
+    for (std::uint64_t id = 1; id <= count; ++id) {
+        items.push_back({static_cast<RankList::Key>(id), id, rng() % 10000000});
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto &item: items) {
+        list.update(item.key, item.role_id, item.score);
+    }
+    auto build_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    RankList bulk;
+    start = std::chrono::steady_clock::now();
+    bulk.assign(items);
+    auto assign_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::uint64_t sum = 0;
+    for (int i = 0; i < 100000; ++i) {
+        auto id = rng() % count + 1;
+        list.update(id, id, list.score(id) + rng() % 1000);
+        sum += list.rank(id);
+    }
+    auto update_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; ++i) {
+        std::vector<RankEntry> top;
+        list.top(100, top);
+        sum += top.size();
+    }
+    auto top_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[Rank] build " << count << " roles: update " << build_us << "us, assign " << assign_us
+              << "us (" << bulk.size() << ")" << std::endl;
+    std::cout << "[Rank] 100000 update+rank: " << update_us << "us, 1000 top100: " << top_us
+              << "us (checksum " << sum << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include "cfl/simple_manager.h"
+#include "cfl/db/db_sqlite.h"
+
+using namespace cfl;
+
+/// 启动加载耗时：20 万角色，ID 不连续（模拟合服后的 ID 分布），4 个加载线程
+int main() {
+    const std::string path = "bench_simple_loader.db";
+    std::remove(path.c_str());
+
+    const int rows = 200000;
+    {
+        auto db = std::make_shared<db::SQLite>(std::unordered_map<std::string, std::string>{{"dbname", path}});
+        if (!db->connect()) {
+            std::cerr << "[Loader] connect failed" << std::endl;
+            return 1;
+        }
+        if (db->execute("CREATE TABLE player (id INTEGER PRIMARY KEY, accountid INTEGER, name TEXT, carrerid INTEGER, "
+                        "createtime INTEGER, logontime INTEGER, logofftime INTEGER, guildid INTEGER, "
+                        "level INTEGER, viplevel INTEGER);") < 0) {
+            std::cerr << "[Loader] create table failed" << std::endl;
+            return 1;
+        }
+        if (db->execute("BEGIN;") < 0) {
+            std::cerr << "[Loader] begin failed" << std::endl;
+            return 1;
+        }
+        for (int i = 0; i < rows; ++i) {
+            auto id = static_cast<int64_t>(i < rows / 2 ? 1000 + i : 5000000 + i * 3);
+            auto name = "role_" + std::to_string(id);
+            if (db->execStmt("INSERT INTO player VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);", id, int64_t{id / 2},
+                             std::string_view(name), i % 4 + 1, int64_t{1700000000}, int64_t{1700000100},
+                             int64_t{1700000200}, int64_t{0}, i % 150 + 1, i % 10) < 0) {
+                std::cerr << "[Loader] insert failed" << std::endl;
+                return 1;
+            }
+        }
+        if (db->execute("COMMIT;") < 0) {
+            std::cerr << "[Loader] commit failed" << std::endl;
+            return 1;
+        }
+    }
+
+    db::ConnectionFactory factory = [&path](const std::string &) -> db::Database::Ptr {
+        auto db = std::make_shared<db::SQLite>(std::unordered_map<std::string, std::string>{{"dbname", path}});
+        return db->connect() ? db : nullptr;
+    };
+
+    auto &mgr = SimpleManager::instance();
+    auto start = std::chrono::steady_clock::now();
+    if (!mgr.load_data(4, factory)) {
+        std::cerr << "[Loader] load_data failed" << std::endl;
+        return 1;
+    }
+    auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    std::remove(path.c_str());
+    std::cout << "[Loader] loaded " << mgr.get_total_count() << " roles in " << cost.count() << "ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cfl/simple_store.h"
+
+using namespace cfl;
+
+// 统计旧的 map + unique_ptr 存储分配的字节数
+static std::size_t g_allocated = 0;
+
+template<class T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template<class U>
+    CountingAllocator(const CountingAllocator<U> &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        g_allocated += n * sizeof(T);
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        g_allocated -= n * sizeof(T);
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template<class U>
+    bool operator==(const CountingAllocator<U> &) const noexcept { return true; }
+};
+
+static SimpleInfo make_info(std::uint64_t id) {
+    SimpleInfo info;
+    info.role_id = id;
+    info.account_id = 100000 + id / 3;          // 每个账号 3 个角色
+    info.guild_id = id % 7 == 0 ? 0 : id % 50;  // 部分角色无公会
+    info.level = static_cast<std::uint32_t>(id % 150);
+    info.name = "player_name_" + std::to_string(id);
+    return info;
+}
+
+/// 20 万角色：map + unique_ptr 存储与列式存储的内存占用，以及按账号查询的扫描与索引耗时
+int main() {
+    const std::uint64_t count = 200000;
+    std::size_t old_bytes = 0;
+    std::size_t new_bytes = 0;
+    std::int64_t scan_us = 0;
+    std::int64_t index_us = 0;
+    std::size_t scan_found = 0;
+    std::size_t index_found = 0;
+    {
+        // 旧布局：map 节点和桶由 CountingAllocator 统计，SimpleInfo 与超出 SSO 的名称按对象大小累加
+        using Name = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+        std::unordered_map<std::uint64_t, std::unique_ptr<SimpleInfo>, std::hash<std::uint64_t>,
+                std::equal_to<>, CountingAllocator<std::pair<const std::uint64_t, std::unique_ptr<SimpleInfo>>>> id_to_info;
+        std::unordered_map<Name, std::uint64_t, std::hash<std::string_view>, std::equal_to<>,
+                CountingAllocator<std::pair<const Name, std::uint64_t>>> name_to_id;
+        std::size_t info_bytes = 0;
+        for (std::uint64_t id = 1; id <= count; ++id) {
+            auto info = std::make_unique<SimpleInfo>(make_info(id));
+            info_bytes += sizeof(SimpleInfo) + (info->name.capacity() > 15 ? info->name.capacity() + 1 : 0);
+            name_to_id.emplace(Name(info->name), id);
+            id_to_info.emplace(id, std::move(info));
+        }
+        old_bytes = g_allocated + info_bytes;
+
+        auto start = std::chrono::steady_clock::now();
+        for (std::uint64_t account = 100000; account < 100000 + 100; ++account) {
+            for (auto &[id, info]: id_to_info) {
+                scan_found += info->account_id == account;
+            }
+        }
+        scan_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+    {
+        SimpleStore store;
+        for (std::uint64_t id = 1; id <= count; ++id) {
+            store.insert(make_info(id));
+        }
+        new_bytes = store.memory_bytes();
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::uint64_t> roles;
+        for (std::uint64_t account = 100000; account < 100000 + 100; ++account) {
+            roles.clear();
+            store.account_roles(account, roles);
+            index_found += roles.size();
+        }
+        index_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::cout << "[Store] map store: " << old_bytes / count << " B/role, columnar store: " << new_bytes / count
+              << " B/role" << std::endl;
+    std::cout << "[Store] 100 account lookups: scan " << scan_us << "us, index " << index_us << "us (found "
+              << scan_found << "/" << index_found << ")" << std::endl;
+    return 0;
+}
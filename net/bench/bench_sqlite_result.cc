@@ -0,0 +1,55 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include "cfl/db/db_sqlite.h"
+
+using namespace cfl::db;
+
+/// 大表加载耗时：物化结果（按列保存原生类型）与流式游标对比
+int main() {
+    auto db = std::make_shared<SQLite>(std::unordered_map<std::string, std::string>{{"dbname", ":memory:"}});
+    if (!db->connect()) {
+        std::cerr << "[SQLite] connect failed" << std::endl;
+        return 1;
+    }
+    const int rows = 100000;
+    if (db->execute("CREATE TABLE role (id INTEGER, level INTEGER, exp INTEGER, name TEXT);") < 0) {
+        std::cerr << "[SQLite] create table failed" << std::endl;
+        return 1;
+    }
+    if (db->execute("BEGIN;") < 0) {
+        std::cerr << "[SQLite] begin failed" << std::endl;
+        return 1;
+    }
+    for (int i = 0; i < rows; ++i) {
+        auto name = "role_" + std::to_string(i);
+        if (db->execStmt("INSERT INTO role VALUES (?, ?, ?, ?);", i, i % 100, int64_t{i} * 10, std::string_view(name)) < 0) {
+            std::cerr << "[SQLite] insert role failed" << std::endl;
+            return 1;
+        }
+    }
+    if (db->execute("COMMIT;") < 0) {
+        std::cerr << "[SQLite] commit failed" << std::endl;
+        return 1;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    int64_t sum = 0;
+    auto data = db->query("SELECT id, level, exp, name FROM role;");
+    while (data->next()) {
+        sum += data->get_int32(0) + data->get_int32(1) + data->get_int64(2);
+    }
+    auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+    std::cout << "[SQLiteResult] load " << rows << " rows cost " << cost.count() << "ms" << std::endl;
+
+    begin = std::chrono::steady_clock::now();
+    int64_t cursor_sum = 0;
+    auto cursor = db->query_cursor("SELECT id, level, exp, name FROM role;");
+    while (cursor->next()) {
+        cursor_sum += cursor->get_int32(0) + cursor->get_int32(1) + cursor->get_int64(2);
+    }
+    cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+    std::cout << "[SQLiteResult] cursor " << rows << " rows cost " << cost.count() << "ms (checksum "
+              << (sum == cursor_sum ? "match" : "MISMATCH") << ")" << std::endl;
+    return 0;
+}
@@ -285,6 +285,9 @@ namespace cfl::db {
         /// 获取错误描述
         [[nodiscard]] virtual std::string_view error_message() const = 0;
 
+        /// 心跳检查，连接可用时返回 true
+        virtual bool ping() = 0;
+
         /**
          * @brief 打开事务
          * @param auto_commit 是否启用自动提交
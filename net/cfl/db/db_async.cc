@@ -0,0 +1,168 @@
+#include "db_async.h"
+#include <algorithm>
+#include "cfl/config.h"
+#include "db_mysql.h"
+
+namespace cfl::db {
+
+    AsyncDb::~AsyncDb() {
+        stop();
+    }
+
+    bool AsyncDb::add_datasource(const std::string &name, std::size_t worker_count, ConnectionFactory factory,
+                                 int first_index) {
+        std::lock_guard lock(sources_mutex_);
+        if (stopped_ || sources_.contains(name)) {
+            return false;
+        }
+        auto source = std::make_unique<DataSource>();
+        source->name = name;
+        source->first_index = first_index;
+        source->factory = factory ? std::move(factory) : [](const std::string &source_name) {
+            return MySQLMgr::instance()->get(source_name);
+        };
+        worker_count = std::max<std::size_t>(1, worker_count);
+        for (std::size_t i = 0; i < worker_count; ++i) {
+            source->workers.push_back(std::make_unique<Worker>());
+        }
+        for (auto &worker: source->workers) {
+            worker->thread = std::jthread([this, src = source.get(), w = worker.get()] { run(*src, *w); });
+        }
+        spdlog::info("[AsyncDb] datasource {} started with {} workers", name, worker_count);
+        sources_.emplace(name, std::move(source));
+        return true;
+    }
+
+    void AsyncDb::stop() {
+        std::lock_guard lock(sources_mutex_);
+        stopped_ = true;
+        for (auto &[name, source]: sources_) {
+            for (auto &worker: source->workers) {
+                {
+                    std::lock_guard worker_lock(worker->mutex);
+                    worker->stopping = true;
+                }
+                worker->cv.notify_one();
+            }
+            for (auto &worker: source->workers) {
+                if (worker->thread.joinable()) {
+                    worker->thread.join();
+                }
+            }
+        }
+    }
+
+    AsyncDb::DataSource *AsyncDb::find_or_add(const std::string &name) {
+        {
+            std::lock_guard lock(sources_mutex_);
+            if (auto it = sources_.find(name); it != sources_.end()) {
+                return it->second.get();
+            }
+        }
+        add_datasource(name, static_cast<std::size_t>(std::max(1, Config::GetGameInfo("async_db_threads", 4))));
+        std::lock_guard lock(sources_mutex_);
+        auto it = sources_.find(name);
+        return it == sources_.end() ? nullptr : it->second.get();
+    }
+
+    int AsyncDb::datasource_first_index(const std::string &name) {
+        auto source = find_or_add(name);
+        return source ? source->first_index : 1;
+    }
+
+    bool AsyncDb::post(const std::string &name, std::uint64_t key, Work work) {
+        auto source = find_or_add(name);
+        if (source == nullptr) {
+            spdlog::error("[AsyncDb] datasource {} unavailable", name);
+            return false;
+        }
+        auto &workers = source->workers;
+        auto index = key != 0 ? key % workers.size()
+                              : source->next.fetch_add(1, std::memory_order_relaxed) % workers.size();
+        auto &worker = *workers[index];
+        {
+            std::lock_guard lock(worker.mutex);
+            if (worker.stopping) {
+                return false;
+            }
+            worker.jobs.push_back(std::move(work));
+        }
+        pending_.fetch_add(1, std::memory_order_release);
+        worker.cv.notify_one();
+        return true;
+    }
+
+    void AsyncDb::complete(std::function<void()> callback) {
+        std::lock_guard lock(completion_mutex_);
+        completions_.push_back(std::move(callback));
+    }
+
+    void AsyncDb::run(DataSource &source, Worker &worker) {
+        while (true) {
+            Work job;
+            {
+                std::unique_lock lock(worker.mutex);
+                worker.cv.wait(lock, [&] { return worker.stopping || !worker.jobs.empty(); });
+                if (worker.jobs.empty()) {
+                    break; // 停止且队列已清空
+                }
+                job = std::move(worker.jobs.front());
+                worker.jobs.pop_front();
+            }
+            if (!worker.conn) {
+                try {
+                    worker.conn = source.factory(source.name);
+                } catch (const std::exception &e) {
+                    spdlog::error("[AsyncDb] connect {} failed: {}", source.name, e.what());
+                }
+                if (!worker.conn) {
+                    spdlog::error("[AsyncDb] no connection for {}", source.name);
+                }
+            }
+            // 任务失败时检查连接，已断开的连接丢弃，下一个任务重新创建
+            if (!job(worker.conn) && worker.conn && !worker.conn->ping()) {
+                spdlog::warn("[AsyncDb] {} connection dropped, reconnect on next job", source.name);
+                worker.conn.reset();
+            }
+            pending_.fetch_sub(1, std::memory_order_release);
+        }
+        worker.conn.reset();
+    }
+
+    bool AsyncDb::query(const std::string &name, std::uint64_t key, std::string sql,
+                        std::function<void(SqlData::Ptr)> done) {
+        return submit<SqlData::Ptr>(name, key, [sql = std::move(sql)](const Database::Ptr &db) -> SqlData::Ptr {
+            return db ? db->query(sql) : nullptr;
+        }, std::move(done));
+    }
+
+    bool AsyncDb::execute(const std::string &name, std::uint64_t key, std::string sql,
+                          std::function<void(int)> done) {
+        return submit<int>(name, key, [sql = std::move(sql)](const Database::Ptr &db) -> int {
+            return db ? db->execute(sql) : -1;
+        }, std::move(done));
+    }
+
+    std::size_t AsyncDb::poll(std::size_t max_callbacks) {
+        {
+            std::lock_guard lock(completion_mutex_);
+            if (polling_.empty()) {
+                polling_.swap(completions_);
+            }
+        }
+        std::size_t count = 0;
+        while (!polling_.empty() && count < max_callbacks) {
+            auto callback = std::move(polling_.front());
+            polling_.pop_front();
+            callback();
+            ++count;
+        }
+        return count;
+    }
+
+    std::size_t AsyncDb::completed() const {
+        std::lock_guard lock(completion_mutex_);
+        return completions_.size() + polling_.size();
+    }
+
+} // namespace cfl::db
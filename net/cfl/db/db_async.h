@@ -0,0 +1,301 @@
+/**
+ * @file db_async.h
+ * @brief 异步数据库执行器
+ *
+ * @details
+ * MySQLUtil / SQLiteUtil 在调用线程上同步执行 SQL，数据库抖动会直接卡住逻辑帧。
+ * AsyncDb 为每个数据源启动 N 个工作线程，每个线程持有独占的数据库连接：
+ * - 逻辑线程提交任务后立即返回，SQL 在工作线程执行；
+ * - 结果（SqlData::Ptr / 影响行数 / 自定义类型）放入完成队列，由逻辑线程每帧调用 poll 取回并执行回调，
+ *   回调总是运行在逻辑线程，可以直接访问游戏对象；
+ * - 相同 key（如角色 ID）的任务总是交给同一个工作线程，按提交顺序执行、按提交顺序完成；
+ *   key 为 0 的任务没有顺序要求，轮流分配给各个工作线程。
+ *
+ * @code
+ * auto async = cfl::db::AsyncDbMgr::instance();
+ * async->execute_prepared("db_game", role_id, "UPDATE role SET exp=? WHERE id=?",
+ *                         [](int rows) { ... }, exp, role_id);
+ * // 逻辑线程每帧
+ * async->poll();
+ * @endcode
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "spdlog/spdlog.h"
+#include "db.h"
+#include "cfl/singleton.h"
+
+namespace cfl::db {
+
+    /**
+     * @brief 为工作线程创建独占连接
+     * @param name 数据源名称
+     * @return 连接，失败时返回 nullptr（下一个任务会重试）
+     */
+    using ConnectionFactory = std::function<Database::Ptr(const std::string &name)>;
+
+    class AsyncDb {
+    public:
+        using Ptr = std::shared_ptr<AsyncDb>;
+
+        /// 在工作线程中执行的任务，db 可能为 nullptr（连接失败）；
+        /// 返回 false 表示任务失败（抛出异常或语句执行失败），工作线程随后检查连接，已断开时重连
+        using Work = std::function<bool(const Database::Ptr &db)>;
+
+        AsyncDb() = default;
+
+        /**
+         * @brief 析构时停止所有工作线程，已提交的任务会先执行完
+         */
+        ~AsyncDb();
+
+        AsyncDb(const AsyncDb &) = delete;
+        AsyncDb &operator=(const AsyncDb &) = delete;
+
+        /**
+         * @brief 注册一个数据源并启动工作线程
+         *
+         * @details 未注册的数据源在第一次提交任务时自动注册，工作线程数取配置项 async_db_threads（默认 4），
+         * 连接由 MySQLMgr 创建。
+         *
+         * @param name 数据源名称
+         * @param worker_count 工作线程数（每个线程一个连接）
+         * @param factory 连接工厂，为空时使用 MySQLMgr
+         * @param first_index 预编译语句第一个占位符的绑定下标（MySQL 从 1 开始，SQLite 从 0 开始）
+         * @return 已注册时返回 false
+         */
+        bool add_datasource(const std::string &name, std::size_t worker_count, ConnectionFactory factory = {},
+                            int first_index = 1);
+
+        /**
+         * @brief 停止所有工作线程
+         * @details 等待已提交的任务执行完，尚未 poll 的完成回调仍保留在完成队列中。
+         */
+        void stop();
+
+        /**
+         * @brief 提交任务
+         *
+         * @tparam R 结果类型
+         * @param name 数据源名称
+         * @param key 顺序键，相同的 key 按提交顺序执行，0 表示无顺序要求
+         * @param work 在工作线程执行，异常时结果为 R{}；结果表示失败时（见 failed）检查连接
+         * @param done 在逻辑线程 poll 时以结果调用（可为空）
+         * @return 停止后提交返回 false
+         */
+        template<class R>
+        bool submit(const std::string &name, std::uint64_t key, std::function<R(const Database::Ptr &)> work,
+                    std::function<void(R)> done) {
+            return post(name, key, [this, work = std::move(work), done = std::move(done)](const Database::Ptr &db) {
+                R result{};
+                bool ok = true;
+                try {
+                    result = work(db);
+                    ok = !failed(result);
+                } catch (const std::exception &e) {
+                    spdlog::error("[AsyncDb] job failed: {}", e.what());
+                    ok = false;
+                }
+                if (done) {
+                    complete([done, result = std::move(result)]() mutable { done(std::move(result)); });
+                }
+                return ok;
+            });
+        }
+
+        /**
+         * @brief 异步查询
+         * @param done 查询结果，失败时为 nullptr
+         */
+        bool query(const std::string &name, std::uint64_t key, std::string sql,
+                   std::function<void(SqlData::Ptr)> done);
+
+        /**
+         * @brief 异步执行更新语句
+         * @param done 影响的行数，失败时为 -1
+         */
+        bool execute(const std::string &name, std::uint64_t key, std::string sql, std::function<void(int)> done);
+
+        /**
+         * @brief 异步执行预编译语句
+         * @details 参数在提交时按值拷贝（字符数组/字符串拷贝为 std::string），工作线程中不会再访问调用方的内存。
+         * @param done 影响的行数，失败时为 -1
+         */
+        template<class... Args>
+        bool execute_prepared(const std::string &name, std::uint64_t key, std::string sql,
+                              std::function<void(int)> done, Args &&... args) {
+            auto first_index = datasource_first_index(name);
+            return submit<int>(name, key,
+                               [sql = std::move(sql), first_index,
+                                values = std::make_tuple(stored_value(std::forward<Args>(args))...)]
+                                       (const Database::Ptr &db) -> int {
+                                   auto stmt = prepare_and_bind(db, sql, first_index, values);
+                                   return stmt ? stmt->execute() : -1;
+                               }, std::move(done));
+        }
+
+        /**
+         * @brief 异步执行预编译查询
+         * @param done 查询结果，失败时为 nullptr
+         */
+        template<class... Args>
+        bool query_prepared(const std::string &name, std::uint64_t key, std::string sql,
+                            std::function<void(SqlData::Ptr)> done, Args &&... args) {
+            auto first_index = datasource_first_index(name);
+            return submit<SqlData::Ptr>(name, key,
+                                        [sql = std::move(sql), first_index,
+                                         values = std::make_tuple(stored_value(std::forward<Args>(args))...)]
+                                                (const Database::Ptr &db) -> SqlData::Ptr {
+                                            auto stmt = prepare_and_bind(db, sql, first_index, values);
+                                            return stmt ? stmt->query() : nullptr;
+                                        }, std::move(done));
+        }
+
+        /**
+         * @brief 在逻辑线程中执行已完成任务的回调
+         * @param max_callbacks 本次最多执行的回调数
+         * @return 执行的回调数
+         */
+        std::size_t poll(std::size_t max_callbacks = SIZE_MAX);
+
+        /**
+         * @brief 已提交但尚未执行完的任务数
+         */
+        [[nodiscard]] std::size_t pending() const noexcept { return pending_.load(std::memory_order_acquire); }
+
+        /**
+         * @brief 等待回调执行的已完成任务数
+         */
+        [[nodiscard]] std::size_t completed() const;
+
+    private:
+        /**
+         * @brief 工作线程：独占连接和任务队列
+         */
+        struct Worker {
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::deque<Work> jobs;
+            bool stopping = false;
+            Database::Ptr conn;
+            std::jthread thread;
+        };
+
+        /**
+         * @brief 数据源
+         */
+        struct DataSource {
+            std::string name;
+            ConnectionFactory factory;
+            int first_index = 1;
+            std::vector<std::unique_ptr<Worker>> workers;
+            std::atomic<std::size_t> next{0}; ///< key 为 0 时轮流分配
+        };
+
+        /// 按 key 把任务投递给数据源的工作线程
+        bool post(const std::string &name, std::uint64_t key, Work work);
+
+        /// 把完成回调放入完成队列
+        void complete(std::function<void()> callback);
+
+        /// 查找数据源，不存在时按配置自动注册
+        DataSource *find_or_add(const std::string &name);
+
+        /// 数据源的绑定起始下标
+        int datasource_first_index(const std::string &name);
+
+        /// 工作线程主循环
+        void run(DataSource &source, Worker &worker);
+
+        /// 任务结果是否表示失败：bool 为 false、整数小于 0（影响行数）、指针为空（结果集）
+        template<class R>
+        static bool failed(const R &result) {
+            if constexpr (std::is_same_v<R, bool>) {
+                return !result;
+            } else if constexpr (std::is_integral_v<R>) {
+                return result < 0;
+            } else if constexpr (std::is_constructible_v<bool, const R &>) {
+                return !static_cast<bool>(result);
+            } else {
+                return false;
+            }
+        }
+
+        /// 参数的存储类型：字符串类拷贝为 std::string，其余按值保存
+        template<class T>
+        static auto stored_value(T &&value) {
+            using D = std::decay_t<T>;
+            if constexpr (std::is_arithmetic_v<D>) {
+                return static_cast<D>(value);
+            } else if constexpr (std::is_convertible_v<const D &, std::string_view>) {
+                return std::string(std::string_view(value));
+            } else {
+                return D(std::forward<T>(value));
+            }
+        }
+
+        template<class T>
+        static int bind_value(Statement &stmt, int idx, const T &value) {
+            if constexpr (std::is_same_v<T, std::string>) {
+                return stmt.bind(idx, std::string_view(value));
+            } else if constexpr (std::is_same_v<T, bool>) {
+                return stmt.bind(idx, static_cast<int8_t>(value));
+            } else {
+                return stmt.bind(idx, value);
+            }
+        }
+
+        /// 预编译并按顺序绑定参数，失败返回 nullptr
+        template<class Tuple>
+        static Statement::Ptr prepare_and_bind(const Database::Ptr &db, const std::string &sql, int first_index,
+                                               const Tuple &values) {
+            if (!db) {
+                return nullptr;
+            }
+            auto stmt = db->prepare(sql);
+            if (!stmt) {
+                spdlog::error("[AsyncDb] prepare failed: {}", sql);
+                return nullptr;
+            }
+            int idx = first_index;
+            bool ok = std::apply([&](const auto &... value) {
+                return ((bind_value(*stmt, idx++, value) == 0) && ...);
+            }, values);
+            if (!ok) {
+                spdlog::error("[AsyncDb] bind failed: {}", sql);
+                return nullptr;
+            }
+            return stmt;
+        }
+
+        mutable std::mutex sources_mutex_;
+        std::unordered_map<std::string, std::unique_ptr<DataSource>> sources_;
+        bool stopped_ = false;
+
+        mutable std::mutex completion_mutex_;
+        std::deque<std::function<void()>> completions_; ///< 完成队列，由逻辑线程 poll
+        std::deque<std::function<void()>> polling_;     ///< poll 时与完成队列交换，缩短持锁时间
+
+        std::atomic<std::size_t> pending_{0};
+    };
+
+    typedef cfl::SingletonPtr<AsyncDb> AsyncDbMgr;
+
+} // namespace cfl::db
@@ -0,0 +1,197 @@
+#include "db_batch.h"
+#include <algorithm>
+
+namespace cfl::db {
+
+    namespace {
+        /// MySQL X 协议单条语句的占位符上限
+        constexpr std::size_t kMySQLMaxParams = 65535;
+        /// SQLite 3.32 之前 SQLITE_MAX_VARIABLE_NUMBER 的默认值，按较小值兼容
+        constexpr std::size_t kSQLiteMaxParams = 999;
+    }
+
+    BatchWriter::BatchWriter(Database::Ptr db, SqlDialect dialect, std::string table,
+                             std::vector<std::string> columns, BatchOptions options, Releaser release)
+            : db_(std::move(db)), release_(std::move(release)), dialect_(dialect), table_(std::move(table)), columns_(std::move(columns)),
+              options_(std::move(options)) {
+        if (options_.key_columns.empty() && !columns_.empty()) {
+            options_.key_columns.push_back(columns_.front());
+        }
+        auto max_params = options_.max_params != 0 ? options_.max_params
+                                                   : (dialect_ == SqlDialect::MySQL ? kMySQLMaxParams
+                                                                                    : kSQLiteMaxParams);
+        if (!columns_.empty()) {
+            rows_per_statement_ = std::max<std::size_t>(1, std::min(options_.max_rows, max_params / columns_.size()));
+            full_sql_ = build_sql(rows_per_statement_);
+        }
+        values_.reserve(rows_per_statement_ * columns_.size());
+        if (!db_) {
+            spdlog::error("[BatchWriter] {}: no database connection", table_);
+            failed_ = true;
+        }
+    }
+
+    BatchWriter::~BatchWriter() {
+        if (transaction_) {
+            rollback();
+        }
+        if (release_ && db_) {
+            release_(std::move(db_));
+        }
+    }
+
+    std::string BatchWriter::build_sql(std::size_t rows) const {
+        std::string sql;
+        sql.reserve(64 + columns_.size() * (16 + rows * 3));
+        if (options_.mode == BatchMode::Replace) {
+            sql += dialect_ == SqlDialect::MySQL ? "REPLACE INTO " : "INSERT OR REPLACE INTO ";
+        } else {
+            sql += "INSERT INTO ";
+        }
+        sql += table_;
+        sql += " (";
+        for (std::size_t i = 0; i < columns_.size(); ++i) {
+            if (i > 0) sql += ", ";
+            sql += columns_[i];
+        }
+        sql += ") VALUES ";
+
+        std::string row = "(";
+        for (std::size_t i = 0; i < columns_.size(); ++i) {
+            row += i > 0 ? ", ?" : "?";
+        }
+        row += ")";
+        for (std::size_t r = 0; r < rows; ++r) {
+            if (r > 0) sql += ", ";
+            sql += row;
+        }
+
+        if (options_.mode == BatchMode::Upsert) {
+            auto is_key = [this](const std::string &column) {
+                return std::find(options_.key_columns.begin(), options_.key_columns.end(), column)
+                       != options_.key_columns.end();
+            };
+            if (dialect_ == SqlDialect::MySQL) {
+                sql += " ON DUPLICATE KEY UPDATE ";
+            } else {
+                sql += " ON CONFLICT (";
+                for (std::size_t i = 0; i < options_.key_columns.size(); ++i) {
+                    if (i > 0) sql += ", ";
+                    sql += options_.key_columns[i];
+                }
+                sql += ") DO UPDATE SET ";
+            }
+            bool first = true;
+            for (auto &column: columns_) {
+                if (is_key(column)) {
+                    continue;
+                }
+                if (!first) sql += ", ";
+                first = false;
+                sql += column;
+                sql += dialect_ == SqlDialect::MySQL ? " = VALUES(" + column + ")" : " = excluded." + column;
+            }
+        }
+        return sql;
+    }
+
+    bool BatchWriter::ensure_transaction() {
+        if (transaction_) {
+            return true;
+        }
+        transaction_ = db_->open_transaction(false);
+        if (!transaction_) {
+            spdlog::error("[BatchWriter] {}: open transaction failed", table_);
+            return false;
+        }
+        return true;
+    }
+
+    int BatchWriter::bind(Statement &stmt, int idx, const Value &value) const {
+        switch (value.type) {
+            case Value::Null:
+                return stmt.bind(idx, nullptr);
+            case Value::Int:
+                return stmt.bind(idx, value.i);
+            case Value::UInt:
+                return stmt.bind(idx, value.u);
+            case Value::Double:
+                return stmt.bind(idx, value.d);
+            case Value::Text:
+                return stmt.bind(idx, std::string_view(text_).substr(value.offset, value.length));
+        }
+        return -1;
+    }
+
+    bool BatchWriter::flush() {
+        if (failed_) {
+            return false;
+        }
+        if (buffered_rows_ == 0) {
+            return true;
+        }
+        if (!ensure_transaction()) {
+            failed_ = true;
+            return false;
+        }
+
+        std::string partial;
+        const auto &sql = buffered_rows_ == rows_per_statement_ ? full_sql_ : (partial = build_sql(buffered_rows_));
+        auto stmt = db_->prepare(sql);
+        if (!stmt) {
+            spdlog::error("[BatchWriter] {}: prepare failed", table_);
+            failed_ = true;
+            return false;
+        }
+        int idx = dialect_ == SqlDialect::MySQL ? 1 : 0;
+        for (auto &value: values_) {
+            if (bind(*stmt, idx++, value) != 0) {
+                spdlog::error("[BatchWriter] {}: bind failed at {}", table_, idx - 1);
+                failed_ = true;
+                return false;
+            }
+        }
+        if (stmt->execute() < 0) {
+            spdlog::error("[BatchWriter] {}: execute {} rows failed: {}", table_, buffered_rows_, stmt->error_message());
+            failed_ = true;
+            return false;
+        }
+        ++statements_;
+        clear_buffer();
+        return true;
+    }
+
+    bool BatchWriter::commit() {
+        if (!flush()) {
+            rollback();
+            return false;
+        }
+        if (!transaction_) {
+            return true;
+        }
+        bool ok = transaction_->commit();
+        if (!ok) {
+            spdlog::error("[BatchWriter] {}: commit failed: {}", table_, transaction_->error_message());
+            transaction_->rollback();
+            failed_ = true;
+        }
+        transaction_.reset();
+        return ok;
+    }
+
+    void BatchWriter::rollback() {
+        clear_buffer();
+        if (transaction_) {
+            transaction_->rollback();
+            transaction_.reset();
+        }
+    }
+
+    void BatchWriter::clear_buffer() {
+        values_.clear();
+        text_.clear();
+        buffered_rows_ = 0;
+        buffered_bytes_ = 0;
+    }
+
+} // namespace cfl::db
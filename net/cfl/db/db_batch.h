@@ -0,0 +1,215 @@
+/**
+ * @file db_batch.h
+ * @brief 多行批量写入器
+ *
+ * @details
+ * 逐行 `REPLACE INTO ... VALUES(?,...)` 每一行都是一次数据库往返，停服或定时存盘时几万个角色就是几万次往返。
+ * BatchWriter 针对一张表和一组列累积多行数据，达到行数或字节数上限时生成一条多行语句
+ * `REPLACE INTO t (a, b) VALUES (?, ?), (?, ?), ...` 执行，所有语句在同一个事务中，commit 时统一提交。
+ *
+ * 支持的写入方式：
+ * - Replace：MySQL 为 `REPLACE INTO`，SQLite 为 `INSERT OR REPLACE INTO`；
+ * - Upsert：MySQL 为 `INSERT ... ON DUPLICATE KEY UPDATE c = VALUES(c)`，
+ *   SQLite 为 `INSERT ... ON CONFLICT (key) DO UPDATE SET c = excluded.c`（需要 SQLite 3.24+）。
+ *
+ * @code
+ * auto writer = cfl::db::MySQLUtil::batch_writer("db_game", "mail", {"id", "roleid", "title"});
+ * for (auto &mail : mails) {
+ *     writer.add_row(mail.guid, mail.role_id, std::string_view(mail.title));
+ * }
+ * bool ok = writer.commit();   // 失败时整个事务回滚
+ * @endcode
+ *
+ * @note 行数据在 add_row 时拷贝，调用方的对象之后可以继续修改；一个 BatchWriter 只能在一个线程中使用。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "spdlog/spdlog.h"
+#include "db.h"
+
+namespace cfl::db {
+
+    /**
+     * @brief SQL 方言，决定生成的语句和占位符的绑定下标
+     */
+    enum class SqlDialect {
+        MySQL,   ///< 绑定下标从 1 开始
+        SQLite,  ///< 绑定下标从 0 开始
+    };
+
+    /**
+     * @brief 批量写入方式
+     */
+    enum class BatchMode {
+        Replace, ///< 整行替换
+        Upsert,  ///< 插入，主键冲突时更新非主键列
+    };
+
+    /**
+     * @brief 批量写入参数
+     */
+    struct BatchOptions {
+        BatchMode mode = BatchMode::Replace;
+        std::size_t max_rows = 500;                ///< 每条语句的最大行数
+        std::size_t max_bytes = 1024 * 1024;       ///< 每条语句绑定数据的最大字节数（MySQL 受 max_allowed_packet 限制）
+        std::size_t max_params = 0;                ///< 每条语句的最大占位符数，0 表示按方言取默认值
+        std::vector<std::string> key_columns;      ///< 主键列（Upsert 时不更新），为空时取第一列
+    };
+
+    class BatchWriter {
+    public:
+        /// 归还连接的回调，连接从连接池取出时由创建方提供
+        using Releaser = std::function<void(Database::Ptr db)>;
+
+        /**
+         * @param db 数据库连接，批量写入期间独占使用
+         * @param dialect SQL 方言
+         * @param table 表名
+         * @param columns 列名，add_row 的参数按此顺序
+         * @param options 批量参数
+         * @param release 析构时归还连接（可为空，连接随写入器一起释放）
+         */
+        BatchWriter(Database::Ptr db, SqlDialect dialect, std::string table, std::vector<std::string> columns,
+                    BatchOptions options = {}, Releaser release = {});
+
+        /**
+         * @brief 析构时未提交的事务会回滚，缓冲中的行被丢弃，然后归还连接
+         */
+        ~BatchWriter();
+
+        BatchWriter(const BatchWriter &) = delete;
+        BatchWriter &operator=(const BatchWriter &) = delete;
+
+        /**
+         * @brief 追加一行，缓冲达到上限时执行一条多行语句
+         * @param values 各列的值，数量必须与列数一致（整数、浮点、字符串、nullptr）
+         * @return 列数不一致、连接无效或执行失败时返回 false，之后的写入都会失败
+         */
+        template<class... Args>
+        bool add_row(const Args &... values) {
+            if (sizeof...(Args) != columns_.size()) {
+                spdlog::error("[BatchWriter] {}: expected {} values, got {}", table_, columns_.size(), sizeof...(Args));
+                failed_ = true;
+                return false;
+            }
+            if (failed_) {
+                return false;
+            }
+            (append(values), ...);
+            ++buffered_rows_;
+            ++total_rows_;
+            if (buffered_rows_ >= rows_per_statement_ || buffered_bytes_ >= options_.max_bytes) {
+                return flush();
+            }
+            return true;
+        }
+
+        /**
+         * @brief 执行缓冲中的行（不提交事务）
+         */
+        bool flush();
+
+        /**
+         * @brief 执行剩余的行并提交事务
+         * @return 任何一条语句失败时回滚整个事务并返回 false
+         */
+        bool commit();
+
+        /**
+         * @brief 放弃缓冲中的行并回滚已执行的语句
+         */
+        void rollback();
+
+        /// 已追加的行数（含已执行的）
+        [[nodiscard]] std::size_t row_count() const { return total_rows_; }
+
+        /// 已执行的语句数
+        [[nodiscard]] std::size_t statement_count() const { return statements_; }
+
+        /// 是否出错
+        [[nodiscard]] bool failed() const { return failed_; }
+
+        /// 每条语句的最大行数（受占位符上限约束后）
+        [[nodiscard]] std::size_t rows_per_statement() const { return rows_per_statement_; }
+
+    private:
+        /// 一个缓冲的值，字符串存放在 text_ 中
+        struct Value {
+            enum Type : std::uint8_t { Null, Int, UInt, Double, Text } type = Null;
+            union {
+                std::int64_t i;
+                std::uint64_t u;
+                double d;
+            };
+            std::uint32_t offset = 0;
+            std::uint32_t length = 0;
+        };
+
+        template<class T>
+        void append(const T &value) {
+            Value v{};
+            if constexpr (std::is_same_v<T, std::nullptr_t>) {
+                v.type = Value::Null;
+            } else if constexpr (std::is_same_v<T, bool>) {
+                v.type = Value::Int;
+                v.i = value ? 1 : 0;
+            } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                v.type = Value::Int;
+                v.i = value;
+            } else if constexpr (std::is_integral_v<T>) {
+                v.type = Value::UInt;
+                v.u = value;
+            } else if constexpr (std::is_floating_point_v<T>) {
+                v.type = Value::Double;
+                v.d = value;
+            } else {
+                static_assert(std::is_convertible_v<const T &, std::string_view>, "BatchWriter: unsupported value type");
+                std::string_view text(value);
+                v.type = Value::Text;
+                v.offset = static_cast<std::uint32_t>(text_.size());
+                v.length = static_cast<std::uint32_t>(text.size());
+                text_.append(text);
+                buffered_bytes_ += text.size();
+            }
+            buffered_bytes_ += sizeof(std::uint64_t);
+            values_.push_back(v);
+        }
+
+        /// 生成 rows 行的语句
+        [[nodiscard]] std::string build_sql(std::size_t rows) const;
+
+        /// 第一次执行语句前开启事务
+        bool ensure_transaction();
+
+        int bind(Statement &stmt, int idx, const Value &value) const;
+
+        void clear_buffer();
+
+        Database::Ptr db_;
+        Releaser release_;
+        SqlDialect dialect_;
+        std::string table_;
+        std::vector<std::string> columns_;
+        BatchOptions options_;
+        std::size_t rows_per_statement_ = 1;
+        std::string full_sql_;              ///< 满批次的语句，每批复用（MySQL 连接会命中语句缓存）
+
+        Transaction::Ptr transaction_;
+        std::vector<Value> values_;         ///< 缓冲的值，按行依次排列
+        std::string text_;                  ///< 字符串值的存储区
+        std::size_t buffered_rows_ = 0;
+        std::size_t buffered_bytes_ = 0;
+        std::size_t total_rows_ = 0;
+        std::size_t statements_ = 0;
+        bool failed_ = false;
+    };
+
+} // namespace cfl::db
@@ -311,7 +311,8 @@ namespace cfl::db {
 
     MySQL::MySQL(
             const std::unordered_map<std::string, std::string> &args)
-            : m_params(args) {}
+            : m_params(args),
+              m_stmt_capacity(static_cast<std::size_t>(std::max(0, Config::GetGameInfo("mysql_stmt_cache_size", 64)))) {}
 
     bool MySQL::connect() {
         try {
@@ -321,6 +322,7 @@ namespace cfl::db {
             std::string pwd = m_params.contains("password") ? m_params.at("password") : "";
             std::string db = m_params.contains("dbname") ? m_params.at("dbname") : "";
 
+            clear_stmt_cache();
             m_session = std::make_shared<mysqlx::Session>(host, port, user, pwd);
 
             if (!db.empty()) {
@@ -342,6 +344,7 @@ namespace cfl::db {
         try {
             if (!m_session) return false;
             m_session->sql("SELECT 1").execute();
+            touch();
             return true;
         } catch (...) {
             return false;
@@ -351,6 +354,7 @@ namespace cfl::db {
     int MySQL::execute(std::string_view sql) {
         try {
             auto res = m_session->sql(std::string(sql)).execute();
+            touch();
             return static_cast<int>(res.getAffectedItemsCount());
         } catch (const mysqlx::Error &err) {
             m_has_error = true;
@@ -381,6 +385,7 @@ namespace cfl::db {
 //                spdlog::error("[MySQL] query begin: {}  dbname: {}", sql, m_dbname);
             auto res = m_session->sql(std::string(sql)).execute();
 //                spdlog::error("[MySQL] query end: {}", res.count());
+            touch();
             return std::make_shared<MySQLResult>(std::move(res)); // 需要 MySQLRes 封装 SqlData
         } catch (const mysqlx::Error &err) {
             m_has_error = true;
@@ -402,12 +407,38 @@ namespace cfl::db {
 
     Statement::Ptr MySQL::prepare(std::string_view sql) {
         try {
-            return std::make_shared<MySQLStatement>(m_session, std::string(sql));
+            return cached_statement(sql);
         } catch (...) {
             return nullptr;
         }
     }
 
+    std::shared_ptr<MySQLStatement> MySQL::cached_statement(std::string_view sql) {
+        if (m_stmt_capacity == 0) {
+            return MySQLStatement::create(m_session, sql);
+        }
+        if (auto it = m_stmt_cache.find(sql); it != m_stmt_cache.end()) {
+            ++m_stmt_hits;
+            m_stmt_lru.splice(m_stmt_lru.begin(), m_stmt_lru, it->second);
+            auto &stmt = m_stmt_lru.front();
+            stmt->clear_bindings();
+            return stmt;
+        }
+        auto stmt = MySQLStatement::create(m_session, sql);
+        if (m_stmt_lru.size() >= m_stmt_capacity) {
+            m_stmt_cache.erase(m_stmt_lru.back()->sql());
+            m_stmt_lru.pop_back();
+        }
+        m_stmt_lru.push_front(stmt);
+        m_stmt_cache.emplace(stmt->sql(), m_stmt_lru.begin());
+        return stmt;
+    }
+
+    void MySQL::clear_stmt_cache() {
+        m_stmt_cache.clear();
+        m_stmt_lru.clear();
+    }
+
     int MySQL::error_code() const {
         return m_has_error ? -1 : 0;
     }
@@ -448,10 +479,16 @@ namespace cfl::db {
         return m_cmd.c_str();
     }
 
-    bool MySQL::is_need_check() const {
+    bool MySQL::is_need_check(int idle_seconds) const {
         auto now = duration_cast<seconds>(
                 system_clock::now().time_since_epoch()).count();
-        return (now - m_last_used_time) > 60;
+        return m_has_error || (now - static_cast<int64_t>(m_last_used_time)) > idle_seconds;
+    }
+
+    void MySQL::touch() {
+        m_has_error = false;
+        m_last_used_time = duration_cast<seconds>(
+                system_clock::now().time_since_epoch()).count();
     }
 
     MySQLTransaction::MySQLTransaction(std::shared_ptr<mysqlx::Session>
@@ -573,13 +610,25 @@ namespace cfl::db {
         return std::make_shared<MySQLStatement>(std::move(sess), std::string(stmt));
     }
 
-// ========== 绑定参数 ==========
-    int MySQLStatement::bind(int idx, std::nullptr_t) {
+    void MySQLStatement::clear_bindings() {
+        bound_count_ = 0;
+    }
+
+    int MySQLStatement::slot(int idx) {
         if (idx <= 0) return -1;
-        if (bound_params_.size() < static_cast<size_t>(idx)) {
-            bound_params_.resize(idx);
+        auto count = static_cast<size_t>(idx);
+        if (bound_params_.size() < count) {
+            bound_params_.resize(count);
         }
-        bound_params_[idx - 1] = mysqlx::Value(); // null
+        bound_count_ = std::max(bound_count_, count);
+        return idx - 1;
+    }
+
+// ========== 绑定参数 ==========
+    int MySQLStatement::bind(int idx, std::nullptr_t) {
+        auto i = slot(idx);
+        if (i < 0) return -1;
+        bound_params_[i] = mysqlx::Value(); // null
         return 0;
     }
 
@@ -592,59 +641,63 @@ namespace cfl::db {
     int MySQLStatement::bind(int idx, uint16_t value) { return bind(idx, static_cast<uint32_t>(value)); }
 
     int MySQLStatement::bind(int idx, int32_t value) {
-        if (idx <= 0) return -1;
-        if (bound_params_.size() < static_cast<size_t>(idx)) bound_params_.resize(idx);
-        bound_params_[idx - 1] = mysqlx::Value(value);
+        auto i = slot(idx);
+        if (i < 0) return -1;
+        bound_params_[i] = mysqlx::Value(value);
         return 0;
     }
 
     int MySQLStatement::bind(int idx, uint32_t value) {
-        if (idx <= 0) return -1;
-        if (bound_params_.size() < static_cast<size_t>(idx)) bound_params_.resize(idx);
-        bound_params_[idx - 1] = mysqlx::Value(value);
+        auto i = slot(idx);
+        if (i < 0) return -1;
+        bound_params_[i] = mysqlx::Value(value);
         return 0;
     }
 
     int MySQLStatement::bind(int idx, int64_t value) {
-        if (idx <= 0) return -1;
-        if (bound_params_.size() < static_cast<size_t>(idx)) bound_params_.resize(idx);
-        bound_params_[idx - 1] = mysqlx::Value(value);
+        auto i = slot(idx);
+        if (i < 0) return -1;
+        bound_params_[i] = mysqlx::Value(value);
         return 0;
     }
 
     int MySQLStatement::bind(int idx, uint64_t value) {
-        if (idx <= 0) return -1;
-        if (bound_params_.size() < static_cast<size_t>(idx)) bound_params_.resize(idx);
-        bound_params_[idx - 1] = mysqlx::Value(value);
+        auto i = slot(idx);
+        if (i < 0) return -1;
+        bound_params_[i] = mysqlx::Value(value);
         return 0;
     }
 
     int MySQLStatement::bind(int idx, float value) {
-        if (idx <= 0) return -1;
-        if (bound_params_.size() < static_cast<size_t>(idx)) bound_params_.resize(idx);
-        bound_params_[idx - 1] = mysqlx::Value(value);
+        auto i = slot(idx);
+        if (i < 0) return -1;
+        bound_params_[i] = mysqlx::Value(value);
         return 0;
     }
 
     int MySQLStatement::bind(int idx, double value) {
-        if (idx <= 0) return -1;
-        if (bound_params_.size() < static_cast<size_t>(idx)) bound_params_.resize(idx);
-        bound_params_[idx - 1] = mysqlx::Value(value);
+        auto i = slot(idx);
+        if (i < 0) return -1;
+        bound_params_[i] = mysqlx::Value(value);
         return 0;
     }
 
     int MySQLStatement::bind(int idx, std::string_view value) {
-        if (idx <= 0) return -1;
-        if (bound_params_.size() < static_cast<size_t>(idx)) bound_params_.resize(idx);
-        bound_params_[idx - 1] = mysqlx::Value(std::string(value));
+        auto i = slot(idx);
+        if (i < 0) return -1;
+        // 文本按字符串绑定，服务端按列的字符集和排序规则比较；按 bytes 绑定会变成二进制比较（如名字查重区分大小写）。
+        // mysqlx::Value 只能持有自己的字符串副本（没有引用外部内存的字符串类型，const char * 构造要求以 0 结尾），
+        // string_view 必须拷贝一次；绑定的文本只有名字、标题等短字段，这次拷贝不在热路径上
+        bound_params_[i] = mysqlx::Value(std::string(value));
         return 0;
     }
 
     int MySQLStatement::bind(int idx, const void *data, int64_t size) {
-        if (idx <= 0 || !data || size < 0) return -1;
-        if (bound_params_.size() < static_cast<size_t>(idx)) bound_params_.resize(idx);
-        bound_params_[idx - 1] = mysqlx::Value(
-                std::string(static_cast<const char *>(data), static_cast<size_t>(size)));
+        if (!data || size < 0) return -1;
+        auto i = slot(idx);
+        if (i < 0) return -1;
+        bound_params_[i] = mysqlx::Value(mysqlx::bytes(static_cast<const mysqlx::byte *>(data),
+                                                       static_cast<size_t>(size)));
         return 0;
     }
 
@@ -652,9 +705,9 @@ namespace cfl::db {
     int MySQLStatement::execute() {
         try {
             auto sql = session_->sql(sql_);
-//            spdlog::info("[MySQLStatement] execute bound_params_: {}", bound_params_.size());
-            if (!bound_params_.empty()) {
-                sql.bind(bound_params_.begin(), bound_params_.end());
+//            spdlog::info("[MySQLStatement] execute bound_params_: {}", bound_count_);
+            if (bound_count_ > 0) {
+                sql.bind(bound_params_.begin(), bound_params_.begin() + static_cast<std::ptrdiff_t>(bound_count_));
             }
 //            spdlog::info("[MySQLStatement] execute: {}", sql_);
             auto res = sql.execute();
@@ -678,8 +731,8 @@ namespace cfl::db {
     SqlData::Ptr MySQLStatement::query() {
         try {
             auto sql = session_->sql(sql_);
-            if (!bound_params_.empty()) {
-                sql.bind(bound_params_.begin(), bound_params_.end());
+            if (bound_count_ > 0) {
+                sql.bind(bound_params_.begin(), bound_params_.begin() + static_cast<std::ptrdiff_t>(bound_count_));
             }
             auto res = sql.execute();
             last_error_ = 0;
@@ -724,6 +777,7 @@ namespace cfl::db {
 //        }
 
     MySQLManager::~MySQLManager() {
+        stop_health_check();
         std::lock_guard lock(mutex_);
         // 清空连接池（智能指针析构即可）
         conns_.clear();
@@ -765,14 +819,21 @@ namespace cfl::db {
             return nullptr;
         }
 
-        // 先尝试从池中取一个可用连接
+        checkouts_.fetch_add(1, std::memory_order_relaxed);
+        // 先尝试从池中取一个可用连接（最近归还的在队首）
         auto &pool = conns_[name];
+        bool dropped = false;
         while (!pool.empty()) {
             auto dbptr = pool.front();
             pool.pop_front();
             lock.unlock(); // 调用时释放锁（避免长时间持锁）
-            // 尝试检查连接是否可用（如果是 MySQL 派生则调用 ping）
+            // 空闲时间未超过阈值的连接直接使用，失效时由执行失败后的重试兜底
             if (auto mysql_ptr = std::dynamic_pointer_cast<MySQL>(dbptr)) {
+                if (!mysql_ptr->is_need_check(idle_check_seconds())) {
+                    ping_skips_.fetch_add(1, std::memory_order_relaxed);
+                    return dbptr;
+                }
+                pings_.fetch_add(1, std::memory_order_relaxed);
                 try {
                     if (mysql_ptr->ping()) {
                         return dbptr;
@@ -781,6 +842,8 @@ namespace cfl::db {
                 } catch (...) {
                     // 出现异常也丢弃继续
                 }
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                dropped = true;
             } else {
                 // 不是 MySQL（但继承于 Database），直接返回
                 return dbptr;
@@ -796,12 +859,28 @@ namespace cfl::db {
             return nullptr;
         }
 
-        // 创建新的 MySQL 实例
-        auto params = def_it->second;
         lock.unlock(); // 释放锁，创建/连接操作不应在锁内执行
+        auto db = connect_new(name);
+        if (db && dropped) {
+            reconnects_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return db;
+    }
+
+    Database::Ptr MySQLManager::connect_new(const std::string &name) {
+        std::unordered_map<std::string, std::string> params;
+        {
+            std::lock_guard lock(mutex_);
+            auto it = db_defines_.find(name);
+            if (it == db_defines_.end()) {
+                return nullptr;
+            }
+            params = it->second;
+        }
         try {
             auto mysql = std::make_shared<MySQL>(params);
             if (!mysql->connect()) {
+                spdlog::error("[MySQLManager] connect {} failed: {}", name, mysql->cmd());
                 return nullptr;
             }
             return std::static_pointer_cast<Database>(mysql);
@@ -810,6 +889,21 @@ namespace cfl::db {
         }
     }
 
+    Database::Ptr MySQLManager::replace_broken(const std::string &name, const Database::Ptr &db) {
+        auto mysql = std::dynamic_pointer_cast<MySQL>(db);
+        if (!mysql || mysql->ping()) {
+            return nullptr;
+        }
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        auto fresh = connect_new(name);
+        if (fresh) {
+            reconnects_.fetch_add(1, std::memory_order_relaxed);
+            retries_.fetch_add(1, std::memory_order_relaxed);
+            spdlog::warn("[MySQLManager] {}: connection lost, retry on a new connection", name);
+        }
+        return fresh;
+    }
+
     void MySQLManager::release_mysql(const std::string &name, Database *db) {
         if (db == nullptr) return;
         std::lock_guard lock(mutex_);
@@ -838,7 +932,22 @@ namespace cfl::db {
             // 超出池容量，丢弃（让智能指针析构）
             return;
         }
-        lst.push_back(std::move(dbptr));
+        // 归还到队首：优先复用刚用过的连接（跳过心跳），不常用的连接留在队尾由健康检查处理
+        lst.push_front(std::move(dbptr));
+    }
+
+    void MySQLManager::release(const std::string &name, Database::Ptr db) {
+        if (!db) return;
+        std::lock_guard lock(mutex_);
+        if (db_defines_.find(name) == db_defines_.end()) {
+            return;
+        }
+        push_back_conn(conns_, name, std::move(db), max_conn_);
+    }
+
+    bool MySQLManager::has_datasource(const std::string &name) const {
+        std::lock_guard lock(mutex_);
+        return db_defines_.contains(name);
     }
 
     int MySQLManager::execute(const std::string &name, std::string_view sql) {
@@ -849,22 +958,20 @@ namespace cfl::db {
         }
         int ret = -1;
         try {
-            // 用 dynamic_cast 调用 MySQL 的 execute（Database 可能也定义了 execute）
-            if (auto mysql = std::dynamic_pointer_cast<MySQL>(db)) {
-                ret = mysql->execute(sql);
-            } else {
-                // fallback to Database interface
-                ret = db->execute(sql);
+            ret = db->execute(sql);
+            // 连接已断开时在新连接上重试一次（失效连接不再归还）
+            if (ret < 0) {
+                if (auto fresh = replace_broken(name, db)) {
+                    db = std::move(fresh);
+                    ret = db->execute(sql);
+                }
             }
         } catch (...) {
             ret = -1;
         }
 
         // 归还连接到池
-        {
-            std::lock_guard lock(mutex_);
-            push_back_conn(conns_, name, db, max_conn_);
-        }
+        release(name, std::move(db));
         return ret;
     }
 
@@ -876,20 +983,24 @@ namespace cfl::db {
 
         SqlData::Ptr result;
         try {
-            if (auto mysql = std::dynamic_pointer_cast<MySQL>(db)) {
-                result = mysql->query(sql);
-            } else {
-                result = db->query(sql);
+            result = db->query(sql);
+            // 连接已断开时在新连接上重试一次（失效连接不再归还）
+            if (!result) {
+                if (auto fresh = replace_broken(name, db)) {
+                    db = std::move(fresh);
+                    result = db->query(sql);
+                }
+            }
+            // 结果集按需从会话读取，归还连接前先缓存所有行，避免连接被其他线程取走后交错读取
+            if (result) {
+                (void) result->row_count();
             }
         } catch (...) {
             result = nullptr;
         }
 
         // 归还连接到池
-        {
-            std::lock_guard lock(mutex_);
-            push_back_conn(conns_, name, db, max_conn_);
-        }
+        release(name, std::move(db));
         return result;
     }
 
@@ -918,26 +1029,85 @@ namespace cfl::db {
         return trx;
     }
 
-    void MySQLManager::check_connection(int /*sec*/) {
-        std::lock_guard lock(mutex_);
-        for (auto &kv: conns_) {
-            auto &name = kv.first;
-            auto &lst = kv.second;
-            for (auto it = lst.begin(); it != lst.end();) {
-                bool alive = true;
-                if (auto mysql = std::dynamic_pointer_cast<MySQL>(*it)) {
-                    try {
-                        alive = mysql->ping();
-                    } catch (...) {
-                        alive = false;
+    void MySQLManager::check_connection(int sec) {
+        // 在锁内取出空闲超时的连接，心跳在锁外执行
+        std::vector<std::pair<std::string, Database::Ptr>> idle;
+        {
+            std::lock_guard lock(mutex_);
+            for (auto &[name, lst]: conns_) {
+                for (auto it = lst.begin(); it != lst.end();) {
+                    auto mysql = std::dynamic_pointer_cast<MySQL>(*it);
+                    if (mysql && mysql->is_need_check(sec)) {
+                        idle.emplace_back(name, std::move(*it));
+                        it = lst.erase(it);
+                    } else {
+                        ++it;
                     }
                 }
-                if (!alive) {
-                    it = lst.erase(it);
-                } else {
-                    ++it;
+            }
+        }
+
+        for (auto &[name, db]: idle) {
+            bool alive = false;
+            try {
+                alive = std::static_pointer_cast<MySQL>(db)->ping();
+            } catch (...) {
+                alive = false;
+            }
+            if (alive) {
+                release(name, std::move(db));
+            } else {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                spdlog::warn("[MySQLManager] {}: drop dead connection", name);
+            }
+        }
+    }
+
+    void MySQLManager::start_health_check(int interval_sec) {
+        std::lock_guard lock(health_mutex_);
+        if (health_thread_.joinable() || interval_sec <= 0) {
+            return;
+        }
+        health_thread_ = std::jthread([this, interval_sec](std::stop_token token) {
+            std::unique_lock lock(health_mutex_);
+            while (!token.stop_requested()) {
+                health_cv_.wait_for(lock, token, seconds(interval_sec), [] { return false; });
+                if (token.stop_requested()) {
+                    break;
                 }
+                lock.unlock();
+                check_connection(idle_check_seconds());
+                lock.lock();
             }
+        });
+        spdlog::info("[MySQLManager] health check every {}s, idle threshold {}s", interval_sec, idle_check_seconds());
+    }
+
+    void MySQLManager::stop_health_check() {
+        std::jthread thread;
+        {
+            std::lock_guard lock(health_mutex_);
+            thread = std::move(health_thread_);
+        }
+        if (thread.joinable()) {
+            thread.request_stop();
+            thread.join();
         }
     }
+
+    void MySQLManager::init_health_check() {
+        set_idle_check_seconds(std::max(0, Config::GetGameInfo("mysql_idle_check_sec", 30)));
+        start_health_check(Config::GetGameInfo("mysql_health_check_sec", 30));
+    }
+
+    MySQLPoolStats MySQLManager::stats() const {
+        MySQLPoolStats result;
+        result.checkouts = checkouts_.load(std::memory_order_relaxed);
+        result.pings = pings_.load(std::memory_order_relaxed);
+        result.ping_skips = ping_skips_.load(std::memory_order_relaxed);
+        result.dropped = dropped_.load(std::memory_order_relaxed);
+        result.reconnects = reconnects_.load(std::memory_order_relaxed);
+        result.retries = retries_.load(std::memory_order_relaxed);
+        return result;
+    }
 }
\ No newline at end of file
@@ -2,20 +2,27 @@
 
 #include <memory>
 #include <functional>
+#include <list>
 #include <map>
 #include <vector>
 #include "db.h"
+#include "db_batch.h"
 #include "cfl/singleton.h"
 
 #include <mysqlx/xdevapi.h>
 #include "db.h"
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 namespace cfl::db {
     class MySQL;
 
     class MySQLStmt;
 
+    class MySQLStatement;
+
     struct MySQLTime {
         MySQLTime(time_t t)
                 : ts(t) {}
@@ -159,7 +166,7 @@ namespace cfl::db {
         bool connect();
 
         /// 心跳检查
-        bool ping();
+        bool ping() override;
 
         // ===== SqlUpdate / SqlQuery =====
         int execute(std::string_view sql) override;
@@ -196,12 +203,41 @@ namespace cfl::db {
         template<class... Args>
         SqlData::Ptr queryStmt(const char *stmt, Args &&... args);
 
+        /**
+         * @brief 从语句缓存中取出 SQL 对应的语句对象，不存在时创建并放入缓存
+         *
+         * @details 每个连接按 SQL 文本维护一个 LRU 缓存（容量取配置项 mysql_stmt_cache_size，默认 64，0 表示不缓存），
+         * 命中时复用语句对象及其参数缓冲区，并清空上一次绑定的参数。
+         * 缓存的只是客户端的绑定层：mysqlx::SqlStatement 的 bind 只能追加参数、无法清空，
+         * 每次执行仍按 SQL 文本调用 session->sql()，不会使用服务端预编译。
+         * 同一连接只能在一个线程中使用，取出语句后应在下一次取同一 SQL 之前完成绑定和执行。
+         */
+        std::shared_ptr<MySQLStatement> cached_statement(std::string_view sql);
+
+        /// 语句缓存中的语句数
+        [[nodiscard]] std::size_t stmt_cache_size() const { return m_stmt_lru.size(); }
+
+        /// 语句缓存命中次数
+        [[nodiscard]] uint64_t stmt_cache_hits() const { return m_stmt_hits; }
+
+        /// 清空语句缓存（重连时调用，旧语句绑定的是旧会话）
+        void clear_stmt_cache();
+
     private:
-        bool is_need_check() const;
+        /// 空闲时间超过 idle_seconds 秒，取出时需要心跳确认
+        bool is_need_check(int idle_seconds = 60) const;
+
+        /// 记录最近一次成功使用的时间，并清除错误标记
+        void touch();
 
     private:
         std::unordered_map<std::string, std::string> m_params;
         std::shared_ptr<mysqlx::Session> m_session;
+        std::list<std::shared_ptr<MySQLStatement>> m_stmt_lru;  ///< 最近使用的语句在前
+        /// SQL 文本 -> m_stmt_lru 中的位置，键引用语句对象持有的 SQL
+        std::unordered_map<std::string_view, std::list<std::shared_ptr<MySQLStatement>>::iterator> m_stmt_cache;
+        std::size_t m_stmt_capacity{64};
+        uint64_t m_stmt_hits{};
         std::string m_cmd;
         std::string m_dbname;
         uint64_t m_last_used_time{};
@@ -286,6 +322,14 @@ namespace cfl::db {
 
         ~MySQLStatement() override;
 
+        /// SQL 模板
+        [[nodiscard]] const std::string &sql() const { return sql_; }
+
+        /**
+         * @brief 清空已绑定的参数，保留参数缓冲区供下一次绑定复用
+         */
+        void clear_bindings();
+
         // ========== 绑定参数 ==========
         int bind(int idx, std::nullptr_t) override;
 
@@ -331,16 +375,36 @@ namespace cfl::db {
         MySQLStatement(std::shared_ptr<mysqlx::Session> sess, std::string stmt);
 
     private:
+        /// 确保参数数组至少有 idx 个元素，返回对应的下标，idx 非法时返回 -1
+        int slot(int idx);
+
         std::shared_ptr<mysqlx::Session> session_;
         std::string sql_;
-        std::vector<mysqlx::Value> bound_params_;
+        std::vector<mysqlx::Value> bound_params_;   ///< 参数数组，只增不减，前 bound_count_ 个有效
+        std::size_t bound_count_ = 0;               ///< 本次绑定的参数个数
         int last_error_ = 0;
         std::string last_errmsg_;
     };
 
+    /**
+     * @brief 连接池统计信息
+     */
+    struct MySQLPoolStats {
+        uint64_t checkouts = 0;   ///< 取出连接的次数
+        uint64_t pings = 0;       ///< 取出时空闲超时、执行心跳的次数
+        uint64_t ping_skips = 0;  ///< 取出时刚用过、跳过心跳的次数
+        uint64_t dropped = 0;     ///< 心跳或执行失败后丢弃的连接数
+        uint64_t reconnects = 0;  ///< 替换失效连接而新建的连接数
+        uint64_t retries = 0;     ///< 连接断开后在新连接上重试的次数
+    };
+
 /**
      * @brief MySQL 数据库连接管理器（基于 mysqlx::Session）
      * @details 负责管理多个 MySQL 数据源，支持连接池、查询和事务。
+     *
+     * 连接的有效性按空闲时间判断：取出时只有空闲超过 mysql_idle_check_sec 秒（默认 30）的连接才执行心跳，
+     * 刚归还的连接直接使用；后台线程每 mysql_health_check_sec 秒（默认 30，0 表示不启动）
+     * 对池中空闲超时的连接执行 check_connection。execute / query 失败且连接已断开时，在新连接上重试一次。
      */
     class MySQLManager {
     public:
@@ -353,6 +417,7 @@ namespace cfl::db {
             register_mysql("db_log");
             register_mysql("db_gm");
             register_mysql("db_account");
+            init_health_check();
         }
 
         ~MySQLManager();
@@ -361,6 +426,16 @@ namespace cfl::db {
          */
         [[nodiscard]] Database::Ptr get(const std::string &name);
 
+        /**
+         * @brief 归还 get 取出的连接
+         */
+        void release(const std::string &name, Database::Ptr db);
+
+        /**
+         * @brief 数据源是否已注册
+         */
+        [[nodiscard]] bool has_datasource(const std::string &name) const;
+
         /**
          * @brief 注册一个 MySQL 数据源
          * @param name 数据源名称
@@ -376,11 +451,33 @@ namespace cfl::db {
         void register_mysql(const std::string &name);
 
         /**
-         * @brief 检查并维持连接池的健康
-         * @param sec 检查间隔秒数
+         * @brief 对池中空闲超过 sec 秒的连接执行心跳，丢弃失效的连接
+         * @details 心跳期间不持有连接池的锁，被检查的连接暂时不会被取出。
+         * @param sec 空闲时间阈值（秒）
          */
         void check_connection(int sec = 30);
 
+        /**
+         * @brief 启动后台健康检查线程，已启动时忽略
+         * @param interval_sec 检查间隔秒数
+         */
+        void start_health_check(int interval_sec = 30);
+
+        /**
+         * @brief 停止后台健康检查线程
+         */
+        void stop_health_check();
+
+        /// 获取/设置取出连接时需要心跳的空闲时间阈值（秒）
+        [[nodiscard]] int idle_check_seconds() const { return idle_check_sec_.load(std::memory_order_relaxed); }
+
+        void set_idle_check_seconds(int sec) { idle_check_sec_.store(sec, std::memory_order_relaxed); }
+
+        /**
+         * @brief 连接池统计信息
+         */
+        [[nodiscard]] MySQLPoolStats stats() const;
+
         /// 获取/设置最大连接数
         [[nodiscard]] uint32_t max_connections() const { return max_conn_; }
 
@@ -402,6 +499,39 @@ namespace cfl::db {
             return execute(name, std::vformat(fmt, std::make_format_args(std::forward<Args>(args)...)));
         }
 
+        /**
+         * @brief 执行预编译 SQL（带参数绑定），失败且连接已断开时在新连接上重试一次
+         * @param name 数据源名称
+         * @param sql SQL 模板
+         * @return 影响的行数，失败返回 -1
+         */
+        template<typename... Args>
+        int execute_prepared(const std::string &name, const char *sql, const Args &... args) {
+            Database::Ptr db = get(name);
+            if (!db) {
+                return -1;
+            }
+            auto exec = [&](const Database::Ptr &conn) {
+                auto mysql = std::dynamic_pointer_cast<MySQL>(conn);
+                return mysql ? mysql->execStmt(sql, args...) : -1;
+            };
+            int ret = -1;
+            try {
+                ret = exec(db);
+                // 连接已断开时在新连接上重试一次（失效连接不再归还）
+                if (ret < 0) {
+                    if (auto fresh = replace_broken(name, db)) {
+                        db = std::move(fresh);
+                        ret = exec(db);
+                    }
+                }
+            } catch (...) {
+                ret = -1;
+            }
+            release(name, std::move(db));
+            return ret;
+        }
+
         /**
          * @brief 执行 SQL 查询
          * @param name 数据源名称
@@ -430,11 +560,35 @@ namespace cfl::db {
         /// 释放某个连接（归还到连接池）
         void release_mysql(const std::string &name, Database *db);
 
+        /// 按数据源参数新建连接，失败返回 nullptr
+        Database::Ptr connect_new(const std::string &name);
+
+        /**
+         * @brief 执行失败后检查连接，已断开时丢弃并返回一个新连接
+         * @return 连接仍然有效（SQL 本身出错）或新建失败时返回 nullptr
+         */
+        Database::Ptr replace_broken(const std::string &name, const Database::Ptr &db);
+
+        /// 按配置启动健康检查线程
+        void init_health_check();
+
     private:
         uint32_t max_conn_{10};
         mutable MutexType mutex_;
         std::unordered_map<std::string, std::list<Database::Ptr>> conns_;
         std::unordered_map<std::string, std::unordered_map<std::string, std::string>> db_defines_;
+
+        std::atomic<int> idle_check_sec_{30};
+        std::atomic<uint64_t> checkouts_{0};
+        std::atomic<uint64_t> pings_{0};
+        std::atomic<uint64_t> ping_skips_{0};
+        std::atomic<uint64_t> dropped_{0};
+        std::atomic<uint64_t> reconnects_{0};
+        std::atomic<uint64_t> retries_{0};
+
+        std::mutex health_mutex_;
+        std::condition_variable_any health_cv_;
+        std::jthread health_thread_;
     };
 
     typedef cfl::SingletonPtr<MySQLManager> MySQLMgr;
@@ -461,15 +615,21 @@ namespace cfl::db {
             return try_query(name, count, sql);
         }
 
+        /**
+         * @brief 创建指定数据源的批量写入器（独占一个连接，写入器销毁时归还连接池）
+         */
+        [[nodiscard]] static BatchWriter batch_writer(std::string_view name, std::string table,
+                                                     std::vector<std::string> columns, BatchOptions options = {}) {
+            return {MySQLMgr::instance()->get(std::string{name}), SqlDialect::MySQL, std::move(table),
+                    std::move(columns), std::move(options),
+                    [name = std::string{name}](Database::Ptr db) {
+                        MySQLMgr::instance()->release(name, std::move(db));
+                    }};
+        }
+
         template<typename... Args>
         static int execute_prepared(const char *name, const char *sql, Args &&... args) {
-            auto db = MySQLMgr::instance()->get(std::string{name});
-            auto mysql = std::dynamic_pointer_cast<MySQL>(db);
-            if (!mysql) {
-                return -1;
-            }
-
-            return mysql->execStmt(sql, std::forward<Args>(args)...);
+            return MySQLMgr::instance()->execute_prepared(std::string{name}, sql, args...);
         }
 
         template<typename... Args>
@@ -485,22 +645,17 @@ namespace cfl::db {
         }
 
         static MySQLUtil::DataPtr query(std::string_view name, std::string_view sql) {
-            auto db = MySQLMgr::instance()->get(std::string{name});
-            if (!db) {
+            auto mgr = MySQLMgr::instance();
+            if (!mgr->has_datasource(std::string{name})) {
                 throw std::runtime_error(std::format("MySQLUtil::query - no datasource [{}]", name));
             }
-            return db->query(sql);
+            return mgr->query(std::string{name}, sql);
         }
 
         static MySQLUtil::DataPtr try_query(std::string_view name, uint32_t count, std::string_view sql) {
             for (uint32_t i = 0; i < count; ++i) {
                 try {
-                    auto db = MySQLMgr::instance()->get(std::string{name});
-//                auto db = MySQLManager::instance().get(std::string{name});
-                    if (!db) {
-                        throw std::runtime_error(std::format("MySQLUtil::try_query - no datasource [{}]", name));
-                    }
-                    auto res = db->query(sql);
+                    auto res = query(name, sql);
                     if (res) {
                         return res;
                     }
@@ -516,23 +671,17 @@ namespace cfl::db {
         }
 
         static int execute(std::string_view name, std::string_view sql) {
-            auto db = MySQLMgr::instance()->get(std::string{name});
-//        auto db = MySQLManager::instance().get(std::string{name});
-            if (!db) {
+            auto mgr = MySQLMgr::instance();
+            if (!mgr->has_datasource(std::string{name})) {
                 throw std::runtime_error(std::format("MySQLUtil::execute - no datasource [{}]", name));
             }
-            return db->execute(sql);
+            return mgr->execute(std::string{name}, sql);
         }
 
         static int try_execute(std::string_view name, uint32_t count, std::string_view sql) {
             for (uint32_t i = 0; i < count; ++i) {
                 try {
-                    auto db = MySQLMgr::instance()->get(std::string{name});
-//                auto db = MySQLManager::instance().get(std::string{name});
-                    if (!db) {
-                        throw std::runtime_error(std::format("MySQLUtil::try_execute - no datasource [{}]", name));
-                    }
-                    auto rt = db->execute(sql);
+                    auto rt = execute(name, sql);
                     if (rt >= 0) {
                         return rt;
                     }
@@ -550,17 +699,17 @@ namespace cfl::db {
     namespace {
         template<size_t N, typename... Args>
         struct MySQLBinder {
-            static int Bind(MySQLStatement::Ptr) { return 0; }
+            static int Bind(MySQLStatement &) { return 0; }
         };
 
         template<typename... Args>
-        int bindX(MySQLStatement::Ptr stmt, Args &... args) {
+        int bindX(MySQLStatement &stmt, Args &... args) {
             return MySQLBinder<1, Args...>::Bind(stmt, args...);
         }
 
         template<size_t N, typename T, typename... Tail>
         struct MySQLBinder<N, T, Tail...> {
-            static int Bind(MySQLStatement::Ptr stmt, T value, Tail &... tail) {
+            static int Bind(MySQLStatement &stmt, const T &value, Tail &... tail) {
                 int rt = BindSingle(stmt, value);
                 if (rt != 0) return rt;
                 if constexpr (sizeof...(Tail) > 0) {
@@ -570,65 +719,72 @@ namespace cfl::db {
             }
 
         private:
-            static int BindSingle(MySQLStatement::Ptr stmt, int8_t v) { return stmt->bind(N, v); }
+            static int BindSingle(MySQLStatement &stmt, int8_t v) { return stmt.bind(N, v); }
 
-            static int BindSingle(MySQLStatement::Ptr stmt, uint8_t v) { return stmt->bind(N, v); }
+            static int BindSingle(MySQLStatement &stmt, uint8_t v) { return stmt.bind(N, v); }
 
-            static int BindSingle(MySQLStatement::Ptr stmt, int16_t v) { return stmt->bind(N, v); }
+            static int BindSingle(MySQLStatement &stmt, int16_t v) { return stmt.bind(N, v); }
 
-            static int BindSingle(MySQLStatement::Ptr stmt, uint16_t v) { return stmt->bind(N, v); }
+            static int BindSingle(MySQLStatement &stmt, uint16_t v) { return stmt.bind(N, v); }
 
-            static int BindSingle(MySQLStatement::Ptr stmt, int32_t v) { return stmt->bind(N, v); }
+            static int BindSingle(MySQLStatement &stmt, int32_t v) { return stmt.bind(N, v); }
 
-            static int BindSingle(MySQLStatement::Ptr stmt, uint32_t v) { return stmt->bind(N, v); }
+            static int BindSingle(MySQLStatement &stmt, uint32_t v) { return stmt.bind(N, v); }
 
-            static int BindSingle(MySQLStatement::Ptr stmt, int64_t v) { return stmt->bind(N, v); }
+            static int BindSingle(MySQLStatement &stmt, int64_t v) { return stmt.bind(N, v); }
 
-            static int BindSingle(MySQLStatement::Ptr stmt, uint64_t v) { return stmt->bind(N, v); }
+            static int BindSingle(MySQLStatement &stmt, uint64_t v) { return stmt.bind(N, v); }
 
-            static int BindSingle(MySQLStatement::Ptr stmt, float v) { return stmt->bind(N, v); }
+            static int BindSingle(MySQLStatement &stmt, float v) { return stmt.bind(N, v); }
 
-            static int BindSingle(MySQLStatement::Ptr stmt, double v) { return stmt->bind(N, v); }
+            static int BindSingle(MySQLStatement &stmt, double v) { return stmt.bind(N, v); }
 
-            static int BindSingle(MySQLStatement::Ptr stmt, const std::string &v) { return stmt->bind(N,
-                                                                                                      std::string_view(
-                                                                                                              v));
-            }
+            static int BindSingle(MySQLStatement &stmt, const std::string &v) { return stmt.bind(N, std::string_view(v)); }
 
-            static int BindSingle(MySQLStatement::Ptr stmt, std::string_view v) { return stmt->bind(N, v); }
+            static int BindSingle(MySQLStatement &stmt, std::string_view v) { return stmt.bind(N, v); }
         };
     }
 
     template<typename... Args>
     int MySQL::execStmt(const char *stmt, Args &&... args) {
-        auto st = MySQLStatement::create(m_session, stmt);
+        auto st = cached_statement(stmt);
         if (!st) {
             spdlog::error("[MySQL][execStmt] bind error: {}", stmt);
             return -1;
         }
-        int rt = bindX(st, args...);
+        int rt = bindX(*st, args...);
         if (rt != 0) {
             spdlog::error("[MySQL][execStmt] bind error: {}", stmt);
             return rt;
         }
         auto res = st->execute();
         if (res == -1) {
+            m_has_error = true;
+            m_cmd = st->error_message();
             spdlog::error("[MySQL][execStmt] execute error: {} {}", res ,stmt);
             return -1;
         }
+        touch();
         return res;
     }
 
     template<class... Args>
     SqlData::Ptr MySQL::queryStmt(const char *stmt, Args &&... args) {
-        auto st = MySQLStatement::create(m_session, stmt);
+        auto st = cached_statement(stmt);
         if (!st) {
             return nullptr;
         }
-        int rt = bindX(st, args...);
+        int rt = bindX(*st, args...);
         if (rt != 0) {
             return nullptr;
         }
-        return st->query();
+        auto res = st->query();
+        if (!res) {
+            m_has_error = true;
+            m_cmd = st->error_message();
+            return nullptr;
+        }
+        touch();
+        return res;
     }
 }
\ No newline at end of file
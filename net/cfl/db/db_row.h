@@ -0,0 +1,249 @@
+/**
+ * @file db_row.h
+ * @brief 结果集行到结构体的编译期绑定
+ *
+ * @details
+ * 配置表和玩家表的加载代码逐行调用 `query.get_int32("Carrer")`，每一行的每个字段都要按列名查找下标。
+ * CFL_ROW 为结构体声明一组 (成员, 列名) 绑定：
+ * - 每个结果集只在构造 RowReader 时按列名解析一次下标；
+ * - 之后每一行按下标直接读取，读取函数由成员类型在编译期选择，不支持的类型编译失败；
+ * - 结果集中不存在的列或 NULL 值保留成员的默认值。
+ *
+ * @code
+ * CFL_ROW(StCarrerInfo,
+ *         CFL_COL(id, "Carrer"),
+ *         CFL_COL(actor_id, "ActorID"),
+ *         CFL_COL(name, "CarrerName"));
+ *
+ * cfl::db::read_rows<StCarrerInfo>(query, [&](StCarrerInfo &&info) { carrer_map.emplace(info.id, std::move(info)); });
+ * @endcode
+ *
+ * 支持的成员类型：整数（按位宽和符号选择 get_intN/get_uintN）、bool、枚举（按底层类型读取）、
+ * float、double、std::string、std::vector<std::byte>，以及上述类型的 std::array：
+ * - CFL_COL 绑定整个数组时，从指定列开始按列顺序连续读取数组长度个列（如 P1、P2 ...）；
+ * - CFL_COL_AT 把数组的一个元素绑定到一个列。
+ *
+ * @note CFL_ROW 必须写在 cfl::db 的外层命名空间（全局或 cfl）中。
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "spdlog/spdlog.h"
+#include "db.h"
+
+namespace cfl::db {
+
+    /**
+     * @brief 结构体的列绑定，由 CFL_ROW 特化
+     */
+    template<class T>
+    struct RowBinding;
+
+    /**
+     * @brief 一个成员与列的绑定
+     */
+    template<class S, class M>
+    struct RowField {
+        M S::*member;             ///< 成员指针
+        std::string_view column;  ///< 列名
+        int element = -1;         ///< 数组元素下标，-1 表示整个成员
+    };
+
+    template<class S, class M>
+    constexpr RowField<S, M> row_field(M S::*member, std::string_view column, int element = -1) {
+        return {member, column, element};
+    }
+
+    namespace detail {
+        template<class T>
+        struct is_std_array : std::false_type {};
+
+        template<class T, std::size_t N>
+        struct is_std_array<std::array<T, N>> : std::true_type {};
+
+        template<class>
+        inline constexpr bool unsupported_row_type = false;
+
+        /// 按类型读取一个列
+        template<class V>
+        void read_value(const SqlData &data, int idx, V &out) {
+            if constexpr (std::is_same_v<V, bool>) {
+                out = data.get_int8(idx) != 0;
+            } else if constexpr (std::is_enum_v<V>) {
+                std::underlying_type_t<V> value{};
+                read_value(data, idx, value);
+                out = static_cast<V>(value);
+            } else if constexpr (std::is_integral_v<V> && std::is_signed_v<V>) {
+                if constexpr (sizeof(V) == 1) out = static_cast<V>(data.get_int8(idx));
+                else if constexpr (sizeof(V) == 2) out = static_cast<V>(data.get_int16(idx));
+                else if constexpr (sizeof(V) == 4) out = static_cast<V>(data.get_int32(idx));
+                else out = static_cast<V>(data.get_int64(idx));
+            } else if constexpr (std::is_integral_v<V>) {
+                if constexpr (sizeof(V) == 1) out = static_cast<V>(data.get_uint8(idx));
+                else if constexpr (sizeof(V) == 2) out = static_cast<V>(data.get_uint16(idx));
+                else if constexpr (sizeof(V) == 4) out = static_cast<V>(data.get_uint32(idx));
+                else out = static_cast<V>(data.get_uint64(idx));
+            } else if constexpr (std::is_same_v<V, float>) {
+                out = data.get_float(idx);
+            } else if constexpr (std::is_same_v<V, double>) {
+                out = data.get_double(idx);
+            } else if constexpr (std::is_same_v<V, std::string>) {
+                out = data.get_string(idx);
+            } else if constexpr (std::is_same_v<V, std::vector<std::byte>>) {
+                out = data.get_blob(idx);
+            } else {
+                static_assert(unsupported_row_type<V>, "CFL_ROW: unsupported member type");
+            }
+        }
+
+        /// 读取一个绑定，NULL 值保留默认值
+        template<class S, class M>
+        void read_field(const SqlData &data, int idx, const RowField<S, M> &field, S &row) {
+            auto &member = row.*(field.member);
+            if constexpr (is_std_array<M>::value) {
+                if (field.element >= 0) {
+                    if (!data.is_null(idx)) {
+                        read_value(data, idx, member[field.element]);
+                    }
+                } else {
+                    for (std::size_t i = 0; i < member.size(); ++i) {
+                        if (!data.is_null(idx + static_cast<int>(i))) {
+                            read_value(data, idx + static_cast<int>(i), member[i]);
+                        }
+                    }
+                }
+            } else {
+                if (!data.is_null(idx)) {
+                    read_value(data, idx, member);
+                }
+            }
+        }
+
+        /// 绑定占用的列数
+        template<class S, class M>
+        constexpr int field_width(const RowField<S, M> &field) {
+            if constexpr (is_std_array<M>::value) {
+                return field.element >= 0 ? 1 : static_cast<int>(std::tuple_size_v<M>);
+            } else {
+                return 1;
+            }
+        }
+    }
+
+    /**
+     * @class RowReader
+     * @brief 按 RowBinding<T> 读取结果集的行
+     *
+     * @details 构造时按列名解析一次下标，read 只按下标读取。一个 RowReader 只能用于构造时的结果集。
+     */
+    template<class T>
+    class RowReader {
+    public:
+        explicit RowReader(const SqlData &data) {
+            index_.fill(-1);
+            const int count = data.column_count();
+            std::vector<std::string> names;
+            names.reserve(count);
+            for (int i = 0; i < count; ++i) {
+                names.push_back(data.column_name(i));
+            }
+            resolve(names, std::make_index_sequence<kFieldCount>{});
+        }
+
+        /**
+         * @brief 读取当前行到 row，不存在的列保留 row 中原有的值
+         */
+        void read(const SqlData &data, T &row) const {
+            read(data, row, std::make_index_sequence<kFieldCount>{});
+        }
+
+        /**
+         * @brief 所有绑定的列是否都存在
+         */
+        [[nodiscard]] bool complete() const noexcept { return missing_ == 0; }
+
+        /**
+         * @brief 结果集中不存在的绑定数
+         */
+        [[nodiscard]] std::size_t missing() const noexcept { return missing_; }
+
+    private:
+        static constexpr auto kFields = RowBinding<T>::fields();
+        static constexpr std::size_t kFieldCount = std::tuple_size_v<decltype(kFields)>;
+
+        template<std::size_t... I>
+        void resolve(const std::vector<std::string> &names, std::index_sequence<I...>) {
+            (resolve_one(names, I, std::get<I>(kFields)), ...);
+        }
+
+        template<class M>
+        void resolve_one(const std::vector<std::string> &names, std::size_t slot, const RowField<T, M> &field) {
+            const int count = static_cast<int>(names.size());
+            for (int i = 0; i < count; ++i) {
+                if (names[i] == field.column) {
+                    if (i + detail::field_width(field) <= count) {
+                        index_[slot] = i;
+                    }
+                    break;
+                }
+            }
+            if (index_[slot] < 0) {
+                ++missing_;
+                spdlog::warn("[RowReader] column {} not found", field.column);
+            }
+        }
+
+        template<std::size_t... I>
+        void read(const SqlData &data, T &row, std::index_sequence<I...>) const {
+            ((index_[I] >= 0 ? detail::read_field(data, index_[I], std::get<I>(kFields), row) : void()), ...);
+        }
+
+        std::array<int, kFieldCount> index_{};  ///< 每个绑定的列下标，-1 表示不存在
+        std::size_t missing_ = 0;
+    };
+
+    /**
+     * @brief 遍历结果集剩余的行，每行读取为一个 T 并回调
+     * @param data 结果集
+     * @param on_row 以 T&& 调用
+     * @return 读取的行数
+     */
+    template<class T, class F>
+    std::size_t read_rows(SqlData &data, F &&on_row) {
+        RowReader<T> reader(data);
+        std::size_t rows = 0;
+        while (data.next()) {
+            T row{};
+            reader.read(data, row);
+            on_row(std::move(row));
+            ++rows;
+        }
+        return rows;
+    }
+
+} // namespace cfl::db
+
+/**
+ * @brief 声明结构体 Type 的列绑定，参数为 CFL_COL / CFL_COL_AT 列表
+ */
+#define CFL_ROW(Type, ...)                                                  \
+    template<>                                                              \
+    struct cfl::db::RowBinding<Type> {                                      \
+        using row_type = Type;                                              \
+        static constexpr auto fields() { return std::make_tuple(__VA_ARGS__); } \
+    }
+
+/// 绑定成员 member 到列 column
+#define CFL_COL(member, column) ::cfl::db::row_field(&row_type::member, column)
+
+/// 绑定数组成员 member 的第 index 个元素到列 column
+#define CFL_COL_AT(member, index, column) ::cfl::db::row_field(&row_type::member, column, index)
@@ -3,6 +3,9 @@
 #include <sstream>
 #include <iostream>
 #include <ctime>
+#include <charconv>
+#include <cstring>
+#include <format>
 #include "db_sqlite.h"
 
 namespace cfl::db {
@@ -36,6 +39,40 @@ namespace cfl::db {
         return SQLiteTime(std::mktime(const_cast<std::tm *>(&tm)));
     }
 
+// ========================== 类型转换 ==========================
+    namespace {
+        /// 文本按整数解析（与旧实现一致，解析失败返回 0）
+        int64_t parse_int64(std::string_view text) {
+            int64_t value = 0;
+            auto begin = text.data();
+            auto end = text.data() + text.size();
+            while (begin != end && (*begin == ' ' || *begin == '\t')) ++begin;
+            if (begin != end && *begin == '+') ++begin;
+            auto [ptr, ec] = std::from_chars(begin, end, value);
+            if (ec != std::errc() && begin != end) {
+                // 超出 int64 的无符号值按位解释
+                uint64_t u = 0;
+                if (std::from_chars(begin, end, u).ec == std::errc()) {
+                    return static_cast<int64_t>(u);
+                }
+            }
+            return value;
+        }
+
+        double parse_double(std::string_view text) {
+            // std::from_chars(double) 在部分标准库中不可用，使用 strtod（文本较短，拷贝到栈上保证以 0 结尾）
+            char buffer[64];
+            auto n = std::min(text.size(), sizeof(buffer) - 1);
+            std::memcpy(buffer, text.data(), n);
+            buffer[n] = '\0';
+            return std::strtod(buffer, nullptr);
+        }
+
+        std::vector<std::byte> to_blob(std::span<const std::byte> view) {
+            return {view.begin(), view.end()};
+        }
+    }
+
 // ========================== SQLiteResult ==========================
     SQLiteResult::SQLiteResult(int err, std::string errstr)
             : m_errno(err), m_errstr(std::move(errstr)) {}
@@ -50,75 +87,111 @@ namespace cfl::db {
 
     int SQLiteResult::column_count() const { return m_column_count; }
 
-    int SQLiteResult::column_bytes(int idx) const {
-        if (m_current_row < 0 || m_current_row >= m_row_count) return 0;
-        return static_cast<int>(m_data[m_current_row][idx].size());
+    int SQLiteResult::cell_type(int idx) const {
+        if (!valid_cell(idx)) return SQLITE_NULL;
+        return m_columns[idx].types[m_current_row];
     }
 
-    int SQLiteResult::column_type(int idx) const {
-        if (is_null(idx)) return SQLITE_NULL;
-        return SQLITE_TEXT; // 简化处理
+    int SQLiteResult::column_bytes(int idx) const {
+        switch (cell_type(idx)) {
+            case SQLITE_TEXT:
+            case SQLITE_BLOB:
+                return static_cast<int>(m_columns[idx].cells[m_current_row].bytes.length);
+            case SQLITE_INTEGER:
+            case SQLITE_FLOAT:
+                return static_cast<int>(sizeof(int64_t));
+            default:
+                return 0;
+        }
     }
 
+    int SQLiteResult::column_type(int idx) const { return cell_type(idx); }
+
     std::string SQLiteResult::column_name(int idx) const {
         return m_column_names[idx];
     }
 
-    bool SQLiteResult::is_null(int idx) const {
-        if (m_current_row < 0 || m_current_row >= m_row_count) return true;
-        return m_data[m_current_row][idx].empty();
-    }
+    bool SQLiteResult::is_null(int idx) const { return cell_type(idx) == SQLITE_NULL; }
 
-    int8_t SQLiteResult::get_int8(int idx) const { return static_cast<int8_t>(std::stoi(m_data[m_current_row][idx])); }
+    int8_t SQLiteResult::get_int8(int idx) const { return static_cast<int8_t>(get_int64(idx)); }
 
-    uint8_t SQLiteResult::get_uint8(int idx) const {
-        return static_cast<uint8_t>(std::stoul(m_data[m_current_row][idx]));
-    }
+    uint8_t SQLiteResult::get_uint8(int idx) const { return static_cast<uint8_t>(get_int64(idx)); }
 
-    int16_t SQLiteResult::get_int16(int idx) const {
-        return static_cast<int16_t>(std::stoi(m_data[m_current_row][idx]));
-    }
+    int16_t SQLiteResult::get_int16(int idx) const { return static_cast<int16_t>(get_int64(idx)); }
 
-    uint16_t SQLiteResult::get_uint16(int idx) const {
-        return static_cast<uint16_t>(std::stoul(m_data[m_current_row][idx]));
-    }
+    uint16_t SQLiteResult::get_uint16(int idx) const { return static_cast<uint16_t>(get_int64(idx)); }
 
-    int32_t SQLiteResult::get_int32(int idx) const {
-        if (m_data[m_current_row][idx].empty()) return 0;
-        return std::stoi(m_data[m_current_row][idx]);
-    }
+    int32_t SQLiteResult::get_int32(int idx) const { return static_cast<int32_t>(get_int64(idx)); }
+
+    uint32_t SQLiteResult::get_uint32(int idx) const { return static_cast<uint32_t>(get_int64(idx)); }
 
-    uint32_t SQLiteResult::get_uint32(int idx) const {
-        return static_cast<uint32_t>(std::stoul(m_data[m_current_row][idx]));
+    int64_t SQLiteResult::get_int64(int idx) const {
+        switch (cell_type(idx)) {
+            case SQLITE_INTEGER:
+                return m_columns[idx].cells[m_current_row].i;
+            case SQLITE_FLOAT:
+                return static_cast<int64_t>(m_columns[idx].cells[m_current_row].d);
+            case SQLITE_TEXT:
+                return parse_int64(get_string_view(idx));
+            default:
+                return 0;
+        }
     }
 
-    int64_t SQLiteResult::get_int64(int idx) const { return std::stoll(m_data[m_current_row][idx]); }
+    uint64_t SQLiteResult::get_uint64(int idx) const { return static_cast<uint64_t>(get_int64(idx)); }
 
-    uint64_t SQLiteResult::get_uint64(int idx) const { return std::stoull(m_data[m_current_row][idx]); }
+    float SQLiteResult::get_float(int idx) const { return static_cast<float>(get_double(idx)); }
 
-    float SQLiteResult::get_float(int idx) const { return std::stof(m_data[m_current_row][idx]); }
+    double SQLiteResult::get_double(int idx) const {
+        switch (cell_type(idx)) {
+            case SQLITE_INTEGER:
+                return static_cast<double>(m_columns[idx].cells[m_current_row].i);
+            case SQLITE_FLOAT:
+                return m_columns[idx].cells[m_current_row].d;
+            case SQLITE_TEXT:
+                return parse_double(get_string_view(idx));
+            default:
+                return 0;
+        }
+    }
 
-    double SQLiteResult::get_double(int idx) const { return std::stod(m_data[m_current_row][idx]); }
+    std::string_view SQLiteResult::get_string_view(int idx) const {
+        auto type = cell_type(idx);
+        if (type != SQLITE_TEXT && type != SQLITE_BLOB) {
+            return {};
+        }
+        auto &cell = m_columns[idx].cells[m_current_row];
+        return {m_arena.data() + cell.bytes.offset, cell.bytes.length};
+    }
 
-    std::string SQLiteResult::get_string(int idx) const { return m_data[m_current_row][idx]; }
+    std::span<const std::byte> SQLiteResult::get_blob_view(int idx) const {
+        auto view = get_string_view(idx);
+        return {reinterpret_cast<const std::byte *>(view.data()), view.size()};
+    }
 
-    std::vector<std::byte> SQLiteResult::get_blob(int idx) const {
-        const auto& str = m_data[m_current_row][idx];
-        std::vector<std::byte> blob(str.size());
-        std::transform(str.begin(), str.end(), blob.begin(),
-                       [](char c) { return std::byte(c); });
-        return blob;
+    std::string SQLiteResult::get_string(int idx) const {
+        switch (cell_type(idx)) {
+            case SQLITE_INTEGER:
+                return std::to_string(m_columns[idx].cells[m_current_row].i);
+            case SQLITE_FLOAT:
+                return std::format("{}", m_columns[idx].cells[m_current_row].d);
+            default:
+                return std::string(get_string_view(idx));
+        }
     }
 
+    std::vector<std::byte> SQLiteResult::get_blob(int idx) const { return to_blob(get_blob_view(idx)); }
 
-    std::time_t SQLiteResult::get_time(int idx) const { return std::stoll(m_data[m_current_row][idx]); }
+    std::time_t SQLiteResult::get_time(int idx) const { return get_int64(idx); }
 
     int SQLiteResult::column_index(std::string_view name) const {
-        auto it = m_col_index.find(std::string(name));
-        if (it == m_col_index.end()) {
-            throw std::runtime_error("Unknown column name: " + std::string(name));
+        // 列数通常很少，线性查找避免按名字访问时构造临时字符串
+        for (int i = 0; i < m_column_count; ++i) {
+            if (m_column_names[i] == name) {
+                return i;
+            }
         }
-        return it->second;
+        throw std::runtime_error("Unknown column name: " + std::string(name));
     }
 
     [[nodiscard]] bool SQLiteResult::is_null(std::string_view col_name) const{
@@ -185,21 +258,154 @@ namespace cfl::db {
         return false;
     }
 
-    void SQLiteResult::set_column_count(int count) { m_column_count = count; }
+    bool SQLiteResult::load(sqlite3 *db, sqlite3_stmt *stmt) {
+        m_column_count = sqlite3_column_count(stmt);
+        m_column_names.clear();
+        m_columns.assign(m_column_count, Column{});
+        for (int i = 0; i < m_column_count; i++) {
+            m_column_names.emplace_back(sqlite3_column_name(stmt, i));
+        }
+
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            for (int i = 0; i < m_column_count; i++) {
+                auto &column = m_columns[i];
+                Cell cell{};
+                int type = sqlite3_column_type(stmt, i);
+                switch (type) {
+                    case SQLITE_INTEGER:
+                        cell.i = sqlite3_column_int64(stmt, i);
+                        break;
+                    case SQLITE_FLOAT:
+                        cell.d = sqlite3_column_double(stmt, i);
+                        break;
+                    case SQLITE_TEXT:
+                    case SQLITE_BLOB: {
+                        // 先取指针再取长度（SQLite 文档要求的调用顺序）
+                        auto data = type == SQLITE_TEXT
+                                    ? static_cast<const void *>(sqlite3_column_text(stmt, i))
+                                    : sqlite3_column_blob(stmt, i);
+                        auto length = static_cast<size_t>(sqlite3_column_bytes(stmt, i));
+                        if (m_arena.size() + length > UINT32_MAX) {
+                            m_errno = SQLITE_TOOBIG;
+                            m_errstr = "result exceeds 4GB";
+                            return false;
+                        }
+                        cell.bytes.offset = static_cast<uint32_t>(m_arena.size());
+                        cell.bytes.length = static_cast<uint32_t>(length);
+                        if (length > 0) {
+                            m_arena.append(static_cast<const char *>(data), length);
+                        }
+                        break;
+                    }
+                    default:
+                        type = SQLITE_NULL;
+                        break;
+                }
+                column.types.push_back(static_cast<uint8_t>(type));
+                column.cells.push_back(cell);
+            }
+            ++m_row_count;
+        }
+        if (rc != SQLITE_DONE) {
+            m_errno = rc;
+            m_errstr = sqlite3_errmsg(db);
+            return false;
+        }
+        return true;
+    }
+
+// ========================== SQLiteCursor ==========================
+    SQLiteCursor::SQLiteCursor(std::shared_ptr<SQLite> db, sqlite3_stmt *stmt, std::shared_ptr<SQLiteStatement> owner)
+            : m_db(std::move(db)), m_owner(std::move(owner)), m_stmt(stmt) {
+        m_column_count = m_stmt ? sqlite3_column_count(m_stmt) : 0;
+        m_done = m_stmt == nullptr;
+    }
+
+    SQLiteCursor::~SQLiteCursor() {
+        if (m_stmt == nullptr) {
+            return;
+        }
+        if (m_owner) {
+            sqlite3_reset(m_stmt);
+        } else {
+            sqlite3_finalize(m_stmt);
+        }
+    }
+
+    bool SQLiteCursor::next() {
+        if (m_done) {
+            return false;
+        }
+        int rc = sqlite3_step(m_stmt);
+        if (rc == SQLITE_ROW) {
+            m_has_row = true;
+            ++m_row_count;
+            return true;
+        }
+        m_has_row = false;
+        m_done = true;
+        if (rc != SQLITE_DONE) {
+            m_errno = rc;
+            m_errstr = sqlite3_errmsg(m_db->getRawDb());
+        }
+        return false;
+    }
+
+    int SQLiteCursor::column_bytes(int idx) const {
+        return valid_cell(idx) ? sqlite3_column_bytes(m_stmt, idx) : 0;
+    }
+
+    int SQLiteCursor::column_type(int idx) const {
+        return valid_cell(idx) ? sqlite3_column_type(m_stmt, idx) : SQLITE_NULL;
+    }
+
+    std::string SQLiteCursor::column_name(int idx) const {
+        auto name = m_stmt ? sqlite3_column_name(m_stmt, idx) : nullptr;
+        return name ? name : "";
+    }
 
-    void SQLiteResult::set_row_count(int count) {
-        m_row_count = count;
-        m_data.resize(count);
+    bool SQLiteCursor::is_null(int idx) const { return column_type(idx) == SQLITE_NULL; }
+
+    int64_t SQLiteCursor::get_int64(int idx) const {
+        return valid_cell(idx) ? sqlite3_column_int64(m_stmt, idx) : 0;
     }
 
-    void SQLiteResult::add_column_name(const std::string &name) {
-        m_column_names.push_back(name);
-        m_col_index[name] = m_column_names.size() - 1;
+    double SQLiteCursor::get_double(int idx) const {
+        return valid_cell(idx) ? sqlite3_column_double(m_stmt, idx) : 0;
     }
 
-    void SQLiteResult::set_data(int row, int col, std::string &&value) {
-        if ((int) m_data[row].size() < m_column_count) m_data[row].resize(m_column_count);
-        m_data[row][col] = std::move(value);
+    std::string_view SQLiteCursor::get_string_view(int idx) const {
+        if (!valid_cell(idx)) {
+            return {};
+        }
+        auto text = reinterpret_cast<const char *>(sqlite3_column_text(m_stmt, idx));
+        if (text == nullptr) {
+            return {};
+        }
+        return {text, static_cast<size_t>(sqlite3_column_bytes(m_stmt, idx))};
+    }
+
+    std::span<const std::byte> SQLiteCursor::get_blob_view(int idx) const {
+        if (!valid_cell(idx)) {
+            return {};
+        }
+        auto data = static_cast<const std::byte *>(sqlite3_column_blob(m_stmt, idx));
+        if (data == nullptr) {
+            return {};
+        }
+        return {data, static_cast<size_t>(sqlite3_column_bytes(m_stmt, idx))};
+    }
+
+    std::vector<std::byte> SQLiteCursor::get_blob(int idx) const { return to_blob(get_blob_view(idx)); }
+
+    int SQLiteCursor::column_index(std::string_view name) const {
+        for (int i = 0; i < m_column_count; ++i) {
+            if (name == sqlite3_column_name(m_stmt, i)) {
+                return i;
+            }
+        }
+        throw std::runtime_error("Unknown column name: " + std::string(name));
     }
 
 // ========================== SQLite ==========================
@@ -241,32 +447,30 @@ namespace cfl::db {
 
     SqlData::Ptr SQLite::query(std::string_view sql) {
         sqlite3_stmt *stmt = nullptr;
-        if (sqlite3_prepare_v2(m_db, sql.data(), -1, &stmt, nullptr) != SQLITE_OK){
+        if (sqlite3_prepare_v2(m_db, sql.data(), static_cast<int>(sql.size()), &stmt, nullptr) != SQLITE_OK){
             spdlog::error("sqlite3_prepare_v2 error: {}", sqlite3_errmsg(m_db));
             return std::make_shared<SQLiteResult>(sqlite3_errcode(m_db), sqlite3_errmsg(m_db));
         }
 
         auto result = std::make_shared<SQLiteResult>();
-        int col_count = sqlite3_column_count(stmt);
-        result->set_column_count(col_count);
-        for (int i = 0; i < col_count; i++)
-            result->add_column_name(sqlite3_column_name(stmt, i));
-
-        int row = 0;
-        while (sqlite3_step(stmt) == SQLITE_ROW) {
-            result->set_row_count(row + 1);
-            for (int i = 0; i < col_count; i++) {
-                const unsigned char *txt = sqlite3_column_text(stmt, i);
-                result->set_data(row, i, txt ? std::string(reinterpret_cast<const char *>(txt)) : "");
-            }
-            row++;
+        if (!result->load(m_db, stmt)) {
+            spdlog::error("sqlite3_step error: {}", result->error_message());
         }
 
         sqlite3_finalize(stmt);
-//        spdlog::debug("sqlite3_step: {}", row);
+//        spdlog::debug("sqlite3_step: {}", result->row_count());
         return result;
     }
 
+    SqlData::Ptr SQLite::query_cursor(std::string_view sql) {
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v2(m_db, sql.data(), static_cast<int>(sql.size()), &stmt, nullptr) != SQLITE_OK){
+            spdlog::error("sqlite3_prepare_v2 error: {}", sqlite3_errmsg(m_db));
+            return std::make_shared<SQLiteResult>(sqlite3_errcode(m_db), sqlite3_errmsg(m_db));
+        }
+        return std::make_shared<SQLiteCursor>(shared_from_this(), stmt);
+    }
+
     Transaction::Ptr SQLite::open_transaction(bool auto_commit) {
         return SQLiteTransaction::create(shared_from_this(), auto_commit);
     }
@@ -382,25 +586,25 @@ namespace cfl::db {
     int64_t SQLiteStatement::last_insert_id() const { return sqlite3_last_insert_rowid(db_->getRawDb()); }
 
     SqlData::Ptr SQLiteStatement::query() {
+        if (!stmt_) {
+            return std::make_shared<SQLiteResult>(last_error_, last_errmsg_);
+        }
         auto result = std::make_shared<SQLiteResult>();
-        int col_count = sqlite3_column_count(stmt_);
-        result->set_column_count(col_count);
-        for (int i = 0; i < col_count; i++)
-            result->add_column_name(sqlite3_column_name(stmt_, i));
-
-        int row = 0;
-        while (sqlite3_step(stmt_) == SQLITE_ROW) {
-            result->set_row_count(row + 1);
-            for (int i = 0; i < col_count; i++) {
-                const unsigned char *txt = sqlite3_column_text(stmt_, i);
-                result->set_data(row, i, txt ? std::string(reinterpret_cast<const char *>(txt)) : "");
-            }
-            row++;
+        if (!result->load(db_->getRawDb(), stmt_)) {
+            last_error_ = result->error_code();
+            last_errmsg_ = result->error_message();
         }
         sqlite3_reset(stmt_);
         return result;
     }
 
+    SqlData::Ptr SQLiteStatement::cursor() {
+        if (!stmt_) {
+            return std::make_shared<SQLiteResult>(last_error_, last_errmsg_);
+        }
+        return std::make_shared<SQLiteCursor>(db_, stmt_, shared_from_this());
+    }
+
     int SQLiteStatement::error_code() const { return last_error_; }
 
     std::string_view SQLiteStatement::error_message() const { return last_errmsg_; }
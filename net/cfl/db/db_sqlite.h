@@ -8,7 +8,9 @@
 #include <unordered_map>
 #include <list>
 #include <mutex>
+#include <span>
 #include "db.h"
+#include "db_batch.h"
 #include "cfl/singleton.h"
 #include <sqlite3.h>
 
@@ -73,8 +75,11 @@ namespace cfl::db {
     inline SQLiteTime tm_to_sqlite_time(const std::tm &tm);
 
     /**
-     * @brief SQLite 查询结果封装
+     * @brief SQLite 查询结果封装（按列存储）
      * @details 统一封装 query / statement 的返回结果，提供按列访问。
+     * 每列保存 SQLite 的原生类型：整数和浮点数不装箱直接存放在列数组中，
+     * 文本和 BLOB 集中拷贝到同一块内存（arena），get_string_view / get_blob_view 直接返回视图，不分配内存。
+     * 按类型读取时只在类型不一致（如整数列按字符串读取）时才做转换。
      */
     class SQLiteResult : public SqlData {
     public:
@@ -186,20 +191,134 @@ namespace cfl::db {
         bool next() override;
 
         // SQLite 特有方法
-        void set_column_count(int count);
-        void set_row_count(int count);
-        void add_column_name(const std::string& name);
-        void set_data(int row, int col, std::string&& value);
+        /// 获取字符串视图，指向结果内部的内存，结果销毁前有效
+        [[nodiscard]] std::string_view get_string_view(int idx) const;
+
+        /// 获取 BLOB 视图，指向结果内部的内存，结果销毁前有效
+        [[nodiscard]] std::span<const std::byte> get_blob_view(int idx) const;
+
+        /**
+         * @brief 执行语句并读取全部结果行
+         * @return 执行出错时返回 false，错误码和错误信息记录在结果中
+         */
+        bool load(sqlite3 *db, sqlite3_stmt *stmt);
 
     private:
+        /// 单元格：按所在列的类型解释
+        union Cell {
+            int64_t i;                  ///< SQLITE_INTEGER
+            double d;                   ///< SQLITE_FLOAT
+            struct {
+                uint32_t offset;        ///< 在 arena 中的偏移
+                uint32_t length;        ///< 字节数
+            } bytes;                    ///< SQLITE_TEXT / SQLITE_BLOB
+        };
+
+        /// 一列数据，SQLite 同一列的不同行可以是不同类型
+        struct Column {
+            std::vector<uint8_t> types; ///< 每行的 SQLITE_* 类型
+            std::vector<Cell> cells;    ///< 每行的值
+        };
+
+        [[nodiscard]] bool valid_cell(int idx) const {
+            return m_current_row >= 0 && m_current_row < m_row_count && idx >= 0 && idx < m_column_count;
+        }
+
+        [[nodiscard]] int cell_type(int idx) const;
+
         int m_errno{};                                      ///< 错误码
         std::string m_errstr;                               ///< 错误消息
         int m_row_count{0};                                 ///< 总行数
         int m_column_count{0};                              ///< 总列数
         std::vector<std::string> m_column_names;            ///< 列名数组
-        std::vector<std::vector<std::string>> m_data;       ///< 查询结果数据
+        std::vector<Column> m_columns;                      ///< 按列存储的数据
+        std::string m_arena;                                ///< 文本与 BLOB 数据
         int m_current_row{-1};                              ///< 当前行索引
-        std::unordered_map<std::string, int> m_col_index;
+    };
+
+    class SQLiteStatement;
+
+    /**
+     * @brief SQLite 流式游标
+     * @details 每次 next 执行一次 sqlite3_step，直接从语句读取当前行，不缓存整个结果集，适合逐行处理的大表加载。
+     * 字符串视图只在移动到下一行之前有效；row_count 返回已读取的行数。
+     * 游标存活期间独占对应的语句（和连接上的读事务），用完应尽快释放。
+     */
+    class SQLiteCursor : public SqlData {
+    public:
+        using Ptr = std::shared_ptr<SQLiteCursor>;
+
+        /**
+         * @param db 所属连接
+         * @param stmt 语句
+         * @param owner 语句的持有者（SQLiteStatement），为空时游标负责 finalize 语句
+         */
+        SQLiteCursor(std::shared_ptr<SQLite> db, sqlite3_stmt *stmt, std::shared_ptr<SQLiteStatement> owner = {});
+
+        ~SQLiteCursor() override;
+
+        SQLiteCursor(const SQLiteCursor &) = delete;
+        SQLiteCursor &operator=(const SQLiteCursor &) = delete;
+
+        [[nodiscard]] int error_code() const override { return m_errno; }
+        [[nodiscard]] std::string_view error_message() const override { return m_errstr; }
+        [[nodiscard]] int row_count() const override { return m_row_count; }
+        [[nodiscard]] int column_count() const override { return m_column_count; }
+        [[nodiscard]] int column_bytes(int idx) const override;
+        [[nodiscard]] int column_type(int idx) const override;
+        [[nodiscard]] std::string column_name(int idx) const override;
+        [[nodiscard]] bool is_null(int idx) const override;
+        [[nodiscard]] int8_t get_int8(int idx) const override { return static_cast<int8_t>(get_int64(idx)); }
+        [[nodiscard]] uint8_t get_uint8(int idx) const override { return static_cast<uint8_t>(get_int64(idx)); }
+        [[nodiscard]] int16_t get_int16(int idx) const override { return static_cast<int16_t>(get_int64(idx)); }
+        [[nodiscard]] uint16_t get_uint16(int idx) const override { return static_cast<uint16_t>(get_int64(idx)); }
+        [[nodiscard]] int32_t get_int32(int idx) const override { return static_cast<int32_t>(get_int64(idx)); }
+        [[nodiscard]] uint32_t get_uint32(int idx) const override { return static_cast<uint32_t>(get_int64(idx)); }
+        [[nodiscard]] int64_t get_int64(int idx) const override;
+        [[nodiscard]] uint64_t get_uint64(int idx) const override { return static_cast<uint64_t>(get_int64(idx)); }
+        [[nodiscard]] float get_float(int idx) const override { return static_cast<float>(get_double(idx)); }
+        [[nodiscard]] double get_double(int idx) const override;
+        [[nodiscard]] std::string get_string(int idx) const override { return std::string(get_string_view(idx)); }
+        [[nodiscard]] std::vector<std::byte> get_blob(int idx) const override;
+        [[nodiscard]] std::time_t get_time(int idx) const override { return get_int64(idx); }
+
+        int column_index(std::string_view name) const override;
+        [[nodiscard]] bool is_null(std::string_view col_name) const override { return is_null(column_index(col_name)); }
+        [[nodiscard]] int8_t get_int8(std::string_view col_name) const override { return get_int8(column_index(col_name)); }
+        [[nodiscard]] uint8_t get_uint8(std::string_view col_name) const override { return get_uint8(column_index(col_name)); }
+        [[nodiscard]] int16_t get_int16(std::string_view col_name) const override { return get_int16(column_index(col_name)); }
+        [[nodiscard]] uint16_t get_uint16(std::string_view col_name) const override { return get_uint16(column_index(col_name)); }
+        [[nodiscard]] int32_t get_int32(std::string_view col_name) const override { return get_int32(column_index(col_name)); }
+        [[nodiscard]] uint32_t get_uint32(std::string_view col_name) const override { return get_uint32(column_index(col_name)); }
+        [[nodiscard]] int64_t get_int64(std::string_view col_name) const override { return get_int64(column_index(col_name)); }
+        [[nodiscard]] uint64_t get_uint64(std::string_view col_name) const override { return get_uint64(column_index(col_name)); }
+        [[nodiscard]] float get_float(std::string_view col_name) const override { return get_float(column_index(col_name)); }
+        [[nodiscard]] double get_double(std::string_view col_name) const override { return get_double(column_index(col_name)); }
+        [[nodiscard]] std::string get_string(std::string_view col_name) const override { return get_string(column_index(col_name)); }
+        [[nodiscard]] std::vector<std::byte> get_blob(std::string_view col_name) const override { return get_blob(column_index(col_name)); }
+        [[nodiscard]] std::time_t get_time(std::string_view col_name) const override { return get_time(column_index(col_name)); }
+
+        /// 执行一次 sqlite3_step，没有更多行或出错时返回 false
+        bool next() override;
+
+        /// 当前行的字符串视图，移动到下一行前有效
+        [[nodiscard]] std::string_view get_string_view(int idx) const;
+
+        /// 当前行的 BLOB 视图，移动到下一行前有效
+        [[nodiscard]] std::span<const std::byte> get_blob_view(int idx) const;
+
+    private:
+        [[nodiscard]] bool valid_cell(int idx) const { return m_has_row && idx >= 0 && idx < m_column_count; }
+
+        std::shared_ptr<SQLite> m_db;                   ///< 所属连接（保证语句先于连接释放）
+        std::shared_ptr<SQLiteStatement> m_owner;       ///< 语句的持有者
+        sqlite3_stmt *m_stmt{nullptr};                  ///< 语句
+        int m_errno{};                                  ///< 错误码
+        std::string m_errstr;                           ///< 错误消息
+        int m_row_count{0};                             ///< 已读取的行数
+        int m_column_count{0};                          ///< 列数
+        bool m_has_row{false};                          ///< 当前是否位于一行上
+        bool m_done{false};                             ///< 已读完或出错
     };
 
     /**
@@ -219,7 +338,7 @@ namespace cfl::db {
         bool connect();
 
         /// 心跳检查
-        bool ping();
+        bool ping() override;
 
         // ===== SQL 执行接口 =====
 
@@ -232,6 +351,12 @@ namespace cfl::db {
         /// 执行查询
         SqlData::Ptr query(std::string_view sql) override;
 
+        /**
+         * @brief 以流式游标执行查询，不缓存整个结果集
+         * @return 游标，SQL 编译失败时返回带错误码的空结果
+         */
+        SqlData::Ptr query_cursor(std::string_view sql);
+
         // ===== Transaction =====
         Transaction::Ptr open_transaction(bool auto_commit = false) override;
 
@@ -374,6 +499,12 @@ namespace cfl::db {
         [[nodiscard]] int64_t last_insert_id() const override;
         [[nodiscard]] SqlData::Ptr query() override;
 
+        /**
+         * @brief 以流式游标执行已绑定参数的语句
+         * @details 游标存活期间不要再绑定或执行该语句；游标释放时重置语句，之后可以重新绑定。
+         */
+        [[nodiscard]] SqlData::Ptr cursor();
+
         // ===== 错误 =====
         [[nodiscard]] int error_code() const override;
         [[nodiscard]] std::string_view error_message() const override;
@@ -500,6 +631,13 @@ namespace cfl::db {
         /// 执行更新
         static int execute(std::string_view name, std::string_view sql);
 
+        /// 创建指定数据源的批量写入器
+        [[nodiscard]] static BatchWriter batch_writer(std::string_view name, std::string table,
+                                                     std::vector<std::string> columns, BatchOptions options = {}) {
+            return {SQLiteMgr::instance()->get(std::string{name}), SqlDialect::SQLite, std::move(table),
+                    std::move(columns), std::move(options)};
+        }
+
         /// 执行预编译 SQL（带参数绑定）
         template<typename... Args>
         static int execute_prepared(const char *name, const char *sql, Args &&... args) {
@@ -564,14 +702,17 @@ namespace cfl::db {
     // ========================== SQLite::execStmt 实现 ==========================
     template<typename... Args>
     int SQLite::execStmt(const char *sql, Args &&... args) {
+        // 失败统一返回 -1，与 execute 和 MySQL::execStmt 一致（SQLite 错误码为正数，调用方按 < 0 判断失败）
         auto stmt = SQLiteStatement::create(getSQLite(), sql);
         if (!stmt) {
-            return SQLITE_ERROR;
+            spdlog::error("SQLite::execStmt: SQLiteStatement::create error");
+            return -1;
         }
 
         int rc = bindX(stmt, std::forward<Args>(args)...);
         if (rc != SQLITE_OK) {
-            return rc;
+            spdlog::error("SQLite::execStmt: bindX error, rc={}", rc);
+            return -1;
         }
 
         return stmt->execute();
@@ -1,9 +1,11 @@
 #include "cfl/db/db_mysql.h"
 #include "cfl/shm/obj/global_data_obj.h"
 
+#include <algorithm>
 #include <cstring>      // for std::memcpy
 #include <format>       // for std::format
 #include <stdexcept>
+#include "config.h"
 #include "global_data_manager.h"
 #include "server_define.h"
 #include "shm/shmpool.h"
@@ -12,60 +14,125 @@ namespace cfl {
 
     using namespace shm;
 
-    bool GlobalDataManager::load_data() {
-        std::scoped_lock lock(mutex_);
+    namespace {
+        /// 全局数据所在的数据源
+        const std::string kGlobalSource = "db_game";
+    }
 
-        // 创建或获取共享内存对象
-        global_data_ = (create_object<GlobalDataObject>(SHMTYPE::Global, false));
-        if (!global_data_) {
-            throw std::runtime_error("Failed to create GlobalDataObject.");
-        }
+    GlobalDataManager::GlobalDataManager()
+            : guid_allocator_([this](std::uint64_t watermark) { return persist_guid(watermark); },
+                              static_cast<std::uint64_t>(std::max(1, Config::GetGameInfo("guid_segment", 10000))),
+                              static_cast<std::uint32_t>(std::max(1, Config::GetGameInfo("guid_thread_block", 64)))) {
+        load_data();
+    }
 
-        global_data_->lock();
-        // todo: 根据服务器数据设置：服务器ID、GUID、最大在线人数、扩展数据
-//        global_data_->server_id = GameService::instance().getServerId();
-//
-//        const std::string sql = std::format(
-//                "SELECT * FROM globaldata WHERE serverid = {}",
-//                GameService::instance().getServerId()
-//        );
-//
-//        CppMySQLQuery query = DBMysql::instance().query(sql.c_str());
-//        if (!query.eof()) {
-//            global_data_->guid = query.getInt64Field("maxguid");
-//            global_data_->max_online = query.getIntField("maxonline");
-//
-//            int blobLen = 0;
-//            const unsigned char* blobData = query.getBlobField("exdata", blobLen);
-//            if (blobData && blobLen > 0) {
-//                std::memcpy(global_data_->extraData.data(), blobData,
-//                            std::min(blobLen, static_cast<int>(global_data_->extraData.size() * sizeof(int32_t))));
-//            }
-//        }
-//
-//        if (global_data_->guid <= 0) {
-//            const auto sid = GameService::instance().getServerId();
-//            global_data_->guid = (static_cast<std::uint64_t>(sid) << 48) + 1;
-//        }
-//
-//        // 预分配一定范围
-//        global_data_->guid += 100;
-        global_data_->unlock();
+    bool GlobalDataManager::load_data() {
+        std::uint64_t watermark = 0;
+        {
+            std::scoped_lock lock(mutex_);
+
+            // 重启后附加共享内存中已有的对象，保留其中的水位和扩展数据；没有时新建。
+            // 重复调用时沿用已持有的对象，不能再次包装同一个块
+            if (!global_data_) {
+                auto existing = attach_used_objects<GlobalDataObject>(
+                        DataPoolManager::instance().get_shared_pool(SHMTYPE::Global));
+                auto newest = std::max_element(existing.begin(), existing.end(), [](auto &a, auto &b) {
+                    return a->guid < b->guid;
+                });
+                if (newest != existing.end()) {
+                    global_data_ = *newest;
+                    spdlog::info("[GlobalDataManager] attached global data in shared memory, guid watermark {}",
+                                 global_data_->guid);
+                    if (existing.size() > 1) {
+                        // 旧版本每次启动都新建对象，多余的对象随 existing 释放归还给池
+                        spdlog::warn("[GlobalDataManager] {} stale global data objects released",
+                                     existing.size() - 1);
+                    }
+                } else {
+                    global_data_ = create_object<GlobalDataObject>(SHMTYPE::Global, false);
+                }
+            }
+            if (!global_data_) {
+                throw std::runtime_error("Failed to create GlobalDataObject.");
+            }
+
+            server_id_ = static_cast<std::uint32_t>(Config::GetGameInfo("server_id", 1));
+            // 共享内存中的水位（从共享内存恢复时不为 0）
+            watermark = global_data_->guid;
+            std::uint32_t max_online = global_data_->max_online;
+            // 水位为 0 说明共享内存中没有数据，扩展数据以数据库为准
+            bool from_db = watermark == 0;
+
+            persist_to_db_ = db::MySQLMgr::instance()->has_datasource(kGlobalSource);
+            if (persist_to_db_) {
+                auto query = db::MySQLUtil::query_fmt(kGlobalSource,
+                                                      "SELECT maxguid, maxonline, extradata FROM globaldata WHERE serverid = {}",
+                                                      server_id_);
+                if (!query) {
+                    throw std::runtime_error("Failed to load globaldata.");
+                }
+                if (query->next()) {
+                    // 共享内存和数据库都不小于已发出的 GUID，取较大者
+                    watermark = std::max(watermark, query->get_uint64(0));
+                    max_online = std::max(max_online, query->get_uint32(1));
+                    if (from_db) {
+                        auto extra = query->get_blob(2);
+                        global_data_->lock();
+                        std::memcpy(global_data_->extra_data.data(), extra.data(),
+                                    std::min(extra.size(), sizeof(global_data_->extra_data)));
+                        global_data_->unlock();
+                    }
+                }
+            } else {
+                spdlog::warn("[GlobalDataManager] {} not registered, GUID watermark kept in shared memory only",
+                             kGlobalSource);
+            }
+            if (watermark == 0) {
+                watermark = static_cast<std::uint64_t>(server_id_) << 48;
+            }
+
+            global_data_->lock();
+            global_data_->server_id = server_id_;
+            global_data_->guid = watermark;
+            global_data_->max_online = max_online;
+            global_data_->unlock();
+        }
 
+        // 预留第一段时会回调 persist_guid，需要在 mutex_ 之外调用
+        if (!guid_allocator_.start(watermark)) {
+            throw std::runtime_error("Failed to reserve GUID segment.");
+        }
         return true;
     }
 
-    std::uint64_t GlobalDataManager::make_new_guid() {
-        std::scoped_lock lock(mutex_);
-        if (!global_data_) {
-            throw std::runtime_error("GlobalDataObject is not initialized.");
+    bool GlobalDataManager::persist_guid(std::uint64_t watermark) {
+        {
+            std::scoped_lock lock(mutex_);
+            if (!global_data_) {
+                return false;
+            }
+            // 由预留线程调用，不能追加变更日志（只允许逻辑线程写入）
+            global_data_->lock();
+            global_data_->guid = watermark;
+            global_data_->unlock_unpublished();
         }
+        if (!persist_to_db_) {
+            return true;
+        }
+        // 只增不减，避免旧的写入覆盖新的水位
+        return db::MySQLUtil::execute_prepared(
+                kGlobalSource.c_str(),
+                "INSERT INTO globaldata (serverid, maxguid) VALUES(?, ?) "
+                "ON DUPLICATE KEY UPDATE maxguid = GREATEST(maxguid, VALUES(maxguid));",
+                server_id_, watermark) >= 0;
+    }
 
-        global_data_->lock();
-        const auto newGuid = ++global_data_->guid;
-        global_data_->unlock();
-
-        return newGuid;
+    std::uint64_t GlobalDataManager::make_new_guid() {
+        auto guid = guid_allocator_.next();
+        if (guid == 0) {
+            throw std::runtime_error("Failed to persist GUID watermark.");
+        }
+        return guid;
     }
 
     void GlobalDataManager::set_max_online(std::int32_t num) noexcept {
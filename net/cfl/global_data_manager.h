@@ -1,6 +1,7 @@
 #pragma once
 
 #include "db/db_mysql.h"
+#include "guid_allocator.h"
 #include "shm/obj/global_data_obj.h"
 #include <cstdint>
 #include <memory>
@@ -78,15 +79,23 @@ namespace cfl {
         /**
          * @brief 生成新的全局唯一 GUID。
          *
-         * 根据内部的全局计数器生成递增的唯一标识符，
+         * 由 GuidAllocator 从线程本地区间分配，不加锁；
          * 可用于角色、物品、任务等对象的唯一标识。
+         * GlobalDataObject::guid 记录已预留的水位（不小于任何已发出的 GUID），
+         * 每段（配置项 guid_segment，默认 10000）写入一次共享内存和数据库。
          *
          * @return 新生成的 64 位全局唯一 ID。
+         * @throw std::runtime_error 水位无法写入时抛出。
          *
          * @threadsafe
          */
         [[nodiscard]] std::uint64_t make_new_guid();
 
+        /**
+         * @brief GUID 分配器（只读），用于查看水位和统计。
+         */
+        [[nodiscard]] const GuidAllocator &guid_allocator() const noexcept { return guid_allocator_; }
+
         /**
          * @brief 设置最大在线人数。
          *
@@ -137,9 +146,7 @@ namespace cfl {
          *
          * 初始化为空状态，需调用 loadData() 完成加载。
          */
-        GlobalDataManager(){
-            load_data();
-        }
+        GlobalDataManager();
 
         /**
          * @brief 析构函数（私有）。
@@ -148,6 +155,14 @@ namespace cfl {
          */
         ~GlobalDataManager() = default;
 
+        /**
+         * @brief 把 GUID 水位写入共享内存，配置了 db_game 时同时写入数据库。
+         *
+         * @param watermark 新的水位。
+         * @return 写入成功返回 `true`。
+         */
+        bool persist_guid(std::uint64_t watermark);
+
     private:
         /**
          * @brief 全局数据对象指针。
@@ -163,6 +178,21 @@ namespace cfl {
          * 保证在多线程读写全局数据时的同步性。
          */
         mutable std::mutex mutex_;
+
+        /**
+         * @brief 服务器ID，GUID 的高 16 位。
+         */
+        std::uint32_t server_id_ = 0;
+
+        /**
+         * @brief 水位是否写入数据库（db_game 已注册时为 true）。
+         */
+        bool persist_to_db_ = false;
+
+        /**
+         * @brief GUID 分配器，声明在 global_data_ 之后，先于它析构。
+         */
+        GuidAllocator guid_allocator_;
     };
 
 } // namespace cfl
@@ -0,0 +1,141 @@
+#include "guid_allocator.h"
+#include <algorithm>
+#include <chrono>
+#include "spdlog/spdlog.h"
+
+namespace cfl {
+
+    namespace {
+        /// 线程本地区间 [next, end)，owner 为所属分配器的编号
+        struct LocalBlock {
+            std::uint64_t owner = 0;
+            std::uint64_t next = 0;
+            std::uint64_t end = 0;
+        };
+
+        thread_local LocalBlock t_block;
+
+        std::atomic<std::uint64_t> g_instance_id{0};
+
+        /// 写入失败后重试的间隔
+        constexpr auto kRetryInterval = std::chrono::seconds(1);
+    }
+
+    GuidAllocator::GuidAllocator(Persist persist, std::uint64_t segment, std::uint32_t thread_block)
+            : persist_(std::move(persist)), segment_(std::max<std::uint64_t>(segment, 2)),
+              thread_block_(std::clamp<std::uint32_t>(thread_block, 1, static_cast<std::uint32_t>(segment_ / 2))),
+              instance_id_(g_instance_id.fetch_add(1) + 1) {
+    }
+
+    GuidAllocator::~GuidAllocator() {
+        stop();
+    }
+
+    bool GuidAllocator::start(std::uint64_t watermark) {
+        {
+            std::lock_guard lock(persist_mutex_);
+            if (started_) {
+                return true;
+            }
+            durable_.store(watermark, std::memory_order_release);
+            next_.store(watermark + 1, std::memory_order_release);
+            if (!advance_locked(watermark + segment_)) {
+                spdlog::error("[GuidAllocator] reserve first segment after {} failed", watermark);
+                return false;
+            }
+            started_ = true;
+        }
+
+        prefetch_thread_ = std::jthread([this](std::stop_token token) {
+            std::unique_lock signal(signal_mutex_);
+            while (!token.stop_requested()) {
+                signal_cv_.wait(signal, token, [this] { return prefetching_.load(std::memory_order_acquire); });
+                if (token.stop_requested()) {
+                    break;
+                }
+                signal.unlock();
+                bool ok;
+                {
+                    std::lock_guard lock(persist_mutex_);
+                    // 以已领取的位置为基准，保证推进后至少还有一整段可用
+                    auto base = std::max(durable_.load(std::memory_order_acquire),
+                                         next_.load(std::memory_order_acquire));
+                    ok = advance_locked(base + segment_);
+                }
+                signal.lock();
+                if (ok) {
+                    prefetching_.store(false, std::memory_order_release);
+                } else {
+                    signal_cv_.wait_for(signal, token, kRetryInterval, [] { return false; });
+                }
+            }
+        });
+        spdlog::info("[GuidAllocator] start after {}, segment {}, thread block {}", watermark, segment_,
+                     thread_block_);
+        return true;
+    }
+
+    void GuidAllocator::stop() {
+        if (prefetch_thread_.joinable()) {
+            prefetch_thread_.request_stop();
+            prefetch_thread_.join();
+        }
+    }
+
+    bool GuidAllocator::advance_locked(std::uint64_t target) {
+        if (durable_.load(std::memory_order_acquire) >= target) {
+            return true;
+        }
+        if (!persist_ || !persist_(target)) {
+            return false;
+        }
+        persists_.fetch_add(1, std::memory_order_relaxed);
+        durable_.store(target, std::memory_order_release);
+        return true;
+    }
+
+    void GuidAllocator::maybe_prefetch(std::uint64_t block_end) {
+        auto durable = durable_.load(std::memory_order_acquire);
+        if (durable > block_end && durable - block_end >= segment_ / 2) {
+            return;
+        }
+        if (!prefetching_.exchange(true, std::memory_order_acq_rel)) {
+            std::lock_guard signal(signal_mutex_);
+            signal_cv_.notify_one();
+        }
+    }
+
+    std::uint64_t GuidAllocator::claim_block() {
+        auto start = next_.fetch_add(thread_block_, std::memory_order_acq_rel);
+        auto last = start + thread_block_ - 1;
+        if (last > durable_.load(std::memory_order_acquire)) {
+            // 后台线程没能提前推进水位，同步写入
+            stalls_.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard lock(persist_mutex_);
+            if (!advance_locked(last + segment_)) {
+                spdlog::error("[GuidAllocator] persist watermark {} failed", last + segment_);
+                return 0;
+            }
+        } else {
+            maybe_prefetch(last);
+        }
+        return start;
+    }
+
+    std::uint64_t GuidAllocator::next() {
+        auto &block = t_block;
+        if (block.owner == instance_id_ && block.next < block.end) {
+            return block.next++;
+        }
+        if (!started_.load(std::memory_order_acquire)) {
+            return 0;
+        }
+        auto start = claim_block();
+        if (start == 0) {
+            return 0;
+        }
+        block = {instance_id_, start + 1, start + thread_block_};
+        return start;
+    }
+
+} // namespace cfl
@@ -0,0 +1,112 @@
+/**
+ * @file guid_allocator.h
+ * @brief 按段预留、线程本地分配的 GUID 分配器
+ *
+ * @details
+ * 每次生成 GUID 都要加互斥锁、再加共享内存对象锁，邮件、物品等高频创建时成为热点。GuidAllocator 分三层：
+ * - 持久化水位（watermark）：已写入存储的最大可用 ID。只有不超过水位的 ID 才会发出，
+ *   因此从共享内存或数据库重启后，从水位 + 1 继续分配不会与已发出的 ID 重复；
+ * - 全局计数器：线程本地区间用完时，用一次 fetch_add 领取下一个区间（默认 64 个）；
+ * - 线程本地区间：区间内的分配没有任何原子操作。
+ *
+ * 剩余的已持久化 ID 少于半段时，后台线程把水位推进一段（默认 10000）并写入存储，
+ * 分配线程通常不会等待持久化；水位耗尽（如存储长时间不可写）时，领取区间的线程同步写入并等待。
+ *
+ * @note ID 全局唯一、每个线程内递增，但不保证全局连续：线程退出或重启时未用完的区间直接丢弃。
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace cfl {
+
+    class GuidAllocator {
+    public:
+        /**
+         * @brief 把新的水位写入存储
+         * @details 在后台线程或领取区间的线程中调用，调用之间互斥；返回 true 后该水位必须已经落地。
+         * @return 写入失败时返回 false，水位不变
+         */
+        using Persist = std::function<bool(std::uint64_t watermark)>;
+
+        /**
+         * @param persist 水位写入函数
+         * @param segment 每次推进水位的 ID 数
+         * @param thread_block 每个线程每次领取的 ID 数
+         */
+        explicit GuidAllocator(Persist persist, std::uint64_t segment = 10000, std::uint32_t thread_block = 64);
+
+        /**
+         * @brief 析构时停止后台线程
+         */
+        ~GuidAllocator();
+
+        GuidAllocator(const GuidAllocator &) = delete;
+        GuidAllocator &operator=(const GuidAllocator &) = delete;
+
+        /**
+         * @brief 从已持久化的水位开始分配，同步预留第一段并启动后台线程
+         * @param watermark 存储中记录的水位（共享内存与数据库中较大的一个），第一个 ID 为 watermark + 1
+         * @return 第一段写入失败时返回 false
+         */
+        bool start(std::uint64_t watermark);
+
+        /**
+         * @brief 停止后台线程，之后仍可在已持久化的范围内分配
+         */
+        void stop();
+
+        /**
+         * @brief 分配一个 ID
+         * @return 新的 ID；未启动或水位写入失败时返回 0
+         * @threadsafe
+         */
+        [[nodiscard]] std::uint64_t next();
+
+        /// 已持久化的水位
+        [[nodiscard]] std::uint64_t watermark() const noexcept { return durable_.load(std::memory_order_acquire); }
+
+        /// 下一个未领取区间的起始 ID
+        [[nodiscard]] std::uint64_t reserved() const noexcept { return next_.load(std::memory_order_acquire); }
+
+        /// 水位写入次数
+        [[nodiscard]] std::uint64_t persist_count() const noexcept { return persists_.load(std::memory_order_relaxed); }
+
+        /// 分配线程同步等待写入的次数
+        [[nodiscard]] std::uint64_t stall_count() const noexcept { return stalls_.load(std::memory_order_relaxed); }
+
+    private:
+        /// 领取一个新区间，返回区间的起始 ID，失败时返回 0
+        std::uint64_t claim_block();
+
+        /// 同步推进水位直到不小于 target（调用方持有 persist_mutex_）
+        bool advance_locked(std::uint64_t target);
+
+        /// 剩余的已持久化 ID 不足半段时唤醒后台线程
+        void maybe_prefetch(std::uint64_t block_end);
+
+        Persist persist_;
+        const std::uint64_t segment_;
+        const std::uint32_t thread_block_;
+        const std::uint64_t instance_id_;              ///< 区分线程本地区间属于哪个分配器
+
+        std::atomic<std::uint64_t> next_{0};           ///< 下一个未领取区间的起始 ID
+        std::atomic<std::uint64_t> durable_{0};        ///< 已持久化的水位
+        std::atomic<bool> started_{false};
+        std::atomic<bool> prefetching_{false};
+        std::atomic<std::uint64_t> persists_{0};
+        std::atomic<std::uint64_t> stalls_{0};
+
+        std::mutex persist_mutex_;                     ///< 串行化水位写入
+        std::mutex signal_mutex_;
+        std::condition_variable_any signal_cv_;
+        std::jthread prefetch_thread_;
+    };
+
+} // namespace cfl
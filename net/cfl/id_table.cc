@@ -0,0 +1,112 @@
+#include "id_table.h"
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace cfl {
+
+    IdTable::IdTable(std::size_t capacity) {
+        rehash(std::bit_ceil(std::max<std::size_t>(capacity, 16)));
+    }
+
+    std::uint32_t IdTable::find(std::uint64_t id) const noexcept {
+        if (id == 0) {
+            return kNotFound;
+        }
+        for (auto pos = home(id);; pos = (pos + 1) & mask_) {
+            auto &slot = slots_[pos];
+            if (slot.id == id) {
+                return slot.value;
+            }
+            if (slot.id == 0) {
+                return kNotFound;
+            }
+        }
+    }
+
+    bool IdTable::insert(std::uint64_t id, std::uint32_t value) {
+        if (id == 0 || contains(id)) {
+            return false;
+        }
+        return assign(id, value);
+    }
+
+    bool IdTable::assign(std::uint64_t id, std::uint32_t value) {
+        if (id == 0) {
+            return false;
+        }
+        if ((size_ + 1) * 10 > slots_.size() * 7) {
+            rehash(slots_.size() * 2);
+        }
+        for (auto pos = home(id);; pos = (pos + 1) & mask_) {
+            auto &slot = slots_[pos];
+            if (slot.id == id) {
+                slot.value = value;
+                return true;
+            }
+            if (slot.id == 0) {
+                slot = {id, value};
+                ++size_;
+                return true;
+            }
+        }
+    }
+
+    bool IdTable::erase(std::uint64_t id) noexcept {
+        if (id == 0) {
+            return false;
+        }
+        auto pos = home(id);
+        while (slots_[pos].id != id) {
+            if (slots_[pos].id == 0) {
+                return false;
+            }
+            pos = (pos + 1) & mask_;
+        }
+        // 把探测链上后面的项前移，填补空出的槽位
+        auto hole = pos;
+        for (auto next = (hole + 1) & mask_; slots_[next].id != 0; next = (next + 1) & mask_) {
+            auto want = home(slots_[next].id);
+            // want 不在 (hole, next] 之间时，该项可以移到 hole
+            if (((next - want) & mask_) >= ((next - hole) & mask_)) {
+                slots_[hole] = slots_[next];
+                hole = next;
+            }
+        }
+        slots_[hole] = {};
+        --size_;
+        return true;
+    }
+
+    void IdTable::reserve(std::size_t count) {
+        auto need = std::bit_ceil(std::max<std::size_t>(count * 10 / 7 + 1, 16));
+        if (need > slots_.size()) {
+            rehash(need);
+        }
+    }
+
+    void IdTable::clear() noexcept {
+        std::fill(slots_.begin(), slots_.end(), Slot{});
+        size_ = 0;
+    }
+
+    void IdTable::rehash(std::size_t capacity) {
+        auto old = std::move(slots_);
+        slots_.assign(capacity, Slot{});
+        mask_ = capacity - 1;
+        shift_ = 64 - static_cast<unsigned>(std::countr_zero(capacity));
+        size_ = 0;
+        for (auto &slot: old) {
+            if (slot.id != 0) {
+                for (auto pos = home(slot.id);; pos = (pos + 1) & mask_) {
+                    if (slots_[pos].id == 0) {
+                        slots_[pos] = slot;
+                        ++size_;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+} // namespace cfl
@@ -0,0 +1,88 @@
+#pragma once
+/**
+ * @file id_table.h
+ * @brief 64 位 ID 到 32 位下标的开放寻址哈希表。
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace cfl {
+
+    /**
+     * @class IdTable
+     * @brief 线性探测的开放寻址哈希表，键为非 0 的 64 位 ID，值为 32 位下标
+     *
+     * - 键和值存放在同一个连续数组中，查找通常只访问一到两条缓存行；
+     * - 容量为 2 的幂，负载超过 70% 时翻倍；
+     * - 删除时把后续探测链上的项向前移动（backward shift），不留墓碑。
+     *
+     * @note 键 0 保留为空槽标记；非线程安全。
+     */
+    class IdTable {
+    public:
+        static constexpr std::uint32_t kNotFound = std::numeric_limits<std::uint32_t>::max();
+
+        explicit IdTable(std::size_t capacity = 16);
+
+        /**
+         * @brief 查找 ID 对应的下标
+         * @return 不存在时返回 kNotFound
+         */
+        [[nodiscard]] std::uint32_t find(std::uint64_t id) const noexcept;
+
+        [[nodiscard]] bool contains(std::uint64_t id) const noexcept { return find(id) != kNotFound; }
+
+        /**
+         * @brief 插入 ID，已存在时不修改
+         * @return true 插入成功；false ID 为 0 或已存在
+         */
+        bool insert(std::uint64_t id, std::uint32_t value);
+
+        /**
+         * @brief 插入或覆盖 ID 对应的下标
+         * @return ID 为 0 时返回 false
+         */
+        bool assign(std::uint64_t id, std::uint32_t value);
+
+        /**
+         * @brief 删除 ID
+         * @return 不存在时返回 false
+         */
+        bool erase(std::uint64_t id) noexcept;
+
+        /**
+         * @brief 预留至少能容纳 count 个 ID 的容量
+         */
+        void reserve(std::size_t count);
+
+        void clear() noexcept;
+
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+        [[nodiscard]] std::size_t capacity() const noexcept { return slots_.size(); }
+
+    private:
+        struct Slot {
+            std::uint64_t id = 0;   // 0 表示空槽
+            std::uint32_t value = 0;
+        };
+
+        [[nodiscard]] std::size_t home(std::uint64_t id) const noexcept {
+            // Fibonacci 散列，取高位
+            return static_cast<std::size_t>((id * 0x9E3779B97F4A7C15ull) >> shift_);
+        }
+
+        void rehash(std::size_t capacity);
+
+        std::vector<Slot> slots_;
+        std::size_t mask_ = 0;
+        unsigned shift_ = 64;
+        std::size_t size_ = 0;
+    };
+
+} // namespace cfl
@@ -0,0 +1,71 @@
+#include "group_mail_list.h"
+
+namespace cfl::shm {
+
+    namespace {
+        // 墓碑少于该数量时不压缩
+        constexpr std::size_t kMinCompactTombstones = 64;
+    }
+
+    bool GroupMailList::add(MailPtr mail) {
+        if (!mail || index_.contains(mail->guid)) {
+            return false;
+        }
+        Entry entry{mail->time, mail->guid, std::move(mail)};
+        if (!entries_.empty()) {
+            auto &back = entries_.back();
+            if (entry.time < back.time || (entry.time == back.time && entry.guid < back.guid)) {
+                sorted_ = false;
+            }
+        }
+        last_time_ = std::max(last_time_, entry.time);
+        index_.emplace(entry.guid, entries_.size());
+        entries_.push_back(std::move(entry));
+        return true;
+    }
+
+    bool GroupMailList::remove(std::uint64_t guid) {
+        auto it = index_.find(guid);
+        if (it == index_.end()) {
+            return false;
+        }
+        entries_[it->second].mail.reset();
+        index_.erase(it);
+        ++tombstones_;
+        return true;
+    }
+
+    GroupMailList::MailPtr GroupMailList::find(std::uint64_t guid) const {
+        auto it = index_.find(guid);
+        return it != index_.end() ? entries_[it->second].mail : nullptr;
+    }
+
+    void GroupMailList::clear() {
+        entries_.clear();
+        index_.clear();
+        tombstones_ = 0;
+        last_time_ = 0;
+        sorted_ = true;
+    }
+
+    void GroupMailList::prepare() {
+        if (!sorted_ || (tombstones_ >= kMinCompactTombstones && tombstones_ * 2 >= entries_.size())) {
+            rebuild();
+        }
+    }
+
+    void GroupMailList::rebuild() {
+        std::erase_if(entries_, [](const Entry &entry) { return !entry.mail; });
+        if (!sorted_) {
+            std::sort(entries_.begin(), entries_.end(), [](const Entry &a, const Entry &b) {
+                return a.time != b.time ? a.time < b.time : a.guid < b.guid;
+            });
+            sorted_ = true;
+        }
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            index_[entries_[i].guid] = i;
+        }
+        tombstones_ = 0;
+    }
+
+} // namespace cfl::shm
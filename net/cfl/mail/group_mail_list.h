@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "cfl/shm/obj/mail_data_obj.h"
+
+namespace cfl::shm {
+
+//==============================================================
+// @class GroupMailList
+// @brief 按发送时间排序的群邮件列表
+//
+// 玩家登录时只需要发送时间晚于角色群邮件水位（groupMailTime）的群邮件：
+// - 群邮件按 (时间, GUID) 排序存放在只追加的数组中，时间拷贝在数组项里，二分查找不访问共享内存对象；
+// - 删除时只把数组项置为墓碑（释放邮件对象），墓碑超过一半时在下次查询前整体压缩；
+// - 从数据库或共享内存恢复时可以乱序加入，在下次查询前统一排序。
+//
+// @note 非线程安全，只能在逻辑线程中使用
+//==============================================================
+    class GroupMailList {
+    public:
+        using MailPtr = std::shared_ptr<GroupMailDataObject>;
+
+        //==========================================================
+        // @brief 加入群邮件
+        // @return 邮件为空或 GUID 已存在时返回 false
+        //==========================================================
+        bool add(MailPtr mail);
+
+        //==========================================================
+        // @brief 删除群邮件（置为墓碑）
+        // @return GUID 不存在时返回 false
+        //==========================================================
+        bool remove(std::uint64_t guid);
+
+        //==========================================================
+        // @brief 按 GUID 查找群邮件，不存在时返回空
+        //==========================================================
+        [[nodiscard]] MailPtr find(std::uint64_t guid) const;
+
+        [[nodiscard]] bool contains(std::uint64_t guid) const { return index_.contains(guid); }
+
+        //==========================================================
+        // @brief 按时间顺序遍历发送时间晚于 time 的群邮件
+        // @param f 以 const MailPtr & 调用
+        // @return 遍历的邮件数
+        //==========================================================
+        template<class F>
+        std::size_t for_each_after(std::uint64_t time, F &&f) {
+            prepare();
+            auto it = std::upper_bound(entries_.begin(), entries_.end(), time,
+                                       [](std::uint64_t t, const Entry &entry) { return t < entry.time; });
+            std::size_t count = 0;
+            for (; it != entries_.end(); ++it) {
+                if (it->mail) {
+                    f(it->mail);
+                    ++count;
+                }
+            }
+            return count;
+        }
+
+        //==========================================================
+        // @brief 遍历所有群邮件（不保证顺序）
+        //==========================================================
+        template<class F>
+        void for_each(F &&f) const {
+            for (auto &entry: entries_) {
+                if (entry.mail) {
+                    f(entry.mail);
+                }
+            }
+        }
+
+        //==========================================================
+        // @brief 为新群邮件分配发送时间：不早于 now，且严格晚于已有的群邮件，
+        //        保证角色的群邮件水位不会跳过同一毫秒内发送的邮件
+        //==========================================================
+        [[nodiscard]] std::uint64_t next_time(std::uint64_t now) const noexcept {
+            return std::max(now, last_time_ + 1);
+        }
+
+        // 群邮件数（不含墓碑）
+        [[nodiscard]] std::size_t size() const noexcept { return index_.size(); }
+
+        [[nodiscard]] bool empty() const noexcept { return index_.empty(); }
+
+        // 尚未压缩的墓碑数
+        [[nodiscard]] std::size_t tombstones() const noexcept { return tombstones_; }
+
+        void clear();
+
+    private:
+        struct Entry {
+            std::uint64_t time = 0;   // 发送时间（拷贝自邮件对象）
+            std::uint64_t guid = 0;
+            MailPtr mail;             // 为空表示墓碑
+        };
+
+        // 查询前排序或压缩
+        void prepare();
+
+        // 排序并去掉墓碑，重建 GUID 索引
+        void rebuild();
+
+        std::vector<Entry> entries_;
+        std::unordered_map<std::uint64_t, std::size_t> index_; // GUID -> entries_ 下标
+        std::size_t tombstones_ = 0;
+        std::uint64_t last_time_ = 0;   // 最大的发送时间
+        bool sorted_ = true;
+    };
+
+} // namespace cfl::shm
@@ -0,0 +1,56 @@
+#include "mail_expiry_index.h"
+
+namespace cfl::shm {
+
+    MailExpiryIndex::MailExpiryIndex(std::uint64_t bucket_ms)
+            : bucket_ms_(bucket_ms > 0 ? bucket_ms : 3600 * 1000) {
+    }
+
+    void MailExpiryIndex::set_bucket_ms(std::uint64_t bucket_ms) {
+        if (bucket_ms == 0 || bucket_ms == bucket_ms_) {
+            return;
+        }
+        // 已有的项按新的跨度重新分桶
+        auto old = std::move(buckets_);
+        buckets_.clear();
+        guids_.clear();
+        size_ = 0;
+        bucket_ms_ = bucket_ms;
+        for (auto &[id, bucket]: old) {
+            for (auto &entry: bucket.entries) {
+                add(entry.kind, entry.guid, entry.role_id, entry.expire_time);
+            }
+        }
+    }
+
+    bool MailExpiryIndex::add(Kind kind, std::uint64_t guid, std::uint64_t role_id, std::uint64_t expire_time) {
+        if (!guids_.insert(guid).second) {
+            return false;
+        }
+        auto &bucket = buckets_[expire_time / bucket_ms_];
+        if (bucket.sorted && !bucket.entries.empty() && bucket.entries.back().expire_time < expire_time) {
+            bucket.sorted = false;
+        }
+        bucket.entries.push_back({expire_time, guid, role_id, kind});
+        ++size_;
+        return true;
+    }
+
+    std::uint64_t MailExpiryIndex::next_expire_time() const {
+        if (buckets_.empty()) {
+            return 0;
+        }
+        auto &entries = buckets_.begin()->second.entries;
+        auto it = std::min_element(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+            return a.expire_time < b.expire_time;
+        });
+        return it->expire_time;
+    }
+
+    void MailExpiryIndex::clear() {
+        buckets_.clear();
+        guids_.clear();
+        size_ = 0;
+    }
+
+} // namespace cfl::shm
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+namespace cfl::shm {
+
+//==============================================================
+// @class MailExpiryIndex
+// @brief 按到期时间分桶的邮件过期索引
+//
+// 清理过期邮件时不需要遍历每个玩家的邮件和全部群邮件：
+// - 邮件加入时按到期时间落到对应的时间桶（默认一小时一桶）；
+// - 每帧只处理有限数量的到期项，桶在第一次被清理时按到期时间排序，之后从尾部弹出；
+// - 邮件被提前删除时不从索引中移除，到期时由处理函数发现对象已不存在并跳过；
+// - 同一 guid 在处理前只登记一次，玩家每次登录重新加载邮件时不会重复加入。
+//
+// @note 非线程安全，只能在逻辑线程中使用
+//==============================================================
+    class MailExpiryIndex {
+    public:
+        enum class Kind : std::uint8_t {
+            Personal,   // 个人邮件（包括离线邮件）
+            Group,      // 群发邮件
+        };
+
+        struct Entry {
+            std::uint64_t expire_time = 0;
+            std::uint64_t guid = 0;
+            std::uint64_t role_id = 0;   // 个人邮件的接收者，群发邮件为 0
+            Kind kind = Kind::Personal;
+        };
+
+        //==========================================================
+        // @param bucket_ms 时间桶跨度（毫秒），为 0 时按一小时
+        //==========================================================
+        explicit MailExpiryIndex(std::uint64_t bucket_ms = 3600 * 1000);
+
+        void set_bucket_ms(std::uint64_t bucket_ms);
+
+        [[nodiscard]] std::uint64_t bucket_ms() const noexcept { return bucket_ms_; }
+
+        //==========================================================
+        // @brief 加入一封邮件
+        // @return guid 已在索引中时忽略并返回 false
+        //==========================================================
+        bool add(Kind kind, std::uint64_t guid, std::uint64_t role_id, std::uint64_t expire_time);
+
+        [[nodiscard]] bool contains(std::uint64_t guid) const { return guids_.contains(guid); }
+
+        //==========================================================
+        // @brief 按到期时间顺序处理到期时间不晚于 now 的项
+        // @param budget 本次最多处理的项数
+        // @param f 以 const Entry & 调用
+        // @return 处理的项数
+        //==========================================================
+        template<class F>
+        std::size_t sweep(std::uint64_t now, std::size_t budget, F &&f) {
+            std::size_t count = 0;
+            while (count < budget && !buckets_.empty()) {
+                auto it = buckets_.begin();
+                if (it->first * bucket_ms_ > now) {
+                    break;
+                }
+                auto &bucket = it->second;
+                if (!bucket.sorted) {
+                    // 到期时间降序，最早到期的在尾部
+                    std::sort(bucket.entries.begin(), bucket.entries.end(), [](const Entry &a, const Entry &b) {
+                        return a.expire_time > b.expire_time;
+                    });
+                    bucket.sorted = true;
+                }
+                while (count < budget && !bucket.entries.empty() && bucket.entries.back().expire_time <= now) {
+                    auto entry = bucket.entries.back();
+                    bucket.entries.pop_back();
+                    guids_.erase(entry.guid);
+                    --size_;
+                    ++count;
+                    f(entry);
+                }
+                if (!bucket.entries.empty()) {
+                    // 预算用完，或当前桶剩余的项还没有到期
+                    break;
+                }
+                buckets_.erase(it);
+            }
+            return count;
+        }
+
+        //==========================================================
+        // @brief 最早的到期时间，索引为空时返回 0
+        //==========================================================
+        [[nodiscard]] std::uint64_t next_expire_time() const;
+
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+        [[nodiscard]] std::size_t bucket_count() const noexcept { return buckets_.size(); }
+
+        void clear();
+
+    private:
+        struct Bucket {
+            std::vector<Entry> entries;
+            bool sorted = true;
+        };
+
+        std::map<std::uint64_t, Bucket> buckets_;   // 桶编号（到期时间 / bucket_ms_）-> 桶
+        std::unordered_set<std::uint64_t> guids_;   // 索引中的邮件，用于去重
+        std::uint64_t bucket_ms_;
+        std::size_t size_ = 0;
+    };
+
+} // namespace cfl::shm
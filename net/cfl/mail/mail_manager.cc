@@ -1,8 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <unordered_map>
 #include <memory>
 #include <vector>
+#include <span>
 #include <string_view>
 #include "cfl/shm/obj/mail_data_obj.h"
 #include "cfl/shm/shmpool.h"
@@ -12,28 +14,53 @@
 #include "cfl/tools/common.h"
 #include "cfl/modules/role_module.h"
 #include "cfl/modules/mail_module.h"
+#include "cfl/player_manager.h"
+#include "cfl/protos/gen_proto/msg.pb.h"
+#include "cfl/config.h"
 
 namespace cfl {
     using namespace cfl::shm;
 
+    namespace {
+        /// 把新收取的群邮件引用一次批量写库；角色的群邮件水位会随角色数据保存，引用必须同样落库
+        void save_group_mail_states(std::span<const GroupMailStateObject *const> states, std::string_view caller) {
+            if (states.empty() || !db::MySQLMgr::instance()->has_datasource("db_game")) {
+                return;
+            }
+            if (!GroupMailStateObject::create_batch(states)) {
+                spdlog::error("[MailManager::{}] save {} group mail states failed", caller, states.size());
+            }
+        }
+    }
+
     bool MailManager::send_group_mail(std::string_view sender,
                                       std::string_view title,
                                       std::string_view content,
                                       const std::vector<StMailItem> &items,
                                       int32_t recv_group) {
         if (recv_group == 2) {
-            // todo: 使用PlayerManager群发
-            //            auto node = CPlayerManager::GetInstancePtr()->MoveFirst();
-//            if (!node) return false;
-//
-//            for (; node; node = CPlayerManager::GetInstancePtr()->MoveNext(node)) {
-//                if (auto player = node->GetValue(); player && player->IsOnline()) {
-//                    if (auto mailModule = dynamic_cast<CMailModule *>(player->GetModuleByType(MT_MAIL))) {
-//                        mailModule->AddMail(EMT_CUSTOM, std::string(sender), std::string(title),
-//                                            std::string(content), items);
-//                    }
-//                }
-//            }
+            // 只发给当前在线的玩家，直接生成个人邮件，一次批量写库
+            std::string sender_str(sender), title_str(title), content_str(content);
+            std::vector<MailRef> mails;
+            for (auto player: PlayerManager::instance().online_players()) {
+                if (auto mail_module = std::dynamic_pointer_cast<MailModule>(player->get_module_by_type(ModuleType::Mail))) {
+                    if (auto mail = mail_module->add_mail(mail_custom, sender_str, title_str, content_str, items)) {
+                        mails.push_back(std::move(mail));
+                    }
+                }
+            }
+            if (!mails.empty() && db::MySQLMgr::instance()->has_datasource("db_game")) {
+                std::vector<const MailDataObject *> objects;
+                objects.reserve(mails.size());
+                for (auto &mail: mails) {
+                    if (auto obj = mail.get()) {
+                        objects.push_back(obj);
+                    }
+                }
+                if (!MailDataObject::create_batch(objects)) {
+                    spdlog::error("[MailManager::send_group_mail] save {} mails failed", objects.size());
+                }
+            }
             return true;
         }
 
@@ -41,11 +68,12 @@ namespace cfl {
         group_mail->lock();
         group_mail->guid = GlobalDataManager::instance().make_new_guid();
         group_mail->mail_type = mail_custom;
-        group_mail->time = get_timestamp();
+        // 发送时间严格递增，角色水位按时间比较时不会漏掉同一毫秒的邮件
+        group_mail->time = group_mail_data_.next_time(get_timestamp());
 
-        group_mail->title = str_copy(title.data(), MAIL_TITLE_LEN);
-        group_mail->content = str_copy(content.data(), MAIL_CONTENT_LEN);
-        group_mail->sender = str_copy(sender.data(), ROLE_NAME_LEN);
+        str_copy(group_mail->title, title);
+        str_copy(group_mail->content, content);
+        str_copy(group_mail->sender, sender);
 
         for (size_t i = 0; i < items.size() && i < MAIL_ITEM_COUNT; ++i) {
             if (items[i].item_id == 0) break;
@@ -53,20 +81,28 @@ namespace cfl {
         }
 
         group_mail->unlock();
-        group_mail_data_.emplace(group_mail->guid, group_mail);
-
-        // todo: 群发邮件
-//        auto node = CPlayerManager::GetInstancePtr()->MoveFirst();
-//        if (!node) return false;
-//
-//        for (; node; node = CPlayerManager::GetInstancePtr()->MoveNext(node)) {
-//            if (auto player = node->GetValue(); player && player->IsOnline()) {
-//                if (auto mailModule = dynamic_cast<CMailModule *>(player->GetModuleByType(MT_MAIL))) {
-//                    mailModule->ReceiveGroupMail(groupMail);
-//                }
-//            }
-//        }
+        add_group_mail(group_mail);
 
+        // 在线玩家只创建引用记录，邮件内容序列化一次后原样广播
+        MailChangeNty nty;
+        MailModule::fill_group_mail_item(nty.add_change_list(), *group_mail, mail_new);
+        auto payload = nty.SerializeAsString();
+        std::size_t online = 0;
+        std::vector<const GroupMailStateObject *> states;
+        for (auto player: PlayerManager::instance().online_players()) {
+            auto mail_module = std::dynamic_pointer_cast<MailModule>(player->get_module_by_type(ModuleType::Mail));
+            if (!mail_module || !mail_module->receive_group_mail(group_mail, false)) {
+                continue;
+            }
+            if (auto state = mail_module->get_group_mail_state(group_mail->guid)) {
+                states.push_back(state);
+            }
+            player->send_msg_raw(MSG_MAIL_CHANGE_NTY, payload.data(), static_cast<std::uint32_t>(payload.size()));
+            ++online;
+        }
+        save_group_mail_states(states, "send_group_mail");
+        spdlog::info("[MailManager::send_group_mail] group mail {} broadcast to {} online players", group_mail->guid,
+                     online);
         return true;
     }
 
@@ -74,24 +110,31 @@ namespace cfl {
                                        const std::vector<StMailItem> &items, std::string_view sender,
                                        std::string_view title) {
         if (mailType <= 0) return false;
-        // todo: 使用playermanager遍历添加邮件
-//        if (auto player = CPlayerManager::GetInstancePtr()->GetPlayer(roleId); player) {
-//            if (auto mailModule = dynamic_cast<CMailModule *>(player->GetModuleByType(MT_MAIL))) {
-//                return mailModule->AddMail(mailType, std::string(sender), std::string(title),
-//                                           std::string(content), items);
-//            }
-//            return false;
-//        }
-
-        auto mailObject = shm::create_object<MailDataObject>(SHMTYPE::Mail, true);
+        // 已加载的玩家直接放入邮件模块，否则作为离线邮件等待登录时取回
+        if (auto player = PlayerManager::instance().get_player(roleId)) {
+            if (auto mail_module = std::dynamic_pointer_cast<MailModule>(player->get_module_by_type(ModuleType::Mail))) {
+                return static_cast<bool>(mail_module->add_mail(mailType, std::string(sender), std::string(title),
+                                                               std::string(content), items));
+            }
+            return false;
+        }
+
+        auto mailRef = shm::make_shm_ref<MailDataObject>(SHMTYPE::Mail, true);
+        auto mailObject = mailRef.get();
+        if (mailObject == nullptr) {
+            return false;
+        }
         mailObject->lock();
         mailObject->guid = GlobalDataManager::instance().make_new_guid();
         mailObject->role_id = roleId;
+        mailObject->group_guid = 0;
+        mailObject->sender_id = 0;
         mailObject->mail_type = mailType;
+        mailObject->status = mail_new;
         mailObject->time = get_timestamp();
-        mailObject->title = str_copy(title.data(), MAIL_TITLE_LEN);
-        mailObject->content = str_copy(content.data(), MAIL_CONTENT_LEN);
-        mailObject->sender = str_copy(sender.data(), ROLE_NAME_LEN);
+        str_copy(mailObject->title, title);
+        str_copy(mailObject->content, content);
+        str_copy(mailObject->sender, sender);
 
         for (size_t i = 0; i < items.size() && i < MAIL_ITEM_COUNT; ++i) {
             if (items[i].item_id == 0) break;
@@ -99,17 +142,16 @@ namespace cfl {
         }
         mailObject->unlock();
 
-        off_mail_data_.emplace(mailObject->guid, mailObject);
-        return true;
+        return add_off_mail(mailRef);
     }
 
-    std::shared_ptr<MailDataObject> MailManager::pick_up_mail_data(uint64_t guid) {
+    MailRef MailManager::pick_up_mail_data(uint64_t guid) {
         if (auto it = off_mail_data_.find(guid); it != off_mail_data_.end()) {
             auto mail = it->second;
             off_mail_data_.erase(it);
             return mail;
         }
-        return nullptr;
+        return {};
     }
 
     bool MailManager::send_off_operation(uint64_t role_id) {
@@ -119,22 +161,55 @@ namespace cfl {
     }
 
     bool MailManager::delete_group_mail(uint64_t guid) {
-        auto it = group_mail_data_.find(guid);
-        if (it == group_mail_data_.end()) {
+        auto mail = group_mail_data_.find(guid);
+        if (!mail) {
             spdlog::error("[MailManager::delete_group_mail] guid not found");
             return false;
         }
 
-        auto mail = it->second;
         mail->destroy();
 
-        group_mail_data_.erase(it);
+        // 置为墓碑，下次登录查询前按需压缩
+        group_mail_data_.remove(guid);
 
-        // todo: playermanager的一些工作
+        // 已加载玩家的引用随之删除，离线玩家的引用在下次登录加载时丢弃
+        auto holders = group_mail_holders_.extract(guid);
+        if (holders.empty()) {
+            return true;
+        }
+        for (auto role_id: holders.mapped()) {
+            auto player = PlayerManager::instance().get_player(role_id);
+            if (!player) {
+                continue;
+            }
+            if (auto mail_module = std::dynamic_pointer_cast<MailModule>(player->get_module_by_type(ModuleType::Mail))) {
+                mail_module->delete_mail_by_group_id(guid);
+            }
+        }
         return true;
     }
 
+    void MailManager::add_group_mail_holder(uint64_t group_guid, uint64_t role_id) {
+        group_mail_holders_[group_guid].insert(role_id);
+    }
+
+    void MailManager::remove_group_mail_holder(uint64_t group_guid, uint64_t role_id) {
+        auto it = group_mail_holders_.find(group_guid);
+        if (it == group_mail_holders_.end()) {
+            return;
+        }
+        it->second.erase(role_id);
+        if (it->second.empty()) {
+            group_mail_holders_.erase(it);
+        }
+    }
+
     bool MailManager::load_data() {
+        mail_expire_ms_ = static_cast<uint64_t>(std::max(0, Config::GetGameInfo("mail_expire_days", 30))) * 24 * 3600 * 1000;
+        expire_per_frame_ = static_cast<std::size_t>(std::max(1, Config::GetGameInfo("mail_expire_per_frame", 256)));
+        delete_batch_ = static_cast<std::size_t>(std::max(1, Config::GetGameInfo("mail_delete_batch", 500)));
+        expiry_index_.set_bucket_ms(
+                static_cast<uint64_t>(std::max(1, Config::GetGameInfo("mail_expire_bucket_minutes", 60))) * 60 * 1000);
         if (!load_group_mail_data()) {
             return false;
         }
@@ -143,16 +218,147 @@ namespace cfl {
 
     bool MailManager::process_role_login(std::shared_ptr<PlayerObject> &player) {
         auto role_module = dynamic_pointer_cast<RoleModule>(player->get_module_by_type(ModuleType::Role));
-        for(auto& mail : group_mail_data_){
-            spdlog::info("[MailManager::process_role_login] group mail id", mail.first);
-            auto mail_object = mail.second;
-            if(mail_object->time > role_module->get_last_logon_time()){
-                spdlog::error("[MailManager::process_role_login] todo: send group mail");
-                auto mail_module = dynamic_pointer_cast<MailModule>(player->get_module_by_type(ModuleType::Mail));
-                mail_module->receive_group_mail(mail_object);
+        auto mail_module = dynamic_pointer_cast<MailModule>(player->get_module_by_type(ModuleType::Mail));
+        if (!role_module || !mail_module) {
+            spdlog::error("[MailManager::process_role_login] role or mail module missing");
+            return false;
+        }
+
+        auto since = role_module->get_group_mail_time();
+        if (since == 0) {
+            since = role_module->get_last_logon_time();
+        }
+        std::vector<const GroupMailStateObject *> states;
+        auto count = group_mail_data_.for_each_after(since, [&](const GroupMailList::MailPtr &mail) {
+            if (mail_module->receive_group_mail(mail)) {
+                if (auto state = mail_module->get_group_mail_state(mail->guid)) {
+                    states.push_back(state);
+                }
             }
+        });
+        save_group_mail_states(states, "process_role_login");
+        if (count > 0) {
+            spdlog::info("[MailManager::process_role_login] role {} received {} group mails", player->role_id(), count);
+        }
+        return true;
+    }
+
+    bool MailManager::add_group_mail(GroupMailList::MailPtr mail) {
+        if (!mail) {
+            return false;
         }
+        auto guid = mail->guid;
+        auto time = mail->time;
+        if (!group_mail_data_.add(std::move(mail))) {
+            return false;
+        }
+        if (mail_expire_ms_ > 0) {
+            expiry_index_.add(MailExpiryIndex::Kind::Group, guid, 0, time + mail_expire_ms_);
+        }
+        return true;
+    }
 
+    bool MailManager::add_off_mail(MailRef mail) {
+        auto obj = mail.get();
+        if (obj == nullptr || !off_mail_data_.emplace(obj->guid, mail).second) {
+            return false;
+        }
+        track_mail(obj->guid, obj->role_id, obj->time);
         return true;
     }
+
+    void MailManager::track_mail(uint64_t guid, uint64_t role_id, uint64_t time) {
+        if (mail_expire_ms_ > 0) {
+            expiry_index_.add(MailExpiryIndex::Kind::Personal, guid, role_id, time + mail_expire_ms_);
+        }
+    }
+
+    std::size_t MailManager::sweep_expired_mails(uint64_t now) {
+        auto count = expiry_index_.sweep(now, expire_per_frame_, [this](const MailExpiryIndex::Entry &entry) {
+            if (entry.kind == MailExpiryIndex::Kind::Group) {
+                // 已被手动删除的群邮件跳过
+                if (group_mail_data_.contains(entry.guid) && delete_group_mail(entry.guid)) {
+                    expired_group_ids_.push_back(entry.guid);
+                }
+                return;
+            }
+            if (auto it = off_mail_data_.find(entry.guid); it != off_mail_data_.end()) {
+                it->second.release();
+                off_mail_data_.erase(it);
+            } else if (auto player = PlayerManager::instance().get_player(entry.role_id)) {
+                if (auto mail_module = std::dynamic_pointer_cast<MailModule>(player->get_module_by_type(ModuleType::Mail))) {
+                    mail_module->delete_mail(entry.guid);
+                }
+            }
+            // 玩家未加载时邮件只在数据库中，同样需要删除
+            expired_mail_ids_.push_back(entry.guid);
+        });
+        flush_expired_deletes(now);
+        return count;
+    }
+
+    void MailManager::flush_expired_deletes(uint64_t now) {
+        if (expired_mail_ids_.empty() && expired_group_ids_.empty()) {
+            return;
+        }
+        if (now < delete_retry_time_) {
+            return;
+        }
+        if (!db::MySQLMgr::instance()->has_datasource("db_game")) {
+            // 保留待删除项，数据源注册后再执行；每帧都会走到这里，只提示一次
+            if (!warned_no_db_) {
+                spdlog::error("[MailManager::flush_expired_deletes] db_game not registered, expired mails kept queued");
+                warned_no_db_ = true;
+            }
+            return;
+        }
+
+        auto delete_in = [](std::string_view table, std::string_view column, std::span<const uint64_t> ids) {
+            std::string sql = std::format("DELETE FROM {} WHERE {} IN (", table, column);
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                if (i > 0) {
+                    sql += ',';
+                }
+                sql += std::to_string(ids[i]);
+            }
+            sql += ");";
+            if (db::MySQLUtil::execute("db_game", sql) < 0) {
+                spdlog::error("[MailManager::flush_expired_deletes] delete {} rows from {} failed", ids.size(), table);
+                return false;
+            }
+            return true;
+        };
+
+        // 逐批删除，遇到失败的批次停止；返回已删除的 ID 数
+        auto delete_batches = [this](std::vector<uint64_t> &ids, auto &&delete_batch) {
+            std::size_t done = 0;
+            while (done < ids.size()) {
+                auto batch = std::span<const uint64_t>(ids).subspan(done, std::min(delete_batch_, ids.size() - done));
+                if (!delete_batch(batch)) {
+                    break;
+                }
+                done += batch.size();
+            }
+            ids.erase(ids.begin(), ids.begin() + static_cast<std::ptrdiff_t>(done));
+            return ids.empty();
+        };
+
+        bool ok = delete_batches(expired_mail_ids_, [&](std::span<const uint64_t> batch) {
+            return delete_in("mail", "id", batch);
+        });
+        // 先删离线玩家的群邮件引用，再删群邮件本身
+        ok = delete_batches(expired_group_ids_, [&](std::span<const uint64_t> batch) {
+            return delete_in("mail", "groupid", batch) && delete_in("mail_group", "id", batch);
+        }) && ok;
+
+        if (ok) {
+            delete_retry_ms_ = 0;
+            delete_retry_time_ = 0;
+            return;
+        }
+        delete_retry_ms_ = std::clamp(delete_retry_ms_ * 2, kDeleteRetryMinMs, kDeleteRetryMaxMs);
+        delete_retry_time_ = now + delete_retry_ms_;
+        spdlog::warn("[MailManager::flush_expired_deletes] {} mails and {} group mails kept queued, retry in {}ms",
+                     expired_mail_ids_.size(), expired_group_ids_.size(), delete_retry_ms_);
+    }
 }
\ No newline at end of file
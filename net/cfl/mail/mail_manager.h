@@ -5,12 +5,15 @@
 #include <string_view>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include "cfl/protos/gen_proto/define.pb.h"   // 导入协议定义（通常包含 MailType、StMailItem 等结构）
 #include "cfl/server_define.h"                 // 一些服务器全局定义（如枚举、宏、常量等）
 #include "cfl/shm/obj/mail_data_obj.h"         // 包含邮件对象的共享内存结构定义
 #include "cfl/db/db_mysql.h"                   // MySQL 数据库访问封装
 #include "cfl/playerobj.h"                     // 玩家对象类定义
+#include "group_mail_list.h"                   // 按时间排序的群邮件列表
+#include "mail_expiry_index.h"                 // 按到期时间分桶的过期索引
 
 namespace cfl::shm {
 
@@ -103,6 +106,12 @@ namespace cfl::shm {
 
             // 遍历结果集
             while (res->next()){
+                // 已经从共享内存恢复的群邮件不再重复加载
+                auto guid = res->get_int64("id");
+                if (group_mail_data_.contains(guid)) {
+                    continue;
+                }
+
                 // 创建共享内存对象 GroupMailDataObject
                 auto group_mail = create_object<GroupMailDataObject>(SHMTYPE::GroupMail, false);
 
@@ -111,13 +120,13 @@ namespace cfl::shm {
 
                 // 从结果集中取出频道、GUID、时间戳等字段
                 group_mail->channel = res->get_int32("channel");
-                group_mail->guid = res->get_int64("id");
+                group_mail->guid = guid;
                 group_mail->time = res->get_int64("mail_time");
 
                 // 将字符串字段拷贝到固定长度的缓冲区中
-                group_mail->title = str_copy(res->get_string("title"), MAIL_TITLE_LEN);
-                group_mail->content = str_copy(res->get_string("content"), MAIL_CONTENT_LEN);
-                group_mail->sender = str_copy(res->get_string("sender"), ROLE_NAME_LEN);
+                str_copy(group_mail->title, res->get_string("title"));
+                str_copy(group_mail->content, res->get_string("content"));
+                str_copy(group_mail->sender, res->get_string("sender"));
 
                 // 读取二进制附件数据（itemdata 字段存储的是 StMailItem 数组）
                 std::vector<std::byte> blob = res->get_blob("itemdata");
@@ -126,15 +135,16 @@ namespace cfl::shm {
                 auto count = std::min(blob.size() / sizeof(StMailItem), group_mail->items.size());
                 std::memcpy(group_mail->items.data(), blob.data(), count * sizeof(StMailItem));
 
-                // 将该群邮件对象放入管理容器，以 guid 为 key
-                group_mail_data_.emplace(group_mail->guid, group_mail);
+                // 将该群邮件对象放入管理容器（按发送时间排序，乱序加入时在下次查询前统一排序）
+                add_group_mail(group_mail);
             }
             return true;
         }
 
         //==========================================================
         // @brief 玩家登录时处理邮件逻辑
-        //        例如加载未读邮件、群发邮件合并、清理过期邮件等
+        //        从角色的群邮件水位（groupMailTime）二分定位，只下发之后发送的群邮件；
+        //        从未领取过群邮件的角色（水位为 0）以上次登录时间为起点
         // @param player 玩家对象指针
         // @return 是否处理成功
         //==========================================================
@@ -143,23 +153,95 @@ namespace cfl::shm {
         //==========================================================
         // @brief 拾取单封邮件数据（通常在客户端请求领取附件时调用）
         // @param guid 邮件唯一ID
-        // @return 返回该邮件的共享指针对象
+        // @return 返回该邮件的句柄，不存在时返回空句柄
+        //==========================================================
+        MailRef pick_up_mail_data(uint64_t guid);
+
+        //==========================================================
+        // @brief 加入群邮件并登记过期时间
+        // @return 邮件为空或 GUID 已存在时返回 false
+        //==========================================================
+        bool add_group_mail(GroupMailList::MailPtr mail);
+
+        //==========================================================
+        // @brief 加入离线邮件并登记过期时间
+        //==========================================================
+        bool add_off_mail(MailRef mail);
+
+        //==========================================================
+        // @brief 登记个人邮件的过期时间（按发送时间 + mail_expire_days）
+        //        邮件挂到玩家 MailModule 时调用，过期关闭时不登记
+        //==========================================================
+        void track_mail(uint64_t guid, uint64_t role_id, uint64_t time);
+
+        //==========================================================
+        // @brief 登记/注销持有群邮件（引用或旧数据中的拷贝）的已加载玩家
+        //        删除群邮件时只处理登记的玩家，不遍历所有玩家
+        //==========================================================
+        void add_group_mail_holder(uint64_t group_guid, uint64_t role_id);
+
+        void remove_group_mail_holder(uint64_t group_guid, uint64_t role_id);
+
+        //==========================================================
+        // @brief 清理到期邮件，每帧调用一次
+        //        最多处理 mail_expire_per_frame 封：回收共享内存对象，
+        //        已加载的玩家同步删除给客户端，数据库删除按 mail_delete_batch 个 ID 分批执行
+        // @param now 当前时间（毫秒）
+        // @return 本次处理的过期项数
+        //==========================================================
+        std::size_t sweep_expired_mails(uint64_t now);
+
         //==========================================================
-        std::shared_ptr<MailDataObject> pick_up_mail_data(uint64_t guid);
+        // @brief 过期索引（只读，用于统计）
+        //==========================================================
+        [[nodiscard]] const MailExpiryIndex &expiry_index() const noexcept { return expiry_index_; }
 
         //==========================================================
         // @brief 离线邮件缓存（key: 角色ID，value: 邮件对象）
         //        玩家不在线时发送的邮件会暂存在这里
         //==========================================================
-        std::unordered_map<uint64_t, std::shared_ptr<MailDataObject>> off_mail_data_;
+        std::unordered_map<uint64_t, MailRef> off_mail_data_;
 
         //==========================================================
-        // @brief 群邮件缓存（key: 邮件GUID，value: 群邮件对象）
+        // @brief 群邮件缓存（按发送时间排序，可按 GUID 查找）
         //        所有群发邮件加载到此容器中，供在线玩家登录时下发
         //==========================================================
-        std::unordered_map<uint64_t, std::shared_ptr<GroupMailDataObject>> group_mail_data_;
+        GroupMailList group_mail_data_;
 
     private:
+        // 分批执行攒下的数据库删除，失败的批次及之后的 ID 保留，退避后重试
+        void flush_expired_deletes(uint64_t now);
+
+        // 按到期时间分桶的个人邮件和群邮件
+        MailExpiryIndex expiry_index_;
+
+        // 邮件有效期（毫秒），为 0 时不过期
+        uint64_t mail_expire_ms_ = uint64_t{30} * 24 * 3600 * 1000;
+
+        // 每帧最多处理的过期项数
+        std::size_t expire_per_frame_ = 256;
+
+        // 群邮件 GUID -> 持有该群邮件的已加载玩家
+        std::unordered_map<uint64_t, std::unordered_set<uint64_t>> group_mail_holders_;
+
+        // 待删除的个人邮件和群邮件 GUID
+        std::vector<uint64_t> expired_mail_ids_;
+        std::vector<uint64_t> expired_group_ids_;
+
+        // 每条 DELETE 语句最多带的 ID 数
+        std::size_t delete_batch_ = 500;
+
+        // 删除失败后的退避时间（毫秒），每次连续失败翻倍，成功后清零
+        static constexpr uint64_t kDeleteRetryMinMs = 1000;
+        static constexpr uint64_t kDeleteRetryMaxMs = 60 * 1000;
+        uint64_t delete_retry_ms_ = 0;
+
+        // 退避期间不执行删除，到这个时间（毫秒）后再重试
+        uint64_t delete_retry_time_ = 0;
+
+        // 已提示过 db_game 未注册
+        bool warned_no_db_ = false;
+
         // 构造函数私有化，保证单例模式
         MailManager() = default;
 
@@ -4,14 +4,104 @@
 #include "cfl/global_data_manager.h"
 #include "role_module.h"
 #include "cfl/protos/gen_proto/msg.pb.h"
+#include "module_store.h"
 
 namespace cfl {
+    namespace {
+        /// 逐帧同步需要的邮件模块状态：每帧只扫描 pending，有变更时才访问模块
+        struct MailTickState {
+            bool pending = false;
+            MailModule *module = nullptr;
+        };
+
+        /// 在线玩家的邮件模块
+        ModuleStore<MailTickState> g_online_mails;
+    }
+
+    bool MailModule::on_destroy() {
+        on_logout();
+        auto &manager = MailManager::instance();
+        for (auto &mail: mail_data_map_) {
+            if (auto obj = mail.second.get(); obj && obj->group_guid != 0) {
+                manager.remove_group_mail_holder(obj->group_guid, obj->role_id);
+            }
+            mail.second.release();
+        }
+        mail_data_map_.clear();
+        for (auto &state: group_mail_states_) {
+            if (auto obj = state.second.get()) {
+                manager.remove_group_mail_holder(obj->group_guid, obj->role_id);
+            }
+            state.second.release();
+        }
+        group_mail_states_.clear();
+        return true;
+    }
+
+    bool MailModule::on_login() {
+        g_online_mails.add(store_slot_, {has_pending_change(), this});
+        return true;
+    }
+
+    bool MailModule::on_logout() {
+        g_online_mails.remove(store_slot_);
+        return true;
+    }
+
+    void MailModule::tick_all(uint64_t now) {
+        MailManager::instance().sweep_expired_mails(now);
+        for (auto &state: g_online_mails.states()) {
+            if (state.pending) {
+                state.module->notify_change();
+            }
+        }
+    }
+
+    void MailModule::mark_change(uint64_t guid) {
+        add_change_id(guid);
+        if (store_slot_ != ModuleStore<MailTickState>::kNoSlot) {
+            g_online_mails.at(store_slot_).pending = true;
+        }
+    }
+
+    void MailModule::mark_remove(uint64_t guid) {
+        add_remove_id(guid);
+        if (store_slot_ != ModuleStore<MailTickState>::kNoSlot) {
+            g_online_mails.at(store_slot_).pending = true;
+        }
+    }
+
     bool MailModule::read_from_db_login_data(const DBRoleLoginAck &ack) {
         auto &mail_data = ack.mails();
         for (auto &mail: mail_data.items()) {
-            auto obj = MailManager::instance().pick_up_mail_data(mail.guid());
-            if (!obj) {
-                obj = create_object<MailDataObject>(SHMTYPE::Mail, true);
+            // 群发邮件引用只有个人列，内容从群邮件解析；旧数据中带内容的群邮件拷贝仍按个人邮件加载
+            if (mail.group_id() != 0 && mail.title().empty() && mail.content().empty()) {
+                // 群邮件已被删除时丢弃引用
+                if (group_mail_states_.contains(mail.group_id()) ||
+                    !MailManager::instance().group_mail_data_.contains(mail.group_id())) {
+                    continue;
+                }
+                auto ref = make_shm_ref<GroupMailStateObject>(SHMTYPE::GroupMailState, true);
+                auto obj = ref.get();
+                if (obj == nullptr) {
+                    return false;
+                }
+                obj->role_id = mail.role_id();
+                obj->guid = mail.guid();
+                obj->group_guid = mail.group_id();
+                obj->time = mail.time();
+                obj->mail_type = mail.mail_type();
+                obj->status = mail.status();
+                add_group_mail_state(ref);
+                continue;
+            }
+            auto ref = MailManager::instance().pick_up_mail_data(mail.guid());
+            if (!ref) {
+                ref = make_shm_ref<MailDataObject>(SHMTYPE::Mail, true);
+                auto obj = ref.get();
+                if (obj == nullptr) {
+                    return false;
+                }
                 obj->role_id = mail.role_id();
                 obj->guid = mail.guid();
                 obj->group_guid = mail.group_id();
@@ -19,67 +109,115 @@ namespace cfl {
                 obj->sender_id = mail.sender_id();
                 obj->mail_type = mail.mail_type();
                 obj->status = mail.status();
-                obj->sender = str_copy(mail.sender(), ROLE_NAME_LEN);
-                obj->title = str_copy(mail.title(), MAIL_TITLE_LEN);
-                obj->content = str_copy(mail.content(), MAIL_CONTENT_LEN);
+                str_copy(obj->sender, mail.sender());
+                str_copy(obj->title, mail.title());
+                str_copy(obj->content, mail.content());
                 std::string blob = mail.items();
                 memcpy(obj->items.data(), blob.data(),
                        std::min(blob.size(), sizeof(obj->items)));
-                mail_data_map_[obj->guid] = obj;
-            } else {
-                mail_data_map_[obj->guid] = obj;
+                // 从离线邮件取回的在发送时已经登记过
+                MailManager::instance().track_mail(obj->guid, obj->role_id, obj->time);
             }
+            if (auto obj = ref.get(); obj && obj->group_guid != 0) {
+                MailManager::instance().add_group_mail_holder(obj->group_guid, obj->role_id);
+            }
+            mail_data_map_[mail.guid()] = ref;
         }
 
         return true;
     }
 
-    bool MailModule::add_mail(std::shared_ptr<MailDataObject> mail) {
-        mail_data_map_.emplace(mail->guid, mail);
+    bool MailModule::add_mail(MailRef mail) {
+        auto obj = mail.get();
+        if (obj == nullptr) {
+            return false;
+        }
+        if (mail_data_map_.emplace(obj->guid, mail).second) {
+            MailManager::instance().track_mail(obj->guid, obj->role_id, obj->time);
+            if (obj->group_guid != 0) {
+                MailManager::instance().add_group_mail_holder(obj->group_guid, obj->role_id);
+            }
+        }
+        return true;
+    }
+
+    bool MailModule::add_group_mail_state(GroupMailStateRef state) {
+        auto obj = state.get();
+        if (obj == nullptr) {
+            return false;
+        }
+        if (group_mail_states_.emplace(obj->group_guid, state).second) {
+            MailManager::instance().add_group_mail_holder(obj->group_guid, obj->role_id);
+        }
         return true;
     }
 
     bool MailModule::delete_mail(uint64_t guid) {
         auto it = mail_data_map_.find(guid);
         if (it == mail_data_map_.end()) {
-            return false;
+            // 群发邮件以群邮件 guid 出现在客户端
+            auto state = group_mail_states_.find(guid);
+            if (state == group_mail_states_.end()) {
+                return false;
+            }
+            if (auto obj = state->second.get()) {
+                MailManager::instance().remove_group_mail_holder(obj->group_guid, obj->role_id);
+            }
+            state->second.release();
+            group_mail_states_.erase(state);
+            mark_remove(guid);
+            return true;
         }
 
-        auto obj = it->second;
-        obj->destroy();
+        it->second.release();
         mail_data_map_.erase(it);
 
-        add_remove_id(guid);
+        mark_remove(guid);
         return true;
     }
 
     bool MailModule::delete_mail_by_group_id(uint64_t group_id) {
         for (auto it = mail_data_map_.begin(); it != mail_data_map_.end();) {
-            auto obj = it->second;
-            if (obj->group_guid == group_id) {
-                obj->destroy();
+            auto obj = it->second.get();
+            if (obj == nullptr || obj->group_guid == group_id) {
+                auto guid = it->first;
+                it->second.release();
                 it = mail_data_map_.erase(it);
-                add_remove_id(obj->guid);
+                mark_remove(guid);
             } else {
                 ++it;
             }
         }
+        if (auto it = group_mail_states_.find(group_id); it != group_mail_states_.end()) {
+            it->second.release();
+            group_mail_states_.erase(it);
+            mark_remove(group_id);
+        }
+        MailManager::instance().remove_group_mail_holder(group_id, owner_player->role_id());
         return true;
     }
 
-    bool MailModule::add_mail(MailType mail_type, const std::string &sender, const std::string &title,
-                              const std::string &content, const std::vector<StMailItem> &items) {
-        auto obj = create_object<MailDataObject>(SHMTYPE::Mail, true);
+    MailRef MailModule::add_mail(MailType mail_type, const std::string &sender, const std::string &title,
+                                 const std::string &content, const std::vector<StMailItem> &items) {
+        auto ref = make_shm_ref<MailDataObject>(SHMTYPE::Mail, true);
+        auto obj = ref.get();
+        if (obj == nullptr) {
+            return {};
+        }
         obj->lock();
         obj->guid = GlobalDataManager::instance().make_new_guid();
         auto pl = owner_player;
         obj->role_id = pl->role_id();
-        obj->sender = str_copy(sender, ROLE_NAME_LEN);
-        obj->title = str_copy(title, MAIL_TITLE_LEN);
-        obj->content = str_copy(content, MAIL_CONTENT_LEN);
+        obj->group_guid = 0;
+        obj->sender_id = 0;
+        str_copy(obj->sender, sender);
+        str_copy(obj->title, title);
+        str_copy(obj->content, content);
         obj->mail_type = mail_type;
+        obj->status = mail_new;
         obj->time = get_timestamp();
-        for(int i = 0; i < items.size(); ++i){
+        obj->items.fill(StMailItem{});
+        for(int i = 0; i < items.size() && i < obj->items.size(); ++i){
             if(items[i].item_id == 0){
                 break;
             }
@@ -87,19 +225,26 @@ namespace cfl {
         }
 
         obj->unlock();
-        return add_mail(obj);
+        return add_mail(ref) ? ref : MailRef{};
     }
 
-    std::shared_ptr<MailDataObject> MailModule::get_mail_by_guid(uint64_t guid) {
+    MailDataObject *MailModule::get_mail_by_guid(uint64_t guid) {
         auto it = mail_data_map_.find(guid);
         if (it == mail_data_map_.end()) {
             return nullptr;
         }
-        return it->second;
+        return it->second.get();
     }
 
-    bool MailModule::receive_group_mail(std::shared_ptr<GroupMailDataObject> group_mail) {
-        auto obj = create_object<MailDataObject>(SHMTYPE::Mail, true);
+    bool MailModule::receive_group_mail(std::shared_ptr<GroupMailDataObject> group_mail, bool sync) {
+        if (group_mail_states_.contains(group_mail->guid)) {
+            return true;
+        }
+        auto ref = make_shm_ref<GroupMailStateObject>(SHMTYPE::GroupMailState, true);
+        auto obj = ref.get();
+        if (obj == nullptr) {
+            return false;
+        }
         obj->lock();
         obj->guid = GlobalDataManager::instance().make_new_guid();
         auto pl = owner_player;
@@ -107,33 +252,68 @@ namespace cfl {
         obj->time = get_timestamp();
         obj->group_guid = group_mail->guid;
         obj->mail_type = group_mail->mail_type;
-        obj->title = str_copy(group_mail->title, MAIL_TITLE_LEN);
-        obj->content = str_copy(group_mail->content, MAIL_CONTENT_LEN);
-        obj->sender = str_copy(group_mail->sender, ROLE_NAME_LEN);
-        for(int i = 0; i < group_mail->items.size(); ++i){
-            if(group_mail->items[i].item_id == 0){
-                break;
-            }
-            obj->items[i] = group_mail->items[i];
-        }
+        obj->status = mail_new;
         obj->unlock();
 
-        add_mail(obj);
+        add_group_mail_state(ref);
+        if (sync) {
+            mark_change(group_mail->guid);
+        }
         auto role_module = std::dynamic_pointer_cast<RoleModule>(pl->get_module_by_type(ModuleType::Role));
         role_module->set_group_mail_time(group_mail->time);
 
-        spdlog::info("receive group mail:{}", group_mail->guid);
+        // 广播时每个在线玩家都会走到这里，汇总日志由 MailManager::send_group_mail 输出
+        spdlog::debug("[MailModule::receive_group_mail] role {} received group mail {}", pl->role_id(), group_mail->guid);
         return true;
     }
 
+    GroupMailStateObject *MailModule::get_group_mail_state(uint64_t group_guid) {
+        auto it = group_mail_states_.find(group_guid);
+        if (it == group_mail_states_.end()) {
+            return nullptr;
+        }
+        return it->second.get();
+    }
+
+    void MailModule::fill_group_mail_item(MailItem *item, const GroupMailDataObject &group_mail, int32_t status) {
+        item->set_guid(group_mail.guid);
+        item->set_mail_type(group_mail.mail_type);
+        item->set_status(status);
+        item->set_title(group_mail.title);
+        item->set_content(group_mail.content);
+        item->set_sender(group_mail.sender);
+        for (auto &mail_item: group_mail.items) {
+            if (mail_item.item_id == 0) {
+                break;
+            }
+            item->add_item_id(mail_item.item_id);
+            item->add_item_num(mail_item.item_count);
+        }
+    }
+
     bool MailModule::notify_change() {
+        if (store_slot_ != ModuleStore<MailTickState>::kNoSlot) {
+            g_online_mails.at(store_slot_).pending = false;
+        }
         if(change_set.empty() && remove_set.empty()){
             return true;
         }
         MailChangeNty nty;
         for(auto &guid: change_set){
-            auto item = nty.add_change_list();
+            if (auto state = get_group_mail_state(guid); state != nullptr) {
+                // 群邮件已被删除时引用随之失效
+                if (auto group_mail = MailManager::instance().group_mail_data_.find(guid)) {
+                    fill_group_mail_item(nty.add_change_list(), *group_mail, state->status);
+                } else {
+                    nty.add_remove_list(guid);
+                }
+                continue;
+            }
             auto obj = get_mail_by_guid(guid);
+            if (obj == nullptr) {
+                continue;
+            }
+            auto item = nty.add_change_list();
             item->set_guid(obj->guid);
             item->set_mail_type(obj->mail_type);
             item->set_status(obj->status);
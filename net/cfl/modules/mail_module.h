@@ -1,5 +1,6 @@
 #pragma once
 
+#include <limits>
 #include <unordered_map>
 #include <memory>
 #include <string>
@@ -24,21 +25,11 @@ namespace cfl {
     public:
         bool on_create(uint64_t role_id) override { return true; }
 
-        bool on_destroy() override {
-            for (auto &mail: mail_data_map_) {
-                mail.second->release();
-            }
-            mail_data_map_.clear();
-            return true;
-        }
+        bool on_destroy() override;
 
-        bool on_login() override {
-            return true;
-        }
+        bool on_login() override;
 
-        bool on_logout() override{
-            return true;
-        }
+        bool on_logout() override;
 
         bool on_new_day() override{
             return true;
@@ -60,26 +51,70 @@ namespace cfl {
         void register_message_handler(){}
 
     public:
-        bool add_mail(std::shared_ptr<MailDataObject> mail);
+        bool add_mail(MailRef mail);
 
         bool delete_mail(uint64_t guid);
 
         bool delete_mail_by_group_id(uint64_t group_id);
 
-        bool add_mail(
+        /**
+         * @brief 创建一封个人邮件并加入模块
+         * @return 新邮件的引用，共享内存不足时为空
+         */
+        MailRef add_mail(
                 MailType mail_type,
                 const std::string &sender,
                 const std::string &title,
                 const std::string &content,
                 const std::vector<StMailItem> &items);
 
-        std::shared_ptr<MailDataObject> get_mail_by_guid(uint64_t guid);
-
-        bool receive_group_mail(std::shared_ptr<GroupMailDataObject> group_mail);
+        /**
+         * @brief 根据 guid 获取邮件对象
+         * @return 邮件不存在或已被回收时返回 nullptr，指针只在当前调用栈内有效
+         */
+        MailDataObject *get_mail_by_guid(uint64_t guid);
+
+        /**
+         * @brief 收取群发邮件，只创建引用群邮件的个人状态记录
+         * @param sync 为 false 时不加入变更集合，由调用方统一广播给在线玩家
+         */
+        bool receive_group_mail(std::shared_ptr<GroupMailDataObject> group_mail, bool sync = true);
+
+        /**
+         * @brief 加入已有的群发邮件引用（从数据库或共享内存恢复）
+         */
+        bool add_group_mail_state(GroupMailStateRef state);
+
+        /**
+         * @brief 根据群邮件 guid 获取玩家的引用记录
+         * @return 不存在或已被回收时返回 nullptr，指针只在当前调用栈内有效
+         */
+        GroupMailStateObject *get_group_mail_state(uint64_t group_guid);
+
+        /**
+         * @brief 用群邮件内容填充同步给客户端的邮件项，邮件ID为群邮件 guid
+         */
+        static void fill_group_mail_item(MailItem *item, const GroupMailDataObject &group_mail, int32_t status);
 
         bool notify_change() override;
 
+        /**
+         * @brief 每帧处理（注册到 ModuleRegistry）：清理过期邮件，把在线玩家的邮件变更同步给客户端
+         * @param now 当前时间（毫秒）
+         */
+        static void tick_all(uint64_t now);
+
     private:
-        std::unordered_map<uint64_t, std::shared_ptr<MailDataObject>> mail_data_map_;
+        // 记录变更ID，在线时同时置位批量状态中的待同步标记
+        void mark_change(uint64_t guid);
+
+        void mark_remove(uint64_t guid);
+
+        // 在线期间在批量状态数组中的下标
+        uint32_t store_slot_ = std::numeric_limits<uint32_t>::max();
+
+        std::unordered_map<uint64_t, MailRef> mail_data_map_;
+        // 群发邮件引用，key 为群邮件 guid
+        std::unordered_map<uint64_t, GroupMailStateRef> group_mail_states_;
     };
 }
\ No newline at end of file
@@ -134,6 +134,11 @@ namespace cfl {
          */
         PlayerObjPtr get_owner();
 
+        /**
+         * @brief 是否有尚未同步给客户端的变更
+         */
+        [[nodiscard]] bool has_pending_change() const noexcept { return !change_set.empty() || !remove_set.empty(); }
+
     protected:
         PlayerObjPtr owner_player;   ///< 所属玩家对象指针
         std::set<std::uint64_t> change_set;     ///< 需要同步/保存的数据ID集合
@@ -0,0 +1,76 @@
+#include "module_registry.h"
+#include "role_module.h"
+#include "mail_module.h"
+#include "cfl/db/db_async.h"
+
+namespace cfl {
+
+    ModuleRegistry &ModuleRegistry::instance() {
+        static ModuleRegistry instance;
+        return instance;
+    }
+
+    ModuleRegistry::ModuleRegistry() {
+        register_module(ModuleType::Role, {
+                [](ModuleBase::PlayerObjPtr owner) { return std::make_shared<RoleModule>(owner); },
+                {},
+                RoleModule::new_day_all
+        });
+        register_module(ModuleType::Mail, {
+                [](ModuleBase::PlayerObjPtr owner) { return std::make_shared<MailModule>(owner); },
+                MailModule::tick_all,
+                {}
+        });
+    }
+
+    bool ModuleRegistry::register_module(ModuleType type, Hooks hooks) {
+        auto index = static_cast<std::size_t>(type);
+        if (index >= hooks_.size() || !hooks.create) {
+            return false;
+        }
+        hooks_[index] = std::move(hooks);
+        rebuild();
+        return true;
+    }
+
+    std::shared_ptr<ModuleBase> ModuleRegistry::create(ModuleType type, ModuleBase::PlayerObjPtr owner) const {
+        if (!registered(type)) {
+            return nullptr;
+        }
+        return hooks_[static_cast<std::size_t>(type)].create(owner);
+    }
+
+    void ModuleRegistry::tick_all(std::uint64_t now) const {
+        // 先执行异步写库的完成回调（如角色下线存盘失败时还原脏位）
+        db::AsyncDbMgr::instance()->poll();
+        for (auto &hook: tick_hooks_) {
+            hook(now);
+        }
+    }
+
+    void ModuleRegistry::new_day_all(std::uint64_t now) const {
+        for (auto &hook: new_day_hooks_) {
+            hook(now);
+        }
+    }
+
+    void ModuleRegistry::rebuild() {
+        types_.clear();
+        tick_hooks_.clear();
+        new_day_hooks_.clear();
+        for (std::size_t i = 0; i < hooks_.size(); ++i) {
+            auto &hooks = hooks_[i];
+            if (!hooks.create) {
+                continue;
+            }
+            types_.push_back(static_cast<ModuleType>(i));
+            if (hooks.tick_all) {
+                tick_hooks_.push_back(hooks.tick_all);
+            }
+            if (hooks.new_day_all) {
+                new_day_hooks_.push_back(hooks.new_day_all);
+            }
+        }
+    }
+
+} // namespace cfl
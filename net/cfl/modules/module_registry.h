@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+#include "module_base.h"
+
+namespace cfl {
+
+    /**
+     * @class ModuleRegistry
+     * @brief 模块注册表：每类模块的创建函数和跨玩家的批量钩子
+     *
+     * - PlayerObject 只创建、遍历已注册的模块类型，未实现的类型不占用任何调用；
+     * - 批量钩子由模块自己实现，一次循环处理所有在线玩家该模块的状态（见 ModuleStore）；
+     * - tick_all / new_day_all 只保存非空的钩子，逐帧调用时没有空检查。
+     *
+     * @note 使用单例模式访问：`ModuleRegistry::instance()`，仅在逻辑线程中使用。
+     */
+    class ModuleRegistry {
+    public:
+        using Factory = std::function<std::shared_ptr<ModuleBase>(ModuleBase::PlayerObjPtr owner)>;
+        using TickHook = std::function<void(std::uint64_t now)>;
+
+        struct Hooks {
+            Factory create;             ///< 为玩家创建模块，必须提供
+            TickHook tick_all;          ///< 每帧处理所有在线玩家（可为空）
+            TickHook new_day_all;       ///< 跨天时处理所有在线玩家（可为空）
+        };
+
+        /**
+         * @brief 获取全局实例，首次调用时注册内置模块
+         */
+        [[nodiscard]] static ModuleRegistry &instance();
+
+        ModuleRegistry(const ModuleRegistry &) = delete;
+        ModuleRegistry &operator=(const ModuleRegistry &) = delete;
+
+        /**
+         * @brief 注册或替换某类模块
+         * @return 类型越界或未提供创建函数时返回 false
+         */
+        bool register_module(ModuleType type, Hooks hooks);
+
+        [[nodiscard]] bool registered(ModuleType type) const noexcept {
+            return static_cast<std::size_t>(type) < hooks_.size() && hooks_[static_cast<std::size_t>(type)].create;
+        }
+
+        /**
+         * @brief 已注册的模块类型，按 ModuleType 顺序
+         */
+        [[nodiscard]] std::span<const ModuleType> types() const noexcept { return types_; }
+
+        /**
+         * @brief 为玩家创建某类模块
+         * @return 未注册时返回 nullptr
+         */
+        [[nodiscard]] std::shared_ptr<ModuleBase> create(ModuleType type, ModuleBase::PlayerObjPtr owner) const;
+
+        /**
+         * @brief 每帧调用，先执行 AsyncDb 的完成回调，再依次执行各模块的 tick_all
+         * @param now 当前时间（毫秒）
+         */
+        void tick_all(std::uint64_t now) const;
+
+        /**
+         * @brief 跨天时调用，依次执行各模块的 new_day_all
+         * @param now 当前时间（毫秒）
+         */
+        void new_day_all(std::uint64_t now) const;
+
+    private:
+        ModuleRegistry();
+        ~ModuleRegistry() = default;
+
+        // 根据 hooks_ 重建 types_ 和钩子列表
+        void rebuild();
+
+        std::array<Hooks, static_cast<std::size_t>(ModuleType::End)> hooks_{};
+        std::vector<ModuleType> types_;
+        std::vector<TickHook> tick_hooks_;
+        std::vector<TickHook> new_day_hooks_;
+    };
+
+} // namespace cfl
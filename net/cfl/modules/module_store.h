@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace cfl {
+
+    /**
+     * @class ModuleStore
+     * @brief 某类模块所有在线玩家的逐帧状态，连续存放
+     *
+     * 批量钩子（tick_all / new_day_all）直接遍历状态数组，不经过 PlayerObject 和虚函数。
+     * - 模块在上线时 add，下线或销毁时 remove，模块自己保存所在的下标（slot）；
+     * - remove 时把最后一项移到空位，并通过保存的 slot 地址更新被移动模块的下标。
+     *
+     * @tparam State 每个玩家的状态，应只包含批量处理需要的热数据
+     * @note 非线程安全，只能在逻辑线程中使用
+     */
+    template<class State>
+    class ModuleStore {
+    public:
+        static constexpr std::uint32_t kNoSlot = std::numeric_limits<std::uint32_t>::max();
+
+        /**
+         * @brief 加入一个玩家的状态
+         * @param slot 模块中保存下标的成员，须为 kNoSlot；模块存活期间地址不能变化
+         */
+        void add(std::uint32_t &slot, State state) {
+            if (slot != kNoSlot) {
+                return;
+            }
+            slot = static_cast<std::uint32_t>(states_.size());
+            states_.push_back(std::move(state));
+            slots_.push_back(&slot);
+        }
+
+        /**
+         * @brief 移除玩家的状态，slot 被重置为 kNoSlot
+         */
+        void remove(std::uint32_t &slot) {
+            if (slot == kNoSlot || slot >= states_.size()) {
+                return;
+            }
+            auto last = states_.size() - 1;
+            if (slot != last) {
+                states_[slot] = std::move(states_[last]);
+                slots_[slot] = slots_[last];
+                *slots_[slot] = slot;
+            }
+            states_.pop_back();
+            slots_.pop_back();
+            slot = kNoSlot;
+        }
+
+        [[nodiscard]] State &at(std::uint32_t slot) noexcept { return states_[slot]; }
+
+        [[nodiscard]] std::span<State> states() noexcept { return states_; }
+
+        [[nodiscard]] std::size_t size() const noexcept { return states_.size(); }
+
+        [[nodiscard]] bool empty() const noexcept { return states_.empty(); }
+
+    private:
+        std::vector<State> states_;
+        std::vector<std::uint32_t *> slots_;   ///< 与 states_ 对应的模块下标成员
+    };
+
+} // namespace cfl
@@ -2,7 +2,19 @@
 #include "cfl/shm/shmpool.h"
 #include "cfl/static_data.h"
 #include "cfl/simple_manager.h"
+#include "module_store.h"
 namespace cfl{
+    namespace {
+        /// 跨天批量处理需要的角色状态
+        /// 在线期间下线时间以这里为准，跨天只改写数组；下线或销毁时写回共享内存对象
+        struct RoleDayState {
+            std::uint64_t logoff_time = 0;
+        };
+
+        /// 在线角色
+        ModuleStore<RoleDayState> g_online_roles;
+    }
+
     RoleModule::RoleModule(PlayerObjPtr owner)
         : ModuleBase(owner)
     {
@@ -28,6 +40,7 @@ namespace cfl{
         role_data_object_->createTime = get_timestamp();
         role_data_object_->logonTime = role_data_object_->createTime;
         role_data_object_->logoffTime = role_data_object_->logonTime + 1;
+        role_data_object_->mark_dirty_mask(shm::RoleDataObject::all_fields_mask());
 
         role_data_object_->unlock();
         actor_id_ = carrer_info->actor_id;
@@ -35,6 +48,12 @@ namespace cfl{
     }
 
     bool RoleModule::on_destroy() {
+        if (store_slot_ != ModuleStore<RoleDayState>::kNoSlot && role_data_object_) {
+            role_data_object_->lock();
+            role_data_object_->set<shm::RoleField::LogoffTime>(g_online_roles.at(store_slot_).logoff_time);
+            role_data_object_->unlock();
+        }
+        g_online_roles.remove(store_slot_);
         role_data_object_->release();
         role_data_object_.reset();
         return true;
@@ -50,31 +69,43 @@ namespace cfl{
         if(role_data_object_->logoffTime < role_data_object_->logonTime){
             // 处理异常数据
             role_data_object_->logoffTime = role_data_object_->logonTime + 1;
+            role_data_object_->mark_dirty(shm::RoleField::LogoffTime);
             SimpleManager::instance().set_logoff_time(get_role_id(), role_data_object_->logoffTime);
         }
 
         role_data_object_->logonTime = cfl::get_timestamp();
+        role_data_object_->mark_dirty(shm::RoleField::LogonTime);
         role_data_object_->unlock();
         SimpleManager::instance().set_logon_time(get_role_id(), role_data_object_->logonTime);
+        g_online_roles.add(store_slot_, {role_data_object_->logoffTime});
         return true;
     }
 
     bool RoleModule::on_logout() {
+        g_online_roles.remove(store_slot_);
         if(!role_data_object_){
             return false;
         }
         role_data_object_->lock();
         role_data_object_->logoffTime = cfl::get_timestamp();
         role_data_object_->onlineTime += role_data_object_->logoffTime - role_data_object_->logonTime;
+        role_data_object_->mark_dirty(shm::RoleField::LogoffTime);
         role_data_object_->unlock();
+        // 下线时把脏字段交给异步工作线程写库，不阻塞逻辑帧；失败时脏位在回调中还原
+        if (db::MySQLMgr::instance()->has_datasource("gameserver") && !role_data_object_->UpdateAsync()) {
+            spdlog::error("[RoleModule] role {} save on logout not submitted", get_role_id());
+        }
         return true;
     }
 
     bool RoleModule::on_new_day() {
-        role_data_object_->lock();
-        role_data_object_->logoffTime = cfl::get_timestamp() + 1;
-        role_data_object_->unlock();
-        return true;
+        return set_last_logoff_time(cfl::get_timestamp() + 1);
+    }
+
+    void RoleModule::new_day_all(std::uint64_t now) {
+        for (auto &state: g_online_roles.states()) {
+            state.logoff_time = now + 1;
+        }
     }
 
     bool RoleModule::init_base_data(std::uint64_t role_id, std::string_view name, std::uint32_t career_id,
@@ -88,6 +119,7 @@ namespace cfl{
         // 复制name
         strcpy_s(role_data_object_->name, name.data());
         role_data_object_->langId = 0;
+        role_data_object_->mark_dirty_mask(shm::RoleDataObject::all_fields_mask());
         role_data_object_->unlock();
         auto pInfo = StaticData::instance().get_carrer_info(career_id);
         if(!pInfo){
@@ -141,6 +173,20 @@ namespace cfl{
         return true;
     }
 
+    bool RoleModule::restore_from_shared_memory(std::shared_ptr<shm::RoleDataObject> obj) {
+        if (!obj) {
+            return false;
+        }
+        role_data_object_ = std::move(obj);
+        auto pInfo = StaticData::instance().get_carrer_info(role_data_object_->carrerId);
+        if(!pInfo){
+            spdlog::error("[RoleModule::restore_from_shared_memory] no career info");
+            return false;
+        }
+        actor_id_ = pInfo->actor_id;
+        return true;
+    }
+
     bool RoleModule::save_to_client_login_data(RoleLoginAck &ack) {
         ack.set_account_id(role_data_object_->accountId);
         ack.set_role_id(role_data_object_->roleId);
@@ -213,6 +259,8 @@ namespace cfl{
         else{
             role_data_object_->actime[action_id - 1] = 0;
         }
+        role_data_object_->mark_dirty(shm::RoleDataObject::action_field(action_id - 1));
+        role_data_object_->mark_dirty(shm::RoleDataObject::actime_field(action_id - 1));
         role_data_object_->unlock();
         return true;
     }
@@ -233,7 +281,9 @@ namespace cfl{
             return false;
         }
 
+        role_data_object_->lock();
         update_action(action_id);
+        role_data_object_->unlock();
         return role_data_object_->action[action_id - 1] >= static_cast<std::uint64_t>(action_num);
     }
 
@@ -247,7 +297,9 @@ namespace cfl{
             return 0;
         }
 
+        role_data_object_->lock();
         update_action(action_id);
+        role_data_object_->unlock();
         return role_data_object_->action[action_id - 1];
     }
 
@@ -289,6 +341,8 @@ namespace cfl{
             role_data_object_->actime[action_id - 1] = 0;
         }
 
+        role_data_object_->mark_dirty(shm::RoleDataObject::action_field(action_id - 1));
+        role_data_object_->mark_dirty(shm::RoleDataObject::actime_field(action_id - 1));
         std::uint64_t ret = role_data_object_->action[action_id - 1];
         role_data_object_->unlock();
         return ret;
@@ -308,8 +362,9 @@ namespace cfl{
         if (role_data_object_->action[action_id - 1] >= maxv) {
             if (role_data_object_->actime[action_id - 1] != 0) {
                 spdlog::warn("update_action: action is max but actime is not 0 (action_id={})", action_id);
+                role_data_object_->actime[action_id - 1] = 0;
+                role_data_object_->mark_dirty(shm::RoleDataObject::actime_field(action_id - 1));
             }
-            role_data_object_->actime[action_id - 1] = 0;
             return false;
         }
 
@@ -342,6 +397,8 @@ namespace cfl{
 //             更新起始时间到上次补满的后续时间点（避免重复计入）
             role_data_object_->actime[action_id - 1] = role_data_object_->actime[action_id - 1] + static_cast<std::uint64_t>(addNum) * unit;
         }
+        role_data_object_->mark_dirty(shm::RoleDataObject::action_field(action_id - 1));
+        role_data_object_->mark_dirty(shm::RoleDataObject::actime_field(action_id - 1));
 
         return true;
     }
@@ -368,6 +425,7 @@ namespace cfl{
 
         role_data_object_->lock();
         role_data_object_->exp += static_cast<std::uint64_t>(exp);
+        role_data_object_->mark_dirty(shm::RoleField::Exp);
         role_data_object_->unlock();
 
         while (role_data_object_->level < MaxRoleLevel) {
@@ -381,6 +439,8 @@ namespace cfl{
                 role_data_object_->lock();
                 role_data_object_->exp -= pLevelInfo->need_exp;
                 role_data_object_->level += 1;
+                role_data_object_->mark_dirty(shm::RoleField::Exp);
+                role_data_object_->mark_dirty(shm::RoleField::Level);
                 role_data_object_->unlock();
             } else {
                 break;
@@ -391,6 +451,9 @@ namespace cfl{
     }
 
     std::uint64_t RoleModule::get_last_logoff_time() const {
+        if (store_slot_ != ModuleStore<RoleDayState>::kNoSlot) {
+            return g_online_roles.at(store_slot_).logoff_time;
+        }
         if (!role_data_object_) {
             return 0;
         }
@@ -403,8 +466,11 @@ namespace cfl{
             return false;
         }
         role_data_object_->lock();
-        role_data_object_->logoffTime = time;
+        role_data_object_->set<shm::RoleField::LogoffTime>(time);
         role_data_object_->unlock();
+        if (store_slot_ != ModuleStore<RoleDayState>::kNoSlot) {
+            g_online_roles.at(store_slot_).logoff_time = time;
+        }
         return true;
     }
 
@@ -435,7 +501,7 @@ namespace cfl{
             return;
         }
         role_data_object_->lock();
-        role_data_object_->groupMailTime = time; // 假定字段名为 groupMailTime，若字段名不同请调整
+        role_data_object_->set<shm::RoleField::GroupTime>(time);
         role_data_object_->unlock();
     }
 
@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <array>
 #include <memory>
+#include <limits>
 
 namespace cfl {
     namespace shm {
@@ -68,6 +69,12 @@ namespace cfl {
          */
         bool on_new_day() override;
 
+        /**
+         * @brief 跨天时批量处理所有在线角色（注册到 ModuleRegistry）
+         * @param now 当前时间（毫秒）
+         */
+        static void new_day_all(std::uint64_t now);
+
         /**
          * @brief 初始化基础数据
          * @param role_id 角色ID
@@ -90,6 +97,13 @@ namespace cfl {
          */
         bool read_from_db_login_data(const DBRoleLoginAck& ack);
 
+        /**
+         * @brief 进程重启后接管共享内存中已存在的角色数据
+         * @param obj 共享内存中的角色数据对象
+         * @return true 成功，false 失败
+         */
+        bool restore_from_shared_memory(std::shared_ptr<shm::RoleDataObject> obj);
+
         /**
          * @brief 保存数据到客户端登录数据
          * @param ack 客户端登录应答包
@@ -162,6 +176,7 @@ namespace cfl {
          * @brief 更新行动力
          * @param action_id 行动力ID
          * @return true 成功，false 失败
+         * @note 会修改共享内存中的角色数据，调用方需处于 lock()/unlock() 之间
          */
         bool update_action(std::uint32_t action_id);
 
@@ -180,7 +195,7 @@ namespace cfl {
         std::uint64_t add_exp(int32_t exp);
 
         /**
-         * @brief 获取上次下线时间
+         * @brief 获取上次下线时间，在线时取跨天批量状态中的值
          * @return 时间戳
          */
         std::uint64_t get_last_logoff_time() const;
@@ -269,6 +284,11 @@ namespace cfl {
          * @brief 共享内存中的角色数据对象
          */
         std::shared_ptr<shm::RoleDataObject> role_data_object_;
+
+        /**
+         * @brief 在线期间在批量状态数组中的下标
+         */
+        std::uint32_t store_slot_ = std::numeric_limits<std::uint32_t>::max();
     };
 
 }
@@ -0,0 +1,283 @@
+#include "player_manager.h"
+#include <mutex>
+#include <vector>
+#include "spdlog/spdlog.h"
+#include "cfl/shm/shmpool.h"
+#include "cfl/shm/obj/role_data_obj.h"
+#include "cfl/shm/obj/mail_data_obj.h"
+#include "cfl/mail/mail_manager.h"
+#include "cfl/modules/mail_module.h"
+
+namespace cfl {
+
+    PlayerManager &PlayerManager::instance() noexcept {
+        static PlayerManager instance;
+        return instance;
+    }
+
+    PlayerManager::PlayerPtr PlayerManager::create_player(std::uint64_t role_id) {
+        if (role_id == 0) {
+            return nullptr;
+        }
+        if (auto player = get_player(role_id)) {
+            return player;
+        }
+        auto handle = pool_.emplace();
+        index_.assign(role_id, handle.index);
+        auto &player = pool_.get(handle)->player;
+        player.init(role_id);
+        player.create_all_modules();
+        return &player;
+    }
+
+    PlayerManager::PlayerPtr PlayerManager::get_player(std::uint64_t role_id) const {
+        auto index = index_.find(role_id);
+        if (index == IdTable::kNotFound) {
+            return nullptr;
+        }
+        return &pool_.at(index)->player;
+    }
+
+    PlayerManager::PlayerPtr PlayerManager::get_player(PlayerHandle handle) const {
+        auto entry = pool_.get(handle);
+        return entry != nullptr ? &entry->player : nullptr;
+    }
+
+    PlayerHandle PlayerManager::get_handle(std::uint64_t role_id) const {
+        auto index = index_.find(role_id);
+        if (index == IdTable::kNotFound) {
+            return {};
+        }
+        return pool_.handle_at(index);
+    }
+
+    bool PlayerManager::release_player(std::uint64_t role_id) {
+        auto index = index_.find(role_id);
+        if (index == IdTable::kNotFound) {
+            return false;
+        }
+        auto entry = pool_.at(index);
+        remove_online(*entry);
+        entry->player.uninit();
+        index_.erase(role_id);
+        pool_.erase(pool_.handle_at(index));
+        return true;
+    }
+
+    bool PlayerManager::update_online(PlayerObject &player) {
+        auto index = index_.find(player.role_id());
+        if (index == IdTable::kNotFound) {
+            return false;
+        }
+        auto entry = pool_.at(index);
+        if (&entry->player != &player) {
+            return false;
+        }
+        if (player.is_online()) {
+            if (entry->online_pos == kNotOnline) {
+                entry->online_pos = static_cast<std::uint32_t>(online_.size());
+                online_.push_back(&player);
+                online_slots_.push_back(index);
+            }
+        } else {
+            remove_online(*entry);
+        }
+        return true;
+    }
+
+    void PlayerManager::remove_online(PlayerEntry &entry) {
+        auto pos = entry.online_pos;
+        if (pos == kNotOnline) {
+            return;
+        }
+        auto last = online_.size() - 1;
+        if (pos != last) {
+            online_[pos] = online_[last];
+            online_slots_[pos] = online_slots_[last];
+            pool_.at(online_slots_[pos])->online_pos = pos;
+        }
+        online_.pop_back();
+        online_slots_.pop_back();
+        entry.online_pos = kNotOnline;
+    }
+
+    bool PlayerManager::restore_from_shared_memory() {
+        auto &pool_manager = shm::DataPoolManager::instance();
+        auto worker_count = pool_manager.restore_worker_count();
+
+        // 每个工作线程一个桶，扫描期间无需加锁，finish 时在调用线程合并
+        std::vector<std::vector<PlayerHandle>> player_buckets(worker_count);
+        // 恢复失败的玩家交回调用线程处理，工作线程中不析构玩家、不归还共享内存块
+        std::vector<std::vector<std::pair<PlayerHandle, std::shared_ptr<shm::RoleDataObject>>>> failed_buckets(worker_count);
+        std::vector<std::vector<shm::MailRef>> mail_buckets(worker_count);
+        std::vector<std::vector<std::shared_ptr<shm::GroupMailDataObject>>> group_mail_buckets(worker_count);
+        std::vector<std::vector<shm::GroupMailStateRef>> group_mail_state_buckets(worker_count);
+        // 只有取得和归还槽位需要加锁，玩家及其模块在各自的槽位中并行构建
+        std::mutex pool_mutex;
+
+        pool_manager.register_restore_handler(shm::SHMTYPE::RoleData, {
+                [&](std::size_t worker, shm::SharedObject *object) {
+                    auto role = shm::attach_object<shm::RoleDataObject>(shm::SHMTYPE::RoleData, object);
+                    if (!role) {
+                        return false;
+                    }
+                    PlayerHandle handle;
+                    PlayerEntry *entry;
+                    {
+                        std::lock_guard lock(pool_mutex);
+                        handle = pool_.emplace();
+                        entry = pool_.get(handle);
+                    }
+                    if (!entry->player.restore_from_shared_memory(role)) {
+                        spdlog::error("[PlayerManager] restore role {} failed", role->roleId);
+                        failed_buckets[worker].emplace_back(handle, std::move(role));
+                        return false;
+                    }
+                    player_buckets[worker].push_back(handle);
+                    return true;
+                },
+                [&](std::size_t) {
+                    std::size_t total = 0;
+                    for (auto &bucket: player_buckets) {
+                        total += bucket.size();
+                    }
+                    index_.reserve(index_.size() + total);
+                    std::size_t duplicated = 0;
+                    for (auto &bucket: player_buckets) {
+                        for (auto handle: bucket) {
+                            auto &player = pool_.get(handle)->player;
+                            if (!index_.insert(player.role_id(), handle.index)) {
+                                player.uninit();
+                                pool_.erase(handle);
+                                ++duplicated;
+                            }
+                        }
+                        bucket.clear();
+                    }
+                    spdlog::info("[PlayerManager] restored {} players, {} duplicated", total - duplicated, duplicated);
+
+                    // 恢复失败的角色可能有未落地的修改：合并成批量语句写库，写库失败时把数据留在共享内存中
+                    std::vector<shm::RoleDataObject *> dirty_roles;
+                    for (auto &bucket: failed_buckets) {
+                        for (auto &[handle, role]: bucket) {
+                            if (role->is_dirty()) {
+                                dirty_roles.push_back(role.get());
+                            }
+                        }
+                    }
+                    if (!dirty_roles.empty() && !shm::RoleDataObject::SaveBatch(dirty_roles)) {
+                        spdlog::error("[PlayerManager] save {} failed roles failed", dirty_roles.size());
+                    }
+                    for (auto &bucket: failed_buckets) {
+                        for (auto &[handle, role]: bucket) {
+                            // 写库失败时脏位被还原
+                            bool saved = !role->is_dirty();
+                            if (!saved) {
+                                shm::detach_object(role);
+                            }
+                            pool_.get(handle)->player.uninit();
+                            pool_.erase(handle);
+                            if (!saved) {
+                                // 模块销毁时会把对象标记为已释放，这里恢复为使用中，避免被当作空闲块回收
+                                role->use();
+                                spdlog::error("[PlayerManager] role {} is kept in shared memory, save failed", role->roleId);
+                            }
+                        }
+                        bucket.clear();
+                    }
+                    return true;
+                }
+        });
+
+        pool_manager.register_restore_handler(shm::SHMTYPE::Mail, {
+                [&](std::size_t worker, shm::SharedObject *object) {
+                    mail_buckets[worker].emplace_back(shm::MailRef::from_object(shm::SHMTYPE::Mail, object));
+                    return true;
+                },
+                [&](std::size_t) {
+                    std::size_t offline = 0;
+                    for (auto &bucket: mail_buckets) {
+                        for (auto &mail: bucket) {
+                            auto mail_object = mail.get();
+                            if (mail_object == nullptr) {
+                                continue;
+                            }
+                            auto player = get_player(mail_object->role_id);
+                            auto mail_module = player
+                                    ? std::dynamic_pointer_cast<MailModule>(player->get_module_by_type(ModuleType::Mail))
+                                    : nullptr;
+                            if (mail_module) {
+                                mail_module->add_mail(mail);
+                            } else {
+                                shm::MailManager::instance().add_off_mail(mail);
+                                ++offline;
+                            }
+                        }
+                        bucket.clear();
+                    }
+                    spdlog::info("[PlayerManager] restored mails, {} offline", offline);
+                    return true;
+                }
+        });
+
+        pool_manager.register_restore_handler(shm::SHMTYPE::GroupMail, {
+                [&](std::size_t worker, shm::SharedObject *object) {
+                    group_mail_buckets[worker].emplace_back(shm::attach_object<shm::GroupMailDataObject>(shm::SHMTYPE::GroupMail, object));
+                    return true;
+                },
+                [&](std::size_t) {
+                    for (auto &bucket: group_mail_buckets) {
+                        for (auto &group_mail: bucket) {
+                            shm::MailManager::instance().add_group_mail(group_mail);
+                        }
+                        bucket.clear();
+                    }
+                    return true;
+                }
+        });
+
+        pool_manager.register_restore_handler(shm::SHMTYPE::GroupMailState, {
+                [&](std::size_t worker, shm::SharedObject *object) {
+                    group_mail_state_buckets[worker].emplace_back(
+                            shm::GroupMailStateRef::from_object(shm::SHMTYPE::GroupMailState, object));
+                    return true;
+                },
+                [&](std::size_t) {
+                    std::size_t dropped = 0;
+                    for (auto &bucket: group_mail_state_buckets) {
+                        for (auto &state: bucket) {
+                            auto state_object = state.get();
+                            if (state_object == nullptr) {
+                                continue;
+                            }
+                            auto player = get_player(state_object->role_id);
+                            auto mail_module = player
+                                    ? std::dynamic_pointer_cast<MailModule>(player->get_module_by_type(ModuleType::Mail))
+                                    : nullptr;
+                            // 角色或群邮件已不存在时引用没有意义，直接回收
+                            if (mail_module &&
+                                shm::MailManager::instance().group_mail_data_.contains(state_object->group_guid)) {
+                                mail_module->add_group_mail_state(state);
+                            } else {
+                                state.release();
+                                ++dropped;
+                            }
+                        }
+                        bucket.clear();
+                    }
+                    spdlog::info("[PlayerManager] restored group mail references, {} dropped", dropped);
+                    return true;
+                }
+        });
+
+        bool result = pool_manager.restore_from_shared_memory();
+
+        // 处理器引用了本函数的局部变量，恢复结束后立即注销
+        pool_manager.register_restore_handler(shm::SHMTYPE::RoleData, {});
+        pool_manager.register_restore_handler(shm::SHMTYPE::Mail, {});
+        pool_manager.register_restore_handler(shm::SHMTYPE::GroupMail, {});
+        pool_manager.register_restore_handler(shm::SHMTYPE::GroupMailState, {});
+        return result;
+    }
+
+} // namespace cfl
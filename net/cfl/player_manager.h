@@ -0,0 +1,147 @@
+#pragma once
+/**
+ * @file player_manager.h
+ * @brief 定义 PlayerManager 类，管理进程内所有的玩家对象。
+ */
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "playerobj.h"
+#include "id_table.h"
+#include "slab_pool.h"
+
+namespace cfl {
+
+    /// 玩家句柄，跨帧保存玩家时使用，玩家被释放后 get_player 返回 nullptr
+    using PlayerHandle = SlabHandle;
+
+    /**
+     * @class PlayerManager
+     * @brief 玩家对象管理器，按角色ID索引所有已加载的玩家。
+     *
+     * 功能包括：
+     * - 创建、查找、移除玩家对象
+     * - 维护在线玩家的连续数组，供广播和逐帧逻辑遍历
+     * - 进程重启后从共享内存并行恢复玩家及其模块数据
+     *
+     * @details
+     * - 玩家对象从按块分配的对象池（SlabPool）中构造，地址在释放前不变，模块以裸指针引用所属玩家；
+     * - 角色ID -> 槽位下标使用开放寻址表（IdTable），查找不经过链表节点；
+     * - 在线玩家保存在连续数组中，上下线时交换删除，槽位中记录其在数组中的位置。
+     *
+     * @note 使用单例模式访问：`PlayerManager::instance()`，仅在逻辑线程中使用。
+     */
+    class PlayerManager {
+    public:
+        using PlayerPtr = PlayerObject *;
+
+        /**
+         * @brief 获取 PlayerManager 的全局唯一实例。
+         */
+        [[nodiscard]] static PlayerManager &instance() noexcept;
+
+        PlayerManager(const PlayerManager &) = delete;
+        PlayerManager &operator=(const PlayerManager &) = delete;
+
+        /**
+         * @brief 创建一个玩家对象并加入管理器。
+         * @param role_id 角色ID。
+         * @return 新建的玩家对象；若该角色已存在则返回已有对象；角色ID为 0 时返回 nullptr。
+         */
+        PlayerPtr create_player(std::uint64_t role_id);
+
+        /**
+         * @brief 根据角色ID查找玩家对象。
+         * @param role_id 角色ID。
+         * @return 玩家对象，不存在时返回 nullptr；指针在玩家被释放前有效。
+         */
+        [[nodiscard]] PlayerPtr get_player(std::uint64_t role_id) const;
+
+        /**
+         * @brief 根据句柄查找玩家对象。
+         * @return 句柄无效或玩家已被释放时返回 nullptr。
+         */
+        [[nodiscard]] PlayerPtr get_player(PlayerHandle handle) const;
+
+        /**
+         * @brief 获取角色的句柄。
+         * @return 角色不存在时返回无效句柄。
+         */
+        [[nodiscard]] PlayerHandle get_handle(std::uint64_t role_id) const;
+
+        /**
+         * @brief 移除玩家对象。
+         * @param role_id 角色ID。
+         * @return true 移除成功；false 玩家不存在。
+         */
+        bool release_player(std::uint64_t role_id);
+
+        /**
+         * @brief 同步玩家的在线状态到在线数组，由 PlayerObject::set_online 调用。
+         * @return false 玩家不由管理器持有。
+         */
+        bool update_online(PlayerObject &player);
+
+        /**
+         * @brief 获取管理中的玩家数量。
+         */
+        [[nodiscard]] std::size_t player_count() const noexcept { return pool_.size(); }
+
+        /**
+         * @brief 获取在线玩家数量。
+         */
+        [[nodiscard]] std::size_t online_count() const noexcept { return online_.size(); }
+
+        /**
+         * @brief 在线玩家的连续数组，上下线会改变顺序。
+         * @note 遍历期间不要让玩家上下线或释放玩家。
+         */
+        [[nodiscard]] std::span<const PlayerPtr> online_players() const noexcept { return online_; }
+
+        /**
+         * @brief 按槽位顺序遍历所有已加载的玩家（包括离线）。
+         * @param f 以 PlayerObject & 调用。
+         */
+        template<class F>
+        void for_each_player(F &&f) const {
+            pool_.for_each([&f](PlayerHandle, PlayerEntry &entry) { f(entry.player); });
+        }
+
+        /**
+         * @brief 进程重启后从共享内存恢复玩家。
+         *
+         * @details
+         * 为角色、邮件、群邮件、群邮件引用四个池注册恢复处理器，然后调用
+         * DataPoolManager::restore_from_shared_memory 并行扫描：
+         * - 角色池：各工作线程在对象池中取得槽位（加锁）后独立构建 PlayerObject 及其模块，扫描结束后建立索引
+         * - 邮件池：挂到对应玩家的 MailModule，找不到玩家的作为离线邮件交给 MailManager
+         * - 群邮件池：交给 MailManager
+         * - 群邮件引用池：挂到对应玩家的 MailModule，角色或群邮件已不存在的直接回收
+         *
+         * @return true 恢复成功；false 存在恢复失败的池。
+         */
+        bool restore_from_shared_memory();
+
+    private:
+        PlayerManager() = default;
+        ~PlayerManager() = default;
+
+        static constexpr std::uint32_t kNotOnline = SlabHandle::kInvalidIndex;
+
+        struct PlayerEntry {
+            PlayerObject player;
+            std::uint32_t online_pos = kNotOnline;   ///< 在 online_ 中的位置
+        };
+
+        // 从在线数组中交换删除
+        void remove_online(PlayerEntry &entry);
+
+        SlabPool<PlayerEntry> pool_;                ///< 玩家对象池
+        IdTable index_;                             ///< 角色ID -> 槽位下标
+        std::vector<PlayerPtr> online_;             ///< 在线玩家
+        std::vector<std::uint32_t> online_slots_;   ///< 与 online_ 对应的槽位下标
+    };
+
+} // namespace cfl
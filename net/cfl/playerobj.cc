@@ -1,8 +1,31 @@
 #include "playerobj.h"
 #include "cfl/modules/role_module.h"
 #include "cfl/modules/mail_module.h"
+#include "cfl/player_manager.h"
+#include "cfl/modules/module_registry.h"
+#include "cfl/net_engine.h"
 
 namespace cfl {
+    namespace {
+        /**
+         * @brief 按 ModuleType 顺序对已注册的模块调用 f，未注册或未创建的模块直接跳过
+         * @return f 返回 false 时立即返回 false
+         */
+        template<class F>
+        bool for_each_module(std::vector<std::shared_ptr<ModuleBase>> &modules, F &&f) {
+            if (modules.empty()) {
+                return true;
+            }
+            for (auto type: ModuleRegistry::instance().types()) {
+                auto &module = modules[static_cast<std::size_t>(type)];
+                if (module && !f(*module)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
     bool PlayerObject::init(std::uint64_t role_id) {
         role_id_ = role_id;
         proxy_conn_id_ = 0;
@@ -32,14 +55,7 @@ namespace cfl {
     }
 
     bool PlayerObject::on_create(std::uint64_t role_id) {
-        for (auto type = static_cast<int>(ModuleType::Role);
-             type < static_cast<int>(ModuleType::End); type++) {
-            auto module = modules_.at(type);
-            if (module == nullptr || !module->on_create(role_id)) {
-                return false;
-            }
-        }
-        return true;
+        return for_each_module(modules_, [&role_id](ModuleBase &module) { return module.on_create(role_id); });
     }
 
     bool PlayerObject::on_destroy() {
@@ -48,70 +64,111 @@ namespace cfl {
     }
 
     bool PlayerObject::on_login() {
-        for (auto type = static_cast<int>(ModuleType::Role);
-             type < static_cast<int>(ModuleType::End); type++) {
-            auto module = modules_.at(type);
-            if (module == nullptr || !module->on_login()) {
+        if (!modules_.empty()) {
+            auto types = ModuleRegistry::instance().types();
+            for (std::size_t i = 0; i < types.size(); ++i) {
+                auto &module = modules_[static_cast<std::size_t>(types[i])];
+                if (!module || module->on_login()) {
+                    continue;
+                }
+                // 已登录的模块按相反顺序登出，不留下半登录的状态（如 ModuleStore 中的项）
+                while (i-- > 0) {
+                    if (auto &logged_in = modules_[static_cast<std::size_t>(types[i])]) {
+                        logged_in->on_logout();
+                    }
+                }
                 return false;
             }
         }
-        is_online_ = true;
+        set_online(true);
         // todo: 处理跨天逻辑
         return true;
     }
 
     bool PlayerObject::on_logout() {
-        for (auto type = static_cast<int>(ModuleType::Role);
-             type < static_cast<int>(ModuleType::End); type++) {
-            auto module = modules_.at(type);
-            if (module == nullptr || !module->on_logout()) {
-                return false;
-            }
+        if (!for_each_module(modules_, [](ModuleBase &module) { return module.on_logout(); })) {
+            return false;
         }
-        is_online_ = false;
+        set_online(false);
 
         room_id_ = 0;
         return true;
     }
 
     bool PlayerObject::on_new_day() {
-        for (auto type = static_cast<int>(ModuleType::Role);
-             type < static_cast<int>(ModuleType::End); type++) {
-            auto module = modules_.at(type);
-            if (module == nullptr || !module->on_new_day()) {
-                return false;
-            }
+        return for_each_module(modules_, [](ModuleBase &module) { return module.on_new_day(); });
+    }
+
+    bool PlayerObject::read_from_db_login_data(DBRoleLoginAck &ack) {
+        return for_each_module(modules_, [&ack](ModuleBase &module) { return module.read_from_db_login_data(ack); });
+    }
+
+    bool PlayerObject::restore_from_shared_memory(const std::shared_ptr<shm::RoleDataObject> &role) {
+        if (!role) {
+            return false;
+        }
+        init(role->roleId);
+        create_all_modules();
+        account_id_ = role->accountId;
+        name_ = role->name;
+        career_id_ = role->carrerId;
+        city_copy_id_ = role->cityCopyId;
+
+        auto role_module = std::dynamic_pointer_cast<RoleModule>(get_module_by_type(ModuleType::Role));
+        if (role_module == nullptr || !role_module->restore_from_shared_memory(role)) {
+            return false;
         }
+        actor_id_ = role_module->get_actor_id();
         return true;
     }
 
-    bool PlayerObject::read_from_db_login_data(DBRoleLoginAck &ack) {
-        for (auto type = static_cast<int>(ModuleType::Role);
-             type < static_cast<int>(ModuleType::End); type++) {
-            auto module = modules_.at(type);
-            if (module == nullptr || !module->read_from_db_login_data(ack)) {
-                return false;
-            }
+    bool PlayerObject::send_msg_raw(std::int32_t msg_id, const char *data, std::uint32_t len) {
+        // 未绑定代理连接（离线或尚未进入游戏）时不发送
+        if (proxy_conn_id_ <= 0) {
+            return false;
         }
+        return NetEngine::instance().send_message(static_cast<std::uint64_t>(proxy_conn_id_),
+                                                  static_cast<std::uint32_t>(msg_id), role_id_,
+                                                  static_cast<std::uint32_t>(client_conn_id_),
+                                                  std::span<const char>(data, len));
+    }
+
+    bool PlayerObject::set_connect_id(std::uint32_t proxy_id, std::uint32_t client_id) {
+        proxy_conn_id_ = static_cast<std::int32_t>(proxy_id);
+        client_conn_id_ = static_cast<std::int32_t>(client_id);
         return true;
     }
 
+    bool PlayerObject::is_online() const {
+        return is_online_;
+    }
+
+    void PlayerObject::set_online(bool online) {
+        if (is_online_ == online) {
+            return;
+        }
+        is_online_ = online;
+        // 由管理器持有的玩家同步到在线数组
+        PlayerManager::instance().update_online(*this);
+    }
+
     bool PlayerObject::create_all_modules() {
-        modules_.resize(static_cast<std::size_t>(ModuleType::End));
-        modules_[static_cast<std::size_t>(ModuleType::Role)] = std::make_shared<RoleModule>(this);
-        modules_[static_cast<std::size_t>(ModuleType::Mail)] = std::make_shared<MailModule>(this);
+        auto &registry = ModuleRegistry::instance();
+        modules_.assign(static_cast<std::size_t>(ModuleType::End), nullptr);
+        for (auto type: registry.types()) {
+            modules_[static_cast<std::size_t>(type)] = registry.create(type, this);
+        }
         return true;
     }
 
     bool PlayerObject::destroy_all_modules() {
-        for (auto type = static_cast<int>(ModuleType::Role);
-             type < static_cast<int>(ModuleType::End); type++) {
-            auto module = modules_.at(type);
-            if (module == nullptr || !module->on_destroy()) {
-                return false;
-            }
-        }
+        // 每个模块都要销毁，某个模块失败不影响其他模块释放资源
+        bool ok = true;
+        for_each_module(modules_, [&ok](ModuleBase &module) {
+            ok = module.on_destroy() && ok;
+            return true;
+        });
         modules_.clear();
-        return true;
+        return ok;
     }
 }
\ No newline at end of file
@@ -13,6 +13,10 @@
 #include "server_define.h"
 #include "shm/shmpool.h"
 namespace cfl {
+    namespace shm {
+        struct RoleDataObject;
+    }
+
     /**
      * @class PlayerObject
      * @brief 玩家对象类，负责维护玩家的基本属性、登录状态、场景操作和模块管理。
@@ -87,6 +91,14 @@ class PlayerObject : public HandlerManager, std::enable_shared_from_this<PlayerO
          */
         bool read_from_db_login_data(DBRoleLoginAck &ack);
 
+        /**
+         * @brief 进程重启后从共享内存中的角色数据恢复玩家对象。
+         * @details 初始化玩家、创建所有模块并让角色模块直接接管共享内存对象，不访问数据库。
+         * @param role 共享内存中的角色数据对象。
+         * @return 是否成功。
+         */
+        bool restore_from_shared_memory(const std::shared_ptr<shm::RoleDataObject> &role);
+
         /**
          * @brief 发送 Protobuf 消息给客户端。
          * @param msg_id 消息ID。
@@ -94,9 +106,12 @@ class PlayerObject : public HandlerManager, std::enable_shared_from_this<PlayerO
          * @return 是否成功。
          */
         bool send_msg_protobuf(std::int32_t msg_id, const google::protobuf::Message &data){
-            // todo
-            spdlog::error("[send_msg_protobuf] todo");
-            return true;
+            std::string payload;
+            if (!data.SerializeToString(&payload)) {
+                spdlog::error("[send_msg_protobuf] serialize msg {} failed", msg_id);
+                return false;
+            }
+            return send_msg_raw(msg_id, payload.data(), static_cast<std::uint32_t>(payload.size()));
         }
 
         /**
@@ -139,7 +154,7 @@ class PlayerObject : public HandlerManager, std::enable_shared_from_this<PlayerO
         bool is_online() const;
 
         /**
-         * @brief 设置玩家在线状态。
+         * @brief 设置玩家在线状态，并同步到 PlayerManager 的在线数组。
          * @param online 是否在线。
          */
         void set_online(bool online);
@@ -209,7 +224,7 @@ class PlayerObject : public HandlerManager, std::enable_shared_from_this<PlayerO
         bool set_copy_status(std::uint32_t copy_guid, std::uint32_t copy_id, std::uint32_t copy_server_id, bool main_city);
 
         /**
-         * @brief 创建所有模块。
+         * @brief 创建 ModuleRegistry 中已注册的所有模块。
          * @return 是否成功。
          */
         bool create_all_modules();
@@ -223,11 +238,11 @@ class PlayerObject : public HandlerManager, std::enable_shared_from_this<PlayerO
         /**
          * @brief 根据类型获取模块指针。
          * @param module_type 模块类型ID。
-         * @return 模块基类指针。
+         * @return 模块基类指针，模块未注册或尚未创建时返回 nullptr。
          */
         std::shared_ptr<ModuleBase> get_module_by_type(ModuleType module_type){
-            auto type_idx = static_cast<int>(module_type);
-            return modules_.at(type_idx);
+            auto type_idx = static_cast<std::size_t>(module_type);
+            return type_idx < modules_.size() ? modules_[type_idx] : nullptr;
         }
 
         /**
@@ -0,0 +1,310 @@
+#include "rank_list.h"
+#include <algorithm>
+#include <new>
+
+namespace cfl {
+
+    RankList::RankList(std::size_t page_size, std::chrono::milliseconds snapshot_interval)
+            : head_(create_node(kMaxLevel, 0, 0, 0)), page_size_(std::max<std::size_t>(page_size, 1)),
+              snapshot_interval_(snapshot_interval) {
+    }
+
+    RankList::~RankList() {
+        clear();
+        destroy_node(head_);
+    }
+
+    RankList::Node *RankList::create_node(int height, Key key, std::uint64_t role_id, std::uint64_t score) {
+        // 节点和各层指针一次分配
+        void *memory = ::operator new(sizeof(Node) + sizeof(Level) * height);
+        auto node = new(memory) Node{key, role_id, score, nullptr, nullptr, height};
+        node->levels = new(static_cast<char *>(memory) + sizeof(Node)) Level[height];
+        return node;
+    }
+
+    void RankList::destroy_node(Node *node) noexcept {
+        ::operator delete(node);
+    }
+
+    int RankList::random_height() {
+        // 每层晋升概率 1/4
+        int height = 1;
+        while (height < kMaxLevel && (rng_() & 0xFFFF) < 0xFFFF / 4) {
+            ++height;
+        }
+        return height;
+    }
+
+    RankList::Node *RankList::insert_node(Key key, std::uint64_t role_id, std::uint64_t score) {
+        Node *update[kMaxLevel];
+        std::uint32_t rank[kMaxLevel];
+
+        auto x = head_;
+        for (int i = height_ - 1; i >= 0; --i) {
+            rank[i] = i == height_ - 1 ? 0 : rank[i + 1];
+            while (x->levels[i].forward != nullptr && before(x->levels[i].forward, score, role_id)) {
+                rank[i] += x->levels[i].span;
+                x = x->levels[i].forward;
+            }
+            update[i] = x;
+        }
+
+        auto height = random_height();
+        if (height > height_) {
+            for (int i = height_; i < height; ++i) {
+                rank[i] = 0;
+                update[i] = head_;
+                head_->levels[i].span = static_cast<std::uint32_t>(length_);
+            }
+            height_ = height;
+        }
+
+        x = create_node(height, key, role_id, score);
+        for (int i = 0; i < height; ++i) {
+            x->levels[i].forward = update[i]->levels[i].forward;
+            update[i]->levels[i].forward = x;
+            x->levels[i].span = update[i]->levels[i].span - (rank[0] - rank[i]);
+            update[i]->levels[i].span = rank[0] - rank[i] + 1;
+        }
+        // 更高的层跨过了新节点
+        for (int i = height; i < height_; ++i) {
+            ++update[i]->levels[i].span;
+        }
+
+        x->backward = update[0] == head_ ? nullptr : update[0];
+        if (x->levels[0].forward != nullptr) {
+            x->levels[0].forward->backward = x;
+        } else {
+            tail_ = x;
+        }
+        ++length_;
+        return x;
+    }
+
+    void RankList::erase_node(Node *node) {
+        Node *update[kMaxLevel];
+        auto x = head_;
+        for (int i = height_ - 1; i >= 0; --i) {
+            while (x->levels[i].forward != nullptr && before(x->levels[i].forward, node->score, node->role_id)) {
+                x = x->levels[i].forward;
+            }
+            update[i] = x;
+        }
+
+        for (int i = 0; i < height_; ++i) {
+            if (update[i]->levels[i].forward == node) {
+                update[i]->levels[i].span += node->levels[i].span - 1;
+                update[i]->levels[i].forward = node->levels[i].forward;
+            } else {
+                --update[i]->levels[i].span;
+            }
+        }
+        if (node->levels[0].forward != nullptr) {
+            node->levels[0].forward->backward = node->backward;
+        } else {
+            tail_ = node->backward;
+        }
+        while (height_ > 1 && head_->levels[height_ - 1].forward == nullptr) {
+            --height_;
+        }
+        --length_;
+        destroy_node(node);
+    }
+
+    bool RankList::update(Key key, std::uint64_t role_id, std::uint64_t score) {
+        if (key >= nodes_.size()) {
+            nodes_.resize(static_cast<std::size_t>(key) + 1, nullptr);
+        }
+        auto &node = nodes_[key];
+        if (node == nullptr) {
+            node = insert_node(key, role_id, score);
+            touch();
+            return true;
+        }
+
+        if (node->score == score) {
+            return false;
+        }
+        // 新分数不改变前后顺序时原地修改
+        auto next = node->levels[0].forward;
+        if ((node->backward == nullptr || before(node->backward, score, role_id))
+            && (next == nullptr || !before(next, score, role_id))) {
+            node->score = score;
+        } else {
+            erase_node(node);
+            node = insert_node(key, role_id, score);
+        }
+        touch();
+        return true;
+    }
+
+    void RankList::assign(std::vector<RankItem> items) {
+        clear();
+        std::sort(items.begin(), items.end(), [](const RankItem &a, const RankItem &b) {
+            return a.score != b.score ? a.score > b.score : a.role_id < b.role_id;
+        });
+        Key max_key = 0;
+        for (auto &item: items) {
+            max_key = std::max(max_key, item.key);
+        }
+        nodes_.assign(items.empty() ? 0 : static_cast<std::size_t>(max_key) + 1, nullptr);
+
+        // 按名次顺序追加：每层记录最后一个节点及其名次，新节点直接链接在其后
+        Node *last[kMaxLevel];
+        std::uint32_t last_rank[kMaxLevel];
+        std::fill_n(last, kMaxLevel, head_);
+        std::fill_n(last_rank, kMaxLevel, 0u);
+        Node *prev = nullptr;
+        std::uint32_t rank = 0;
+        for (auto &item: items) {
+            auto height = random_height();
+            auto node = create_node(height, item.key, item.role_id, item.score);
+            ++rank;
+            for (int i = 0; i < height; ++i) {
+                last[i]->levels[i].forward = node;
+                last[i]->levels[i].span = rank - last_rank[i];
+                last[i] = node;
+                last_rank[i] = rank;
+            }
+            node->backward = prev;
+            prev = node;
+            height_ = std::max(height_, height);
+            nodes_[item.key] = node;
+        }
+        // 每层最后一个节点的跨度为其后的节点数，与逐个插入时一致
+        for (int i = 0; i < height_; ++i) {
+            last[i]->levels[i].span = rank - last_rank[i];
+        }
+        tail_ = prev;
+        length_ = rank;
+        touch();
+    }
+
+    bool RankList::erase(Key key) {
+        auto node = find(key);
+        if (node == nullptr) {
+            return false;
+        }
+        erase_node(node);
+        nodes_[key] = nullptr;
+        touch();
+        return true;
+    }
+
+    void RankList::clear() {
+        auto x = head_->levels[0].forward;
+        while (x != nullptr) {
+            auto next = x->levels[0].forward;
+            destroy_node(x);
+            x = next;
+        }
+        for (int i = 0; i < kMaxLevel; ++i) {
+            head_->levels[i] = Level{};
+        }
+        tail_ = nullptr;
+        height_ = 1;
+        length_ = 0;
+        nodes_.clear();
+        pages_.clear();
+        touch();
+    }
+
+    std::uint32_t RankList::rank(Key key) const noexcept {
+        auto node = find(key);
+        if (node == nullptr) {
+            return 0;
+        }
+        auto role_id = node->role_id;
+        std::uint32_t rank = 0;
+        auto x = head_;
+        for (int i = height_ - 1; i >= 0; --i) {
+            while (x->levels[i].forward != nullptr
+                   && (x->levels[i].forward == node || before(x->levels[i].forward, node->score, role_id))) {
+                rank += x->levels[i].span;
+                x = x->levels[i].forward;
+            }
+            if (x == node) {
+                return rank;
+            }
+        }
+        return 0;
+    }
+
+    std::uint64_t RankList::score(Key key) const noexcept {
+        auto node = find(key);
+        return node != nullptr ? node->score : 0;
+    }
+
+    RankList::Node *RankList::node_at(std::uint32_t rank) const noexcept {
+        if (rank == 0 || rank > length_) {
+            return nullptr;
+        }
+        std::uint32_t traversed = 0;
+        auto x = head_;
+        for (int i = height_ - 1; i >= 0; --i) {
+            while (x->levels[i].forward != nullptr && traversed + x->levels[i].span <= rank) {
+                traversed += x->levels[i].span;
+                x = x->levels[i].forward;
+            }
+            if (traversed == rank) {
+                return x;
+            }
+        }
+        return nullptr;
+    }
+
+    RankEntry RankList::at(std::uint32_t rank) const noexcept {
+        auto x = node_at(rank);
+        return x != nullptr ? RankEntry{x->role_id, x->score, rank} : RankEntry{};
+    }
+
+    void RankList::range(std::uint32_t first, std::size_t count, std::vector<RankEntry> &out) const {
+        first = std::max<std::uint32_t>(first, 1);
+        if (first > length_ || count == 0) {
+            return;
+        }
+        // 按名次定位第一项，之后沿最底层顺序遍历
+        auto x = node_at(first);
+        count = std::min<std::size_t>(count, length_ - first + 1);
+        out.reserve(out.size() + count);
+        for (std::uint32_t rank = first; x != nullptr && count > 0; --count, ++rank) {
+            out.push_back({x->role_id, x->score, rank});
+            x = x->levels[0].forward;
+        }
+    }
+
+    RankList::PagePtr RankList::page(std::size_t index) {
+        auto now = std::chrono::steady_clock::now();
+        if (pages_version_ != version_ && now - pages_time_ >= snapshot_interval_) {
+            // 开始新的快照周期，之前的页面整体失效（已返回的快照不受影响）
+            pages_.clear();
+            pages_version_ = version_;
+            pages_time_ = now;
+        }
+        if (index < pages_.size() && pages_[index]) {
+            return pages_[index];
+        }
+
+        auto page = std::make_shared<RankPage>();
+        page->index = index;
+        page->version = version_;
+        page->total = length_;
+        page->built_at = now;
+        if (index >= (length_ + page_size_ - 1) / page_size_) {
+            // 超出范围的空页不缓存
+            return page;
+        }
+        range(static_cast<std::uint32_t>(index * page_size_ + 1), page_size_, page->entries);
+        if (index >= pages_.size()) {
+            pages_.resize(index + 1);
+        }
+        pages_[index] = page;
+        return page;
+    }
+
+    void RankList::set_page_size(std::size_t page_size) {
+        page_size_ = std::max<std::size_t>(page_size, 1);
+        pages_.clear();
+    }
+
+} // namespace cfl
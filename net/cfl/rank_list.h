@@ -0,0 +1,218 @@
+/**
+ * @file rank_list.h
+ * @brief 增量维护的排行榜（带跨度的跳表）
+ *
+ * @details
+ * 按分数从高到低排列角色，分数相同时角色ID小的在前。榜上的角色由调用方分配的稠密编号（Key，
+ * 如 SimpleStore 的槽位）标识，编号直接索引节点数组，不需要额外的哈希表。
+ * 跳表每一层的指针记录跨越的节点数（span），
+ * 因此除了按顺序遍历，还可以在 O(log n) 内完成：
+ * - 更新分数（位置不变时原地修改）；
+ * - 查询角色的名次；
+ * - 按名次定位，取前 N 名或任意一页。
+ *
+ * 批量加载时用 assign() 一次建表：排序一次后逐层顺序链接，不逐个查找插入位置。
+ *
+ * 排行榜页面通过 page() 获取只读快照：
+ * - 每次修改递增版本号，页面快照记录生成时的版本号；
+ * - 版本未变时直接返回缓存的快照；
+ * - 版本变化后，快照在 snapshot_interval 内仍然有效，之后整体失效、按需重建，
+ *   频繁变化的战力榜在刷新周期内的重复请求不需要遍历跳表。
+ *
+ * @note 非线程安全，只能在逻辑线程中使用；返回的快照可以交给其他线程只读使用。
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace cfl {
+
+    /**
+     * @brief 排行榜中的一项
+     */
+    struct RankEntry {
+        std::uint64_t role_id = 0;
+        std::uint64_t score = 0;
+        std::uint32_t rank = 0;  ///< 名次，从 1 开始
+    };
+
+    /**
+     * @brief 批量建表时的一项
+     */
+    struct RankItem {
+        std::uint32_t key = 0;     ///< 角色的编号（RankList::Key）
+        std::uint64_t role_id = 0;
+        std::uint64_t score = 0;
+    };
+
+    /**
+     * @brief 排行榜一页的快照
+     */
+    struct RankPage {
+        std::size_t index = 0;                        ///< 页号，从 0 开始
+        std::uint64_t version = 0;                    ///< 生成时排行榜的版本号
+        std::size_t total = 0;                        ///< 生成时排行榜的总人数
+        std::chrono::steady_clock::time_point built_at;
+        std::vector<RankEntry> entries;
+    };
+
+    /**
+     * @class RankList
+     * @brief 按分数降序排列的排行榜
+     */
+    class RankList {
+    public:
+        using PagePtr = std::shared_ptr<const RankPage>;
+
+        /// 角色的稠密编号，由调用方分配（如 SimpleStore::Slot），同一个角色的编号不能变化
+        using Key = std::uint32_t;
+
+        /**
+         * @param page_size 每页的条数
+         * @param snapshot_interval 版本变化后快照仍可使用的时间
+         */
+        explicit RankList(std::size_t page_size = 50,
+                          std::chrono::milliseconds snapshot_interval = std::chrono::seconds(5));
+
+        ~RankList();
+
+        RankList(const RankList &) = delete;
+        RankList &operator=(const RankList &) = delete;
+
+        /**
+         * @brief 设置角色的分数，角色不在榜上时加入
+         * @param key 角色的编号
+         * @param role_id 角色ID，用于输出和同分排序
+         * @param score 分数
+         * @return 排行榜是否发生变化
+         */
+        bool update(Key key, std::uint64_t role_id, std::uint64_t score);
+
+        /**
+         * @brief 用 items 重建排行榜
+         * @details 排序一次后按名次顺序逐层链接，O(n log n)，用于启动时批量加载。items 中的编号不能重复。
+         */
+        void assign(std::vector<RankItem> items);
+
+        /**
+         * @brief 把角色移出排行榜
+         * @return 角色原来不在榜上时返回 false
+         */
+        bool erase(Key key);
+
+        /**
+         * @brief 清空排行榜
+         */
+        void clear();
+
+        /**
+         * @brief 角色的名次（从 1 开始），不在榜上时返回 0
+         */
+        [[nodiscard]] std::uint32_t rank(Key key) const noexcept;
+
+        /**
+         * @brief 角色的分数，不在榜上时返回 0
+         */
+        [[nodiscard]] std::uint64_t score(Key key) const noexcept;
+
+        /**
+         * @brief 第 rank 名（从 1 开始），超出范围时返回的 role_id 为 0
+         */
+        [[nodiscard]] RankEntry at(std::uint32_t rank) const noexcept;
+
+        /**
+         * @brief 从第 first 名开始的最多 count 项（追加到 out）
+         */
+        void range(std::uint32_t first, std::size_t count, std::vector<RankEntry> &out) const;
+
+        /**
+         * @brief 前 count 名（追加到 out）
+         */
+        void top(std::size_t count, std::vector<RankEntry> &out) const { range(1, count, out); }
+
+        /**
+         * @brief 第 index 页的快照（从 0 开始），超出范围时为空页
+         */
+        [[nodiscard]] PagePtr page(std::size_t index);
+
+        /// 榜上人数
+        [[nodiscard]] std::size_t size() const noexcept { return length_; }
+
+        /// 版本号，每次修改递增
+        [[nodiscard]] std::uint64_t version() const noexcept { return version_; }
+
+        /// 每页的条数
+        [[nodiscard]] std::size_t page_size() const noexcept { return page_size_; }
+
+        /// 设置每页的条数，已缓存的页面失效
+        void set_page_size(std::size_t page_size);
+
+        /// 设置版本变化后快照仍可使用的时间
+        void set_snapshot_interval(std::chrono::milliseconds interval) noexcept { snapshot_interval_ = interval; }
+
+    private:
+        static constexpr int kMaxLevel = 32;
+
+        struct Node;
+
+        struct Level {
+            Node *forward = nullptr;
+            std::uint32_t span = 0;  ///< 到 forward 跨越的节点数
+        };
+
+        struct Node {
+            Key key;
+            std::uint64_t role_id;
+            std::uint64_t score;
+            Node *backward;
+            Level *levels;    ///< 长度为 height，紧跟在节点之后一起分配
+            int height;
+        };
+
+        /// a 是否排在 (score, role_id) 之前
+        static bool before(const Node *a, std::uint64_t score, std::uint64_t role_id) noexcept {
+            return a->score > score || (a->score == score && a->role_id < role_id);
+        }
+
+        static Node *create_node(int height, Key key, std::uint64_t role_id, std::uint64_t score);
+
+        static void destroy_node(Node *node) noexcept;
+
+        int random_height();
+
+        Node *insert_node(Key key, std::uint64_t role_id, std::uint64_t score);
+
+        /// 编号对应的节点，不在榜上时返回 nullptr
+        [[nodiscard]] Node *find(Key key) const noexcept {
+            return key < nodes_.size() ? nodes_[key] : nullptr;
+        }
+
+        /// 第 rank 名的节点，超出范围时返回 nullptr
+        [[nodiscard]] Node *node_at(std::uint32_t rank) const noexcept;
+
+        void erase_node(Node *node);
+
+        void touch() noexcept { ++version_; }
+
+        Node *head_;
+        Node *tail_ = nullptr;
+        int height_ = 1;
+        std::size_t length_ = 0;
+        std::vector<Node *> nodes_;  ///< 编号 -> 节点，不在榜上时为 nullptr
+        std::minstd_rand rng_{0x5eed};
+
+        std::uint64_t version_ = 0;
+        std::size_t page_size_;
+        std::chrono::milliseconds snapshot_interval_;
+        std::vector<PagePtr> pages_;                         ///< 当前快照周期内已生成的页面
+        std::uint64_t pages_version_ = 0;                    ///< 当前快照周期开始时的版本号
+        std::chrono::steady_clock::time_point pages_time_;   ///< 当前快照周期开始的时间
+    };
+
+} // namespace cfl
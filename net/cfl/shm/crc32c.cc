@@ -0,0 +1,114 @@
+#include "crc32c.h"
+#include <array>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CFL_CRC32C_X86 1
+#include <nmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace cfl::shm {
+
+    namespace {
+        /// CRC32C 反射多项式
+        constexpr std::uint32_t kPolynomial = 0x82F63B78u;
+
+        using Table = std::array<std::array<std::uint32_t, 256>, 8>;
+
+        /// slicing-by-8 查表
+        constexpr Table make_table() {
+            Table table{};
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc >> 1) ^ ((crc & 1) ? kPolynomial : 0);
+                }
+                table[0][i] = crc;
+            }
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                for (std::size_t slice = 1; slice < 8; ++slice) {
+                    auto prev = table[slice - 1][i];
+                    table[slice][i] = (prev >> 8) ^ table[0][prev & 0xFF];
+                }
+            }
+            return table;
+        }
+
+        constexpr Table kTable = make_table();
+
+        std::uint32_t crc32c_software(const unsigned char *p, std::size_t size, std::uint32_t crc) noexcept {
+            while (size >= 8) {
+                std::uint64_t word;
+                std::memcpy(&word, p, 8);
+                word ^= crc;
+                crc = kTable[7][word & 0xFF] ^ kTable[6][(word >> 8) & 0xFF] ^
+                      kTable[5][(word >> 16) & 0xFF] ^ kTable[4][(word >> 24) & 0xFF] ^
+                      kTable[3][(word >> 32) & 0xFF] ^ kTable[2][(word >> 40) & 0xFF] ^
+                      kTable[1][(word >> 48) & 0xFF] ^ kTable[0][word >> 56];
+                p += 8;
+                size -= 8;
+            }
+            while (size-- > 0) {
+                crc = (crc >> 8) ^ kTable[0][(crc ^ *p++) & 0xFF];
+            }
+            return crc;
+        }
+
+#if defined(CFL_CRC32C_X86)
+#if defined(__GNUC__)
+        __attribute__((target("sse4.2")))
+#endif
+        std::uint32_t crc32c_sse42(const unsigned char *p, std::size_t size, std::uint32_t crc) noexcept {
+            std::uint64_t crc64 = crc;
+            while (size >= 8) {
+                std::uint64_t word;
+                std::memcpy(&word, p, 8);
+                crc64 = _mm_crc32_u64(crc64, word);
+                p += 8;
+                size -= 8;
+            }
+            crc = static_cast<std::uint32_t>(crc64);
+            while (size-- > 0) {
+                crc = _mm_crc32_u8(crc, *p++);
+            }
+            return crc;
+        }
+
+        bool detect_sse42() noexcept {
+#if defined(_MSC_VER)
+            int info[4] = {};
+            __cpuid(info, 1);
+            return (info[2] & (1 << 20)) != 0;
+#else
+            return __builtin_cpu_supports("sse4.2");
+#endif
+        }
+#endif
+
+        const bool kHardware =
+#if defined(CFL_CRC32C_X86)
+                detect_sse42();
+#else
+                false;
+#endif
+    }
+
+    std::uint32_t crc32c(const void *data, std::size_t size, std::uint32_t crc) noexcept {
+        auto p = static_cast<const unsigned char *>(data);
+        crc = ~crc;
+#if defined(CFL_CRC32C_X86)
+        if (kHardware) {
+            return ~crc32c_sse42(p, size, crc);
+        }
+#endif
+        return ~crc32c_software(p, size, crc);
+    }
+
+    bool crc32c_hardware() noexcept {
+        return kHardware;
+    }
+
+} // namespace cfl::shm
@@ -0,0 +1,31 @@
+/**
+ * @file crc32c.h
+ * @brief CRC32C（Castagnoli）校验
+ *
+ * @details
+ * 优先使用 SSE4.2 的 crc32 指令（运行时检测），不支持时退化为 slicing-by-8 查表实现。
+ * 用于共享内存对象块的完整性校验。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cfl::shm {
+
+    /**
+     * @brief 计算 CRC32C
+     * @param data 数据起始地址
+     * @param size 数据字节数
+     * @param crc 上一段数据的结果，用于分段计算（首段传 0）
+     * @return CRC32C 值
+     */
+    std::uint32_t crc32c(const void *data, std::size_t size, std::uint32_t crc = 0) noexcept;
+
+    /**
+     * @brief 当前 CPU 是否使用硬件指令计算 CRC32C
+     */
+    bool crc32c_hardware() noexcept;
+
+} // namespace cfl::shm
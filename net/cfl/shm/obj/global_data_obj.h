@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cstring>
 #include "cfl/shm/shmobj.h"
+#include "cfl/shm/shmlayout.h"
 #include "cfl/db/db_mysql.h"
 #include "cfl/db/db.h"
 
@@ -51,4 +52,27 @@ namespace cfl::shm {
             return true;
         }
     };
+
+    /**
+     * @brief GlobalDataObject 的共享内存布局描述
+     * @note 修改字段时递增 version，并按需注册从旧版本迁移的函数
+     */
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+#endif
+    template<>
+    struct ShmLayout<GlobalDataObject> {
+        static constexpr std::uint32_t version = 1;
+        static constexpr std::uint64_t fingerprint = shm_layout_fingerprint(
+                sizeof(GlobalDataObject), alignof(GlobalDataObject), {
+                        CFL_SHM_FIELD(GlobalDataObject, server_id),
+                        CFL_SHM_FIELD(GlobalDataObject, guid),
+                        CFL_SHM_FIELD(GlobalDataObject, max_online),
+                        CFL_SHM_FIELD(GlobalDataObject, extra_data),
+                });
+    };
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
 }
\ No newline at end of file
@@ -3,8 +3,11 @@
 #include <array>
 #include <string>
 #include <cstdint>
+#include <span>
 #include <string_view>
 #include "cfl/shm/shmobj.h"
+#include "cfl/shm/shmlayout.h"
+#include "cfl/shm/shmref.h"
 #include "cfl/db/db_mysql.h"
 #include "cfl/db/db.h"
 
@@ -37,9 +40,9 @@ namespace cfl::shm {
      */
     struct GroupMailDataObject : public SharedObject {
         std::uint64_t guid{};               // 唯一ID
-        std::string title;                  // 邮件标题
-        std::string content;                // 邮件内容
-        std::string sender;                 // 发送者
+        char title[MAIL_TITLE_LEN]{};       // 邮件标题
+        char content[MAIL_CONTENT_LEN]{};   // 邮件内容
+        char sender[ROLE_NAME_LEN]{};       // 发送者
         std::uint64_t time{};               // 邮件发送时间
         std::int32_t mail_type{};           // 邮件类型
         std::int32_t channel{};             // 邮件频道
@@ -74,6 +77,34 @@ namespace cfl::shm {
             return ret >= 0;
         }
 
+        /**
+         * @brief 批量创建或替换群发邮件记录（多行 REPLACE，一个事务）
+         * @param mails 群发邮件
+         * @return 全部成功时返回 true，失败时整体回滚
+         */
+        static bool create_batch(std::span<const GroupMailDataObject *const> mails) {
+            auto writer = cfl::db::MySQLUtil::batch_writer(
+                    "db_game", "mail_group",
+                    {"id", "title", "content", "sender", "mail_time", "mailtype", "channel", "language", "grouptype",
+                     "itemdata"});
+            for (auto mail: mails) {
+                if (!writer.add_row(mail->guid,
+                                    std::string_view(mail->title),
+                                    std::string_view(mail->content),
+                                    std::string_view(mail->sender),
+                                    mail->time,
+                                    mail->mail_type,
+                                    mail->channel,
+                                    mail->language,
+                                    mail->group_type,
+                                    std::string_view(reinterpret_cast<const char *>(mail->items.data()),
+                                                     sizeof(StMailItem) * mail->items.size()))) {
+                    return false;
+                }
+            }
+            return writer.commit();
+        }
+
         /**
          * @brief 更新群发邮件数据
          * @return 操作是否成功
@@ -103,9 +134,9 @@ namespace cfl::shm {
         std::uint64_t sender_id{};          // 发送者ID
         std::int32_t mail_type{};           // 邮件类型
         std::int32_t status{};              // 邮件状态
-        std::string sender;                 // 发送者名字
-        std::string title;                  // 邮件标题
-        std::string content;                // 邮件内容
+        char sender[ROLE_NAME_LEN]{};       // 发送者名字
+        char title[MAIL_TITLE_LEN]{};       // 邮件标题
+        char content[MAIL_CONTENT_LEN]{};   // 邮件内容
         std::array<StMailItem, MAIL_ITEM_COUNT> items{}; // 邮件附带的道具列表
 
         MailDataObject() = default;
@@ -136,6 +167,35 @@ namespace cfl::shm {
             return ret >= 0;
         }
 
+        /**
+         * @brief 批量创建或替换邮件记录（多行 REPLACE，一个事务）
+         * @param mails 邮件，如一次群发生成的所有个人邮件
+         * @return 全部成功时返回 true，失败时整体回滚
+         */
+        static bool create_batch(std::span<const MailDataObject *const> mails) {
+            auto writer = cfl::db::MySQLUtil::batch_writer(
+                    "db_game", "mail",
+                    {"roleid", "id", "groupid", "mailtype", "mailstatus", "senderid", "sendername", "title", "content",
+                     "mail_time", "itemdata"});
+            for (auto mail: mails) {
+                if (!writer.add_row(mail->role_id,
+                                    mail->guid,
+                                    mail->group_guid,
+                                    mail->mail_type,
+                                    mail->status,
+                                    mail->sender_id,
+                                    std::string_view(mail->sender),
+                                    std::string_view(mail->title),
+                                    std::string_view(mail->content),
+                                    mail->time,
+                                    std::string_view(reinterpret_cast<const char *>(mail->items.data()),
+                                                     sizeof(StMailItem) * mail->items.size()))) {
+                    return false;
+                }
+            }
+            return writer.commit();
+        }
+
         /**
          * @brief 更新邮件数据
          * @return 操作是否成功
@@ -153,6 +213,69 @@ namespace cfl::shm {
         }
     };
 
+    /**
+     * @brief 玩家收到的群发邮件（引用）
+     * 只保存玩家自己的状态，标题、内容、发送者和道具在读取时从 GroupMailDataObject 解析。
+     * 数据库中与个人邮件同表，只写入个人列，标题、内容和道具列保持为空。
+     */
+    struct GroupMailStateObject : public SharedObject {
+        std::uint64_t guid{};               // 记录唯一ID（数据库主键）
+        std::uint64_t role_id{};            // 接收玩家ID
+        std::uint64_t group_guid{};         // 引用的群发邮件ID，同时作为客户端看到的邮件ID
+        std::uint64_t time{};               // 接收时间
+        std::int32_t mail_type{};           // 邮件类型
+        std::int32_t status{};              // 邮件状态（MailStatus，mail_received 表示奖励已领取）
+
+        GroupMailStateObject() = default;
+        ~GroupMailStateObject() = default;
+
+        /**
+         * @brief 创建或替换数据库中的记录
+         * @return 操作是否成功
+         */
+        bool create() {
+            int ret = cfl::db::MySQLUtil::execute_prepared(
+                    "db_game",
+                    "REPLACE INTO mail (roleid, id, groupid, mailtype, mailstatus, mail_time) VALUES(?,?,?,?,?,?);",
+                    role_id,
+                    guid,
+                    group_guid,
+                    mail_type,
+                    status,
+                    time
+            );
+            return ret >= 0;
+        }
+
+        /**
+         * @brief 批量创建或替换记录（多行 REPLACE，一个事务）
+         * @param states 记录，如一次群发时所有在线玩家的引用
+         * @return 全部成功时返回 true，失败时整体回滚
+         */
+        static bool create_batch(std::span<const GroupMailStateObject *const> states) {
+            auto writer = cfl::db::MySQLUtil::batch_writer(
+                    "db_game", "mail", {"roleid", "id", "groupid", "mailtype", "mailstatus", "mail_time"});
+            for (auto state: states) {
+                if (!writer.add_row(state->role_id,
+                                    state->guid,
+                                    state->group_guid,
+                                    state->mail_type,
+                                    state->status,
+                                    state->time)) {
+                    return false;
+                }
+            }
+            return writer.commit();
+        }
+
+        bool update() { return create(); }
+
+        bool remove() const {
+            int ret = cfl::db::MySQLUtil::execute_prepared("db_game", "DELETE FROM mail WHERE id = ?;", guid);
+            return ret >= 0;
+        }
+    };
+
     /**
      * @brief 离线数据对象
      * 用于记录离线事件，例如离线奖励、消息等
@@ -195,4 +318,72 @@ namespace cfl::shm {
         bool remove() const noexcept { return true; }
     };
 
+    /// 个人邮件句柄，邮件删除后立即回收共享内存块
+    using MailRef = ShmRef<MailDataObject>;
+
+    /// 群发邮件引用句柄
+    using GroupMailStateRef = ShmRef<GroupMailStateObject>;
+
+    /**
+     * @brief 邮件相关对象的共享内存布局描述
+     * @note 修改字段时递增对应的 version，并按需注册从旧版本迁移的函数
+     */
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+#endif
+    template<>
+    struct ShmLayout<GroupMailDataObject> {
+        static constexpr std::uint32_t version = 1;
+        static constexpr std::uint64_t fingerprint = shm_layout_fingerprint(
+                sizeof(GroupMailDataObject), alignof(GroupMailDataObject), {
+                        CFL_SHM_FIELD(GroupMailDataObject, guid),
+                        CFL_SHM_FIELD(GroupMailDataObject, title),
+                        CFL_SHM_FIELD(GroupMailDataObject, content),
+                        CFL_SHM_FIELD(GroupMailDataObject, sender),
+                        CFL_SHM_FIELD(GroupMailDataObject, time),
+                        CFL_SHM_FIELD(GroupMailDataObject, mail_type),
+                        CFL_SHM_FIELD(GroupMailDataObject, channel),
+                        CFL_SHM_FIELD(GroupMailDataObject, language),
+                        CFL_SHM_FIELD(GroupMailDataObject, items),
+                        CFL_SHM_FIELD(GroupMailDataObject, group_type),
+                });
+    };
+
+    template<>
+    struct ShmLayout<MailDataObject> {
+        static constexpr std::uint32_t version = 1;
+        static constexpr std::uint64_t fingerprint = shm_layout_fingerprint(
+                sizeof(MailDataObject), alignof(MailDataObject), {
+                        CFL_SHM_FIELD(MailDataObject, guid),
+                        CFL_SHM_FIELD(MailDataObject, role_id),
+                        CFL_SHM_FIELD(MailDataObject, group_guid),
+                        CFL_SHM_FIELD(MailDataObject, time),
+                        CFL_SHM_FIELD(MailDataObject, sender_id),
+                        CFL_SHM_FIELD(MailDataObject, mail_type),
+                        CFL_SHM_FIELD(MailDataObject, status),
+                        CFL_SHM_FIELD(MailDataObject, sender),
+                        CFL_SHM_FIELD(MailDataObject, title),
+                        CFL_SHM_FIELD(MailDataObject, content),
+                        CFL_SHM_FIELD(MailDataObject, items),
+                });
+    };
+
+    template<>
+    struct ShmLayout<GroupMailStateObject> {
+        static constexpr std::uint32_t version = 1;
+        static constexpr std::uint64_t fingerprint = shm_layout_fingerprint(
+                sizeof(GroupMailStateObject), alignof(GroupMailStateObject), {
+                        CFL_SHM_FIELD(GroupMailStateObject, guid),
+                        CFL_SHM_FIELD(GroupMailStateObject, role_id),
+                        CFL_SHM_FIELD(GroupMailStateObject, group_guid),
+                        CFL_SHM_FIELD(GroupMailStateObject, time),
+                        CFL_SHM_FIELD(GroupMailStateObject, mail_type),
+                        CFL_SHM_FIELD(GroupMailStateObject, status),
+                });
+    };
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
 } // namespace cfl
@@ -1,16 +1,75 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <array>
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
 #include <ranges>
+#include <span>
+#include <vector>
 #include "cfl/cfl.h"
 #include "cfl/db/db.h"
 #include "cfl/db/db_mysql.h"
 #include "cfl/db/db_sqlite.h"
+#include "cfl/db/db_async.h"
+#include "cfl/shm/shmlayout.h"
+#include "cfl/shm/shmref.h"
 
 namespace cfl::shm {
 
+    /**
+     * @brief 角色表可增量更新的字段表（字段编号, 列名, 成员）
+     *
+     * @details 字段编号即脏位图中的位序号，新增列时只需在这里追加一行，
+     * 字段枚举、列名表、按位绑定都会由该表自动生成。主键 id 不在表内。
+     */
+#define CFL_ROLE_DATA_FIELDS(X)                 \
+        X(AccountId,   "accountid",  accountId)     \
+        X(Name,        "name",       name)          \
+        X(CarrerId,    "carrerid",   carrerId)      \
+        X(Level,       "level",      level)         \
+        X(CityCopyId,  "citycopyid", cityCopyId)    \
+        X(Exp,         "exp",        exp)           \
+        X(LangId,      "langid",     langId)        \
+        X(VipLevel,    "viplevel",   vipLevel)      \
+        X(VipExp,      "vipexp",     vipExp)        \
+        X(Action1,     "action1",    action[0])     \
+        X(Action2,     "action2",    action[1])     \
+        X(Action3,     "action3",    action[2])     \
+        X(Action4,     "action4",    action[3])     \
+        X(Actime1,     "actime1",    actime[0])     \
+        X(Actime2,     "actime2",    actime[1])     \
+        X(Actime3,     "actime3",    actime[2])     \
+        X(Actime4,     "actime4",    actime[3])     \
+        X(CreateTime,  "createtime", createTime)    \
+        X(LogonTime,   "logontime",  logonTime)     \
+        X(LogoffTime,  "logofftime", logoffTime)    \
+        X(GroupTime,   "grouptime",  groupMailTime) \
+        X(FightValue,  "fightvalue", fightValue)    \
+        X(GuildId,     "guildid",    guildId)
+
+    /**
+     * @brief 角色表字段编号，对应脏位图中的位
+     */
+    enum class RoleField : std::uint8_t {
+#define CFL_ROLE_FIELD_ENUM(id, column, member) id,
+        CFL_ROLE_DATA_FIELDS(CFL_ROLE_FIELD_ENUM)
+#undef CFL_ROLE_FIELD_ENUM
+        Count
+    };
+
+    static_assert(static_cast<std::size_t>(RoleField::Count) <= 64, "RoleField 超出脏位图容量");
+
+    /// 字段编号 -> 数据库列名
+    inline constexpr std::array<std::string_view, static_cast<std::size_t>(RoleField::Count)> kRoleFieldColumns{
+#define CFL_ROLE_FIELD_COLUMN(id, column, member) column,
+            CFL_ROLE_DATA_FIELDS(CFL_ROLE_FIELD_COLUMN)
+#undef CFL_ROLE_FIELD_COLUMN
+    };
+
     /**
      * @brief 角色数据对象，用于共享内存存储与数据库交互
      *
@@ -18,22 +77,33 @@ namespace cfl::shm {
      * RoleDataObject 是游戏中角色的核心数据结构，既用于服务器共享内存保存，
      * 也支持与 MySQL 数据库交互（保存、更新、删除）。
      * 包含了角色的基础信息、体力、经验、VIP、时间戳等关键数据。
+     *
+     * 字段按访问频率分组并按缓存行对齐：
+     * - 对象头（SharedObject 的状态/时间戳/写序号）独占第一个缓存行；
+     * - 热数据（体力、经验、等级、战斗力等逐帧或频繁修改的字段）集中在随后的缓存行；
+     * - 冷数据（角色名、创建时间、签到等很少修改的字段）从新的缓存行开始。
+     * 逐帧更新大量角色时只会写入对象头和热数据所在的缓存行。
      */
     struct RoleDataObject : public SharedObject {
-        // ================= 基础数据 =================
-        uint64_t roleId{0};                 ///< 角色ID（主键）
-        uint64_t accountId{0};              ///< 账号ID
-        char name[64];                      ///< 角色名
-        uint32_t carrerId{0};                ///< 职业ID
-        uint32_t level{0};                   ///< 等级
+        // ================= 热数据 =================
+        alignas(kShmCacheLineSize)
         std::array<int64_t, cfl::ActionNum> action{};   ///< 体力
         std::array<int64_t, cfl::ActionNum> actime{};   ///< 体力恢复时间
+        uint64_t roleId{0};                 ///< 角色ID（主键）
         int64_t exp{0};                     ///< 经验值
-        int32_t langId{0};                  ///< 语言ID
         int64_t fightValue{0};              ///< 战斗力
+        uint32_t level{0};                   ///< 等级
+        uint32_t onlineTime{0};             ///< 在线时长（秒）
         int32_t vipLevel{0};                ///< VIP等级
         int32_t vipExp{0};                  ///< VIP经验
         int32_t cityCopyId{0};              ///< 副本ID
+
+        // ================= 冷数据 =================
+        alignas(kShmCacheLineSize)
+        uint64_t accountId{0};              ///< 账号ID
+        char name[64];                      ///< 角色名
+        uint32_t carrerId{0};                ///< 职业ID
+        int32_t langId{0};                  ///< 语言ID
         int32_t channel{0};                 ///< 渠道号
         bool isDeleted{false};              ///< 是否已删除标志位
         int64_t qq{0};                      ///< QQ号
@@ -42,7 +112,6 @@ namespace cfl::shm {
         uint64_t logoffTime{0};             ///< 下线时间
         uint64_t groupMailTime{0};          ///< 群邮件时间戳
         uint64_t guildId{0};                ///< 公会ID
-        uint32_t onlineTime{0};             ///< 在线时长（秒）
 
         // ================= 签到数据 =================
         int32_t signNum{0};                 ///< 累计签到次数
@@ -57,6 +126,74 @@ namespace cfl::shm {
         RoleDataObject &operator=(RoleDataObject &&) noexcept = default;
         ~RoleDataObject() = default;
 
+        // ================= 脏字段 =================
+        using SharedObject::mark_dirty;
+
+        /// 字段对应的位
+        static constexpr std::uint64_t field_bit(RoleField field) noexcept {
+            return std::uint64_t{1} << static_cast<std::size_t>(field);
+        }
+
+        /// 所有字段的位图
+        static constexpr std::uint64_t all_fields_mask() noexcept {
+            return field_bit(RoleField::Count) - 1;
+        }
+
+        /// 第 index 个体力值对应的字段（index 从 0 开始）
+        static constexpr RoleField action_field(std::size_t index) noexcept {
+            return static_cast<RoleField>(static_cast<std::size_t>(RoleField::Action1) + index);
+        }
+
+        /// 第 index 个体力恢复时间对应的字段（index 从 0 开始）
+        static constexpr RoleField actime_field(std::size_t index) noexcept {
+            return static_cast<RoleField>(static_cast<std::size_t>(RoleField::Actime1) + index);
+        }
+
+        /// 标记字段已修改
+        void mark_dirty(RoleField field) noexcept { mark_dirty_mask(field_bit(field)); }
+
+        /**
+         * @brief 按字段编号取成员引用
+         */
+        template<RoleField F>
+        [[nodiscard]] auto &field() noexcept {
+            static_assert(F < RoleField::Count, "无效的 RoleField");
+#define CFL_ROLE_FIELD_REF(id, column, member) if constexpr (F == RoleField::id) return (member); else
+            CFL_ROLE_DATA_FIELDS(CFL_ROLE_FIELD_REF)
+#undef CFL_ROLE_FIELD_REF
+            return (roleId);
+        }
+
+        /**
+         * @brief 类型安全的字段写入，值发生变化时才置脏位
+         *
+         * @code
+         * role->set<RoleField::Exp>(role->exp + 100);
+         * role->set<RoleField::Name>("new_name");
+         * @endcode
+         */
+        template<RoleField F, class V>
+        void set(const V &value) noexcept {
+            auto &ref = field<F>();
+            using T = std::remove_reference_t<decltype(ref)>;
+            if constexpr (std::is_array_v<T>) {
+                std::string_view src(value);
+                src = src.substr(0, std::min(src.size(), std::extent_v<T> - 1));
+                if (src == std::string_view(ref)) {
+                    return;
+                }
+                std::memcpy(ref, src.data(), src.size());
+                ref[src.size()] = '\0';
+            } else {
+                auto v = static_cast<T>(value);
+                if (ref == v) {
+                    return;
+                }
+                ref = v;
+            }
+            mark_dirty(F);
+        }
+
         // ================= 数据库接口 =================
 
         /**
@@ -69,6 +206,7 @@ namespace cfl::shm {
          */
         [[nodiscard]]
         bool Save() {
+            auto mask = take_dirty_mask();
             int ret = cfl::db::MySQLUtil::execute_prepared(
                     "gameserver",
                     "REPLACE INTO role "
@@ -97,6 +235,9 @@ namespace cfl::shm {
                     fightValue,
                     guildId
             );
+            if (ret < 0) {
+                mark_dirty_mask(mask);
+            }
             return ret >= 0;
         }
 
@@ -110,6 +251,7 @@ namespace cfl::shm {
          */
         [[nodiscard]]
         bool SaveSQLite() {
+            auto mask = take_dirty_mask();
             int ret = cfl::db::SQLiteUtil::execute_prepared(
                     "gameserver",
                     "INSERT OR REPLACE INTO role "
@@ -138,13 +280,67 @@ namespace cfl::shm {
                     fightValue,
                     guildId
             );
+            if (ret < 0) {
+                mark_dirty_mask(mask);
+            }
             return ret >= 0;
         }
 
+        /**
+         * @brief 批量保存角色数据（多行插入，主键冲突时更新，所有行在一个事务中）
+         *
+         * @details 停服或定时存盘时代替逐个 Save / SaveSQLite，每条语句最多写入 BatchOptions::max_rows 行，
+         * 往返次数按批次数而不是角色数计算。已有记录只更新列出的列，isdelete 等其他列保持不变。
+         * 失败时整个事务回滚，所有角色的脏位被还原。
+         *
+         * @param roles 要保存的角色
+         * @param sqlite 写入 SQLite（INSERT OR REPLACE）而不是 MySQL
+         * @return true 全部保存成功
+         */
+        [[nodiscard]]
+        static bool SaveBatch(std::span<RoleDataObject *const> roles, bool sqlite = false) {
+            if (roles.empty()) {
+                return true;
+            }
+            auto columns = std::vector<std::string>{
+                    "id", "accountid", "name", "carrerid", "level", "citycopyid", "exp", "langid", "viplevel", "vipexp",
+                    "action1", "action2", "action3", "action4", "actime1", "actime2", "actime3", "actime4",
+                    "createtime", "logontime", "logofftime", "grouptime", "fightvalue", "guildid"};
+            cfl::db::BatchOptions options;
+            options.mode = cfl::db::BatchMode::Upsert;
+            auto writer = sqlite ? cfl::db::SQLiteUtil::batch_writer("gameserver", "role", std::move(columns), options)
+                                 : cfl::db::MySQLUtil::batch_writer("gameserver", "role", std::move(columns), options);
+            std::vector<std::uint64_t> masks;
+            masks.reserve(roles.size());
+            bool ok = true;
+            for (auto role: roles) {
+                masks.push_back(role->take_dirty_mask());
+                ok = writer.add_row(role->roleId, role->accountId, std::string_view(role->name), role->carrerId,
+                                    role->level, role->cityCopyId, role->exp, role->langId, role->vipLevel,
+                                    role->vipExp,
+                                    role->action[0], role->action[1], role->action[2], role->action[3],
+                                    role->actime[0], role->actime[1], role->actime[2], role->actime[3],
+                                    role->createTime, role->logonTime, role->logoffTime, role->groupMailTime,
+                                    role->fightValue, role->guildId);
+                if (!ok) {
+                    break;
+                }
+            }
+            ok = ok && writer.commit();
+            if (!ok) {
+                writer.rollback();
+                for (std::size_t i = 0; i < masks.size(); ++i) {
+                    roles[i]->mark_dirty_mask(masks[i]);
+                }
+            }
+            return ok;
+        }
+
         /**
          * @brief 更新角色数据（只修改已有记录，不插入新记录）
          *
-         * @details 使用 MySQL 的 `UPDATE` 语句，根据 `id` 更新已有记录。
+         * @details 使用 MySQL 的 `UPDATE` 语句，根据 `id` 更新已有记录，
+         * 只写入脏位图中标记的列；没有脏字段时直接返回，不访问数据库。
          * 与 Save 的区别在于：Save 使用 REPLACE INTO，Update 使用 UPDATE。
          *
          * @return true 更新成功
@@ -152,40 +348,13 @@ namespace cfl::shm {
          */
         [[nodiscard]]
         bool Update() {
-            int ret = cfl::db::MySQLUtil::execute_prepared(
-                    "gameserver",
-                    "UPDATE role SET "
-                    "accountid=?, name=?, carrerid=?, level=?, citycopyid=?, exp=?, langid=?, viplevel=?, vipexp=?, "
-                    "action1=?, action2=?, action3=?, action4=?, "
-                    "actime1=?, actime2=?, actime3=?, actime4=?, "
-                    "createtime=?, logontime=?, logofftime=?, grouptime=?, fightvalue=?, guildid=? "
-                    "WHERE id=?",
-                    accountId,
-                    std::string_view(name),
-                    carrerId,
-                    level,
-                    cityCopyId,
-                    exp,
-                    langId,
-                    vipLevel,
-                    vipExp,
-                    action[0], action[1], action[2], action[3],
-                    actime[0], actime[1], actime[2], actime[3],
-                    createTime,
-                    logonTime,
-                    logoffTime,
-                    groupMailTime,
-                    fightValue,
-                    guildId,
-                    roleId  ///< WHERE 条件
-            );
-            return ret >= 0;
+            return update_dirty_fields(cfl::db::MySQLMgr::instance()->get("gameserver"), 1);
         }
 
         /**
          * @brief 更新角色数据到SQLite（只修改已有记录，不插入新记录）
          *
-         * @details 使用 SQLite 的 `UPDATE` 语句，根据 [id](file://D:\cProjet\gameserver\net\cmake-build-debug\_deps\mysqlcpp-src\jdbc\examples\examples.h#L77-L77) 更新已有记录。
+         * @details 使用 SQLite 的 `UPDATE` 语句，根据 `id` 更新已有记录，只写入脏字段。
          * 与 SaveSQLite 的区别在于：SaveSQLite 使用 INSERT OR REPLACE，UpdateSQLite 使用 UPDATE。
          *
          * @return true 更新成功
@@ -193,34 +362,49 @@ namespace cfl::shm {
          */
         [[nodiscard]]
         bool UpdateSQLite() {
-            int ret = cfl::db::SQLiteUtil::execute_prepared(
-                    "gameserver",
-                    "UPDATE role SET "
-                    "accountid=?, name=?, carrerid=?, level=?, citycopyid=?, exp=?, langid=?, viplevel=?, vipexp=?, "
-                    "action1=?, action2=?, action3=?, action4=?, "
-                    "actime1=?, actime2=?, actime3=?, actime4=?, "
-                    "createtime=?, logontime=?, logofftime=?, grouptime=?, fightvalue=?, guildid=? "
-                    "WHERE id=?",
-                    accountId,
-                    std::string_view(name),
-                    carrerId,
-                    level,
-                    cityCopyId,
-                    exp,
-                    langId,
-                    vipLevel,
-                    vipExp,
-                    action[0], action[1], action[2], action[3],
-                    actime[0], actime[1], actime[2], actime[3],
-                    createTime,
-                    logonTime,
-                    logoffTime,
-                    groupMailTime,
-                    fightValue,
-                    guildId,
-                    roleId  ///< WHERE 条件
-            );
-            return ret >= 0;
+            return update_dirty_fields(cfl::db::SQLiteMgr::instance()->get("gameserver"), 0);
+        }
+
+        /**
+         * @brief 异步更新角色数据（只写入脏字段）
+         *
+         * @details 在调用线程取走脏位图并拷贝一致性快照，SQL 在 AsyncDb 的工作线程执行，
+         * 同一角色的更新按提交顺序执行。失败时在逻辑线程 poll 回调中还原脏位（角色对象仍存活时）。
+         * 只能在逻辑线程调用。
+         *
+         * @param done 完成回调，在逻辑线程执行（可为空）
+         * @return 没有脏字段或已提交时返回 true
+         */
+        bool UpdateAsync(std::function<void(bool)> done = {}) {
+            auto mask = take_dirty_mask();
+            if (mask == 0) {
+                return true;
+            }
+            auto copy = snapshot<RoleDataObject>();
+            if (!copy) {
+                mark_dirty_mask(mask);
+                return false;
+            }
+            auto ref = ShmRef<RoleDataObject>::from_object(SHMTYPE::RoleData, this);
+            bool submitted = cfl::db::AsyncDbMgr::instance()->submit<bool>(
+                    "gameserver", roleId,
+                    [copy = *copy, mask](const cfl::db::Database::Ptr &db) {
+                        return update_fields(db, 1, mask, *copy);
+                    },
+                    [ref, mask, done = std::move(done)](bool ok) {
+                        if (!ok) {
+                            if (auto object = ref.get()) {
+                                object->mark_dirty_mask(mask);
+                            }
+                        }
+                        if (done) {
+                            done(ok);
+                        }
+                    });
+            if (!submitted) {
+                mark_dirty_mask(mask);
+            }
+            return submitted;
         }
 
         /**
@@ -258,5 +442,119 @@ namespace cfl::shm {
             );
             return ret >= 0;
         }
+
+    private:
+        /// 绑定单个字段，字符数组按字符串绑定
+        template<class T>
+        static int bind_field(cfl::db::Statement &stmt, int idx, const T &value) {
+            if constexpr (std::is_array_v<T>) {
+                return stmt.bind(idx, std::string_view(value));
+            } else {
+                return stmt.bind(idx, value);
+            }
+        }
+
+        /**
+         * @brief 按脏位图生成部分 UPDATE 并执行
+         *
+         * @param db 数据库连接
+         * @param first_index 第一个占位符的绑定下标（MySQL 从 1 开始，SQLite 从 0 开始）
+         * @return true 更新成功或无脏字段
+         * @return false 更新失败，脏位会被还原以便下次重试
+         */
+        bool update_dirty_fields(const cfl::db::Database::Ptr &db, int first_index) {
+            auto mask = take_dirty_mask();
+            if (mask == 0) {
+                return true;
+            }
+            if (!update_fields(db, first_index, mask, *this)) {
+                mark_dirty_mask(mask);
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief 按位图把 values 中的字段写入数据库
+         * @details 不读写脏位图，values 可以是共享内存中的对象，也可以是快照副本。
+         */
+        static bool update_fields(const cfl::db::Database::Ptr &db, int first_index, std::uint64_t mask,
+                                  const RoleDataObject &values) {
+            if (!db) {
+                return false;
+            }
+
+            std::string sql = "UPDATE role SET ";
+            for (std::size_t i = 0; i < kRoleFieldColumns.size(); ++i) {
+                if (mask & (std::uint64_t{1} << i)) {
+                    sql.append(kRoleFieldColumns[i]).append("=?,");
+                }
+            }
+            sql.back() = ' ';
+            sql.append("WHERE id=?");
+
+            auto stmt = db->prepare(sql);
+            if (!stmt) {
+                return false;
+            }
+
+            int idx = first_index;
+#define CFL_ROLE_FIELD_BIND(id, column, member) \
+            if (mask & field_bit(RoleField::id)) { bind_field(*stmt, idx++, values.member); }
+            CFL_ROLE_DATA_FIELDS(CFL_ROLE_FIELD_BIND)
+#undef CFL_ROLE_FIELD_BIND
+            stmt->bind(idx, values.roleId);
+
+            return stmt->execute() >= 0;
+        }
+    };
+
+    /**
+     * @brief RoleDataObject 的共享内存布局描述
+     * @note 修改 RoleDataObject 的字段时递增 version，并按需注册从旧版本迁移的函数
+     */
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+#endif
+    static_assert(offsetof(RoleDataObject, action) == kShmCacheLineSize, "对象头必须独占第一个缓存行");
+    static_assert(offsetof(RoleDataObject, cityCopyId) < offsetof(RoleDataObject, action) + 2 * kShmCacheLineSize,
+                  "热数据超出两个缓存行");
+    static_assert(offsetof(RoleDataObject, accountId) % kShmCacheLineSize == 0, "冷数据必须从新的缓存行开始");
+
+    template<>
+    struct ShmLayout<RoleDataObject> {
+        static constexpr std::uint32_t version = 2;
+        static constexpr std::uint64_t fingerprint = shm_layout_fingerprint(
+                sizeof(RoleDataObject), alignof(RoleDataObject), {
+                        CFL_SHM_FIELD(RoleDataObject, roleId),
+                        CFL_SHM_FIELD(RoleDataObject, accountId),
+                        CFL_SHM_FIELD(RoleDataObject, name),
+                        CFL_SHM_FIELD(RoleDataObject, carrerId),
+                        CFL_SHM_FIELD(RoleDataObject, level),
+                        CFL_SHM_FIELD(RoleDataObject, action),
+                        CFL_SHM_FIELD(RoleDataObject, actime),
+                        CFL_SHM_FIELD(RoleDataObject, exp),
+                        CFL_SHM_FIELD(RoleDataObject, langId),
+                        CFL_SHM_FIELD(RoleDataObject, fightValue),
+                        CFL_SHM_FIELD(RoleDataObject, vipLevel),
+                        CFL_SHM_FIELD(RoleDataObject, vipExp),
+                        CFL_SHM_FIELD(RoleDataObject, cityCopyId),
+                        CFL_SHM_FIELD(RoleDataObject, channel),
+                        CFL_SHM_FIELD(RoleDataObject, isDeleted),
+                        CFL_SHM_FIELD(RoleDataObject, qq),
+                        CFL_SHM_FIELD(RoleDataObject, createTime),
+                        CFL_SHM_FIELD(RoleDataObject, logonTime),
+                        CFL_SHM_FIELD(RoleDataObject, logoffTime),
+                        CFL_SHM_FIELD(RoleDataObject, groupMailTime),
+                        CFL_SHM_FIELD(RoleDataObject, guildId),
+                        CFL_SHM_FIELD(RoleDataObject, onlineTime),
+                        CFL_SHM_FIELD(RoleDataObject, signNum),
+                        CFL_SHM_FIELD(RoleDataObject, signDay),
+                        CFL_SHM_FIELD(RoleDataObject, recvAction),
+                });
     };
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
 }
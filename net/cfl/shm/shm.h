@@ -55,11 +55,11 @@ namespace cfl::shm {
 #endif
     }
 
-    /// 打开共享内存
-    inline std::optional<ShmHandle> OpenShareMemory(std::size_t moduleId, std::size_t page) {
+    /// 打开共享内存，read_only 为 true 时只申请读权限
+    inline std::optional<ShmHandle> OpenShareMemory(std::size_t moduleId, std::size_t page, bool read_only = false) {
 #if defined(_WIN32)
         auto name = std::format("SM_{}", (moduleId << 16) | page);
-        HANDLE hShare = OpenFileMappingA(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, name.c_str());
+        HANDLE hShare = OpenFileMappingA(read_only ? FILE_MAP_READ : FILE_MAP_READ | FILE_MAP_WRITE, FALSE, name.c_str());
         if (!hShare) {
             return std::nullopt;
         }
@@ -74,15 +74,18 @@ namespace cfl::shm {
 #endif
     }
 
-    // 根据句柄获取共享内存地址
-    inline char *GetShareMemory(std::optional<ShmHandle> hShm) {
+    // 根据句柄获取共享内存地址，read_only 为 true 时以只读方式映射，写入会触发访问违例
+    inline char *GetShareMemory(std::optional<ShmHandle> hShm, bool read_only = false) {
         if (!hShm.has_value()) {
             return nullptr;
         }
 #ifdef WIN32
-        char *pdata = (char *) MapViewOfFile(hShm.value(), FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0);
+        char *pdata = (char *) MapViewOfFile(hShm.value(), read_only ? FILE_MAP_READ : FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0);
 #else
-        char* pdata = (char*)shmat(hShm.value(), (void*)0, 0);
+        char* pdata = (char*)shmat(hShm.value(), (void*)0, read_only ? SHM_RDONLY : 0);
+        if (pdata == reinterpret_cast<char *>(-1)) {
+            return nullptr;
+        }
 #endif
         return pdata;
     }
@@ -103,6 +106,15 @@ namespace cfl::shm {
 #endif
     }
 
+    /// 关闭句柄但保留共享内存（Linux 下句柄只是标识符，无需关闭）
+    inline void DetachShareMemoryHandle(std::optional<ShmHandle> hShm) {
+#ifdef WIN32
+        if (hShm.has_value()) {
+            CloseHandle(hShm.value());
+        }
+#endif
+    }
+
     inline std::size_t get_last_error()
     {
 #ifdef WIN32
@@ -0,0 +1,195 @@
+#include "shmchangelog.h"
+#include <bit>
+#include <new>
+#include "spdlog/spdlog.h"
+#include "shmpage.h"
+
+namespace cfl::shm {
+
+    namespace {
+        /// 当前进程中接收 unlock 变更的日志
+        std::atomic<ShmChangeLog *> g_installed{nullptr};
+    }
+
+    void publish_change(const SharedObject &object) noexcept {
+        if (auto log = g_installed.load(std::memory_order_acquire)) {
+            log->publish(object);
+        }
+    }
+
+    ShmChangeLog::ShmChangeLog(std::size_t module_id, std::size_t capacity, bool attach_only)
+            : module_id_(module_id), attach_only_(attach_only) {
+        auto handle = OpenShareMemory(module_id_, 0);
+        bool created = false;
+        if (!handle.has_value()) {
+            if (attach_only_) {
+                spdlog::warn("[ShmChangeLog] module_id = {} not present", module_id_);
+                return;
+            }
+            capacity = std::bit_ceil(std::max<std::size_t>(capacity, 2));
+            handle = CreateShareMemory(module_id_, 0, sizeof(ShmChangeLogHeader) + capacity * sizeof(ShmChangeRecord));
+            if (!handle.has_value()) {
+                spdlog::error("[ShmChangeLog] CreateShareMemory failed: module_id = {}, error = {}", module_id_,
+                              get_last_error_str(static_cast<int>(get_last_error())));
+                return;
+            }
+            created = true;
+        }
+        handle_ = handle;
+        base_ = GetShareMemory(handle_);
+        if (base_ == nullptr) {
+            spdlog::error("[ShmChangeLog] GetShareMemory failed: module_id = {}", module_id_);
+            return;
+        }
+
+        if (created) {
+            auto header = new(base_) ShmChangeLogHeader();
+            header->capacity = capacity;
+            header->version = kShmChangeLogVersion;
+            std::atomic_thread_fence(std::memory_order_release);
+            header->magic = kShmChangeLogMagic;
+        }
+        auto header = reinterpret_cast<ShmChangeLogHeader *>(base_);
+        if (header->magic != kShmChangeLogMagic || header->version != kShmChangeLogVersion
+            || !std::has_single_bit(header->capacity)) {
+            spdlog::error("[ShmChangeLog] module_id = {} header mismatch, not attached", module_id_);
+            return;
+        }
+        if (!created && header->capacity != std::bit_ceil(std::max<std::size_t>(capacity, 2)) && !attach_only_) {
+            spdlog::warn("[ShmChangeLog] module_id = {} keeps existing capacity {}", module_id_, header->capacity);
+        }
+        header_ = header;
+        mask_ = header_->capacity - 1;
+        cached_tail_ = header_->tail.load(std::memory_order_acquire);
+        cached_head_ = header_->head.load(std::memory_order_acquire);
+        spdlog::info("[ShmChangeLog] module_id = {} {}, capacity {}, pending {}", module_id_,
+                     created ? "created" : "attached", this->capacity(), pending());
+    }
+
+    ShmChangeLog::~ShmChangeLog() {
+        auto expected = this;
+        g_installed.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+        if (base_ != nullptr) {
+            ReleaseShareMemory(base_);
+            base_ = nullptr;
+            header_ = nullptr;
+        }
+        if (handle_.has_value()) {
+            if (attach_only_) {
+                DetachShareMemoryHandle(handle_);
+            } else {
+                CloseShareMemory(handle_);
+            }
+            handle_.reset();
+        }
+    }
+
+    bool ShmChangeLog::watch(std::size_t pool_id, SharedMemoryManagerBase &pool) {
+        if (pool_id >= kShmChangeLogMaxPools) {
+            spdlog::error("[ShmChangeLog] watch: pool_id = {} out of range", pool_id);
+            return false;
+        }
+        pools_[pool_id] = &pool;
+        pool.set_change_slot(static_cast<std::uint8_t>(pool_id + 1));
+        return true;
+    }
+
+    void ShmChangeLog::unwatch_all() {
+        for (auto &pool: pools_) {
+            if (pool != nullptr) {
+                pool->set_change_slot(0);
+                pool = nullptr;
+            }
+        }
+    }
+
+    bool ShmChangeLog::push(const ShmChangeRecord &record) noexcept {
+        if (header_ == nullptr) {
+            return false;
+        }
+        auto head = header_->head.load(std::memory_order_relaxed);
+        if (head - cached_tail_ > mask_) {
+            cached_tail_ = header_->tail.load(std::memory_order_acquire);
+            if (head - cached_tail_ > mask_) {
+                // 写满：丢弃记录，由消费者全量扫描兜底
+                ++dropped_;
+                header_->overflow.fetch_add(1, std::memory_order_release);
+                return false;
+            }
+        }
+        records()[head & mask_] = record;
+        header_->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void ShmChangeLog::publish(const SharedObject &object) noexcept {
+        auto slot = object.change_slot();
+        if (slot == 0 || pools_[slot - 1] == nullptr) {
+            return;
+        }
+        auto header = pools_[slot - 1]->find_used_block_header(&object);
+        if (header == nullptr) {
+            return;
+        }
+        push({slot - 1u, header->generation, header->index, object.dirty_mask(), object.sequence()});
+    }
+
+    void ShmChangeLog::mark_overflow() noexcept {
+        if (header_ != nullptr) {
+            header_->overflow.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    void ShmChangeLog::install(ShmChangeLog *log) noexcept {
+        g_installed.store(log, std::memory_order_release);
+    }
+
+    ShmChangeLog *ShmChangeLog::installed() noexcept {
+        return g_installed.load(std::memory_order_acquire);
+    }
+
+    bool ShmChangeLog::need_full_scan() noexcept {
+        if (header_ == nullptr) {
+            return false;
+        }
+        auto overflow = header_->overflow.load(std::memory_order_acquire);
+        if (overflow == seen_overflow_) {
+            return false;
+        }
+        seen_overflow_ = overflow;
+        return true;
+    }
+
+    std::size_t ShmChangeLog::consume(const std::function<void(const ShmChangeRecord &)> &visitor,
+                                      std::size_t max_records) {
+        if (header_ == nullptr || !visitor) {
+            return 0;
+        }
+        auto tail = header_->tail.load(std::memory_order_relaxed);
+        if (cached_head_ == tail) {
+            cached_head_ = header_->head.load(std::memory_order_acquire);
+        }
+        std::size_t count = 0;
+        while (tail != cached_head_ && count < max_records) {
+            auto record = records()[tail & mask_];
+            ++tail;
+            ++count;
+            // 先归还槽位再回调，回调耗时不影响生产者
+            header_->tail.store(tail, std::memory_order_release);
+            visitor(record);
+            if (tail == cached_head_) {
+                cached_head_ = header_->head.load(std::memory_order_acquire);
+            }
+        }
+        return count;
+    }
+
+    std::size_t ShmChangeLog::pending() const noexcept {
+        if (header_ == nullptr) {
+            return 0;
+        }
+        return static_cast<std::size_t>(header_->head.load(std::memory_order_acquire)
+                                         - header_->tail.load(std::memory_order_acquire));
+    }
+
+} // namespace cfl::shm
@@ -0,0 +1,196 @@
+/**
+ * @file shmchangelog.h
+ * @brief 共享内存变更日志：单生产者/单消费者的无锁环形缓冲区
+ *
+ * @details
+ * 持久化拆分到独立进程后（以 attach_only 方式附加共享内存池），逐块扫描整个池
+ * 查找修改的开销与池大小成正比。变更日志放在独立的共享内存段中：
+ * - 生产者（游戏进程）在对象 unlock 时追加一条 (池编号, 块索引, 代数, 脏字段位图, 写序号) 记录；
+ * - 消费者（持久化进程）按顺序取出记录，只处理发生变化的对象；
+ * - 环形缓冲区写满时生产者直接丢弃记录并累加溢出计数，从不等待，
+ *   消费者发现溢出计数变化后退化为一次全量扫描。
+ *
+ * head 只由生产者写，tail 只由消费者写，二者分别位于独立的缓存行，
+ * 双方各自缓存对方的位置，只在看起来写满/读空时才重新读取。
+ *
+ * 消费端的典型用法：
+ * @code
+ * ShmChangeLog log(kShmChangeLogModuleId, 0, true);
+ * while (running) {
+ *     if (log.need_full_scan()) {
+ *         full_scan();   // 溢出或刚启动：全量扫描所有池
+ *     }
+ *     log.consume([](const ShmChangeRecord &record) { persist(record); });
+ * }
+ * @endcode
+ * 先检查溢出再全量扫描，溢出前被丢弃的修改一定发生在扫描开始之前；环中残留的旧记录只会造成重复处理。
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include "shm.h"
+
+namespace cfl::shm {
+
+    class SharedObject;
+    class SharedMemoryManagerBase;
+
+    /// 变更日志共享内存的模块编号，不与 SHMTYPE 对应的池冲突
+    inline constexpr std::size_t kShmChangeLogModuleId = 0x100;
+
+    /// 变更日志魔数 "CFLC"
+    inline constexpr std::uint32_t kShmChangeLogMagic = 0x434C4643;
+
+    /// 变更日志格式版本
+    inline constexpr std::uint32_t kShmChangeLogVersion = 1;
+
+    /// 可登记的池数量上限（对象中的编号为一个字节，0 表示未登记）
+    inline constexpr std::size_t kShmChangeLogMaxPools = 255;
+
+    /**
+     * @brief 一条变更记录
+     */
+    struct ShmChangeRecord {
+        std::uint32_t pool = 0;        ///< 池编号（SHMTYPE）
+        std::uint32_t generation = 0;  ///< 块的代数，与当前块头不一致说明块已被回收
+        std::uint64_t index = 0;       ///< 块索引
+        std::uint64_t dirty_mask = 0;  ///< unlock 时的脏字段位图
+        std::uint64_t sequence = 0;    ///< unlock 后的写序号，不大于已持久化的序号时可以跳过
+    };
+
+    /**
+     * @brief 变更日志共享内存段的头部，记录数组紧随其后
+     */
+    struct ShmChangeLogHeader {
+        std::uint32_t magic = 0;                              ///< 魔数，固定为 kShmChangeLogMagic
+        std::uint32_t version = 0;                            ///< 格式版本
+        std::uint64_t capacity = 0;                           ///< 记录容量（2 的幂）
+        alignas(64) std::atomic<std::uint64_t> head{0};       ///< 下一条写入位置，只由生产者修改
+        alignas(64) std::atomic<std::uint64_t> tail{0};       ///< 下一条读取位置，只由消费者修改
+        alignas(64) std::atomic<std::uint64_t> overflow{0};   ///< 写满丢弃记录的次数，只由生产者修改
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "变更日志要求 64 位原子操作无锁");
+
+    /**
+     * @class ShmChangeLog
+     * @brief 位于独立共享内存段中的变更日志
+     *
+     * @note 生产者和消费者各自只能有一个线程；push/publish 只能在游戏逻辑线程调用。
+     */
+    class ShmChangeLog {
+    public:
+        /**
+         * @param module_id 共享内存模块编号
+         * @param capacity 记录容量，向上取整为 2 的幂；附加到已有日志时以已有容量为准
+         * @param attach_only 只附加到已有日志（消费者），析构时不删除共享内存
+         */
+        explicit ShmChangeLog(std::size_t module_id = kShmChangeLogModuleId, std::size_t capacity = 65536,
+                              bool attach_only = false);
+
+        ~ShmChangeLog();
+
+        ShmChangeLog(const ShmChangeLog &) = delete;
+        ShmChangeLog &operator=(const ShmChangeLog &) = delete;
+
+        /**
+         * @brief 共享内存是否创建/附加成功
+         */
+        [[nodiscard]] bool valid() const noexcept { return header_ != nullptr; }
+
+        /**
+         * @brief 记录容量
+         */
+        [[nodiscard]] std::size_t capacity() const noexcept { return static_cast<std::size_t>(mask_ + 1); }
+
+        // ---------- 生产者 ----------
+        /**
+         * @brief 登记一个共享内存池，之后该池对象 unlock 时会追加变更记录
+         * @param pool_id 池编号（SHMTYPE），小于 kShmChangeLogMaxPools
+         * @param pool 共享内存池
+         * @return 编号超出范围时返回 false
+         */
+        bool watch(std::size_t pool_id, SharedMemoryManagerBase &pool);
+
+        /**
+         * @brief 取消登记所有池
+         */
+        void unwatch_all();
+
+        /**
+         * @brief 追加一条记录，写满时丢弃并累加溢出计数，从不等待
+         * @return 是否写入
+         */
+        bool push(const ShmChangeRecord &record) noexcept;
+
+        /**
+         * @brief 根据对象所在的池和块追加一条记录（由 SharedObject::unlock 调用）
+         */
+        void publish(const SharedObject &object) noexcept;
+
+        /**
+         * @brief 通知消费者做一次全量扫描（如重启恢复期间暂停了发布）
+         */
+        void mark_overflow() noexcept;
+
+        /**
+         * @brief 本进程因写满丢弃的记录数
+         */
+        [[nodiscard]] std::uint64_t dropped() const noexcept { return dropped_; }
+
+        /**
+         * @brief 设置当前进程中接收 SharedObject::unlock 变更的日志
+         * @param log 变更日志，nullptr 表示暂停发布
+         */
+        static void install(ShmChangeLog *log) noexcept;
+
+        /**
+         * @brief 当前进程中启用的变更日志（可能为 nullptr）
+         */
+        static ShmChangeLog *installed() noexcept;
+
+        // ---------- 消费者 ----------
+        /**
+         * @brief 自上次调用以来是否发生过溢出，需要全量扫描
+         * @details 消费者首次调用总是返回 true（刚启动时没有可依赖的基准）。
+         */
+        bool need_full_scan() noexcept;
+
+        /**
+         * @brief 按顺序取出记录
+         * @param visitor 记录回调
+         * @param max_records 本次最多取出的记录数
+         * @return 取出的记录数
+         */
+        std::size_t consume(const std::function<void(const ShmChangeRecord &)> &visitor,
+                            std::size_t max_records = SIZE_MAX);
+
+        /**
+         * @brief 尚未取出的记录数（近似值）
+         */
+        [[nodiscard]] std::size_t pending() const noexcept;
+
+    private:
+        ShmChangeRecord *records() const noexcept {
+            return reinterpret_cast<ShmChangeRecord *>(base_ + sizeof(ShmChangeLogHeader));
+        }
+
+        std::size_t module_id_;                         ///< 共享内存模块编号
+        bool attach_only_;                              ///< 只附加，不创建、不删除共享内存
+        std::optional<ShmHandle> handle_{};             ///< 共享内存句柄
+        char *base_ = nullptr;                          ///< 映射地址
+        ShmChangeLogHeader *header_ = nullptr;          ///< 头部
+        std::uint64_t mask_ = 0;                        ///< capacity - 1
+        std::uint64_t cached_tail_ = 0;                 ///< 生产者缓存的 tail
+        std::uint64_t cached_head_ = 0;                 ///< 消费者缓存的 head
+        std::uint64_t seen_overflow_ = UINT64_MAX;      ///< 消费者上次看到的溢出计数
+        std::uint64_t dropped_ = 0;                     ///< 本进程丢弃的记录数
+        SharedMemoryManagerBase *pools_[kShmChangeLogMaxPools]{}; ///< 已登记的池，下标为池编号
+    };
+
+} // namespace cfl::shm
@@ -0,0 +1,352 @@
+#include "shmcheckpoint.h"
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "spdlog/spdlog.h"
+#include "shmpage.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cfl::shm {
+
+    namespace {
+        /// 拷贝对象块时的最大重试次数，写入持续进行的对象沿用上一次检查点的内容
+        constexpr std::size_t kCheckpointCopyRetries = 64;
+
+        /**
+         * @brief 内容不同时拷贝
+         * @return 是否发生了拷贝
+         */
+        bool copy_if_changed(char *dst, const char *src, std::size_t size) {
+            if (std::memcmp(dst, src, size) == 0) {
+                return false;
+            }
+            std::memcpy(dst, src, size);
+            return true;
+        }
+    }
+
+    ShmCheckpoint::ShmCheckpoint(std::string path) : path_(std::move(path)) {}
+
+    ShmCheckpoint::~ShmCheckpoint() {
+        unmap();
+    }
+
+    bool ShmCheckpoint::map(std::size_t size, bool create) {
+        if (data_ != nullptr && size_ >= size && size != 0) {
+            return true;
+        }
+        unmap();
+
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path_.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                                  create ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            if (create) {
+                spdlog::error("[ShmCheckpoint] open {} failed: {}", path_, ::GetLastError());
+            }
+            return false;
+        }
+        LARGE_INTEGER file_size{};
+        GetFileSizeEx(file, &file_size);
+        auto current = static_cast<std::size_t>(file_size.QuadPart);
+        if (size == 0) {
+            size = current;
+        }
+        if (size == 0 || (current < size && !create)) {
+            CloseHandle(file);
+            return false;
+        }
+        // 映射大小超过文件大小时 CreateFileMapping 会扩展文件
+        auto high = static_cast<DWORD>(static_cast<std::uint64_t>(size) >> 32);
+        auto low = static_cast<DWORD>(size & 0xFFFFFFFFu);
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, high, low, nullptr);
+        if (mapping == nullptr) {
+            spdlog::error("[ShmCheckpoint] map {} failed: {}", path_, ::GetLastError());
+            CloseHandle(file);
+            return false;
+        }
+        auto data = static_cast<char *>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+        if (data == nullptr) {
+            spdlog::error("[ShmCheckpoint] map view {} failed: {}", path_, ::GetLastError());
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+        file_ = reinterpret_cast<std::intptr_t>(file);
+        mapping_ = reinterpret_cast<std::intptr_t>(mapping);
+#else
+        int fd = ::open(path_.c_str(), O_RDWR | (create ? O_CREAT : 0), 0644);
+        if (fd < 0) {
+            if (create) {
+                spdlog::error("[ShmCheckpoint] open {} failed: {}", path_, std::strerror(errno));
+            }
+            return false;
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        auto current = static_cast<std::size_t>(st.st_size);
+        if (size == 0) {
+            size = current;
+        }
+        if (size == 0 || (current < size && !create)) {
+            ::close(fd);
+            return false;
+        }
+        if (current < size && ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            spdlog::error("[ShmCheckpoint] resize {} to {} failed: {}", path_, size, std::strerror(errno));
+            ::close(fd);
+            return false;
+        }
+        void *data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            spdlog::error("[ShmCheckpoint] mmap {} failed: {}", path_, std::strerror(errno));
+            ::close(fd);
+            return false;
+        }
+        file_ = fd;
+#endif
+        data_ = static_cast<char *>(data);
+        size_ = size;
+        return true;
+    }
+
+    void ShmCheckpoint::unmap() {
+        if (data_ == nullptr) {
+            return;
+        }
+#if defined(_WIN32)
+        UnmapViewOfFile(data_);
+        CloseHandle(reinterpret_cast<HANDLE>(mapping_));
+        CloseHandle(reinterpret_cast<HANDLE>(file_));
+#else
+        ::munmap(data_, size_);
+        ::close(static_cast<int>(file_));
+#endif
+        data_ = nullptr;
+        size_ = 0;
+        file_ = -1;
+        mapping_ = -1;
+    }
+
+    bool ShmCheckpoint::flush(std::size_t offset, std::size_t size, bool sync) {
+#if defined(_WIN32)
+        if (!FlushViewOfFile(data_ + offset, size)) {
+            return false;
+        }
+        return !sync || FlushFileBuffers(reinterpret_cast<HANDLE>(file_));
+#else
+        // msync 要求地址按系统页对齐
+        static const auto os_page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        auto begin = offset / os_page * os_page;
+        return ::msync(data_ + begin, size + (offset - begin), sync ? MS_SYNC : MS_ASYNC) == 0;
+#endif
+    }
+
+    int ShmCheckpoint::latest_slot() const noexcept {
+        int latest = -1;
+        for (std::size_t slot = 0; slot < kShmCheckpointSlots; ++slot) {
+            auto head = header(slot);
+            if (head->magic != kShmCheckpointMagic || head->version != kShmCheckpointVersion || head->complete != 1) {
+                continue;
+            }
+            if (latest < 0 || head->sequence > header(static_cast<std::size_t>(latest))->sequence) {
+                latest = static_cast<int>(slot);
+            }
+        }
+        return latest;
+    }
+
+    bool ShmCheckpoint::write(const SharedMemoryManagerBase &pool, ShmCheckpointStats *stats) {
+        auto bases = pool.page_bases();
+        auto page_size = pool.page_size();
+        auto raw_block_size = pool.raw_block_size();
+        auto blocks_per_page = pool.blocks_per_page();
+        if (bases.empty()) {
+            return true;
+        }
+        if (!map(kShmCheckpointDataOffset + bases.size() * kShmCheckpointSlots * page_size, true)) {
+            return false;
+        }
+
+        auto matches = [&](const ShmCheckpointHeader *head) {
+            return head->magic == kShmCheckpointMagic && head->version == kShmCheckpointVersion
+                   && head->fingerprint == pool.layout_fingerprint() && head->page_size == page_size;
+        };
+        // 最近一次完整的检查点保持不动，写入另一个槽
+        auto latest = latest_slot();
+        auto slot = latest < 0 ? std::size_t{0} : (static_cast<std::size_t>(latest) + 1) % kShmCheckpointSlots;
+        const ShmCheckpointHeader *prev = latest >= 0 && matches(header(static_cast<std::size_t>(latest)))
+                                          ? header(static_cast<std::size_t>(latest)) : nullptr;
+        auto head = header(slot);
+        bool fresh = !matches(head);
+        if (fresh) {
+            // 新文件或布局变化，整份重写（逐块比较时全部视为变化）
+            *head = ShmCheckpointHeader{};
+            head->magic = kShmCheckpointMagic;
+            head->version = kShmCheckpointVersion;
+            head->module_id = static_cast<std::uint32_t>(pool.module_id());
+            head->layout_version = pool.layout_version();
+            head->fingerprint = pool.layout_fingerprint();
+            head->page_size = page_size;
+        }
+        auto header_offset = slot * sizeof(ShmCheckpointHeader);
+        head->complete = 0;
+        if (!flush(header_offset, sizeof(ShmCheckpointHeader), true)) {
+            spdlog::error("[ShmCheckpoint] flush header {} slot {} failed", path_, slot);
+            return false;
+        }
+
+        ShmCheckpointStats result;
+        result.pages = bases.size();
+        scratch_.resize(raw_block_size);
+        auto headers_size = blocks_per_page * sizeof(MemoryBlockHeader);
+        auto headers_offset = sizeof(ShmLayoutHeader) + raw_block_size * blocks_per_page;
+        std::vector<MemoryBlockHeader> headers(blocks_per_page);
+
+        for (std::size_t page = 0; page < bases.size(); ++page) {
+            auto offset = page_offset(page, slot, page_size);
+            auto dst = data_ + offset;
+            auto src = bases[page];
+            auto src_headers = reinterpret_cast<const MemoryBlockHeader *>(
+                    src + sizeof(ShmLayoutHeader) + raw_block_size * blocks_per_page);
+            // 上一次检查点中的同一页，池扩容后新增的页没有
+            const char *prev_page = prev != nullptr && page < prev->page_count
+                                    ? data_ + page_offset(page, static_cast<std::size_t>(latest), page_size) : nullptr;
+            auto prev_headers = prev_page != nullptr
+                                ? reinterpret_cast<const MemoryBlockHeader *>(prev_page + headers_offset) : nullptr;
+            bool page_dirty = copy_if_changed(dst, src, sizeof(ShmLayoutHeader));
+            std::size_t bytes = page_dirty ? sizeof(ShmLayoutHeader) : 0;
+
+            // 先取块头快照，镜像中的块头只来自快照，保证 in_use 的块一定有与之对应的对象内容
+            std::copy_n(src_headers, blocks_per_page, headers.begin());
+            for (std::size_t i = 0; i < blocks_per_page; ++i) {
+                auto &block_header = headers[i];
+                // 空闲块的对象区在恢复时不会被读取，无需拷贝
+                if (!block_header.in_use) {
+                    continue;
+                }
+                auto block_offset = sizeof(ShmLayoutHeader) + raw_block_size * i;
+                auto object = reinterpret_cast<const SharedObject *>(src + block_offset);
+                bool copied = object->copy_to(scratch_.data(), raw_block_size, kCheckpointCopyRetries);
+                // 拷贝期间块被回收或分配给了别的对象，拷到的内容不属于快照中的对象
+                if (copied && (!src_headers[i].in_use || src_headers[i].generation != block_header.generation)) {
+                    copied = false;
+                }
+                if (!copied) {
+                    ++result.skipped_blocks;
+                    // 上一次检查点中仍是同一个对象时沿用其内容，否则在镜像中标记为未使用
+                    if (prev_headers != nullptr && prev_headers[i].in_use
+                        && prev_headers[i].generation == block_header.generation) {
+                        block_header = prev_headers[i];
+                        if (copy_if_changed(dst + block_offset, prev_page + block_offset, raw_block_size)) {
+                            bytes += raw_block_size;
+                            page_dirty = true;
+                        }
+                    } else {
+                        block_header.in_use = false;
+                    }
+                    continue;
+                }
+                if (copy_if_changed(dst + block_offset, scratch_.data(), raw_block_size)) {
+                    ++result.dirty_blocks;
+                    bytes += raw_block_size;
+                    page_dirty = true;
+                }
+            }
+
+            if (copy_if_changed(dst + headers_offset, reinterpret_cast<const char *>(headers.data()), headers_size)) {
+                bytes += headers_size;
+                page_dirty = true;
+            }
+
+            if (page_dirty) {
+                if (!flush(offset, page_size, true)) {
+                    spdlog::error("[ShmCheckpoint] flush {} slot {} page {} failed", path_, slot, page);
+                    return false;
+                }
+                ++result.dirty_pages;
+                result.bytes += bytes;
+            }
+        }
+
+        head->page_count = bases.size();
+        head->sequence = (latest >= 0 ? header(static_cast<std::size_t>(latest))->sequence : head->sequence) + 1;
+        head->timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        head->complete = 1;
+        if (!flush(header_offset, sizeof(ShmCheckpointHeader), true)) {
+            spdlog::error("[ShmCheckpoint] flush header {} slot {} failed", path_, slot);
+            return false;
+        }
+        if (stats != nullptr) {
+            *stats = result;
+        }
+        return true;
+    }
+
+    bool ShmCheckpoint::restore(SharedMemoryManagerBase &pool) {
+        if (!map(0, false)) {
+            spdlog::info("[ShmCheckpoint] no checkpoint at {}", path_);
+            return false;
+        }
+        if (size_ < kShmCheckpointDataOffset) {
+            spdlog::warn("[ShmCheckpoint] {} is not a checkpoint file", path_);
+            return false;
+        }
+
+        auto latest = latest_slot();
+        if (latest < 0) {
+            spdlog::warn("[ShmCheckpoint] {} has no completely written checkpoint, ignored", path_);
+            return false;
+        }
+        auto slot = static_cast<std::size_t>(latest);
+        ShmCheckpointHeader head = *header(slot);
+        auto page_size = pool.page_size();
+        if (head.fingerprint != pool.layout_fingerprint() || head.layout_version != pool.layout_version()
+            || head.page_size != page_size) {
+            spdlog::warn("[ShmCheckpoint] {} layout version {} fingerprint {:#x} does not match version {} fingerprint {:#x}",
+                         path_, head.layout_version, head.fingerprint, pool.layout_version(), pool.layout_fingerprint());
+            return false;
+        }
+        if (head.page_count == 0 || size_ < page_offset(head.page_count - 1, slot, page_size) + page_size) {
+            spdlog::warn("[ShmCheckpoint] {} is truncated", path_);
+            return false;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        bool loaded = pool.load_pages(static_cast<std::size_t>(head.page_count), [&](std::size_t page, char *base) {
+            auto src = data_ + page_offset(page, slot, page_size);
+            if (reinterpret_cast<const ShmLayoutHeader *>(src)->magic != kShmLayoutMagic) {
+                spdlog::warn("[ShmCheckpoint] {} slot {} page {} has no layout header", path_, slot, page);
+                return false;
+            }
+            std::memcpy(base, src, page_size);
+            return true;
+        });
+        if (!loaded) {
+            return false;
+        }
+        spdlog::info("[ShmCheckpoint] restored module_id = {} from {} slot {}: {} pages, sequence {}, cost {}ms",
+                     pool.module_id(), path_, slot, head.page_count, head.sequence,
+                     std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::steady_clock::now() - begin).count());
+        return true;
+    }
+
+} // namespace cfl::shm
@@ -0,0 +1,159 @@
+/**
+ * @file shmcheckpoint.h
+ * @brief 共享内存检查点：把共享内存池的页镜像增量写入本地文件
+ *
+ * @details
+ * SysV 共享内存可以跨越进程崩溃，但主机重启后就会丢失。检查点把每个池的
+ * 所有页（布局头 + 对象区 + 块头区）定期写入 mmap 映射的本地文件：
+ * - 增量写入：逐块与文件中的上一次镜像比较，只拷贝发生变化的块，只刷新变化的页；
+ * - 一致性：对象按 seqlock 协议拷贝（SharedObject::copy_to），不会写入写了一半的对象，
+ *   写入持续进行的对象保留上一次检查点的内容；
+ * - 完整性：文件中有两个槽，每次写入上一次完整写入之外的那个槽，写入期间该槽的 complete 置 0，
+ *   全部页落盘后再置 1 并递增序号；写到一半崩溃时另一个槽仍是完整的上一次检查点，恢复时选用
+ *   完整且序号最大的槽。
+ *
+ * 启动时若共享内存不存在，DataPoolManager 会用检查点文件填充新建的共享内存，
+ * 随后按正常的重启流程（initialize_block_map / restore_from_shared_memory）恢复。
+ *
+ * 文件格式：
+ * @code
+ * [0, 64)                                 槽 0 的 ShmCheckpointHeader
+ * [64, 128)                               槽 1 的 ShmCheckpointHeader
+ * [4096 + (i * 2 + s) * page_size, ...)   槽 s 中第 i 页的完整镜像
+ * @endcode
+ *
+ * 增量比较针对同一个槽的上一次内容，即两次检查点之前的镜像。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cfl::shm {
+
+    class SharedMemoryManagerBase;
+
+    /// 检查点文件魔数 "CFLK"
+    inline constexpr std::uint32_t kShmCheckpointMagic = 0x4B4C4643;
+
+    /// 检查点文件格式版本
+    inline constexpr std::uint32_t kShmCheckpointVersion = 2;
+
+    /// 检查点槽数量，两个槽交替写入
+    inline constexpr std::size_t kShmCheckpointSlots = 2;
+
+    /// 页镜像在文件中的起始偏移
+    inline constexpr std::size_t kShmCheckpointDataOffset = 4096;
+
+    /**
+     * @brief 检查点文件头
+     */
+    struct alignas(64) ShmCheckpointHeader {
+        std::uint32_t magic = 0;            ///< 魔数，固定为 kShmCheckpointMagic
+        std::uint32_t version = 0;          ///< 文件格式版本
+        std::uint32_t module_id = 0;        ///< 共享内存池模块编号
+        std::uint32_t complete = 0;         ///< 1 表示该槽的检查点完整写入
+        std::uint32_t layout_version = 0;   ///< 对象布局版本
+        std::uint32_t reserved = 0;
+        std::uint64_t fingerprint = 0;      ///< 对象结构指纹
+        std::uint64_t page_size = 0;        ///< 每页字节数
+        std::uint64_t page_count = 0;       ///< 页数量
+        std::uint64_t sequence = 0;         ///< 检查点序号，两个槽共用，每完成一次加一
+        std::int64_t timestamp = 0;         ///< 最近一次完成的时间（秒）
+    };
+
+    /**
+     * @brief 单次检查点的统计信息
+     */
+    struct ShmCheckpointStats {
+        std::size_t pages = 0;          ///< 页数量
+        std::size_t dirty_pages = 0;    ///< 发生变化并刷新的页数量
+        std::size_t dirty_blocks = 0;   ///< 发生变化的对象块数量
+        std::size_t skipped_blocks = 0; ///< 写入持续进行、沿用上一次检查点内容的对象块数量
+        std::size_t bytes = 0;          ///< 拷贝到文件的字节数
+    };
+
+    /**
+     * @class ShmCheckpoint
+     * @brief 一个共享内存池对应的检查点文件
+     *
+     * @note 同一个对象只能在一个线程中使用；被检查的池可以同时在逻辑线程中读写。
+     */
+    class ShmCheckpoint {
+    public:
+        /**
+         * @param path 检查点文件路径
+         */
+        explicit ShmCheckpoint(std::string path);
+
+        ~ShmCheckpoint();
+
+        ShmCheckpoint(const ShmCheckpoint &) = delete;
+        ShmCheckpoint &operator=(const ShmCheckpoint &) = delete;
+
+        /**
+         * @brief 把池的当前内容增量写入检查点文件
+         * @details 写入上一次完整检查点之外的槽，失败或崩溃时上一次检查点保持完整。
+         * @param pool 共享内存池
+         * @param stats 输出本次检查点的统计信息（可为空）
+         * @return 是否写入成功
+         */
+        bool write(const SharedMemoryManagerBase &pool, ShmCheckpointStats *stats = nullptr);
+
+        /**
+         * @brief 用检查点文件填充新建的共享内存池
+         * @details 使用完整写入且序号最大的槽；文件不存在、没有完整的槽或布局与池不一致时返回 false，池保持为空。
+         * @param pool 刚创建、尚未调用 initialize_block_map 的池
+         * @return 是否恢复成功
+         */
+        bool restore(SharedMemoryManagerBase &pool);
+
+        /**
+         * @brief 检查点文件路径
+         */
+        [[nodiscard]] const std::string &path() const noexcept { return path_; }
+
+    private:
+        /**
+         * @brief 映射文件，文件不足 size 字节时按 create 决定是否扩展
+         */
+        bool map(std::size_t size, bool create);
+
+        /**
+         * @brief 解除映射并关闭文件
+         */
+        void unmap();
+
+        /**
+         * @brief 把 [offset, offset + size) 刷新到磁盘
+         */
+        bool flush(std::size_t offset, std::size_t size, bool sync);
+
+        ShmCheckpointHeader *header(std::size_t slot) const noexcept {
+            return reinterpret_cast<ShmCheckpointHeader *>(data_) + slot;
+        }
+
+        /**
+         * @brief 完整写入且序号最大的槽，没有时返回 -1
+         */
+        [[nodiscard]] int latest_slot() const noexcept;
+
+        /**
+         * @brief 槽 slot 中第 page 页在文件中的偏移
+         */
+        static std::size_t page_offset(std::size_t page, std::size_t slot, std::size_t page_size) noexcept {
+            return kShmCheckpointDataOffset + (page * kShmCheckpointSlots + slot) * page_size;
+        }
+
+        std::string path_;             ///< 文件路径
+        char *data_ = nullptr;         ///< 映射地址
+        std::size_t size_ = 0;         ///< 映射字节数
+        std::intptr_t file_ = -1;      ///< 文件句柄（Windows 下为 HANDLE）
+        std::intptr_t mapping_ = -1;   ///< 文件映射句柄（仅 Windows）
+        std::vector<char> scratch_;    ///< 对象块的一致性拷贝缓冲区
+    };
+
+} // namespace cfl::shm
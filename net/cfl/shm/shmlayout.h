@@ -0,0 +1,196 @@
+/**
+ * @file shmlayout.h
+ * @brief 共享内存布局版本与结构指纹
+ *
+ * @details
+ * 每个共享内存页的起始位置都存放一个 ShmLayoutHeader，记录魔数、布局版本、
+ * 对象结构指纹以及分块参数。附加到已有共享内存时先校验首页的布局头：
+ * - 指纹与版本一致：直接附加，保留热数据；
+ * - 不一致但注册了迁移函数：读出旧块，重建共享内存并逐块迁移；
+ * - 其他情况：拒绝附加，避免把旧结构当作新结构读取。
+ *
+ * 结构指纹在编译期由 sizeof / alignof / offsetof 以及字段的类型类别计算，
+ * 对象类型可以通过特化 ShmLayout<T> 声明版本号和参与指纹计算的字段。
+ * 所有放进共享内存池的对象都应特化，只用 sizeof / alignof 无法发现等长字段的调换。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <type_traits>
+#include <utility>
+#include "shmobj.h"
+
+namespace cfl::shm {
+
+    /// 布局头魔数 "CFLS"
+    inline constexpr std::uint32_t kShmLayoutMagic = 0x534C4643;
+
+    /// 布局头自身的版本，修改 ShmLayoutHeader 时递增
+    inline constexpr std::uint32_t kShmLayoutHeaderVersion = 1;
+
+    /**
+     * @brief 共享内存页布局头，位于每一页的起始位置
+     */
+    struct alignas(64) ShmLayoutHeader {
+        std::uint32_t magic = 0;            ///< 魔数，固定为 kShmLayoutMagic
+        std::uint32_t header_version = 0;   ///< 布局头版本
+        std::uint32_t layout_version = 0;   ///< 对象布局版本，由 ShmLayout<T>::version 声明
+        std::uint32_t page_index = 0;       ///< 页编号
+        std::uint64_t fingerprint = 0;      ///< 对象结构指纹
+        std::uint64_t raw_block_size = 0;   ///< 每个对象块的字节数
+        std::uint64_t blocks_per_page = 0;  ///< 每页块数
+        std::uint64_t block_header_size = 0;///< MemoryBlockHeader 的字节数
+    };
+
+    /**
+     * @brief 参与指纹计算的字段描述（偏移 + 大小 + 类型类别）
+     */
+    struct ShmField {
+        std::size_t offset;
+        std::size_t size;
+        std::uint64_t kind = 0;     ///< 见 shm_field_kind
+    };
+
+    /**
+     * @brief 字段的类型类别：浮点 / 有符号 / 无符号 / 枚举 / 其他，以及（数组）元素大小
+     * @details 使等长字段之间的类型调换（如 int32 换成 float、uint64 换成 char[8]）也会改变指纹。
+     */
+    template<class M>
+    constexpr std::uint64_t shm_field_kind() noexcept {
+        using E = std::remove_cv_t<std::remove_all_extents_t<M>>;
+        std::uint64_t category = std::is_floating_point_v<E> ? 1
+                               : std::is_enum_v<E> ? 2
+                               : std::is_signed_v<E> ? 3
+                               : std::is_unsigned_v<E> ? 4
+                               : 5;
+        return (category << 32) | sizeof(E);
+    }
+
+/// 描述一个参与指纹计算的字段（SharedObject 派生类不是标准布局，GCC 下需在使用处关闭 -Winvalid-offsetof）
+#define CFL_SHM_FIELD(type, member) \
+    ::cfl::shm::ShmField{offsetof(type, member), sizeof(static_cast<type *>(nullptr)->member), \
+                         ::cfl::shm::shm_field_kind<decltype(type::member)>()}
+
+    /**
+     * @brief SharedObject 头部字段（校验码、状态、变更槽、写序号等）
+     * @details 头部字段调换或改型时对象大小可能不变，需要单独混入每个对象的指纹。
+     */
+    struct ShmObjectHeaderLayout {
+        static constexpr ShmField fields[] = {
+                CFL_SHM_FIELD(SharedObject, check_code_),
+                CFL_SHM_FIELD(SharedObject, state_),
+                CFL_SHM_FIELD(SharedObject, change_slot_),
+                CFL_SHM_FIELD(SharedObject, payload_size_),
+                CFL_SHM_FIELD(SharedObject, last_update_),
+                CFL_SHM_FIELD(SharedObject, dirty_mask_),
+                CFL_SHM_FIELD(SharedObject, seq_),
+        };
+    };
+
+    /**
+     * @brief 计算结构指纹（FNV-1a）
+     * @param size 对象大小
+     * @param align 对象对齐
+     * @param fields 字段列表
+     */
+    constexpr std::uint64_t shm_layout_fingerprint(std::size_t size, std::size_t align,
+                                                   std::initializer_list<ShmField> fields = {}) noexcept {
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+        auto mix = [&hash](std::uint64_t value) {
+            for (int i = 0; i < 8; ++i) {
+                hash ^= (value >> (i * 8)) & 0xff;
+                hash *= 0x100000001b3ull;
+            }
+        };
+        mix(size);
+        mix(align);
+        mix(sizeof(SharedObject));
+        for (auto &field: ShmObjectHeaderLayout::fields) {
+            mix(field.offset);
+            mix(field.size);
+            mix(field.kind);
+        }
+        for (auto &field: fields) {
+            mix(field.offset);
+            mix(field.size);
+            mix(field.kind);
+        }
+        return hash;
+    }
+
+    /**
+     * @brief 对象布局描述，默认只使用 sizeof / alignof 计算指纹（仅用于测试等临时类型）
+     *
+     * @details 需要更严格校验的类型可以特化：
+     * @code
+     * template<>
+     * struct ShmLayout<RoleDataObject> {
+     *     static constexpr std::uint32_t version = 2;
+     *     static constexpr std::uint64_t fingerprint = shm_layout_fingerprint(
+     *             sizeof(RoleDataObject), alignof(RoleDataObject),
+     *             {CFL_SHM_FIELD(RoleDataObject, roleId), ...});
+     * };
+     * @endcode
+     */
+    template<class T>
+    struct ShmLayout {
+        static constexpr std::uint32_t version = 1;
+        static constexpr std::uint64_t fingerprint = shm_layout_fingerprint(sizeof(T), alignof(T));
+    };
+
+    /**
+     * @brief 布局迁移函数
+     * @param old_block 旧对象块的拷贝（raw_block_size 字节）
+     * @param old_layout 旧共享内存的布局头
+     * @param new_block 新分配的对象块，迁移函数负责在其上构造新对象并填充字段
+     * @return true 表示迁移成功，false 表示丢弃该对象
+     */
+    using LayoutMigration = std::function<bool(const char *old_block, const ShmLayoutHeader &old_layout,
+                                               SharedObject *new_block)>;
+
+    /**
+     * @brief 布局迁移注册表
+     *
+     * @details 以（新结构指纹, 旧布局版本）为键，必须在创建对应的共享内存池之前注册。
+     */
+    class LayoutMigrationRegistry {
+    public:
+        static LayoutMigrationRegistry &instance();
+
+        /**
+         * @brief 注册迁移函数
+         * @param fingerprint 当前对象结构指纹
+         * @param from_version 可迁移的旧布局版本
+         * @param migration 迁移函数
+         */
+        void add(std::uint64_t fingerprint, std::uint32_t from_version, LayoutMigration migration) {
+            migrations_[{fingerprint, from_version}] = std::move(migration);
+        }
+
+        /**
+         * @brief 查找迁移函数
+         * @return 找不到时返回 nullptr
+         */
+        [[nodiscard]] const LayoutMigration *find(std::uint64_t fingerprint, std::uint32_t from_version) const {
+            auto it = migrations_.find({fingerprint, from_version});
+            return it == migrations_.end() ? nullptr : &it->second;
+        }
+
+    private:
+        std::map<std::pair<std::uint64_t, std::uint32_t>, LayoutMigration> migrations_;
+    };
+
+    /**
+     * @brief 为类型 T 注册从旧布局版本迁移的函数
+     */
+    template<class T>
+    void register_layout_migration(std::uint32_t from_version, LayoutMigration migration) {
+        LayoutMigrationRegistry::instance().add(ShmLayout<T>::fingerprint, from_version, std::move(migration));
+    }
+
+} // namespace cfl::shm
@@ -1,11 +1,30 @@
 #pragma once
 #include <chrono>
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
 #include <atomic>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
 #include <string_view>
+#include "crc32c.h"
+
+/// 对象块校验码的标记，位于 check_code 的高 32 位，低 32 位为对象数据的 CRC32C
+#define BLOCK_CHECK_CODE 0x5A
 
 namespace cfl::shm {
 
+    class SharedObject;
+    struct ShmObjectHeaderLayout;
+
+    /**
+     * @brief 对象写入结束时把变更登记到当前启用的变更日志（见 shmchangelog.h）
+     * @details 只有所在池已登记到变更日志的对象（change_slot 非 0）才会调用。
+     */
+    void publish_change(const SharedObject &object) noexcept;
+
     /**
      * @enum ObjectState
      * @brief 表示共享对象的生命周期状态。
@@ -18,6 +37,46 @@ namespace cfl::shm {
         InUse       /**< 使用中状态，表示活跃的引用 */
     };
 
+    /**
+     * @brief 缓存行大小，共享内存池按它对齐每个对象块的起始地址
+     *
+     * @details SharedObject 的状态、时间戳和写序号在每次 lock/unlock 时都会被写入。
+     * 高频修改的对象可以把第一个数据成员声明为 alignas(kShmCacheLineSize)，
+     * 使对象头独占一个缓存行，热字段集中在随后的缓存行，冷字段再单独对齐到后面，
+     * 这样逐帧更新时只会弄脏对象头和热字段所在的缓存行（见 RoleDataObject）。
+     */
+    inline constexpr std::size_t kShmCacheLineSize = 64;
+
+    /// 读取快照时的默认最大重试次数
+    inline constexpr std::size_t kSnapshotRetries = 1024;
+
+    /**
+     * @class Snapshot
+     * @brief 共享对象的一致性副本，由 SharedObject::snapshot 生成。
+     *
+     * 副本是对象内存的逐字节拷贝，只用于读取，不会调用 T 的构造或析构函数。
+     */
+    template<class T>
+    class Snapshot {
+    public:
+        /// 访问副本
+        const T *get() const noexcept { return std::launder(reinterpret_cast<const T *>(storage_)); }
+        const T *operator->() const noexcept { return get(); }
+        const T &operator*() const noexcept { return *get(); }
+
+        /**
+         * @brief 拷贝时对象的写序号
+         * @details 序号相同说明两次快照之间对象没有被写过。
+         */
+        [[nodiscard]] std::uint64_t sequence() const noexcept { return sequence_; }
+
+    private:
+        friend class SharedObject;
+
+        alignas(T) std::byte storage_[sizeof(T)]; ///< 对象的逐字节拷贝
+        std::uint64_t sequence_{0};               ///< 拷贝时的写序号
+    };
+
     /**
      * @class SharedObject
      * @brief 表示一个可放置于共享内存中的对象，具有生命周期状态管理和元信息。
@@ -44,14 +103,42 @@ namespace cfl::shm {
 
         // ---------- 状态变更 API ----------
         /**
-         * @brief 将对象标记为被占用 (Locked)。
+         * @brief 开始写入，将对象标记为被占用 (Locked)。
+         * @details 写序号加一变为奇数，读者看到奇数序号时会重试。不可重入，lock/unlock 必须成对调用。
+         */
+        void lock() noexcept {
+            seq_.fetch_add(1, std::memory_order_acq_rel);
+            std::atomic_thread_fence(std::memory_order_release);
+            set_state(ObjectState::Locked);
+        }
+
+        /**
+         * @brief 写入结束，将对象恢复为使用中 (InUse)。
+         * @details 解锁后的对象仍然存活，不能回到 Idle，否则会被 clean_dirty_blocks 当作空闲块回收，
+         * 重启恢复时也无法识别。写序号加一恢复为偶数。
+         * 写入后内容与校验码不再一致，只清除校验码，持久化取走脏位图时再重新封存（见 take_dirty_mask），
+         * 逐帧的写入路径上不计算 CRC。
+         * 所在池登记了变更日志时，同时把本次变更追加到日志，供持久化进程增量读取。
          */
-        void lock() noexcept { set_state(ObjectState::Locked); }
+        void unlock() noexcept {
+            unseal();
+            set_state(ObjectState::InUse);
+            seq_.fetch_add(1, std::memory_order_release);
+            if (change_slot_ != 0) {
+                publish_change(*this);
+            }
+        }
 
         /**
-         * @brief 将对象标记为空闲 (Idle)。
+         * @brief 写入结束但不追加变更日志，其余与 unlock() 相同。
+         * @details 变更日志只有逻辑线程一个生产者，其他线程（如 GUID 预留线程）写入对象时使用。
+         * 本次修改仍由检查点按内容比较写出，并在对象下一次于逻辑线程 unlock 时随之发布。
          */
-        void unlock() noexcept { set_state(ObjectState::Idle); }
+        void unlock_unpublished() noexcept {
+            unseal();
+            set_state(ObjectState::InUse);
+            seq_.fetch_add(1, std::memory_order_release);
+        }
 
         /**
          * @brief 将对象标记为已释放 (Released)。
@@ -98,6 +185,78 @@ namespace cfl::shm {
          */
         [[nodiscard]] bool is_in_use() const noexcept { return state() == ObjectState::InUse; }
 
+        // ---------- 快照 ----------
+        /**
+         * @brief 获取对象当前的写序号。
+         * @return 偶数表示没有正在进行的写入，奇数表示写入中。
+         */
+        [[nodiscard]] std::uint64_t sequence() const noexcept {
+            return seq_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief 把停在奇数的写序号恢复为偶数。
+         * @details 只用于确定没有写者的场景（如布局迁移）：进程在写入过程中退出时序号停在奇数，
+         * 不恢复的话快照读者会一直重试。
+         */
+        void reset_sequence() noexcept {
+            auto seq = seq_.load(std::memory_order_relaxed);
+            if (seq & 1) {
+                seq_.store(seq + 1, std::memory_order_release);
+            }
+        }
+
+        /**
+         * @brief 读取对象的一致性副本（seqlock 读端）。
+         *
+         * @details 拷贝前后各读一次写序号，序号为奇数或前后不一致说明读到了写了一半的数据，
+         * 此时重试；写端从不等待读端。适用于跨进程的持久化、监控等只读场景。
+         *
+         * @tparam T 对象的实际类型，必须派生自 SharedObject
+         * @param max_retries 最大重试次数
+         * @return 成功返回副本，写入持续进行导致重试次数耗尽时返回 std::nullopt
+         */
+        template<class T>
+        [[nodiscard]] std::optional<Snapshot<T>> snapshot(std::size_t max_retries = kSnapshotRetries) const noexcept {
+            static_assert(std::is_base_of_v<SharedObject, T>, "T 必须派生自 SharedObject");
+            Snapshot<T> copy;
+            if (!copy_to(copy.storage_, sizeof(T), max_retries, &copy.sequence_)) {
+                return std::nullopt;
+            }
+            return copy;
+        }
+
+        /**
+         * @brief 按 seqlock 协议把对象所在的 size 字节一致地拷贝到 dst。
+         *
+         * @details 用于不知道具体类型的场景（如按块拷贝整页），size 通常为池的块大小。
+         *
+         * @param dst 目标缓冲区
+         * @param size 拷贝字节数（从对象起始地址算起）
+         * @param max_retries 最大重试次数
+         * @param sequence 成功时写入拷贝对应的写序号（可为空）
+         * @return 重试次数耗尽时返回 false，dst 内容不可用
+         */
+        bool copy_to(void *dst, std::size_t size, std::size_t max_retries = kSnapshotRetries,
+                     std::uint64_t *sequence = nullptr) const noexcept {
+            for (std::size_t i = 0; i < max_retries; ++i) {
+                auto begin = seq_.load(std::memory_order_acquire);
+                if (begin & 1) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                std::memcpy(dst, static_cast<const void *>(this), size);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq_.load(std::memory_order_relaxed) == begin) {
+                    if (sequence != nullptr) {
+                        *sequence = begin;
+                    }
+                    return true;
+                }
+            }
+            return false;
+        }
+
         // ---------- 元信息 ----------
         /**
          * @brief 获取对象最后一次更新状态的时间点。
@@ -131,7 +290,116 @@ namespace cfl::shm {
             check_code_ = code;
         }
 
+        // ---------- 完整性校验 ----------
+        /**
+         * @brief 设置对象所在块的字节数，由共享内存池在分配时设置。
+         * @details 校验范围为 SharedObject 之后到块末尾的对象数据；未设置时不计算校验码。
+         */
+        void set_payload_size(std::uint32_t size) noexcept { payload_size_ = size; }
+
+        /**
+         * @brief 根据当前内容计算并记录校验码。
+         * @details 持久化（take_dirty_mask）时自动调用：此时对象的内容已全部落地，
+         * 之后校验失败的块即使被隔离也不会丢失已跟踪的修改。
+         */
+        void seal() noexcept {
+            if (payload_size_ <= sizeof(SharedObject)) {
+                return;
+            }
+            check_code_ = (std::size_t{BLOCK_CHECK_CODE} << 32) | compute_checksum();
+        }
+
+        /**
+         * @brief 清除校验码。
+         * @details 写入（unlock、mark_dirty）后内容与校验码不再一致，下次 seal 之前不参与校验。
+         */
+        void unseal() noexcept { check_code_ = 0; }
+
+        /**
+         * @brief 对象当前是否带有有效的校验码。
+         */
+        [[nodiscard]] bool is_sealed() const noexcept {
+            return (check_code_ >> 32) == BLOCK_CHECK_CODE && payload_size_ > sizeof(SharedObject);
+        }
+
+        /**
+         * @brief 校验对象内容。
+         * @return 未封存的对象总是返回 true；封存的对象内容与校验码不一致时返回 false。
+         */
+        [[nodiscard]] bool verify() const noexcept {
+            if (!is_sealed()) {
+                return true;
+            }
+            return static_cast<std::uint32_t>(check_code_) == compute_checksum();
+        }
+
+        // ---------- 变更日志 ----------
+        /**
+         * @brief 设置对象所在池在变更日志中的编号（池编号 + 1），0 表示不发布变更。
+         * @details 由共享内存池在分配和登记变更日志时设置。
+         */
+        void set_change_slot(std::uint8_t slot) noexcept { change_slot_ = slot; }
+
+        /**
+         * @brief 获取对象所在池在变更日志中的编号（池编号 + 1）
+         */
+        [[nodiscard]] std::uint8_t change_slot() const noexcept { return change_slot_; }
+
+        // ---------- 脏字段位图 ----------
+        /**
+         * @brief 标记某个字段已被修改。
+         * @param field_id 字段编号（0 ~ 63），由具体对象的字段表生成。
+         */
+        void mark_dirty(std::size_t field_id) noexcept {
+            unseal();
+            dirty_mask_.fetch_or(std::uint64_t{1} << field_id, std::memory_order_release);
+        }
+
+        /**
+         * @brief 批量标记字段已被修改。
+         * @param mask 字段位图。
+         */
+        void mark_dirty_mask(std::uint64_t mask) noexcept {
+            unseal();
+            dirty_mask_.fetch_or(mask, std::memory_order_release);
+        }
+
+        /**
+         * @brief 获取当前的脏字段位图。
+         * @return 字段位图，0 表示没有未落地的修改。
+         */
+        [[nodiscard]] std::uint64_t dirty_mask() const noexcept {
+            return dirty_mask_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief 丢弃脏字段位图。
+         * @details 块被回收时调用，避免下一个对象继承上一个对象未落地的修改标记。
+         */
+        void clear_dirty() noexcept { dirty_mask_.store(0, std::memory_order_release); }
+
+        /**
+         * @brief 判断对象是否存在未落地的修改。
+         */
+        [[nodiscard]] bool is_dirty() const noexcept { return dirty_mask() != 0; }
+
+        /**
+         * @brief 取出并清空脏字段位图。
+         * @details 持久化时先取走位图再写库，写库期间产生的新修改会重新置位，不会丢失。
+         * 取走时按当前内容重新计算校验码。
+         * @return 取出前的字段位图。
+         */
+        std::uint64_t take_dirty_mask() noexcept {
+            auto mask = dirty_mask_.exchange(0, std::memory_order_acq_rel);
+            if (mask != 0) {
+                seal();
+            }
+            return mask;
+        }
+
     private:
+        friend struct ShmObjectHeaderLayout;  ///< 布局指纹需要读取头部字段的偏移（见 shmlayout.h）
+
         /**
          * @brief 设置对象状态，并更新最后修改时间。
          * @param new_state 新的对象状态。
@@ -141,9 +409,21 @@ namespace cfl::shm {
             last_update_ = std::chrono::system_clock::now();
         }
 
-        std::size_t check_code_;   ///< 对象的检查码，用于完整性校验
+        /**
+         * @brief 计算对象数据（SharedObject 之后的部分）的 CRC32C。
+         */
+        [[nodiscard]] std::uint32_t compute_checksum() const noexcept {
+            auto begin = reinterpret_cast<const char *>(this) + sizeof(SharedObject);
+            return crc32c(begin, payload_size_ - sizeof(SharedObject));
+        }
+
+        std::size_t check_code_;   ///< 对象的检查码，高 32 位为 BLOCK_CHECK_CODE 时低 32 位是对象数据的 CRC32C
         std::atomic<ObjectState> state_;  ///< 对象的生命周期状态，使用原子类型保证线程安全
+        std::uint8_t change_slot_{0};     ///< 所在池在变更日志中的编号 + 1（占用原有的填充字节）
+        std::uint32_t payload_size_{0};   ///< 对象所在块的字节数，决定校验范围（占用原有的填充字节）
         std::chrono::system_clock::time_point last_update_; ///< 最近一次状态更新的时间点
+        std::atomic<std::uint64_t> dirty_mask_{0};          ///< 脏字段位图，每一位对应一个持久化字段
+        std::atomic<std::uint64_t> seq_{0};                 ///< 写序号（seqlock），写入期间为奇数
     };
 
 } // namespace shm
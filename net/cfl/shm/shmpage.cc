@@ -1,8 +1,12 @@
 #include "shmpage.h"
 #include "spdlog/spdlog.h"
 #include <cstring>
+#include <memory>
 #include <span>
-#define BLOCK_CHECK_CODE 0x5A
+#include <format>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 #ifndef _WIN32
 /// @brief Linux/Unix 下定义 INVALID_HANDLE_VALUE
@@ -11,62 +15,57 @@
 
 using namespace cfl::shm;
 
+namespace {
+    /// 对象块大小向上对齐到缓存行，页内每个块的起始地址都落在缓存行边界上
+    constexpr std::size_t align_block_size(std::size_t size) noexcept {
+        return (size + kShmCacheLineSize - 1) / kShmCacheLineSize * kShmCacheLineSize;
+    }
+
+    static_assert(sizeof(ShmLayoutHeader) % kShmCacheLineSize == 0, "布局头之后的对象区必须按缓存行对齐");
+}
+
 /**
  * @brief 构造函数
  * @param module_id 模块编号
- * @param raw_block_size 每个原始块大小（字节数，不含头部）
+ * @param raw_block_size 每个原始块大小（字节数，不含头部），向上对齐到缓存行
  * @param blocks_per_page 每页的块数
- * @param attach_only 是否仅附加到已有共享内存
+ * @param attach_only 是否仅附加到已有共享内存（不创建、不迁移、析构时不删除）
+ * @param layout_version 对象布局版本
+ * @param layout_fingerprint 对象结构指纹
  *
  * @details
- * - 如果指定的共享内存已存在，则尝试附加并导入已有页。
+ * - 如果指定的共享内存已存在，则校验布局头后附加并导入已有页（必要时迁移）。
  * - 如果共享内存不存在且 attach_only=false，则创建新页并初始化。
  */
 SharedMemoryManagerBase::SharedMemoryManagerBase(std::size_t module_id, std::size_t raw_block_size,
-                                                 std::size_t blocks_per_page, bool attach_only)
-        : blocks_per_page_(blocks_per_page), block_size_(raw_block_size + sizeof(MemoryBlockHeader)),
-          raw_block_size_(raw_block_size), module_id_(module_id) {
-    std::size_t nSize = blocks_per_page_ * (block_size_);
+                                                 std::size_t blocks_per_page, bool attach_only,
+                                                 std::uint32_t layout_version, std::uint64_t layout_fingerprint)
+        : blocks_per_page_(blocks_per_page), block_size_(align_block_size(raw_block_size) + sizeof(MemoryBlockHeader)),
+          raw_block_size_(align_block_size(raw_block_size)), module_id_(module_id),
+          layout_version_(layout_version), layout_fingerprint_(layout_fingerprint), attach_only_(attach_only) {
     page_count_ = 0;
     total_blocks_ = 0;
+    empty_created_ = false;
 
-    SharedMemoryPage firstpage;
-    firstpage.handle = OpenShareMemory(module_id_, 0);
-    if (firstpage.handle.has_value()) {
-        firstpage.raw_data = (char *) GetShareMemory(firstpage.handle);
-        if (firstpage.raw_data != nullptr) {
-            spdlog::error("SharedMemoryManagerBase::SharedMemoryManagerBase: module_id = {}", module_id_);
-            firstpage.block_headers = (MemoryBlockHeader *) (firstpage.raw_data + raw_block_size_ * page_count_);
-            pages_.emplace_back(std::move(firstpage));
-            import_existing_pages();
-            empty_created_ = false;
-        } else {
+    // 只附加的进程（如 shm_inspect）以只读方式映射，误写会直接崩溃而不是破坏服务器的数据
+    auto handle = OpenShareMemory(module_id_, 0, attach_only_);
+    if (handle.has_value()) {
+        auto base = GetShareMemory(handle, attach_only_);
+        if (base == nullptr) {
             spdlog::error("SharedMemoryManagerBase::SharedMemoryManagerBase: firstpage.raw_data == nullptr");
             return;
         }
-    } else {
-        if (!attach_only) {
-            firstpage.handle = CreateShareMemory(module_id_, 0, nSize);
-            if (!firstpage.handle.has_value()) {
-                spdlog::error("CreateShareMemory failed: module_id = {}, nSize = {}", module_id_, nSize);
-                return;
-            }
-
-            firstpage.raw_data = (char *) GetShareMemory(firstpage.handle);
-            firstpage.block_headers = (MemoryBlockHeader *) (firstpage.raw_data + raw_block_size_ * blocks_per_page_);
-
-            /// 清空所有内存
-            memset(firstpage.raw_data, 0, nSize);
-
-            page_count_++;
-            total_blocks_ += blocks_per_page_;
-//            init_page(firstpage);
+        attach_existing(handle, base);
+        return;
+    }
 
-            pages_.emplace_back(firstpage);
-            init_page(pages_.back());
+    if (!attach_only) {
+        if (!create_new_page()) {
+            spdlog::error("CreateShareMemory failed: module_id = {}, nSize = {}", module_id_, page_size());
+            return;
         }
-        empty_created_ = true;
     }
+    empty_created_ = true;
 }
 
 /**
@@ -75,28 +74,246 @@ SharedMemoryManagerBase::SharedMemoryManagerBase(std::size_t module_id, std::siz
  */
 SharedMemoryManagerBase::~SharedMemoryManagerBase() {
     for(auto & page : pages_) {
-        cfl::shm::ReleaseShareMemory(page.raw_data);
-        cfl::shm::CloseShareMemory(page.handle);
+        cfl::shm::ReleaseShareMemory(page.base);
+        if (attach_only_) {
+            // 只附加的进程（如 shm_inspect）不能删除服务器正在使用的共享内存
+            cfl::shm::DetachShareMemoryHandle(page.handle);
+        } else {
+            cfl::shm::CloseShareMemory(page.handle);
+        }
         page.handle = INVALID_HANDLE_VALUE;
+        page.base = nullptr;
         page.raw_data = nullptr;
     }
     pages_.clear();
 }
 
+SharedMemoryPage SharedMemoryManagerBase::make_page(std::optional<ShmHandle> handle, char *base) const {
+    SharedMemoryPage page;
+    page.handle = std::move(handle);
+    page.base = base;
+    page.raw_data = base + sizeof(ShmLayoutHeader);
+    page.block_headers = reinterpret_cast<MemoryBlockHeader *>(page.raw_data + raw_block_size_ * blocks_per_page_);
+    return page;
+}
+
+void SharedMemoryManagerBase::write_layout_header(SharedMemoryPage &page, std::size_t page_index) const {
+    auto header = new(page.base) ShmLayoutHeader();
+    header->magic = kShmLayoutMagic;
+    header->header_version = kShmLayoutHeaderVersion;
+    header->layout_version = layout_version_;
+    header->page_index = static_cast<std::uint32_t>(page_index);
+    header->fingerprint = layout_fingerprint_;
+    header->raw_block_size = raw_block_size_;
+    header->blocks_per_page = blocks_per_page_;
+    header->block_header_size = sizeof(MemoryBlockHeader);
+}
+
+/**
+ * @brief 校验首页布局头并附加
+ *
+ * @details
+ * - 布局一致：沿用共享内存中记录的每页块数，导入所有页；
+ * - 布局不一致且注册了迁移函数：执行迁移；
+ * - 其他情况：拒绝附加，保持共享内存原样，由上层决定如何处理。
+ */
+bool SharedMemoryManagerBase::attach_existing(std::optional<ShmHandle> handle, char *base) {
+    const auto &layout = *reinterpret_cast<const ShmLayoutHeader *>(base);
+    auto refuse = [&](std::string_view reason) {
+        spdlog::error("[SharedMemoryManagerBase] refuse to attach module_id = {}: {}", module_id_, reason);
+        ReleaseShareMemory(base);
+        DetachShareMemoryHandle(handle);
+        layout_refused_ = true;
+        return false;
+    };
+
+    if (layout.magic != kShmLayoutMagic) {
+        return refuse("no layout header, segment was created by an older build");
+    }
+    if (layout.header_version != kShmLayoutHeaderVersion || layout.block_header_size != sizeof(MemoryBlockHeader)) {
+        return refuse(std::format("layout header version {} does not match {}",
+                                  layout.header_version, kShmLayoutHeaderVersion));
+    }
+
+    if (layout.fingerprint == layout_fingerprint_ && layout.layout_version == layout_version_
+        && layout.raw_block_size == raw_block_size_) {
+        if (layout.blocks_per_page != blocks_per_page_) {
+            spdlog::warn("[SharedMemoryManagerBase] module_id = {} uses {} blocks per page in shm, configured {}",
+                         module_id_, layout.blocks_per_page, blocks_per_page_);
+            blocks_per_page_ = static_cast<std::size_t>(layout.blocks_per_page);
+        }
+        spdlog::info("SharedMemoryManagerBase::SharedMemoryManagerBase: attach module_id = {}", module_id_);
+        pages_.emplace_back(make_page(std::move(handle), base));
+        page_count_++;
+        total_blocks_ += blocks_per_page_;
+        import_existing_pages();
+        return true;
+    }
+
+    if (layout.fingerprint == layout_fingerprint_ && layout.layout_version == layout_version_ && !attach_only_) {
+        // 结构相同，只是块大小不同（旧版本未按缓存行对齐），逐块拷贝即可
+        spdlog::warn("[SharedMemoryManagerBase] module_id = {} block size {} in shm, expected {}, re-layout",
+                     module_id_, layout.raw_block_size, raw_block_size_);
+        return migrate_existing(std::move(handle), base, layout,
+                                [this](const char *old_block, const ShmLayoutHeader &old_layout, SharedObject *new_block) {
+                                    std::memcpy(static_cast<void *>(new_block), old_block,
+                                                std::min<std::size_t>(old_layout.raw_block_size, raw_block_size_));
+                                    new_block->set_payload_size(static_cast<std::uint32_t>(raw_block_size_));
+                                    new_block->seal();
+                                    return true;
+                                });
+    }
+    if (attach_only_) {
+        return refuse(std::format("layout version {} fingerprint {:#x} does not match version {} fingerprint {:#x}, "
+                                  "attach_only never migrates",
+                                  layout.layout_version, layout.fingerprint, layout_version_, layout_fingerprint_));
+    }
+    auto migration = LayoutMigrationRegistry::instance().find(layout_fingerprint_, layout.layout_version);
+    if (migration == nullptr) {
+        return refuse(std::format("layout version {} fingerprint {:#x} does not match version {} fingerprint {:#x}",
+                                  layout.layout_version, layout.fingerprint, layout_version_, layout_fingerprint_));
+    }
+    return migrate_existing(std::move(handle), base, layout, *migration);
+}
+
+bool SharedMemoryManagerBase::migrate_existing(std::optional<ShmHandle> handle, char *base,
+                                               const ShmLayoutHeader &old_layout, const LayoutMigration &migration) {
+    auto old = old_layout;
+    auto old_raw_block_size = static_cast<std::size_t>(old.raw_block_size);
+    auto old_blocks_per_page = static_cast<std::size_t>(old.blocks_per_page);
+    auto old_page_size = sizeof(ShmLayoutHeader) + old_blocks_per_page * (old_raw_block_size + sizeof(MemoryBlockHeader));
+    spdlog::info("[SharedMemoryManagerBase] migrate module_id = {} from layout version {} to {}",
+                 module_id_, old.layout_version, layout_version_);
+
+    // 按旧布局打开所有页并整页拷贝，重建失败时用这份拷贝恢复旧共享内存
+    std::vector<std::optional<ShmHandle>> old_handles;
+    std::vector<std::vector<char>> old_images;
+    auto copy_page = [&](std::optional<ShmHandle> page_handle, char *page_base) {
+        old_images.emplace_back(page_base, page_base + old_page_size);
+        ReleaseShareMemory(page_base);
+        old_handles.push_back(std::move(page_handle));
+    };
+    copy_page(std::move(handle), base);
+    for (std::size_t page = 1;; ++page) {
+        auto page_handle = OpenShareMemory(module_id_, page);
+        if (!page_handle) {
+            break;
+        }
+        auto page_base = GetShareMemory(page_handle);
+        if (page_base == nullptr) {
+            DetachShareMemoryHandle(page_handle);
+            break;
+        }
+        copy_page(std::move(page_handle), page_base);
+    }
+
+    // 找出所有存活块
+    std::vector<const char *> old_blocks;
+    for (auto &image: old_images) {
+        auto objects = image.data() + sizeof(ShmLayoutHeader);
+        auto headers = reinterpret_cast<const MemoryBlockHeader *>(objects + old_raw_block_size * old_blocks_per_page);
+        for (std::size_t i = 0; i < old_blocks_per_page; ++i) {
+            auto block = objects + old_raw_block_size * i;
+            auto state = reinterpret_cast<const SharedObject *>(block)->state();
+            if (headers[i].in_use && (state == ObjectState::InUse || state == ObjectState::Locked)) {
+                old_blocks.push_back(block);
+            }
+        }
+    }
+
+    // 先在进程内存中按新布局构建所有对象（块大小是缓存行的整数倍，起点对齐后每块都对齐）
+    std::vector<char> staging((old_blocks.size() + 1) * raw_block_size_);
+    void *staging_base = staging.data();
+    auto staging_space = staging.size();
+    std::align(kShmCacheLineSize, old_blocks.size() * raw_block_size_, staging_base, staging_space);
+    auto staged = static_cast<char *>(staging_base);
+    std::size_t migrated = 0;
+    for (auto block: old_blocks) {
+        auto object = reinterpret_cast<SharedObject *>(staged + migrated * raw_block_size_);
+        if (migration(block, old, object)) {
+            ++migrated;
+        } else {
+            std::memset(static_cast<void *>(object), 0, raw_block_size_);
+        }
+    }
+
+    // 迁移失败时删除已建的新页，按拷贝恢复旧共享内存，并拒绝附加
+    auto rollback = [&](std::string_view reason) {
+        spdlog::error("[SharedMemoryManagerBase] migrate module_id = {}: {}, restore old segments", module_id_, reason);
+        for (auto &page: pages_) {
+            ReleaseShareMemory(page.base);
+            CloseShareMemory(page.handle);
+        }
+        pages_.clear();
+        page_count_ = 0;
+        total_blocks_ = 0;
+        block_map_.clear();
+        used_blocks_.clear();
+        free_blocks_.clear();
+        for (std::size_t page = 0; page < old_images.size(); ++page) {
+            auto page_handle = CreateShareMemory(module_id_, page, old_page_size);
+            auto page_base = GetShareMemory(page_handle);
+            if (page_base == nullptr) {
+                spdlog::error("[SharedMemoryManagerBase] migrate module_id = {}: restore page {} failed, data lost",
+                              module_id_, page);
+                DetachShareMemoryHandle(page_handle);
+                continue;
+            }
+            std::memcpy(page_base, old_images[page].data(), old_page_size);
+            ReleaseShareMemory(page_base);
+            DetachShareMemoryHandle(page_handle);
+        }
+        layout_refused_ = true;
+        return false;
+    };
+
+    // 所有对象都已构建好，此时才删除旧共享内存（同名的新页必须在旧页删除之后才能创建）
+    for (auto &page_handle: old_handles) {
+        CloseShareMemory(page_handle);
+    }
+    do {
+        if (!create_new_page()) {
+            return rollback("create page failed");
+        }
+    } while (total_blocks_ < migrated);
+
+    for (std::size_t i = 0; i < migrated; ++i) {
+        auto object = allocate_object(false);
+        if (!object.has_value() || object.value() == nullptr) {
+            return rollback("allocate failed");
+        }
+        auto target = object.value();
+        std::memcpy(static_cast<void *>(target), staged + i * raw_block_size_, raw_block_size_);
+        // 拷贝覆盖了分配时设置的对象头字段；写入中退出的对象写序号为奇数，恢复为偶数
+        target->set_payload_size(static_cast<std::uint32_t>(raw_block_size_));
+        target->set_change_slot(change_slot_);
+        target->reset_sequence();
+        target->use();
+        target->seal();
+    }
+    spdlog::info("[SharedMemoryManagerBase] migrate module_id = {}: {} / {} objects migrated",
+                 module_id_, migrated, old_blocks.size());
+    return true;
+}
+
 /**
  * @brief 导入现有共享内存页
- * @details 递归打开 module_id 下的所有共享内存页，并加入页列表
+ * @details 依次打开 module_id 下首页之后的所有共享内存页，并加入页列表
  */
 void SharedMemoryManagerBase::import_existing_pages() {
-    while (auto handle = OpenShareMemory(module_id_, page_count_)) {
-        SharedMemoryPage page;
-        page.handle = std::move(handle);
-        page.raw_data = static_cast<char*>(GetShareMemory(page.handle));
-        if (!page.raw_data) break;
-
-        page.block_headers = reinterpret_cast<MemoryBlockHeader*>(
-                page.raw_data + raw_block_size_ * blocks_per_page_);
-        pages_.push_back(std::move(page));
+    while (auto handle = OpenShareMemory(module_id_, page_count_, attach_only_)) {
+        auto base = GetShareMemory(handle, attach_only_);
+        if (!base) break;
+
+        auto layout = reinterpret_cast<const ShmLayoutHeader *>(base);
+        if (layout->magic != kShmLayoutMagic || layout->fingerprint != layout_fingerprint_) {
+            spdlog::error("[SharedMemoryManagerBase] module_id = {} page {} layout mismatch, ignored",
+                          module_id_, page_count_);
+            ReleaseShareMemory(base);
+            DetachShareMemoryHandle(handle);
+            break;
+        }
+        pages_.push_back(make_page(std::move(handle), base));
         ++page_count_;
         total_blocks_ += blocks_per_page_;
     }
@@ -164,6 +381,9 @@ std::optional<SharedObject *> SharedMemoryManagerBase::allocate_object(bool new_
             header->in_use = true;
             header->is_new = new_block;
 
+            pObject->set_payload_size(static_cast<std::uint32_t>(raw_block_size_));
+            pObject->set_change_slot(change_slot_);
+            pObject->unseal();
             pObject->use();
             return pObject;
         }
@@ -189,6 +409,14 @@ MemoryBlockHeader *SharedMemoryManagerBase::get_block_header(std::size_t index){
     return &page.block_headers[page_index];
 }
 
+MemoryBlockHeader *SharedMemoryManagerBase::find_used_block_header(const SharedObject *obj) {
+    auto it = used_blocks_.find(const_cast<SharedObject *>(obj));
+    if (it == used_blocks_.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
 /**
  * @brief 根据索引获取对象指针
  * @param index 块索引
@@ -211,20 +439,22 @@ SharedObject *SharedMemoryManagerBase::get_object(std::size_t index) {
  * @return 是否成功销毁
  *
  * @details
- * - 将对象重置
- * - 将其从 used_blocks_ 移动到 free_blocks_
+ * - 将对象重置，并丢弃脏字段位图
+ * - 将其从 used_blocks_ 移动到 free_blocks_，并递增块的代数使旧句柄失效
  */
 bool SharedMemoryManagerBase::destroy_object(cfl::shm::SharedObject *obj) {
     if (obj == nullptr) {
         return false;
     }
     obj->reset();
+    obj->clear_dirty();
     auto it = used_blocks_.find(obj);
     if (it == used_blocks_.end()) {
         return false;
     }
     auto header = it->second;
     header->in_use = false;
+    ++header->generation;
     used_blocks_.erase(it);
     free_blocks_.insert(std::make_pair(header->index, std::ref(header)));
     return true;
@@ -242,7 +472,9 @@ void SharedMemoryManagerBase::clean_dirty_blocks() {
         auto& header = kv.second;
         if (!pObject->is_in_use()) {
             pObject->reset();
+            pObject->clear_dirty();
             header->in_use = false;
+            ++header->generation;
             free_blocks_.insert({header->index, std::ref(header)});
             return true; // 删除
         }
@@ -260,35 +492,100 @@ void SharedMemoryManagerBase::clean_dirty_blocks() {
  * - 加入页列表
  */
 bool SharedMemoryManagerBase::create_new_page() {
-    std::size_t nSize = blocks_per_page_ * (block_size_);
-    SharedMemoryPage newPage;
-    spdlog::info("create new page %d", page_count_);
-    newPage.handle = CreateShareMemory(module_id_, page_count_, nSize);
-    spdlog::info("new page handle %d", newPage.handle.value());
-    if (!newPage.handle.has_value()) {
+    std::size_t nSize = page_size();
+    spdlog::info("create new page {}", page_count_);
+    auto handle = CreateShareMemory(module_id_, page_count_, nSize);
+    if (!handle.has_value()) {
         return false;
     }
 
-    newPage.raw_data = GetShareMemory(newPage.handle);
-    if (newPage.raw_data == nullptr) {
+    auto base = GetShareMemory(handle);
+    if (base == nullptr) {
         return false;
     }
 
-    newPage.block_headers = (MemoryBlockHeader *) (newPage.raw_data + raw_block_size_ * blocks_per_page_);
+    /// 清空所有内存
+    memset(base, 0, nSize);
+
+    auto newPage = make_page(std::move(handle), base);
+    write_layout_header(newPage, page_count_);
     page_count_++;
     total_blocks_ += blocks_per_page_;
-//    init_page(newPage);
-    pages_.emplace_back(std::move(newPage));
+    {
+        std::lock_guard lock(pages_mutex_);
+        pages_.emplace_back(std::move(newPage));
+    }
     init_page(pages_.back());
     return true;
 }
 
+std::vector<char *> SharedMemoryManagerBase::page_bases() const {
+    std::lock_guard lock(pages_mutex_);
+    std::vector<char *> bases;
+    bases.reserve(pages_.size());
+    for (auto &page: pages_) {
+        bases.push_back(page.base);
+    }
+    return bases;
+}
+
+bool SharedMemoryManagerBase::load_pages(std::size_t page_count,
+                                         const std::function<bool(std::size_t page, char *base)> &fill) {
+    if (!empty_created_ || !used_blocks_.empty() || page_count == 0) {
+        return false;
+    }
+    while (page_count_ < page_count) {
+        if (!create_new_page()) {
+            spdlog::error("[SharedMemoryManagerBase] load_pages module_id = {}: create page {} failed",
+                          module_id_, page_count_);
+            return false;
+        }
+    }
+
+    for (std::size_t i = 0; i < page_count; ++i) {
+        if (!fill(i, pages_[i].base)) {
+            // 镜像不可用，已写入的页恢复为空页
+            for (std::size_t j = 0; j <= i; ++j) {
+                memset(pages_[j].base, 0, page_size());
+                write_layout_header(pages_[j], j);
+                auto headers = std::span<MemoryBlockHeader>(pages_[j].block_headers, blocks_per_page_);
+                for (std::size_t k = 0; k < headers.size(); ++k) {
+                    new(&headers[k]) MemoryBlockHeader();
+                    headers[k].index = j * blocks_per_page_ + k;
+                }
+            }
+            return false;
+        }
+    }
+
+    // 映射表由 initialize_block_map 按块头重建
+    block_map_.clear();
+    free_blocks_.clear();
+    used_blocks_.clear();
+    empty_created_ = false;
+    return true;
+}
+
 void SharedMemoryManagerBase::initialize_block_map(){
     if(!empty_created_){
         for(std::size_t i = 0; i < total_blocks_; i++){
             auto header = get_block_header(i);
             auto obj = get_object(i);
-            if(header->in_use && (obj->state() == ObjectState::InUse || obj->state() == ObjectState::Locked)){
+            if(header->quarantined && !attach_only_){
+                // 上次运行隔离的块已记录日志并可由 shm_inspect 排查，对应数据已从数据库重新加载，重启时回收
+                spdlog::warn("[SharedMemoryManagerBase] module_id = {} block {} was quarantined, reclaimed",
+                             module_id_, i);
+                obj->reset();
+                obj->clear_dirty();
+                header->quarantined = false;
+                header->in_use = false;
+                ++header->generation;
+                free_blocks_.insert(std::make_pair(i, header));
+            }
+            else if(header->quarantined){
+                ++quarantined_count_;
+            }
+            else if(header->in_use && (obj->state() == ObjectState::InUse || obj->state() == ObjectState::Locked)){
                 used_blocks_.insert(std::make_pair(obj, header));
             }
             else{
@@ -298,11 +595,94 @@ void SharedMemoryManagerBase::initialize_block_map(){
         }
     }
     else{
+        // 新建的页在 create_new_page 中已经初始化
         if(pages_.empty()){
             page_count_ = 0;
-            return;
         }
+    }
+}
 
-        init_page(pages_[0]);
+std::vector<std::size_t> SharedMemoryManagerBase::verify_blocks(std::size_t worker_count) const {
+    std::vector<std::size_t> corrupt;
+    if (page_count_ == 0) {
+        return corrupt;
+    }
+    worker_count = std::clamp<std::size_t>(worker_count, 1, page_count_);
+    const auto pages_per_worker = (page_count_ + worker_count - 1) / worker_count;
+    std::vector<std::vector<std::size_t>> results(worker_count);
+    std::atomic<std::size_t> verified{0};
+
+    auto begin = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(worker_count);
+        for (std::size_t worker = 0; worker < worker_count; ++worker) {
+            auto first_page = worker * pages_per_worker;
+            auto last_page = std::min(page_count_, first_page + pages_per_worker);
+            if (first_page >= last_page) {
+                break;
+            }
+            workers.emplace_back([&, worker, first_page, last_page] {
+                std::size_t count = 0;
+                for (auto page = first_page; page < last_page; ++page) {
+                    auto &p = pages_[page];
+                    for (std::size_t i = 0; i < blocks_per_page_; ++i) {
+                        auto &header = p.block_headers[i];
+                        auto object = reinterpret_cast<const SharedObject *>(p.raw_data + raw_block_size_ * i);
+                        if (!header.in_use || header.quarantined || object->state() != ObjectState::InUse
+                            || !object->is_sealed()) {
+                            continue;
+                        }
+                        ++count;
+                        if (!object->verify()) {
+                            results[worker].push_back(header.index);
+                        }
+                    }
+                }
+                verified.fetch_add(count, std::memory_order_relaxed);
+            });
+        }
     }
+
+    for (auto &result: results) {
+        corrupt.insert(corrupt.end(), result.begin(), result.end());
+    }
+    spdlog::info("[SharedMemoryManagerBase] verify module_id = {}: {} blocks, {} corrupt, {} workers, crc32c {}, cost {}ms",
+                 module_id_, verified.load(), corrupt.size(), worker_count,
+                 crc32c_hardware() ? "sse4.2" : "software",
+                 std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - begin).count());
+    return corrupt;
+}
+
+void SharedMemoryManagerBase::quarantine_blocks(const std::vector<std::size_t> &indices) {
+    for (auto index: indices) {
+        auto header = get_block_header(index);
+        auto object = get_object(index);
+        if (header == nullptr || object == nullptr || header->quarantined) {
+            continue;
+        }
+        spdlog::error("[SharedMemoryManagerBase] module_id = {} block {} checksum mismatch, quarantined",
+                      module_id_, index);
+        // 只做标记：块不再分配、恢复时跳过，内容和状态原样保留，供 shm_inspect 排查
+        used_blocks_.erase(object);
+        free_blocks_.erase(index);
+        header->quarantined = true;
+        ++quarantined_count_;
+    }
+}
+
+void SharedMemoryManagerBase::set_change_slot(std::uint8_t slot) {
+    change_slot_ = slot;
+    if (attach_only_) {
+        return;
+    }
+    for (auto &[object, header]: used_blocks_) {
+        static_cast<SharedObject *>(object)->set_change_slot(slot);
+    }
+}
+
+LayoutMigrationRegistry &LayoutMigrationRegistry::instance() {
+    static LayoutMigrationRegistry instance;
+    return instance;
 }
\ No newline at end of file
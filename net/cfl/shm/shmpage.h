@@ -25,6 +25,7 @@
 #include <map>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <stdexcept>
 #include <system_error>
@@ -33,6 +34,7 @@
 #include <unordered_map>
 #include "shm.h"
 #include "shmobj.h"
+#include "shmlayout.h"
 
 #if defined(_WIN32)
 #define NOMINMAX
@@ -56,8 +58,10 @@ namespace cfl::shm {
  */
     struct MemoryBlockHeader {
         std::size_t index = 0;        ///< 数据块编号
+        std::uint32_t generation = 0; ///< 代数，块每回收一次加一，用于识别过期句柄
         bool in_use = false;          ///< 是否正在使用
         bool is_new = false;          ///< 是否是新创建的块
+        bool quarantined = false;     ///< 校验失败被隔离，不再分配
         std::time_t before_time = 0;  ///< DS 服务器写入前的时间戳
         std::time_t after_time = 0;   ///< DS 服务器写入后的时间戳
     };
@@ -66,7 +70,8 @@ namespace cfl::shm {
  * @brief 共享内存页
  */
     struct SharedMemoryPage {
-        char *raw_data = nullptr;                  ///< 指向共享内存原始数据
+        char *base = nullptr;                      ///< 映射起始地址，存放 ShmLayoutHeader
+        char *raw_data = nullptr;                  ///< 指向共享内存原始数据（布局头之后）
         MemoryBlockHeader *block_headers = nullptr;///< 块头数组起始地址
         std::optional<ShmHandle> handle{};         ///< 平台相关的共享内存句柄
 
@@ -91,14 +96,21 @@ namespace cfl::shm {
         /**
          * @brief 构造函数：创建或附加到共享内存
          * @param module_id 模块编号
-         * @param raw_block_size 每个原始块大小（字节）
+         * @param raw_block_size 每个原始块大小（字节），向上对齐到 kShmCacheLineSize
          * @param blocks_per_page 每页的块数
-         * @param attach_only 如果为 true 则附加到已有共享内存，否则新建
+         * @param attach_only 如果为 true 则只附加到已有共享内存：不新建、不迁移，析构时也不删除共享内存
+         * @param layout_version 对象布局版本
+         * @param layout_fingerprint 对象结构指纹
+         *
+         * @details 附加到已有共享内存时会校验首页布局头，指纹不一致时尝试执行已注册的迁移，
+         * 无法迁移则拒绝附加（layout_refused() 返回 true），不会修改已有共享内存。
          */
         explicit SharedMemoryManagerBase(std::size_t module_id,
                                          std::size_t raw_block_size,
                                          std::size_t blocks_per_page,
-                                         bool attach_only = false);
+                                         bool attach_only = false,
+                                         std::uint32_t layout_version = 0,
+                                         std::uint64_t layout_fingerprint = 0);
 
         /**
          * @brief 析构函数
@@ -114,9 +126,16 @@ namespace cfl::shm {
         std::size_t page_count_;         ///< 页数量
         std::size_t total_blocks_;       ///< 总块数
         std::size_t block_size_;         ///< 每块字节大小（含头部）
-        std::size_t raw_block_size_;     ///< 原始块大小（未对齐）
+        std::size_t raw_block_size_;     ///< 对象块大小（已对齐到缓存行，不含块头）
         std::size_t module_id_;          ///< 模块编号
         bool empty_created_;             ///< 是否首次创建
+        std::uint32_t layout_version_;   ///< 对象布局版本
+        std::uint64_t layout_fingerprint_; ///< 对象结构指纹
+        bool layout_refused_{false};     ///< 布局不兼容，拒绝附加
+        bool attach_only_{false};        ///< 只附加，不创建、不迁移、不删除共享内存
+        std::size_t quarantined_count_{0}; ///< 被隔离的块数量
+        std::uint8_t change_slot_{0};    ///< 在变更日志中的编号 + 1，0 表示未登记
+        mutable std::mutex pages_mutex_; ///< 保护 pages_ 的增长，供后台检查点线程读取页地址
 
         using BlockRef = std::reference_wrapper<MemoryBlockHeader>;
 
@@ -139,6 +158,29 @@ namespace cfl::shm {
          */
         bool create_new_page();
 
+        /**
+         * @brief 根据映射地址计算页内各区域的位置
+         */
+        SharedMemoryPage make_page(std::optional<ShmHandle> handle, char *base) const;
+
+        /**
+         * @brief 写入页的布局头
+         */
+        void write_layout_header(SharedMemoryPage &page, std::size_t page_index) const;
+
+        /**
+         * @brief 校验已有共享内存首页的布局头，并决定附加、迁移或拒绝
+         * @return 是否附加成功
+         */
+        bool attach_existing(std::optional<ShmHandle> handle, char *base);
+
+        /**
+         * @brief 按旧布局读出所有存活块，在进程内存中迁移完成后再重建共享内存
+         * @return 是否迁移成功；重建失败时恢复旧共享内存并拒绝附加（layout_refused() 返回 true）
+         */
+        bool migrate_existing(std::optional<ShmHandle> handle, char *base, const ShmLayoutHeader &old_layout,
+                              const LayoutMigration &migration);
+
         /**
          * @brief 初始化页面数据区域
          * @details 将页面清零并初始化所有块头
@@ -147,17 +189,97 @@ namespace cfl::shm {
         void init_page(SharedMemoryPage &page);
 
     public:
+        /**
+         * @brief 共享内存页的总字节数（布局头 + 对象区 + 块头区）
+         */
+        std::size_t page_size() const noexcept {
+            return sizeof(ShmLayoutHeader) + blocks_per_page_ * block_size_;
+        }
+
+        /**
+         * @brief 获取模块编号
+         */
+        std::size_t module_id() const noexcept { return module_id_; }
+
+        /**
+         * @brief 获取对象布局版本
+         */
+        std::uint32_t layout_version() const noexcept { return layout_version_; }
+
+        /**
+         * @brief 获取对象结构指纹
+         */
+        std::uint64_t layout_fingerprint() const noexcept { return layout_fingerprint_; }
+
+        /**
+         * @brief 获取所有页的起始地址（包含布局头），可在其他线程中调用
+         */
+        std::vector<char *> page_bases() const;
+
+        /**
+         * @brief 用外部保存的整页镜像填充新建的共享内存（用于从检查点恢复）
+         *
+         * @details 只能在构造后、initialize_block_map 之前且共享内存为新建时调用。
+         * 依次创建 page_count 个页并调用 fill 写入整页内容（布局头 + 对象区 + 块头区），
+         * 成功后共享内存视为已有数据，由 initialize_block_map 按块头重建映射表。
+         *
+         * @param page_count 页数量
+         * @param fill 写入第 page 页的内容，返回 false 表示镜像不可用
+         * @return 是否填充成功，失败时共享内存重置为空页
+         */
+        bool load_pages(std::size_t page_count, const std::function<bool(std::size_t page, char *base)> &fill);
+
         /**
          * @brief 初始化块映射表
+         * @details 上次运行隔离的块在此回收（只附加模式下保留，只计数）。
          */
         void initialize_block_map();
 
+        /**
+         * @brief 并发校验所有使用中对象块的 CRC32C
+         * @details 按页区间切分给多个工作线程，只读取共享内存，不修改映射表。
+         * 未封存（上次持久化之后又被写过）和写入中的对象不参与校验。
+         * @param worker_count 工作线程数（不超过页数）
+         * @return 校验失败的块索引（升序）
+         */
+        std::vector<std::size_t> verify_blocks(std::size_t worker_count) const;
+
+        /**
+         * @brief 隔离校验失败的块
+         * @details 把块从已使用映射表中移除并标记为隔离，本次运行中既不会被恢复也不会被再次分配，
+         * 对应的数据由上层从数据库重新加载（见 DataPoolManager::restore_from_shared_memory）。
+         * 块的内容、状态和代数保持不变，供 shm_inspect 排查；下次启动时 initialize_block_map 回收仍处于隔离状态的块。
+         * @param indices 块索引
+         */
+        void quarantine_blocks(const std::vector<std::size_t> &indices);
+
+        /**
+         * @brief 设置本池在变更日志中的编号（池编号 + 1），0 表示不再发布变更
+         * @details 同时更新所有使用中对象，之后分配的对象也会带上该编号。只附加模式下不修改共享内存。
+         */
+        void set_change_slot(std::uint8_t slot);
+
+        /**
+         * @brief 获取本池在变更日志中的编号（池编号 + 1）
+         */
+        std::uint8_t change_slot() const noexcept { return change_slot_; }
+
+        /**
+         * @brief 获取被隔离的块数量
+         */
+        std::size_t quarantined_count() const noexcept { return quarantined_count_; }
+
         /**
          * @brief 是否是首次创建共享内存
          * @return true 表示首次创建
          */
         bool is_first_created() const noexcept { return empty_created_; }
 
+        /**
+         * @brief 附加时布局校验失败，共享内存未被使用
+         */
+        bool layout_refused() const noexcept { return layout_refused_; }
+
         /**
          * @brief 从共享内存中恢复其他页信息
          */
@@ -185,6 +307,13 @@ namespace cfl::shm {
          */
         MemoryBlockHeader *get_block_header(std::size_t index);
 
+        /**
+         * @brief 根据对象指针查找已使用块的块头
+         * @param obj 对象指针
+         * @return 块头指针，对象不在已使用块中时返回 nullptr
+         */
+        MemoryBlockHeader *find_used_block_header(const SharedObject *obj);
+
         /**
          * @brief 通过索引获取对象指针
          * @param index 块索引
@@ -193,7 +322,17 @@ namespace cfl::shm {
         SharedObject *get_object(std::size_t index);
 
         /**
-         * @brief 获取原始块大小
+         * @brief 获取页数量
+         */
+        std::size_t page_count() const noexcept { return page_count_; }
+
+        /**
+         * @brief 获取每页块数
+         */
+        std::size_t blocks_per_page() const noexcept { return blocks_per_page_; }
+
+        /**
+         * @brief 获取对象块大小（已对齐到缓存行）
          */
         std::size_t raw_block_size() const noexcept { return raw_block_size_; }
 
@@ -233,7 +372,8 @@ namespace cfl::shm {
         SharedMemoryManager(std::size_t module_id,
                             std::size_t blocks_per_page,
                             bool attach_only = false) : SharedMemoryManagerBase(module_id, sizeof(T), blocks_per_page,
-                                                                                attach_only) {}
+                                                                                attach_only, ShmLayout<T>::version,
+                                                                                ShmLayout<T>::fingerprint) {}
 
 /**
          * @brief 通过索引获取对象
@@ -252,9 +392,13 @@ namespace cfl::shm {
                 return std::nullopt;
             }
             T *obj = static_cast<T *>(obj_opt.value());
-            // 在共享内存中原位构造对象
-            if(is_new_block)
+            // 在共享内存中原位构造对象，构造函数会重置状态和校验范围，需要重新设置
+            if(is_new_block) {
                 new(obj) T();
+                obj->set_payload_size(static_cast<std::uint32_t>(raw_block_size_));
+                obj->set_change_slot(change_slot_);
+                obj->use();
+            }
             return std::make_optional(obj);
         }
 
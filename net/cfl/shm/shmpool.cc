@@ -1,4 +1,9 @@
 #include "shmpool.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
 #include "obj/role_data_obj.h"
 #include "obj/global_data_obj.h"
 #include "obj/mail_data_obj.h"
@@ -23,47 +28,289 @@ namespace cfl::shm {
         }
 
         // 先清空，确保可重复 init
+        stop_checkpoint_thread();
+        ShmChangeLog::install(nullptr);
+        change_log_.reset();
         data_object_pools_.clear();
         data_object_pools_.resize(static_cast<size_t>(SHMTYPE::End));
 
+        checkpoints_.clear();
+        checkpoints_.resize(static_cast<size_t>(SHMTYPE::End));
+        auto checkpoint_dir = Config::GetGameInfo<std::string>("shm_checkpoint_dir", "");
+        if (!checkpoint_dir.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(checkpoint_dir, ec);
+            if (ec) {
+                spdlog::error("[DataPoolManager] 创建检查点目录 {} 失败: {}", checkpoint_dir, ec.message());
+                checkpoint_dir.clear();
+            }
+            checkpoint_interval_ = std::chrono::seconds(
+                    std::max(1, Config::GetGameInfo("shm_checkpoint_interval", 60)));
+        }
+
         auto add_pool = [&](SHMTYPE type, auto &&factory) {
             auto idx = static_cast<size_t>(type);
             data_object_pools_[idx] = factory();
-            data_object_pools_[idx]->initialize_block_map();
+            // 附加到已有共享内存，或用检查点文件填充的池都要校验
+            bool attached = !data_object_pools_[idx]->is_first_created();
+            bool restored = false;
+            if (data_object_pools_[idx]->layout_refused()) {
+                spdlog::error("初始化失败: 共享内存池 {} 布局不兼容，请清理共享内存或注册布局迁移", idx);
+                return false;
+            }
+            if (!checkpoint_dir.empty()) {
+                auto path = std::filesystem::path(checkpoint_dir) / std::format("shm_{}_{}.ckpt", area_id, idx);
+                checkpoints_[idx] = std::make_unique<ShmCheckpoint>(path.string());
+                // 主机重启后共享内存不存在，用检查点文件填充
+                if (!attached) {
+                    restored = checkpoints_[idx]->restore(*data_object_pools_[idx]);
+                }
+            }
+            auto &pool = data_object_pools_[idx];
+            pool->initialize_block_map();
+            // 校验失败的块被隔离（本次运行只标记、不回收，下次启动时回收），对应数据在玩家登录时从数据库重新加载；
+            // 检查点文件可能在写入过程中主机断电，比附加的共享内存更需要校验
+            if (attached || restored) {
+                pool->quarantine_blocks(pool->verify_blocks(restore_worker_count()));
+            }
             return true;
         };
         if (!add_pool(SHMTYPE::RoleData, [&] { return std::make_shared<SharedMemoryManager<RoleDataObject>>(static_cast<size_t>(SHMTYPE::RoleData), 1024); })) return false;
         if (!add_pool(SHMTYPE::Global, [&] { return std::make_shared<SharedMemoryManager<GlobalDataObject>>(static_cast<size_t>(SHMTYPE::Global), 1024); })) return false;
         if (!add_pool(SHMTYPE::Mail, [&] { return std::make_shared<SharedMemoryManager<MailDataObject>>(static_cast<size_t>(SHMTYPE::Mail), 1024); })) return false;
         if (!add_pool(SHMTYPE::GroupMail, [&] { return std::make_shared<SharedMemoryManager<GroupMailDataObject>>(static_cast<size_t>(SHMTYPE::GroupMail), 1024); })) return false;
+        if (!add_pool(SHMTYPE::GroupMailState, [&] { return std::make_shared<SharedMemoryManager<GroupMailStateObject>>(static_cast<size_t>(SHMTYPE::GroupMailState), 1024); })) return false;
+
+        auto changelog_capacity = Config::GetGameInfo("shm_changelog_capacity", 0);
+        if (changelog_capacity > 0) {
+            change_log_ = std::make_unique<ShmChangeLog>(kShmChangeLogModuleId,
+                                                         static_cast<std::size_t>(changelog_capacity));
+            if (change_log_->valid()) {
+                for (std::size_t idx = 0; idx < data_object_pools_.size(); ++idx) {
+                    change_log_->watch(idx, *data_object_pools_[idx]);
+                }
+                // 游戏进程重启期间的修改没有记录，让消费者全量扫描一次
+                change_log_->mark_overflow();
+                ShmChangeLog::install(change_log_.get());
+            } else {
+                spdlog::error("[DataPoolManager] 变更日志不可用，持久化进程需要全量扫描");
+                change_log_.reset();
+            }
+        }
+
+        if (!checkpoint_dir.empty()) {
+            start_checkpoint_thread();
+        }
         return true;
     }
 
     bool DataPoolManager::release() {
+        if (checkpoint_thread_.joinable()) {
+            stop_checkpoint_thread();
+            checkpoint();
+        }
+        ShmChangeLog::install(nullptr);
+        change_log_.reset();
         data_object_pools_.clear();
+        checkpoints_.clear();
         return true;
     }
 
+    bool DataPoolManager::checkpoint() {
+        std::lock_guard lock(checkpoint_mutex_);
+        auto begin = std::chrono::steady_clock::now();
+        bool result = true;
+        ShmCheckpointStats total;
+        for (std::size_t idx = 0; idx < checkpoints_.size() && idx < data_object_pools_.size(); ++idx) {
+            auto &checkpoint = checkpoints_[idx];
+            auto &pool = data_object_pools_[idx];
+            if (!checkpoint || !pool) {
+                continue;
+            }
+            ShmCheckpointStats stats;
+            if (!checkpoint->write(*pool, &stats)) {
+                spdlog::error("[DataPoolManager] checkpoint pool {} to {} failed", idx, checkpoint->path());
+                result = false;
+                continue;
+            }
+            total.pages += stats.pages;
+            total.dirty_pages += stats.dirty_pages;
+            total.dirty_blocks += stats.dirty_blocks;
+            total.skipped_blocks += stats.skipped_blocks;
+            total.bytes += stats.bytes;
+        }
+        spdlog::info("[DataPoolManager] checkpoint: {} / {} pages, {} blocks, {} bytes written, {} busy blocks skipped, cost {}ms",
+                     total.dirty_pages, total.pages, total.dirty_blocks, total.bytes, total.skipped_blocks,
+                     std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::steady_clock::now() - begin).count());
+        return result;
+    }
+
+    void DataPoolManager::start_checkpoint_thread() {
+        stop_checkpoint_thread();
+        checkpoint_thread_ = std::jthread([this](std::stop_token token) {
+            std::mutex wait_mutex;
+            std::condition_variable_any wait_cv;
+            std::unique_lock wait_lock(wait_mutex);
+            while (!token.stop_requested()) {
+                // 只等待停止请求或超时
+                wait_cv.wait_for(wait_lock, token, checkpoint_interval_, [] { return false; });
+                if (token.stop_requested()) {
+                    break;
+                }
+                checkpoint();
+            }
+        });
+    }
+
+    void DataPoolManager::stop_checkpoint_thread() {
+        if (checkpoint_thread_.joinable()) {
+            checkpoint_thread_.request_stop();
+            checkpoint_thread_.join();
+        }
+    }
+
+    void DataPoolManager::register_restore_handler(SHMTYPE type, RestoreHandler handler) {
+        auto idx = static_cast<size_t>(type);
+        if (idx >= restore_handlers_.size()) {
+            spdlog::error("register_restore_handler 错误: index={} 超出范围", idx);
+            return;
+        }
+        restore_handlers_[idx] = std::move(handler);
+    }
+
+    std::size_t DataPoolManager::restore_worker_count() const {
+        int threads = Config::GetGameInfo("restore_threads", 0);
+        if (threads > 0) {
+            return static_cast<std::size_t>(threads);
+        }
+        return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    std::size_t DataPoolManager::for_each_used_object(SHMTYPE type, const RestoreVisitor &visitor,
+                                                      std::size_t worker_count) {
+        auto pool = get_shared_pool(type);
+        if (!pool || !visitor || pool->page_count() == 0) {
+            return 0;
+        }
+
+        const auto page_count = pool->page_count();
+        const auto blocks_per_page = pool->blocks_per_page();
+        worker_count = std::clamp<std::size_t>(worker_count, 1, page_count);
+        const auto pages_per_worker = (page_count + worker_count - 1) / worker_count;
+
+        std::atomic<std::size_t> restored{0};
+        std::atomic<std::size_t> failed{0};
+        std::atomic<std::size_t> torn{0};
+
+        auto scan = [&](std::size_t worker, std::size_t first_page, std::size_t last_page) {
+            auto begin = std::chrono::steady_clock::now();
+            std::size_t ok = 0;
+            for (auto index = first_page * blocks_per_page; index < last_page * blocks_per_page; ++index) {
+                auto header = pool->get_block_header(index);
+                auto object = pool->get_object(index);
+                // 隔离的块内容不可信，对应数据在玩家登录时从数据库重新加载
+                if (!header || !object || !header->in_use || header->quarantined) {
+                    continue;
+                }
+                auto state = object->state();
+                if (state != ObjectState::InUse && state != ObjectState::Locked) {
+                    continue;
+                }
+                if (state == ObjectState::Locked) {
+                    // 进程在写入过程中退出，数据可能只写了一半，仍然恢复但需要留意；
+                    // unlock 同时把写序号恢复为偶数，否则快照读者会一直重试
+                    torn.fetch_add(1, std::memory_order_relaxed);
+                    object->unlock();
+                }
+                if (visitor(worker, object)) {
+                    ++ok;
+                } else {
+                    failed.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            restored.fetch_add(ok, std::memory_order_relaxed);
+            spdlog::info("[DataPoolManager] restore pool {} worker {} pages [{}, {}) objects {} cost {}ms",
+                         static_cast<size_t>(type), worker, first_page, last_page, ok,
+                         std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - begin).count());
+        };
+
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(worker_count);
+            for (std::size_t worker = 0; worker < worker_count; ++worker) {
+                auto first_page = worker * pages_per_worker;
+                auto last_page = std::min(page_count, first_page + pages_per_worker);
+                if (first_page >= last_page) {
+                    break;
+                }
+                workers.emplace_back(scan, worker, first_page, last_page);
+            }
+        }
+
+        if (torn.load() > 0) {
+            spdlog::warn("[DataPoolManager] restore pool {}: {} objects were locked when the process exited",
+                         static_cast<size_t>(type), torn.load());
+        }
+        if (failed.load() > 0) {
+            spdlog::error("[DataPoolManager] restore pool {}: {} objects failed to restore",
+                          static_cast<size_t>(type), failed.load());
+        }
+        return restored.load();
+    }
+
     bool DataPoolManager::restore_from_shared_memory() {
-        // 这里可以直接用范围 for
-//        for (auto& pool : data_object_pools_) {
-//            if (!pool) continue;
-//
-//            auto& used_map = pool->get_used_data_list();
-//            for (auto& [ptr, block] : used_map) {
-//                if (auto* role_obj = dynamic_cast<RoleDataObject*>(ptr)) {
-//                    auto* player = CPlayerManager::GetInstancePtr()->CreatePlayer(role_obj->role_id);
-//                    if (player) {
-//                        player->Init(role_obj->role_id);
-//                        if (auto* role_module = dynamic_cast<CRoleModule*>(player->GetModuleByType(MT_ROLE))) {
-//                            role_module->RestoreData(role_obj);
-//                        }
-//                    }
-//                }
-//            }
-//        }
+        auto begin = std::chrono::steady_clock::now();
+        auto worker_count = restore_worker_count();
+        bool result = true;
+        std::size_t total = 0;
+        // 变更日志只允许单个生产者，并发恢复期间暂停发布
+        ShmChangeLog::install(nullptr);
 
-        return true;
+        for (std::size_t idx = 0; idx < restore_handlers_.size(); ++idx) {
+            auto &handler = restore_handlers_[idx];
+            if (!handler.visit) {
+                continue;
+            }
+            auto type = static_cast<SHMTYPE>(idx);
+            auto pool = get_shared_pool(type);
+            if (!pool) {
+                continue;
+            }
+            if (pool->is_first_created()) {
+                spdlog::info("[DataPoolManager] pool {} is newly created, nothing to restore", idx);
+                continue;
+            }
+
+            auto pool_begin = std::chrono::steady_clock::now();
+            auto count = for_each_used_object(type, handler.visit, worker_count);
+            if (handler.finish && !handler.finish(std::min(worker_count, pool->page_count()))) {
+                spdlog::error("[DataPoolManager] restore pool {} finish failed", idx);
+                result = false;
+            }
+            total += count;
+            if (pool->quarantined_count() > 0) {
+                // 隔离的块不恢复：其所有者（角色、邮件）不在内存中，下次登录时经 read_from_db_login_data 从数据库重新加载
+                spdlog::warn("[DataPoolManager] restore pool {}: {} quarantined blocks skipped, "
+                             "their owners reload from the database on next login, blocks are reclaimed on next restart",
+                             idx, pool->quarantined_count());
+            }
+            spdlog::info("[DataPoolManager] restore pool {} done: {} / {} used blocks, cost {}ms",
+                         idx, count, pool->used_count(),
+                         std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - pool_begin).count());
+        }
+
+        if (change_log_) {
+            change_log_->mark_overflow();
+            ShmChangeLog::install(change_log_.get());
+        }
+        spdlog::info("[DataPoolManager] restore_from_shared_memory: {} objects with {} workers, cost {}ms",
+                     total, worker_count,
+                     std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::steady_clock::now() - begin).count());
+        return result;
     }
 
     SharedMemoryManagerBasePtr DataPoolManager::get_shared_pool(SHMTYPE index) {
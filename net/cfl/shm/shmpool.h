@@ -3,8 +3,18 @@
 #include <vector>
 #include <memory>
 #include <cstdint>
+#include <chrono>
+#include <cstring>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
 #include "spdlog/spdlog.h"
 #include "shmpage.h"
+#include "shmcheckpoint.h"
+#include "shmchangelog.h"
 #include "cfl/config.h"
 #include "cfl/cfl.h"
 /**
@@ -19,11 +29,29 @@ namespace cfl::shm {
         Global,
         Mail,
         GroupMail,
+        GroupMailState,
         End,
     };
     using SharedMemoryManagerBasePtr = std::shared_ptr<SharedMemoryManagerBase>;
 //    using SharedMemoryManagerBasePtr = SharedMemoryManagerBase*;
 
+    /**
+     * @brief 恢复时对每个存活对象的回调
+     * @param worker 工作线程编号（0 ~ worker_count-1），用于写入线程私有的容器而无需加锁
+     * @param object 共享内存中的存活对象
+     * @return true 表示该对象恢复成功
+     * @note 会在多个工作线程中并发调用
+     */
+    using RestoreVisitor = std::function<bool(std::size_t worker, SharedObject *object)>;
+
+    /**
+     * @brief 某个共享内存池的恢复处理器
+     */
+    struct RestoreHandler {
+        RestoreVisitor visit;                               ///< 并发处理每个存活对象
+        std::function<bool(std::size_t worker_count)> finish; ///< 整个池扫描完成后在调用线程中执行（可为空）
+    };
+
     class DataPoolManager {
     public:
         /**
@@ -40,16 +68,67 @@ namespace cfl::shm {
 
         /**
          * @brief 释放共享内存对象池
+         * @details 启用检查点时先停止检查点线程并写入最后一次检查点。
          * @return true 表示释放成功，false 表示失败
          */
         bool release();
 
+        /**
+         * @brief 把所有共享内存池增量写入检查点文件
+         *
+         * @details 检查点目录取配置项 shm_checkpoint_dir，为空时不启用。
+         * 启用后 init 会启动后台线程，每隔 shm_checkpoint_interval 秒（默认 60）调用一次；
+         * 启动时共享内存不存在的池会先尝试从检查点文件恢复，恢复或附加的池都会先做 CRC32C 校验。
+         * 可在任意线程调用。
+         *
+         * @return true 表示全部写入成功，未启用时也返回 true
+         */
+        bool checkpoint();
+
+        /**
+         * @brief 获取变更日志
+         *
+         * @details 配置项 shm_changelog_capacity 大于 0 时，init 在独立的共享内存段中创建容量为该值的变更日志
+         * 并登记所有池，之后对象每次 unlock 都会追加一条变更记录，供以 attach_only 方式运行的持久化进程增量读取。
+         *
+         * @return 未启用时返回 nullptr
+         */
+        ShmChangeLog *change_log() const noexcept { return change_log_.get(); }
+
+        /**
+         * @brief 注册某个共享内存池的恢复处理器
+         * @param type 共享内存池类型
+         * @param handler 恢复处理器
+         */
+        void register_restore_handler(SHMTYPE type, RestoreHandler handler);
+
         /**
          * @brief 从共享内存恢复对象池状态
+         *
+         * @details 按 SHMTYPE 顺序依次恢复已注册处理器的池（先角色后邮件，保证邮件恢复时玩家已存在）。
+         * 每个池按页区间切分给多个工作线程并发扫描，扫描完成后调用 finish 汇总。
+         * 工作线程数取配置项 restore_threads，未配置时取硬件并发数。
+         * 恢复期间多个工作线程会 unlock 写了一半的对象，此时暂停发布变更，完成后通知消费者全量扫描。
+         *
          * @return true 表示恢复成功，false 表示失败
          */
         bool restore_from_shared_memory();
 
+        /**
+         * @brief 并发遍历某个池中的所有存活对象
+         *
+         * @param type 共享内存池类型
+         * @param visitor 对象回调
+         * @param worker_count 工作线程数（不超过页数）
+         * @return 回调返回 true 的对象数量
+         */
+        std::size_t for_each_used_object(SHMTYPE type, const RestoreVisitor &visitor, std::size_t worker_count);
+
+        /**
+         * @brief 获取恢复使用的工作线程数
+         */
+        [[nodiscard]] std::size_t restore_worker_count() const;
+
         /**
          * @brief 根据索引获取共享内存对象池
          * @param index 共享内存池索引
@@ -57,6 +136,16 @@ namespace cfl::shm {
          */
         SharedMemoryManagerBasePtr get_shared_pool(SHMTYPE index);
 
+        /**
+         * @brief 根据索引获取共享内存对象池（不增加引用计数，供高频访问路径使用）
+         * @param index 共享内存池索引
+         * @return 池指针，不存在或已释放时返回 nullptr
+         */
+        SharedMemoryManagerBase *find_pool(SHMTYPE index) const noexcept {
+            auto idx = static_cast<size_t>(index);
+            return idx < data_object_pools_.size() ? data_object_pools_[idx].get() : nullptr;
+        }
+
     private:
         /// @brief 私有构造函数，确保单例模式
         DataPoolManager(){
@@ -65,7 +154,10 @@ namespace cfl::shm {
         }
 
         /// @brief 私有析构函数
-        ~DataPoolManager() = default;
+        ~DataPoolManager() {
+            stop_checkpoint_thread();
+            ShmChangeLog::install(nullptr);
+        }
 
         /// @brief 禁止拷贝构造
         DataPoolManager(const DataPoolManager &) = delete;
@@ -73,12 +165,73 @@ namespace cfl::shm {
         /// @brief 禁止赋值操作
         DataPoolManager &operator=(const DataPoolManager &) = delete;
 
+        /// @brief 启动后台检查点线程
+        void start_checkpoint_thread();
+
+        /// @brief 停止后台检查点线程
+        void stop_checkpoint_thread();
+
     private:
         /// @brief 存放共享内存对象池的数组
         std::vector<SharedMemoryManagerBasePtr> data_object_pools_;
 
+        /// @brief 各共享内存池的恢复处理器，下标为 SHMTYPE
+        std::vector<RestoreHandler> restore_handlers_{static_cast<size_t>(SHMTYPE::End)};
+
         /// @brief 每页共享内存大小（字节）
         std::uint32_t shared_page_size_ = 0;
+
+        /// @brief 各共享内存池的检查点文件，下标为 SHMTYPE，未启用时为空
+        std::vector<std::unique_ptr<ShmCheckpoint>> checkpoints_;
+
+        /// @brief 检查点间隔
+        std::chrono::seconds checkpoint_interval_{60};
+
+        /// @brief 串行化检查点写入
+        std::mutex checkpoint_mutex_;
+
+        /// @brief 后台检查点线程
+        std::jthread checkpoint_thread_;
+
+        /// @brief 变更日志，未启用时为空
+        std::unique_ptr<ShmChangeLog> change_log_;
+    };
+
+    /**
+     * @brief 在刚分配的块上构造 T
+     *
+     * @details 块可能是回收来的，仍保留上一个对象的全部字段，必须先清零再原位构造。
+     * 构造会重置对象头，这里重新设置校验范围、变更日志编号和状态。
+     *
+     * @param pool 块所在的池
+     * @param block allocate_object 返回的块
+     * @return 构造好的对象
+     */
+    template<class T>
+    T *construct_object(const SharedMemoryManagerBase &pool, SharedObject *block) {
+        static_assert(std::is_base_of_v<SharedObject, T>, "T 必须派生自 SharedObject");
+        std::memset(static_cast<void *>(block), 0, pool.raw_block_size());
+        auto object = new(block) T();
+        object->set_payload_size(static_cast<std::uint32_t>(pool.raw_block_size()));
+        object->set_change_slot(pool.change_slot());
+        object->use();
+        return object;
+    }
+
+    /**
+     * @brief create_object / attach_object 使用的删除器：析构对象并把块归还给池
+     * @details pool 为空时什么也不做，对象留在共享内存中（见 detach_object）。
+     */
+    template<class T>
+    struct ShmObjectDeleter {
+        SharedMemoryManagerBasePtr pool;    ///< 对象所在的池，持有引用保证池在对象之后释放
+
+        void operator()(T *p) const {
+            if (p && pool) {
+                p->~T(); // 共享内存的分配由 pool 管理，只析构并归还块
+                pool->destroy_object(p);
+            }
+        }
     };
 
     /**
@@ -88,6 +241,10 @@ namespace cfl::shm {
      * @param index 共享内存池索引
      * @param allocate_new 是否分配新的内存块（默认为 true）
      * @return 指向创建对象的指针，若失败则返回 nullptr
+     *
+     * @note 块可能是回收来的，返回前会清零并原位构造 T（见 construct_object）。
+     *       最后一个引用释放时调用析构函数并立即把块归还给池（destroy_object），
+     *       删除器持有池的引用，保证池在对象之后释放。
      */
     template<class T>
     std::shared_ptr<T> create_object(SHMTYPE index, bool allocate_new = true) {
@@ -96,18 +253,81 @@ namespace cfl::shm {
             spdlog::error("CreateObject 错误: SharedMemoryBase 为空");
             return nullptr;
         }
-        auto x = static_cast<T*>(ssm->allocate_object(allocate_new).value());
-        std::shared_ptr<T> object(x,
-                [](T* p) {
-                    if (p) {
-                        p->~T(); // 调用析构函数，但不释放内存，因为共享内存的分配由 pool 管理
-                    }
-                }
-        );
-
-        if (!object) {
-            spdlog::get("sys")->error("CreateObject 错误, 原因: %s", cfl::shm::get_last_error_str(cfl::shm::get_last_error()).c_str());
+        auto allocated = ssm->allocate_object(allocate_new);
+        if (!allocated.has_value() || allocated.value() == nullptr) {
+            spdlog::error("CreateObject 错误: 分配共享内存块失败, pool={}", static_cast<size_t>(index));
+            return nullptr;
         }
+        auto constructed = construct_object<T>(*ssm, allocated.value());
+        std::shared_ptr<T> object(constructed, ShmObjectDeleter<T>{std::move(ssm)});
         return object;
     }
+
+    /**
+     * @brief 将共享内存中已存在的对象包装为智能指针（用于重启恢复）
+     *
+     * @tparam T 对象类型
+     * @param object 共享内存中的对象
+     * @return 指向该对象的指针，释放规则与 create_object 相同
+     */
+    template<class T>
+    std::shared_ptr<T> attach_object(SHMTYPE index, SharedObject *object) {
+        if (object == nullptr) {
+            return nullptr;
+        }
+        SharedMemoryManagerBasePtr ssm = DataPoolManager::instance().get_shared_pool(index);
+        if (!ssm) {
+            spdlog::error("AttachObject 错误: SharedMemoryBase 为空");
+            return nullptr;
+        }
+        return std::shared_ptr<T>(static_cast<T *>(object), ShmObjectDeleter<T>{std::move(ssm)});
+    }
+
+    /**
+     * @brief 把池中所有存活对象包装为智能指针（用于重启后找回全局数据这类不登记恢复处理器的对象）
+     * @details 跳过隔离的块；进程在写入过程中退出（Locked）的对象先解锁。释放规则与 create_object 相同，
+     * 调用方不需要的对象直接丢弃即可归还给池。只能在逻辑线程中、恢复完成后调用。
+     * @param pool 对象所在的池，新建的池返回空列表
+     */
+    template<class T>
+    std::vector<std::shared_ptr<T>> attach_used_objects(const SharedMemoryManagerBasePtr &pool) {
+        std::vector<std::shared_ptr<T>> objects;
+        if (!pool || pool->is_first_created()) {
+            return objects;
+        }
+        for (std::size_t i = 0; i < pool->total_count(); ++i) {
+            auto header = pool->get_block_header(i);
+            auto object = pool->get_object(i);
+            if (!header || !object || !header->in_use || header->quarantined) {
+                continue;
+            }
+            if (object->is_locked()) {
+                object->unlock();
+            }
+            if (!object->is_in_use()) {
+                continue;
+            }
+            objects.emplace_back(static_cast<T *>(object), ShmObjectDeleter<T>{pool});
+        }
+        return objects;
+    }
+
+    /**
+     * @brief 使智能指针释放时不再归还共享内存块
+     *
+     * @details 块保持占用，数据留在共享内存中，下次重启时仍会被恢复。
+     * 用于不能在当前线程归还块、或块中可能有未落地数据的场景（如恢复失败的角色）。
+     *
+     * @return object 不是由 create_object / attach_object 创建时返回 false
+     * @note 只能在没有其他线程同时释放该对象时调用
+     */
+    template<class T>
+    bool detach_object(const std::shared_ptr<T> &object) {
+        auto deleter = std::get_deleter<ShmObjectDeleter<T>>(object);
+        if (deleter == nullptr) {
+            return false;
+        }
+        deleter->pool.reset();
+        return true;
+    }
 }
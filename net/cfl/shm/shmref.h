@@ -0,0 +1,161 @@
+#pragma once
+/**
+ * @file shmref.h
+ * @brief 共享内存对象的轻量句柄
+ *
+ * @details
+ * ShmRef<T> 只保存（池编号, 代数, 块索引）两个机器字，不持有引用计数，也不保存裸指针：
+ * - 每次访问都通过池和块索引重新定位对象，并比较块头中的代数；
+ * - 块被回收时块头代数加一，所有旧句柄随之失效，get() 返回 nullptr；
+ * - release() 立即把块归还给池，不依赖 clean_dirty_blocks 的延迟回收。
+ *
+ * 句柄可以自由拷贝，但同一个对象只应由持有者调用一次 release()，
+ * 其余拷贝在回收后通过 is_stale() 识别出过期状态。
+ *
+ * @note 与共享内存池一样，只能在逻辑线程中使用。
+ */
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include "shmpool.h"
+
+namespace cfl::shm {
+
+    template<class T>
+    class ShmRef {
+    public:
+        /// 空句柄使用的池编号
+        static constexpr std::uint32_t kInvalidPool = std::numeric_limits<std::uint32_t>::max();
+
+        ShmRef() noexcept = default;
+
+        ShmRef(std::nullptr_t) noexcept {}
+
+        ShmRef(SHMTYPE type, std::uint64_t index, std::uint32_t generation) noexcept
+                : pool_(static_cast<std::uint32_t>(type)), generation_(generation), index_(index) {}
+
+        /**
+         * @brief 为池中已使用的对象创建句柄
+         * @param type 共享内存池类型
+         * @param object 池中的对象
+         * @return 对象不属于该池或不在使用中时返回空句柄
+         */
+        static ShmRef from_object(SHMTYPE type, const SharedObject *object) {
+            auto pool = DataPoolManager::instance().find_pool(type);
+            if (pool == nullptr || object == nullptr) {
+                return {};
+            }
+            auto header = pool->find_used_block_header(object);
+            if (header == nullptr) {
+                return {};
+            }
+            return {type, header->index, header->generation};
+        }
+
+        /**
+         * @brief 获取对象指针
+         * @return 空句柄或句柄已过期时返回 nullptr
+         */
+        [[nodiscard]] T *get() const noexcept {
+            if (pool_ == kInvalidPool) {
+                return nullptr;
+            }
+            auto pool = DataPoolManager::instance().find_pool(type());
+            if (pool == nullptr) {
+                return nullptr;
+            }
+            auto header = pool->get_block_header(index_);
+            if (header == nullptr || !header->in_use || header->generation != generation_) {
+                return nullptr;
+            }
+            return static_cast<T *>(pool->get_object(index_));
+        }
+
+        T *operator->() const noexcept {
+            auto object = get();
+            assert(object != nullptr && "access through empty or stale ShmRef");
+            return object;
+        }
+
+        T &operator*() const noexcept { return *operator->(); }
+
+        explicit operator bool() const noexcept { return get() != nullptr; }
+
+        /**
+         * @brief 是否为空句柄（从未指向对象或已 reset）
+         */
+        [[nodiscard]] bool empty() const noexcept { return pool_ == kInvalidPool; }
+
+        /**
+         * @brief 非空但对象已被回收
+         */
+        [[nodiscard]] bool is_stale() const noexcept { return !empty() && get() == nullptr; }
+
+        /**
+         * @brief 立即回收对象所在的块，并清空句柄
+         * @return false 表示句柄为空或已过期（块已被其他持有者回收）
+         */
+        bool release() {
+            auto object = get();
+            if (object == nullptr) {
+                if (!empty()) {
+                    spdlog::warn("[ShmRef] release stale ref pool={} index={} generation={}",
+                                 pool_, index_, generation_);
+                }
+                reset();
+                return false;
+            }
+            auto pool = DataPoolManager::instance().find_pool(type());
+            object->~T();
+            pool->destroy_object(object);
+            reset();
+            return true;
+        }
+
+        /**
+         * @brief 清空句柄，不回收对象
+         */
+        void reset() noexcept { *this = ShmRef{}; }
+
+        [[nodiscard]] SHMTYPE type() const noexcept { return static_cast<SHMTYPE>(pool_); }
+
+        [[nodiscard]] std::uint64_t index() const noexcept { return index_; }
+
+        [[nodiscard]] std::uint32_t generation() const noexcept { return generation_; }
+
+        friend bool operator==(const ShmRef &lhs, const ShmRef &rhs) noexcept {
+            return lhs.pool_ == rhs.pool_ && lhs.generation_ == rhs.generation_ && lhs.index_ == rhs.index_;
+        }
+
+    private:
+        std::uint32_t pool_ = kInvalidPool;  ///< 池编号（SHMTYPE）
+        std::uint32_t generation_ = 0;       ///< 创建句柄时块的代数
+        std::uint64_t index_ = 0;            ///< 块索引
+    };
+
+    /**
+     * @brief 在共享内存池中创建对象并返回句柄
+     *
+     * @tparam T 要创建的对象类型
+     * @param type 共享内存池类型
+     * @param allocate_new 是否分配新的内存块（默认为 true）
+     * @return 分配失败时返回空句柄
+     * @note 块可能是回收来的，返回前会清零并原位构造 T（见 construct_object）
+     */
+    template<class T>
+    ShmRef<T> make_shm_ref(SHMTYPE type, bool allocate_new = true) {
+        auto pool = DataPoolManager::instance().find_pool(type);
+        if (pool == nullptr) {
+            spdlog::error("[ShmRef] make_shm_ref 错误: pool {} 不存在", static_cast<size_t>(type));
+            return {};
+        }
+        auto object = pool->allocate_object(allocate_new);
+        if (!object.has_value() || object.value() == nullptr) {
+            spdlog::error("[ShmRef] make_shm_ref 错误: pool {} 分配失败", static_cast<size_t>(type));
+            return {};
+        }
+        return ShmRef<T>::from_object(type, construct_object<T>(*pool, object.value()));
+    }
+
+} // namespace cfl::shm
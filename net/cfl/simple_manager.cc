@@ -1,141 +1,279 @@
 #include "simple_manager.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <thread>
 #include "cfl.h"
 #include "db/db_mysql.h"
+#include "db/db_row.h"
+
+CFL_ROW(cfl::SimpleInfo,
+        CFL_COL(role_id, "id"),
+        CFL_COL(account_id, "accountid"),
+        CFL_COL(name, "name"),
+        CFL_COL(career_id, "carrerid"),
+        CFL_COL(create_time, "createtime"),
+        CFL_COL(logon_time, "logontime"),
+        CFL_COL(logoff_time, "logofftime"),
+        CFL_COL(guild_id, "guildid"),
+        CFL_COL(level, "level"),
+        CFL_COL(vip_level, "viplevel"));
+
 namespace cfl {
+    namespace {
+        /// 玩家数据所在的数据源
+        const std::string kSimpleSource = "db_game";
+
+        /// 加载时读取的列，与 CFL_ROW(SimpleInfo) 一致
+        constexpr std::string_view kSimpleColumns =
+                "id, accountid, name, carrerid, createtime, logontime, logofftime, guildid, level, viplevel";
+    }
+
     SimpleManager &SimpleManager::instance() noexcept {
         static SimpleManager instance;
         return instance;
     }
 
     bool SimpleManager::load_data() {
-        auto query = db::MySQLUtil::query("db_game", "SELECT * FROM player");;
-        while (query->next()) {
-            auto info = std::make_unique<SimpleInfo>();
-            info->role_id = query->get_int64("id");
-            info->account_id = query->get_int64("accountid");
-            info->name = query->get_string("name");
-            info->career_id = query->get_int32("carrerid");
-            info->create_time = query->get_int64("createtime");
-            info->logon_time = query->get_int64("logontime");
-            info->logoff_time = query->get_int64("logofftime");
-            info->guild_id = query->get_int64("guildid");
-            info->level = query->get_int32("level");
-            info->vip_level = query->get_int32("viplevel");
-
-            add_simple_info(std::move(info));
+        auto page_size = static_cast<std::size_t>(std::max(1, Config::GetGameInfo("rank_page_size", 50)));
+        auto snapshot_ms = std::chrono::milliseconds(std::max(0, Config::GetGameInfo("rank_snapshot_ms", 5000)));
+        for (auto &rank: ranks_) {
+            rank.set_page_size(page_size);
+            rank.set_snapshot_interval(snapshot_ms);
+        }
+        auto threads = static_cast<std::size_t>(std::max(1, Config::GetGameInfo("simple_load_threads", 4)));
+        return load_data(threads, {});
+    }
+
+    bool SimpleManager::load_data(std::size_t threads, const db::ConnectionFactory &factory) {
+        using clock = std::chrono::steady_clock;
+        auto elapsed_ms = [](clock::time_point from) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - from).count();
+        };
+        auto connect = [&factory]() -> db::Database::Ptr {
+            return factory ? factory(kSimpleSource) : db::MySQLMgr::instance()->get(kSimpleSource);
+        };
+        auto release = [&factory](db::Database::Ptr db) {
+            if (!factory && db) {
+                db::MySQLMgr::instance()->release(kSimpleSource, std::move(db));
+            }
+        };
+        threads = std::max<std::size_t>(threads, 1);
+        const auto start = clock::now();
+
+        // 阶段一：总数和分块边界。沿主键索引每次跳过 chunk_rows 行取边界ID，每块行数相同，
+        // 按 [MIN(id), MAX(id)] 等宽切分时，ID 空洞会让大部分行集中在少数几块中
+        auto db = connect();
+        if (!db) {
+            spdlog::error("[SimpleManager] load_data: no connection to {}", kSimpleSource);
+            return false;
+        }
+        auto count = db->query("SELECT COUNT(*) FROM player");
+        if (!count || !count->next()) {
+            spdlog::error("[SimpleManager] load_data: query role count failed");
+            release(std::move(db));
+            return false;
+        }
+        const auto total = count->get_uint64(0);
+        if (total == 0) {
+            release(std::move(db));
+            spdlog::info("[SimpleManager] load_data: no role");
+            return true;
+        }
+        // 至少分成 threads * 4 块，让各线程的负载均衡
+        auto chunk_rows = static_cast<std::uint64_t>(std::max(1, Config::GetGameInfo("simple_load_chunk_rows", 50000)));
+        chunk_rows = std::max<std::uint64_t>(1, std::min<std::uint64_t>(chunk_rows, total / (threads * 4)));
+        std::vector<std::uint64_t> bounds;      // 第 i 块包含 (bounds[i - 1], bounds[i]]，最后一块没有上界
+        bounds.reserve(static_cast<std::size_t>(total / chunk_rows + 1));
+        for (;;) {
+            auto sql = bounds.empty()
+                       ? std::format("SELECT id FROM player ORDER BY id LIMIT 1 OFFSET {}", chunk_rows - 1)
+                       : std::format("SELECT id FROM player WHERE id > {} ORDER BY id LIMIT 1 OFFSET {}",
+                                     bounds.back(), chunk_rows - 1);
+            auto bound = db->query(sql);
+            if (!bound) {
+                spdlog::error("[SimpleManager] load_data: query chunk bound failed: {}", db->error_message());
+                release(std::move(db));
+                return false;
+            }
+            if (!bound->next()) {
+                break;
+            }
+            bounds.push_back(bound->get_uint64(0));
+        }
+        release(std::move(db));
+        const auto range_ms = elapsed_ms(start);
+
+        // 阶段二：按边界分块，各线程独占连接并行读取、解析
+        const auto chunk_count = static_cast<std::uint64_t>(bounds.size() + 1);
+
+        std::vector<std::vector<SimpleInfo>> chunks(chunk_count);
+        std::atomic<std::uint64_t> next_chunk{0};
+        std::atomic<bool> failed{false};
+        const auto fetch_start = clock::now();
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(threads);
+            for (std::size_t t = 0; t < threads; ++t) {
+                workers.emplace_back([&]() {
+                    auto conn = connect();
+                    if (!conn) {
+                        spdlog::error("[SimpleManager] load_data: no connection to {}", kSimpleSource);
+                        failed = true;
+                        return;
+                    }
+                    for (auto i = next_chunk.fetch_add(1); i < chunk_count && !failed; i = next_chunk.fetch_add(1)) {
+                        std::string where;
+                        if (i > 0) {
+                            where = std::format(" WHERE id > {}", bounds[i - 1]);
+                        }
+                        if (i < bounds.size()) {
+                            where += std::format("{} id <= {}", i > 0 ? " AND" : " WHERE", bounds[i]);
+                        }
+                        auto data = conn->query(std::format("SELECT {} FROM player{}", kSimpleColumns, where));
+                        if (!data) {
+                            spdlog::error("[SimpleManager] load_data: query chunk {} failed: {}", i,
+                                          conn->error_message());
+                            failed = true;
+                            break;
+                        }
+                        auto &chunk = chunks[i];
+                        chunk.reserve(static_cast<std::size_t>(chunk_rows));
+                        db::read_rows<SimpleInfo>(*data, [&chunk](SimpleInfo &&info) {
+                            chunk.push_back(std::move(info));
+                        });
+                    }
+                    release(std::move(conn));
+                });
+            }
+        }
+        if (failed) {
+            return false;
+        }
+        const auto fetch_ms = elapsed_ms(fetch_start);
+
+        // 阶段三：预留容量后批量建立索引
+        const auto index_start = clock::now();
+        std::size_t loaded = 0;
+        for (auto &chunk: chunks) {
+            loaded += chunk.size();
         }
+        store_.reserve(store_.size() + loaded);
+        for (auto &chunk: chunks) {
+            for (auto &info: chunk) {
+                store_.insert(info);
+            }
+            std::vector<SimpleInfo>().swap(chunk);
+        }
+        rebuild_ranks();
+        const auto index_ms = elapsed_ms(index_start);
+
+        spdlog::info("[SimpleManager] loaded {} roles in {} chunks with {} threads: {}ms "
+                     "(bounds {}ms, fetch {}ms, index {}ms)",
+                     loaded, chunk_count, threads, elapsed_ms(start), range_ms, fetch_ms, index_ms);
         return true;
     }
 
-    SimpleInfo *SimpleManager::get_simple_info_by_id(std::uint64_t id) noexcept {
-        auto it = id_to_info_.find(id);
-        return (it != id_to_info_.end()) ? it->second.get() : nullptr;
+    std::optional<SimpleView> SimpleManager::get_simple_info_by_id(std::uint64_t id) const noexcept {
+        auto slot = store_.find(id);
+        if (slot == SimpleStore::npos) {
+            return std::nullopt;
+        }
+        return store_.view(slot);
     }
 
     std::uint64_t SimpleManager::get_role_id_by_name(std::string_view name) const noexcept {
-        auto it = name_to_id_.find(std::string(name));
-        return (it != name_to_id_.end()) ? it->second : 0;
+        auto slot = store_.find_by_name(name);
+        return slot != SimpleStore::npos ? store_.role_id(slot) : 0;
     }
 
     std::uint64_t SimpleManager::get_create_time(std::uint64_t id) const noexcept {
-        if (auto info = instance().get_simple_info_by_id(id))
+        if (auto info = get_simple_info_by_id(id))
             return info->create_time;
         return 0;
     }
 
     std::uint64_t SimpleManager::get_logon_time(std::uint64_t id) const noexcept {
-        if (auto info = instance().get_simple_info_by_id(id))
+        if (auto info = get_simple_info_by_id(id))
             return info->logon_time;
         return 0;
     }
 
     std::uint64_t SimpleManager::get_logoff_time(std::uint64_t id) const noexcept {
-        if (auto info = instance().get_simple_info_by_id(id))
+        if (auto info = get_simple_info_by_id(id))
             return info->logoff_time;
         return 0;
     }
 
     std::uint64_t SimpleManager::get_fight_value(std::uint64_t id) const noexcept {
-        if (auto info = instance().get_simple_info_by_id(id))
+        if (auto info = get_simple_info_by_id(id))
             return info->fight_value;
         return 0;
     }
 
     bool SimpleManager::set_fight_value(std::uint64_t id, std::uint64_t value, std::uint32_t level) noexcept {
-        if (auto info = get_simple_info_by_id(id)) {
-            info->fight_value = value;
-            info->level = level;
-            return true;
-        }
-        return false;
+        auto slot = store_.find(id);
+        if (slot == SimpleStore::npos) return false;
+        store_.fight_value(slot) = value;
+        store_.level(slot) = level;
+        update_ranks(slot);
+        return true;
     }
 
     bool SimpleManager::set_name(std::uint64_t id, std::string_view name) {
-        auto *info = get_simple_info_by_id(id);
-        if (!info) return false;
-
-        // 移除旧名称映射
-        name_to_id_.erase(info->name);
-
-        info->name = name;
-        auto [it, inserted] = name_to_id_.insert({std::string(name), id});
-        if (!inserted) {
-//            std::cerr << "[SimpleManager] Duplicate role name: " << name << '\n';
-            return false;
-        }
-        return true;
+        auto slot = store_.find(id);
+        if (slot == SimpleStore::npos) return false;
+        // 新名称已被其他角色使用时不做修改
+        return store_.set_name(slot, name);
     }
 
     bool SimpleManager::set_create_time(std::uint64_t id, std::uint64_t time) noexcept {
-        if (auto info = get_simple_info_by_id(id)) {
-            info->create_time = time;
-            return true;
-        }
-        return false;
+        auto slot = store_.find(id);
+        if (slot == SimpleStore::npos) return false;
+        store_.create_time(slot) = time;
+        return true;
     }
 
     bool SimpleManager::set_logon_time(std::uint64_t id, std::uint64_t time) noexcept {
-        if (auto info = get_simple_info_by_id(id)) {
-            info->logon_time = time;
-            return true;
-        }
-        return false;
+        auto slot = store_.find(id);
+        if (slot == SimpleStore::npos) return false;
+        store_.logon_time(slot) = time;
+        return true;
     }
 
     bool SimpleManager::set_logoff_time(std::uint64_t id, std::uint64_t time) noexcept {
-        if (auto info = get_simple_info_by_id(id)) {
-            info->logoff_time = time;
-            return true;
-        }
-        return false;
+        auto slot = store_.find(id);
+        if (slot == SimpleStore::npos) return false;
+        store_.logoff_time(slot) = time;
+        return true;
     }
 
     bool SimpleManager::set_vip_level(std::uint64_t id, std::uint32_t vipLevel) noexcept {
-        if (auto info = get_simple_info_by_id(id)) {
-            info->vip_level = vipLevel;
-            return true;
-        }
-        return false;
+        auto slot = store_.find(id);
+        if (slot == SimpleStore::npos) return false;
+        store_.vip_level(slot) = vipLevel;
+        update_ranks(slot);
+        return true;
     }
 
     bool SimpleManager::set_guild_id(std::uint64_t id, std::uint64_t guildId) noexcept {
-        if (auto info = get_simple_info_by_id(id)) {
-            info->guild_id = guildId;
-            return true;
-        }
-        return false;
+        auto slot = store_.find(id);
+        if (slot == SimpleStore::npos) return false;
+        store_.set_guild_id(slot, guildId);
+        return true;
     }
 
     bool SimpleManager::set_role_deleted(std::uint64_t id, bool deleted) noexcept {
-        if (auto info = get_simple_info_by_id(id)) {
-            info->is_deleted = deleted;
-            return true;
-        }
-        return false;
+        auto slot = store_.find(id);
+        if (slot == SimpleStore::npos) return false;
+        store_.is_deleted(slot) = deleted ? 1 : 0;
+        update_ranks(slot);
+        return true;
     }
 
     bool SimpleManager::check_name_exist(std::string_view name) const noexcept {
-        return name_to_id_.contains(std::string(name));
+        return store_.find_by_name(name) != SimpleStore::npos;
     }
 
     bool SimpleManager::check_name_format(std::string_view name) const noexcept {
@@ -146,57 +284,103 @@ namespace cfl {
     }
 
     std::uint64_t SimpleManager::get_guild_id(std::uint64_t id) const noexcept {
-        if (auto info = instance().get_simple_info_by_id(id))
+        if (auto info = get_simple_info_by_id(id))
             return info->guild_id;
         return 0;
     }
 
     std::uint32_t SimpleManager::get_total_count() const noexcept {
-        return static_cast<std::uint32_t>(id_to_info_.size());
+        return static_cast<std::uint32_t>(store_.size());
     }
 
     bool SimpleManager::get_role_ids_by_account_id(std::uint64_t accountId, std::vector<std::uint64_t> &roleIds) const {
         roleIds.clear();
-        for (const auto &[id, info]: id_to_info_) {
-            if (info && info->account_id == accountId)
-                roleIds.push_back(id);
-        }
+        store_.account_roles(accountId, roleIds);
+        return true;
+    }
+
+    bool SimpleManager::get_role_ids_by_guild_id(std::uint64_t guildId, std::vector<std::uint64_t> &roleIds) const {
+        roleIds.clear();
+        store_.guild_roles(guildId, roleIds);
         return true;
     }
 
-    SimpleInfo *SimpleManager::create_simple_info(std::uint64_t roleId,
-                                                std::uint64_t accountId,
-                                                std::string_view name,
-                                                std::uint32_t careerId) {
-        auto info = std::make_unique<SimpleInfo>();
-        info->role_id = roleId;
-        info->account_id = accountId;
-        info->name = name;
-        info->career_id = careerId;
-        info->create_time = get_timestamp();
-        info->vip_level = 0;
-        info->level = 0;
-        info->fight_value = 0;
+    std::optional<SimpleView> SimpleManager::create_simple_info(std::uint64_t roleId,
+                                                                std::uint64_t accountId,
+                                                                std::string_view name,
+                                                                std::uint32_t careerId) {
+        SimpleInfo info;
+        info.role_id = roleId;
+        info.account_id = accountId;
+        info.name = name;
+        info.career_id = careerId;
+        info.create_time = get_timestamp();
 
-        auto raw_ptr = info.get();
-        id_to_info_.emplace(roleId, std::move(info));
-        name_to_id_[std::string(name)] = roleId;
-        return raw_ptr;
+        auto slot = store_.insert(info);
+        if (slot == SimpleStore::npos) {
+            return std::nullopt;
+        }
+        update_ranks(slot);
+        return store_.view(slot);
     }
 
-    bool SimpleManager::add_simple_info(std::unique_ptr<SimpleInfo> info) {
-        if (!info) return false;
+    bool SimpleManager::add_simple_info(const SimpleInfo &info) {
+        auto slot = store_.insert(info);
+        if (slot == SimpleStore::npos) {
+            return false;
+        }
+        update_ranks(slot);
+        return true;
+    }
+
+    std::uint32_t SimpleManager::get_rank(RankType type, std::uint64_t id) const noexcept {
+        auto slot = store_.find(id);
+        return slot != SimpleStore::npos ? rank_list(type).rank(slot) : 0;
+    }
 
-        auto roleId = info->role_id;
-        const auto &name = info->name;
+    void SimpleManager::get_top(RankType type, std::size_t count, std::vector<RankEntry> &entries) const {
+        entries.clear();
+        rank_list(type).top(count, entries);
+    }
 
-        id_to_info_.emplace(roleId, std::move(info));
+    RankList::PagePtr SimpleManager::get_rank_page(RankType type, std::size_t page) {
+        return ranks_[static_cast<std::size_t>(type)].page(page);
+    }
 
-        auto [_, inserted] = name_to_id_.insert({name, roleId});
-        if (!inserted) {
-//            std::cerr << "[SimpleManager] Duplicate role name detected: " << name << '\n';
+    void SimpleManager::update_ranks(SimpleStore::Slot slot) {
+        auto id = store_.role_id(slot);
+        auto &fight = ranks_[static_cast<std::size_t>(RankType::FightValue)];
+        auto &level = ranks_[static_cast<std::size_t>(RankType::Level)];
+        auto &vip = ranks_[static_cast<std::size_t>(RankType::VipLevel)];
+        if (store_.is_deleted(slot) != 0) {
+            fight.erase(slot);
+            level.erase(slot);
+            vip.erase(slot);
+            return;
         }
+        fight.update(slot, id, store_.fight_value(slot));
+        level.update(slot, id, store_.level(slot));
+        vip.update(slot, id, store_.vip_level(slot));
+    }
 
-        return true;
+    void SimpleManager::rebuild_ranks() {
+        std::vector<RankItem> fight;
+        std::vector<RankItem> level;
+        std::vector<RankItem> vip;
+        fight.reserve(store_.size());
+        level.reserve(store_.size());
+        vip.reserve(store_.size());
+        for (SimpleStore::Slot slot = 0; slot < store_.size(); ++slot) {
+            if (store_.is_deleted(slot) != 0) {
+                continue;
+            }
+            auto id = store_.role_id(slot);
+            fight.push_back({slot, id, store_.fight_value(slot)});
+            level.push_back({slot, id, store_.level(slot)});
+            vip.push_back({slot, id, store_.vip_level(slot)});
+        }
+        ranks_[static_cast<std::size_t>(RankType::FightValue)].assign(std::move(fight));
+        ranks_[static_cast<std::size_t>(RankType::Level)].assign(std::move(level));
+        ranks_[static_cast<std::size_t>(RankType::VipLevel)].assign(std::move(vip));
     }
 }
\ No newline at end of file
@@ -1,36 +1,27 @@
 #pragma once
+#include <array>
 #include <string>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <optional>
 #include <cstdint>
+#include "db/db_async.h"
 #include "db/db_mysql.h"
+#include "rank_list.h"
+#include "simple_store.h"
 
 namespace cfl {
 
     /**
-     * @brief 存储玩家基础信息的数据结构。
-     *
-     * 用于保存角色（Role）的核心元数据，如 ID、账号、职业、等级、战斗力、登录/登出时间等。
-     * 通常作为 SimpleManager 的管理对象。
+     * @brief SimpleManager 维护的排行榜类型
      */
-    struct SimpleInfo {
-        std::uint64_t role_id = 0;       ///< 角色唯一ID
-        std::uint64_t account_id = 0;    ///< 所属账号ID
-        std::uint64_t guild_id = 0;      ///< 公会ID
-        std::uint32_t career_id = 0;     ///< 职业ID
-        std::uint32_t level = 0;         ///< 等级
-        std::uint32_t vip_level = 0;     ///< VIP等级
-        std::uint64_t fight_value = 0;   ///< 战斗力
-        std::uint64_t logoff_time = 0;   ///< 最近登出时间（Unix时间戳）
-        std::uint64_t logon_time = 0;    ///< 最近登录时间（Unix时间戳）
-        std::uint64_t create_time = 0;   ///< 创建时间（Unix时间戳）
-        std::string name;                ///< 角色名
-        bool is_deleted = false;         ///< 删除标志（true 表示角色被删除）
-        std::uint32_t logon_status = 0;  ///< 登录状态（0: 正常, 1: 从数据库加载中）
-
-        SimpleInfo() = default;
+    enum class RankType {
+        FightValue = 0, ///< 战斗力
+        Level,          ///< 等级
+        VipLevel,       ///< VIP等级
+        Count,
     };
 
     /**
@@ -41,6 +32,7 @@ namespace cfl {
      * - 根据 ID 或名称查询角色
      * - 创建和修改角色基础数据
      * - 检查角色名合法性、唯一性
+     * - 维护战斗力、等级、VIP等级排行榜（已删除的角色不上榜）
      *
      * @note 使用单例模式访问：`SimpleManager::instance()`
      */
@@ -55,9 +47,9 @@ namespace cfl {
         /**
          * @brief 根据角色ID获取角色信息。
          * @param id 角色ID。
-         * @return SimpleInfo* 指向角色信息的指针；若不存在则返回 nullptr。
+         * @return 角色信息的快照；若不存在则返回 std::nullopt。
          */
-        [[nodiscard]] SimpleInfo *get_simple_info_by_id(std::uint64_t id) noexcept;
+        [[nodiscard]] std::optional<SimpleView> get_simple_info_by_id(std::uint64_t id) const noexcept;
 
         /**
          * @brief 创建一个新的角色信息对象并插入管理器。
@@ -65,26 +57,43 @@ namespace cfl {
          * @param accountId 账号ID。
          * @param name 角色名。
          * @param careerId 职业ID。
-         * @return SimpleInfo* 指向新建的 SimpleInfo 对象。
+         * @return 新建角色的快照；角色ID已存在时返回 std::nullopt。
          */
-        [[nodiscard]] SimpleInfo *create_simple_info(std::uint64_t roleId,
+        [[nodiscard]] std::optional<SimpleView> create_simple_info(std::uint64_t roleId,
                                                    std::uint64_t accountId,
                                                    std::string_view name,
                                                    std::uint32_t careerId);
 
         /**
          * @brief 将一个外部构建的 SimpleInfo 对象加入管理器。
-         * @param info 智能指针包装的 SimpleInfo 对象。
-         * @return true 插入成功；false 插入失败（例如 info 为 nullptr）。
+         * @param info 角色信息（按列拷贝到存储中）。
+         * @return true 插入成功；false 插入失败（角色ID为 0 或已存在）。
          */
-        bool add_simple_info(std::unique_ptr<SimpleInfo> info);
+        bool add_simple_info(const SimpleInfo &info);
 
         /**
          * @brief 从数据库加载所有玩家数据。
+         * @details 线程数取配置项 simple_load_threads（默认 4），连接取自 db_game 连接池。
+         *          全部角色加入存储后一次性重建排行榜（见 rebuild_ranks）。
          * @return true 加载成功；false 加载失败。
          */
         bool load_data();
 
+        /**
+         * @brief 按角色ID区间分块，多个连接并行读取和解析玩家数据，再一次性建立索引。
+         *
+         * @details 分为三个阶段，每个阶段的耗时都会输出到日志：
+         * - 查询总数，再沿主键索引逐块跳过 simple_load_chunk_rows 行（默认 50000）取得分块边界，
+         *   每块行数相同，与ID分布（合服后的空洞、号段）无关；
+         * - 每个线程独占一个连接，依次领取ID区间，边读取边解析到本块的缓冲中；
+         * - 按总数预留哈希表容量，在调用线程中批量建立ID和名称索引。
+         *
+         * @param threads 加载线程数（每个线程一个连接）
+         * @param factory 连接工厂，为空时使用 MySQLMgr 的 db_game 连接池
+         * @return true 加载成功；false 任一分块查询失败（此时不修改已有数据）
+         */
+        bool load_data(std::size_t threads, const db::ConnectionFactory &factory);
+
         /**
          * @brief 通过角色名获取角色ID。
          * @param name 角色名。
@@ -224,6 +233,52 @@ namespace cfl {
          */
         bool get_role_ids_by_account_id(std::uint64_t accountId, std::vector<std::uint64_t> &roleIds) const;
 
+        /**
+         * @brief 获取公会中的所有角色ID。
+         * @param guildId 公会ID（0 表示无公会，返回空列表）。
+         * @param roleIds 输出参数，用于存储角色ID列表。
+         * @return true 查询成功。
+         */
+        bool get_role_ids_by_guild_id(std::uint64_t guildId, std::vector<std::uint64_t> &roleIds) const;
+
+        /**
+         * @brief 获取角色在排行榜中的名次。
+         * @param type 排行榜类型。
+         * @param id 角色ID。
+         * @return 名次（从 1 开始）；不在榜上时返回 0。
+         */
+        [[nodiscard]] std::uint32_t get_rank(RankType type, std::uint64_t id) const noexcept;
+
+        /**
+         * @brief 获取排行榜前 count 名。
+         * @param type 排行榜类型。
+         * @param count 条数。
+         * @param entries 输出参数，按名次排列。
+         */
+        void get_top(RankType type, std::size_t count, std::vector<RankEntry> &entries) const;
+
+        /**
+         * @brief 获取排行榜一页的快照。
+         * @details 每页条数取配置项 rank_page_size（默认 50）；排行榜变化后，
+         *          已生成的快照在 rank_snapshot_ms（默认 5000）毫秒内仍会被复用。
+         * @param type 排行榜类型。
+         * @param page 页号（从 0 开始）。
+         * @return 只读快照，超出范围时为空页。
+         */
+        [[nodiscard]] RankList::PagePtr get_rank_page(RankType type, std::size_t page);
+
+        /**
+         * @brief 排行榜（只读），以 SimpleStore 的槽位为编号。
+         */
+        [[nodiscard]] const RankList &rank_list(RankType type) const noexcept {
+            return ranks_[static_cast<std::size_t>(type)];
+        }
+
+        /**
+         * @brief 角色信息的列式存储（只读）。
+         */
+        [[nodiscard]] const SimpleStore &store() const noexcept { return store_; }
+
     private:
         /**
          * @brief 构造函数（私有，单例模式）。
@@ -242,14 +297,24 @@ namespace cfl {
         SimpleManager &operator=(const SimpleManager &) = delete;
 
         /**
-         * @brief 角色ID到角色信息的映射。
+         * @brief 按槽位中的当前值更新角色在各排行榜中的位置，已删除的角色移出排行榜。
+         */
+        void update_ranks(SimpleStore::Slot slot);
+
+        /**
+         * @brief 按存储中的全部角色重建排行榜，每个排行榜排序一次后顺序建表。
+         */
+        void rebuild_ranks();
+
+        /**
+         * @brief 角色信息的列式存储，含角色ID、角色名、账号、公会索引。
          */
-        std::unordered_map<std::uint64_t, std::unique_ptr<SimpleInfo>> id_to_info_;
+        SimpleStore store_;
 
         /**
-         * @brief 角色名到角色ID的映射。
+         * @brief 各类型的排行榜，按 RankType 下标。
          */
-        std::unordered_map<std::string, std::uint64_t> name_to_id_;
+        std::array<RankList, static_cast<std::size_t>(RankType::Count)> ranks_;
     };
 
 } // namespace cfl
@@ -0,0 +1,295 @@
+#include "simple_store.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace cfl {
+
+    namespace {
+        /// 名称区每块的字节数（块内偏移为 16 位）
+        constexpr std::uint32_t kNameBlockBits = 16;
+        constexpr std::uint32_t kNameBlockSize = 1u << kNameBlockBits;
+    }
+
+    std::uint64_t SimpleStore::hash_id(std::uint64_t id) noexcept {
+        // splitmix64 的混合步骤，打散连续的角色ID
+        id ^= id >> 30;
+        id *= 0xbf58476d1ce4e5b9ULL;
+        id ^= id >> 27;
+        id *= 0x94d049bb133111ebULL;
+        id ^= id >> 31;
+        return id;
+    }
+
+    std::uint64_t SimpleStore::hash_name(std::string_view name) noexcept {
+        return hash_id(std::hash<std::string_view>{}(name));
+    }
+
+    void SimpleStore::reserve(std::size_t count) {
+        role_id_.reserve(count);
+        account_id_.reserve(count);
+        guild_id_.reserve(count);
+        fight_value_.reserve(count);
+        logoff_time_.reserve(count);
+        logon_time_.reserve(count);
+        create_time_.reserve(count);
+        career_id_.reserve(count);
+        level_.reserve(count);
+        vip_level_.reserve(count);
+        name_offset_.reserve(count);
+        name_length_.reserve(count);
+        is_deleted_.reserve(count);
+        logon_status_.reserve(count);
+        next_in_account_.reserve(count);
+        next_in_guild_.reserve(count);
+
+        id_index_.reserve(count, [this](Slot s) { return hash_id(role_id_[s]); });
+        name_index_.reserve(count, [this](Slot s) { return hash_name(name(s)); });
+        // 账号、公会索引只存链表头，按需增长
+    }
+
+    void SimpleStore::clear() {
+        role_id_.clear();
+        account_id_.clear();
+        guild_id_.clear();
+        fight_value_.clear();
+        logoff_time_.clear();
+        logon_time_.clear();
+        create_time_.clear();
+        career_id_.clear();
+        level_.clear();
+        vip_level_.clear();
+        name_offset_.clear();
+        name_length_.clear();
+        is_deleted_.clear();
+        logon_status_.clear();
+        next_in_account_.clear();
+        next_in_guild_.clear();
+        name_blocks_.clear();
+        name_used_ = 0;
+        id_index_.clear();
+        name_index_.clear();
+        account_index_.clear();
+        guild_index_.clear();
+    }
+
+    std::uint32_t SimpleStore::store_name(std::string_view name) {
+        auto length = static_cast<std::uint32_t>(name.size());
+        if ((name_used_ & (kNameBlockSize - 1)) + length > kNameBlockSize) {
+            // 当前块放不下：从下一块开始（块尾的剩余空间不再使用）
+            name_used_ = ((name_used_ >> kNameBlockBits) + 1) << kNameBlockBits;
+        }
+        while ((name_used_ >> kNameBlockBits) >= name_blocks_.size()) {
+            name_blocks_.push_back(std::make_unique<char[]>(kNameBlockSize));
+        }
+        auto offset = name_used_;
+        if (length > 0) {
+            std::memcpy(name_blocks_[offset >> kNameBlockBits].get() + (offset & (kNameBlockSize - 1)), name.data(),
+                        length);
+        }
+        name_used_ += length;
+        return offset;
+    }
+
+    std::string_view SimpleStore::name(Slot slot) const noexcept {
+        auto offset = name_offset_[slot];
+        auto length = name_length_[slot];
+        if (length == 0) {
+            return {};
+        }
+        return {name_blocks_[offset >> kNameBlockBits].get() + (offset & (kNameBlockSize - 1)), length};
+    }
+
+    SimpleStore::Slot SimpleStore::insert(const SimpleInfo &info) {
+        if (info.role_id == 0 || find(info.role_id) != npos) {
+            return npos;
+        }
+        auto slot = static_cast<Slot>(role_id_.size());
+        std::string_view info_name = info.name;
+        info_name = info_name.substr(0, std::min<std::size_t>(info_name.size(), UINT16_MAX));
+
+        role_id_.push_back(info.role_id);
+        account_id_.push_back(info.account_id);
+        guild_id_.push_back(info.guild_id);
+        fight_value_.push_back(info.fight_value);
+        logoff_time_.push_back(info.logoff_time);
+        logon_time_.push_back(info.logon_time);
+        create_time_.push_back(info.create_time);
+        career_id_.push_back(info.career_id);
+        level_.push_back(info.level);
+        vip_level_.push_back(info.vip_level);
+        name_offset_.push_back(store_name(info_name));
+        name_length_.push_back(static_cast<std::uint16_t>(info_name.size()));
+        is_deleted_.push_back(info.is_deleted ? 1 : 0);
+        logon_status_.push_back(static_cast<std::uint8_t>(info.logon_status));
+        next_in_account_.push_back(npos);
+        next_in_guild_.push_back(npos);
+
+        id_index_.insert(hash_id(info.role_id), slot, [this](Slot s) { return hash_id(role_id_[s]); });
+        if (!info_name.empty() && find_by_name(info_name) == npos) {
+            name_index_.insert(hash_name(info_name), slot, [this](Slot s) { return hash_name(name(s)); });
+        }
+
+        // 账号链表：新角色成为链表头
+        auto account_hash = hash_id(info.account_id);
+        auto head = account_index_.find_bucket(account_hash, [this, &info](Slot s) {
+            return account_id_[s] == info.account_id;
+        });
+        if (head != nullptr) {
+            next_in_account_[slot] = *head;
+            *head = slot;
+        } else {
+            account_index_.insert(account_hash, slot, [this](Slot s) { return hash_id(account_id_[s]); });
+        }
+
+        link_guild(slot);
+        return slot;
+    }
+
+    SimpleStore::Slot SimpleStore::find(std::uint64_t role_id) const noexcept {
+        return id_index_.find(hash_id(role_id), [this, role_id](Slot s) { return role_id_[s] == role_id; });
+    }
+
+    SimpleStore::Slot SimpleStore::find_by_name(std::string_view name) const noexcept {
+        return name_index_.find(hash_name(name), [this, name](Slot s) { return this->name(s) == name; });
+    }
+
+    void SimpleStore::account_roles(std::uint64_t account_id, std::vector<std::uint64_t> &out) const {
+        auto slot = account_index_.find(hash_id(account_id), [this, account_id](Slot s) {
+            return account_id_[s] == account_id;
+        });
+        for (; slot != npos; slot = next_in_account_[slot]) {
+            out.push_back(role_id_[slot]);
+        }
+    }
+
+    void SimpleStore::guild_roles(std::uint64_t guild_id, std::vector<std::uint64_t> &out) const {
+        if (guild_id == 0) {
+            return;
+        }
+        auto slot = guild_index_.find(hash_id(guild_id), [this, guild_id](Slot s) { return guild_id_[s] == guild_id; });
+        for (; slot != npos; slot = next_in_guild_[slot]) {
+            out.push_back(role_id_[slot]);
+        }
+    }
+
+    bool SimpleStore::set_name(Slot slot, std::string_view new_name) {
+        new_name = new_name.substr(0, std::min<std::size_t>(new_name.size(), UINT16_MAX));
+        auto owner = find_by_name(new_name);
+        if (owner == slot) {
+            return true;
+        }
+        if (owner != npos) {
+            return false;
+        }
+        auto hash_of = [this](Slot s) { return hash_name(name(s)); };
+        auto old_name = name(slot);
+        if (!old_name.empty()) {
+            name_index_.erase(hash_name(old_name), slot, hash_of);
+        }
+        // 旧名称占用的名称区空间不回收，改名很少发生
+        name_offset_[slot] = store_name(new_name);
+        name_length_[slot] = static_cast<std::uint16_t>(new_name.size());
+        if (!new_name.empty()) {
+            name_index_.insert(hash_name(new_name), slot, hash_of);
+        }
+        return true;
+    }
+
+    void SimpleStore::set_guild_id(Slot slot, std::uint64_t guild_id) {
+        if (guild_id_[slot] == guild_id) {
+            return;
+        }
+        unlink_guild(slot);
+        guild_id_[slot] = guild_id;
+        link_guild(slot);
+    }
+
+    void SimpleStore::link_guild(Slot slot) {
+        auto guild_id = guild_id_[slot];
+        next_in_guild_[slot] = npos;
+        if (guild_id == 0) {
+            return;
+        }
+        auto guild_hash = hash_id(guild_id);
+        auto head = guild_index_.find_bucket(guild_hash, [this, guild_id](Slot s) { return guild_id_[s] == guild_id; });
+        if (head != nullptr) {
+            next_in_guild_[slot] = *head;
+            *head = slot;
+        } else {
+            guild_index_.insert(guild_hash, slot, [this](Slot s) { return hash_id(guild_id_[s]); });
+        }
+    }
+
+    void SimpleStore::unlink_guild(Slot slot) {
+        auto guild_id = guild_id_[slot];
+        if (guild_id == 0) {
+            return;
+        }
+        auto guild_hash = hash_id(guild_id);
+        auto head = guild_index_.find_bucket(guild_hash, [this, guild_id](Slot s) { return guild_id_[s] == guild_id; });
+        if (head == nullptr) {
+            return;
+        }
+        if (*head == slot) {
+            if (next_in_guild_[slot] != npos) {
+                *head = next_in_guild_[slot];
+            } else {
+                guild_index_.erase(guild_hash, slot, [this](Slot s) { return hash_id(guild_id_[s]); });
+            }
+        } else {
+            // 公会人数有限，单向链表中查找前驱
+            for (auto prev = *head; next_in_guild_[prev] != npos; prev = next_in_guild_[prev]) {
+                if (next_in_guild_[prev] == slot) {
+                    next_in_guild_[prev] = next_in_guild_[slot];
+                    break;
+                }
+            }
+        }
+        next_in_guild_[slot] = npos;
+    }
+
+    SimpleView SimpleStore::view(Slot slot) const noexcept {
+        SimpleView v;
+        v.role_id = role_id_[slot];
+        v.account_id = account_id_[slot];
+        v.guild_id = guild_id_[slot];
+        v.career_id = career_id_[slot];
+        v.level = level_[slot];
+        v.vip_level = vip_level_[slot];
+        v.fight_value = fight_value_[slot];
+        v.logoff_time = logoff_time_[slot];
+        v.logon_time = logon_time_[slot];
+        v.create_time = create_time_[slot];
+        v.name = name(slot);
+        v.is_deleted = is_deleted_[slot] != 0;
+        v.logon_status = logon_status_[slot];
+        return v;
+    }
+
+    std::size_t SimpleStore::memory_bytes() const noexcept {
+        std::size_t bytes = 0;
+        auto column = [&bytes](const auto &v) { bytes += v.capacity() * sizeof(v[0]); };
+        column(role_id_);
+        column(account_id_);
+        column(guild_id_);
+        column(fight_value_);
+        column(logoff_time_);
+        column(logon_time_);
+        column(create_time_);
+        column(career_id_);
+        column(level_);
+        column(vip_level_);
+        column(name_offset_);
+        column(name_length_);
+        column(is_deleted_);
+        column(logon_status_);
+        column(next_in_account_);
+        column(next_in_guild_);
+        bytes += name_blocks_.size() * kNameBlockSize;
+        bytes += id_index_.memory_bytes() + name_index_.memory_bytes() + account_index_.memory_bytes()
+                 + guild_index_.memory_bytes();
+        return bytes;
+    }
+
+} // namespace cfl
@@ -0,0 +1,306 @@
+/**
+ * @file simple_store.h
+ * @brief 角色基础信息的列式存储
+ *
+ * @details
+ * 每个角色一个堆上的 SimpleInfo 加上 ID、名称两张 unordered_map，每个角色要 3~4 次内存分配，
+ * 按账号查角色还需要遍历全部角色。SimpleStore 按列保存角色信息（struct-of-arrays）：
+ * - 每个角色占一个槽位（Slot），各字段分别存放在连续的数组中；
+ * - 角色名存放在分块的名称区中，块不会移动，返回的 string_view 在存储清空前一直有效；
+ * - 角色 ID、角色名为开放寻址（线性探测）哈希索引，桶中只存槽位，按名称查询不构造临时字符串；
+ * - 账号、公会为二级索引：索引中存放链表头，同账号/同公会的角色通过槽位链接，查询为 O(1) + 角色数。
+ *
+ * @note 角色只增不删（删除角色只设置 is_deleted 标志）；非线程安全，只能在逻辑线程中使用。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cfl {
+
+    /**
+     * @brief 存储玩家基础信息的数据结构。
+     *
+     * 用于从数据库加载和创建角色时传递一整行数据，加入 SimpleStore 后按列保存。
+     */
+    struct SimpleInfo {
+        std::uint64_t role_id = 0;       ///< 角色唯一ID
+        std::uint64_t account_id = 0;    ///< 所属账号ID
+        std::uint64_t guild_id = 0;      ///< 公会ID
+        std::uint32_t career_id = 0;     ///< 职业ID
+        std::uint32_t level = 0;         ///< 等级
+        std::uint32_t vip_level = 0;     ///< VIP等级
+        std::uint64_t fight_value = 0;   ///< 战斗力
+        std::uint64_t logoff_time = 0;   ///< 最近登出时间（Unix时间戳）
+        std::uint64_t logon_time = 0;    ///< 最近登录时间（Unix时间戳）
+        std::uint64_t create_time = 0;   ///< 创建时间（Unix时间戳）
+        std::string name;                ///< 角色名
+        bool is_deleted = false;         ///< 删除标志（true 表示角色被删除）
+        std::uint32_t logon_status = 0;  ///< 登录状态（0: 正常, 1: 从数据库加载中）
+
+        SimpleInfo() = default;
+    };
+
+    /**
+     * @brief 某一时刻的角色信息快照，角色名引用存储中的名称区。
+     */
+    struct SimpleView {
+        std::uint64_t role_id = 0;
+        std::uint64_t account_id = 0;
+        std::uint64_t guild_id = 0;
+        std::uint32_t career_id = 0;
+        std::uint32_t level = 0;
+        std::uint32_t vip_level = 0;
+        std::uint64_t fight_value = 0;
+        std::uint64_t logoff_time = 0;
+        std::uint64_t logon_time = 0;
+        std::uint64_t create_time = 0;
+        std::string_view name;           ///< 存储清空前有效（改名后仍指向旧名称）
+        bool is_deleted = false;
+        std::uint32_t logon_status = 0;
+    };
+
+    /**
+     * @class SimpleStore
+     * @brief 角色基础信息的列式存储和索引
+     */
+    class SimpleStore {
+    public:
+        using Slot = std::uint32_t;
+
+        /// 无效槽位
+        static constexpr Slot npos = UINT32_MAX;
+
+        SimpleStore() = default;
+
+        SimpleStore(const SimpleStore &) = delete;
+        SimpleStore &operator=(const SimpleStore &) = delete;
+
+        /**
+         * @brief 预留 count 个角色的列和索引容量
+         */
+        void reserve(std::size_t count);
+
+        /**
+         * @brief 清空所有角色
+         */
+        void clear();
+
+        /**
+         * @brief 加入一个角色
+         * @details 角色名已被其他角色使用时，名称索引仍指向原来的角色。
+         * @return 新角色的槽位；角色ID为 0 或已存在时返回 npos
+         */
+        Slot insert(const SimpleInfo &info);
+
+        /**
+         * @brief 按角色ID查找槽位，不存在时返回 npos
+         */
+        [[nodiscard]] Slot find(std::uint64_t role_id) const noexcept;
+
+        /**
+         * @brief 按角色名查找槽位，不存在时返回 npos
+         */
+        [[nodiscard]] Slot find_by_name(std::string_view name) const noexcept;
+
+        /**
+         * @brief 账号下的所有角色ID（追加到 out）
+         */
+        void account_roles(std::uint64_t account_id, std::vector<std::uint64_t> &out) const;
+
+        /**
+         * @brief 公会中的所有角色ID（追加到 out）
+         */
+        void guild_roles(std::uint64_t guild_id, std::vector<std::uint64_t> &out) const;
+
+        /**
+         * @brief 修改角色名
+         * @return 新名称已被其他角色使用时返回 false，不做修改
+         */
+        bool set_name(Slot slot, std::string_view name);
+
+        /**
+         * @brief 修改角色的公会，同时维护公会索引
+         */
+        void set_guild_id(Slot slot, std::uint64_t guild_id);
+
+        /**
+         * @brief 槽位中角色的快照
+         */
+        [[nodiscard]] SimpleView view(Slot slot) const noexcept;
+
+        /// 角色数
+        [[nodiscard]] std::size_t size() const noexcept { return role_id_.size(); }
+
+        /**
+         * @brief 列、索引和名称区占用的字节数（按容量计）
+         */
+        [[nodiscard]] std::size_t memory_bytes() const noexcept;
+
+        // ---------- 按槽位访问的列 ----------
+        [[nodiscard]] std::uint64_t role_id(Slot slot) const noexcept { return role_id_[slot]; }
+        [[nodiscard]] std::uint64_t account_id(Slot slot) const noexcept { return account_id_[slot]; }
+        [[nodiscard]] std::uint64_t guild_id(Slot slot) const noexcept { return guild_id_[slot]; }
+        [[nodiscard]] std::string_view name(Slot slot) const noexcept;
+
+        std::uint32_t &career_id(Slot slot) noexcept { return career_id_[slot]; }
+        std::uint32_t &level(Slot slot) noexcept { return level_[slot]; }
+        std::uint32_t &vip_level(Slot slot) noexcept { return vip_level_[slot]; }
+        std::uint64_t &fight_value(Slot slot) noexcept { return fight_value_[slot]; }
+        std::uint64_t &logoff_time(Slot slot) noexcept { return logoff_time_[slot]; }
+        std::uint64_t &logon_time(Slot slot) noexcept { return logon_time_[slot]; }
+        std::uint64_t &create_time(Slot slot) noexcept { return create_time_[slot]; }
+        std::uint8_t &is_deleted(Slot slot) noexcept { return is_deleted_[slot]; }
+        std::uint8_t &logon_status(Slot slot) noexcept { return logon_status_[slot]; }
+
+    private:
+        /**
+         * @brief 桶中存放槽位的开放寻址哈希表，键和哈希值由调用方通过槽位计算
+         */
+        class SlotIndex {
+        public:
+            /// 查找满足 eq(slot) 的槽位
+            template<class Eq>
+            [[nodiscard]] Slot find(std::uint64_t hash, Eq &&eq) const noexcept {
+                const Slot *bucket = find_bucket(hash, eq);
+                return bucket != nullptr ? *bucket : npos;
+            }
+
+            /// 查找满足 eq(slot) 的桶，用于原地替换同键的槽位
+            template<class Eq>
+            [[nodiscard]] Slot *find_bucket(std::uint64_t hash, Eq &&eq) const noexcept {
+                if (buckets_.empty()) {
+                    return nullptr;
+                }
+                for (auto i = hash & mask_;; i = (i + 1) & mask_) {
+                    auto slot = buckets_[i];
+                    if (slot == npos) {
+                        return nullptr;
+                    }
+                    if (eq(slot)) {
+                        return const_cast<Slot *>(&buckets_[i]);
+                    }
+                }
+            }
+
+            /// 插入槽位（不检查重复），hash_of(slot) 用于扩容时重新分布
+            template<class HashOf>
+            void insert(std::uint64_t hash, Slot slot, HashOf &&hash_of) {
+                reserve(size_ + 1, hash_of);
+                place(hash, slot);
+                ++size_;
+            }
+
+            /// 删除槽位，后续桶回移以保持探测链连续
+            template<class HashOf>
+            bool erase(std::uint64_t hash, Slot slot, HashOf &&hash_of) noexcept {
+                auto bucket = find_bucket(hash, [slot](Slot s) { return s == slot; });
+                if (bucket == nullptr) {
+                    return false;
+                }
+                auto hole = static_cast<std::size_t>(bucket - buckets_.data());
+                for (auto i = (hole + 1) & mask_; buckets_[i] != npos; i = (i + 1) & mask_) {
+                    auto home = hash_of(buckets_[i]) & mask_;
+                    // home 不在 (hole, i] 区间内时，该元素可以回移到空位
+                    bool in_range = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+                    if (!in_range) {
+                        buckets_[hole] = buckets_[i];
+                        hole = i;
+                    }
+                }
+                buckets_[hole] = npos;
+                --size_;
+                return true;
+            }
+
+            /// 保证容纳 count 个槽位时负载不超过 1/2
+            template<class HashOf>
+            void reserve(std::size_t count, HashOf &&hash_of) {
+                if (count * 2 <= buckets_.size()) {
+                    return;
+                }
+                std::size_t capacity = 16;
+                while (capacity < count * 2) {
+                    capacity <<= 1;
+                }
+                auto old = std::move(buckets_);
+                buckets_.assign(capacity, npos);
+                mask_ = capacity - 1;
+                for (auto slot: old) {
+                    if (slot != npos) {
+                        place(hash_of(slot), slot);
+                    }
+                }
+            }
+
+            void clear() noexcept {
+                buckets_.clear();
+                mask_ = 0;
+                size_ = 0;
+            }
+
+            [[nodiscard]] std::size_t memory_bytes() const noexcept { return buckets_.capacity() * sizeof(Slot); }
+
+        private:
+            void place(std::uint64_t hash, Slot slot) noexcept {
+                auto i = hash & mask_;
+                while (buckets_[i] != npos) {
+                    i = (i + 1) & mask_;
+                }
+                buckets_[i] = slot;
+            }
+
+            std::vector<Slot> buckets_;
+            std::size_t mask_ = 0;
+            std::size_t size_ = 0;
+        };
+
+        /// 把名称拷贝到名称区，返回全局偏移
+        std::uint32_t store_name(std::string_view name);
+
+        /// 把槽位挂到公会链表头
+        void link_guild(Slot slot);
+
+        /// 把槽位从公会链表中摘除
+        void unlink_guild(Slot slot);
+
+        static std::uint64_t hash_id(std::uint64_t id) noexcept;
+
+        static std::uint64_t hash_name(std::string_view name) noexcept;
+
+        // 列
+        std::vector<std::uint64_t> role_id_;
+        std::vector<std::uint64_t> account_id_;
+        std::vector<std::uint64_t> guild_id_;
+        std::vector<std::uint64_t> fight_value_;
+        std::vector<std::uint64_t> logoff_time_;
+        std::vector<std::uint64_t> logon_time_;
+        std::vector<std::uint64_t> create_time_;
+        std::vector<std::uint32_t> career_id_;
+        std::vector<std::uint32_t> level_;
+        std::vector<std::uint32_t> vip_level_;
+        std::vector<std::uint32_t> name_offset_;   ///< 名称在名称区中的全局偏移
+        std::vector<std::uint16_t> name_length_;
+        std::vector<std::uint8_t> is_deleted_;
+        std::vector<std::uint8_t> logon_status_;
+        std::vector<Slot> next_in_account_;        ///< 同账号的下一个角色
+        std::vector<Slot> next_in_guild_;          ///< 同公会的下一个角色
+
+        // 名称区：固定大小的块，块地址不变
+        std::vector<std::unique_ptr<char[]>> name_blocks_;
+        std::uint32_t name_used_ = 0;              ///< 已使用的全局偏移
+
+        // 索引
+        SlotIndex id_index_;
+        SlotIndex name_index_;
+        SlotIndex account_index_;                  ///< 账号 -> 链表头
+        SlotIndex guild_index_;                    ///< 公会 -> 链表头（guild_id 为 0 的角色不加入）
+    };
+
+} // namespace cfl
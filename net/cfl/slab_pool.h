@@ -0,0 +1,195 @@
+#pragma once
+/**
+ * @file slab_pool.h
+ * @brief 按块分配的对象池，对象地址稳定，句柄带代数校验。
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace cfl {
+
+    /**
+     * @brief 对象池句柄
+     *
+     * 保存槽位下标和代数，对象被释放后槽位代数加一，旧句柄随之失效。
+     */
+    struct SlabHandle {
+        static constexpr std::uint32_t kInvalidIndex = std::numeric_limits<std::uint32_t>::max();
+
+        std::uint32_t index = kInvalidIndex;
+        std::uint32_t generation = 0;
+
+        [[nodiscard]] bool valid() const noexcept { return index != kInvalidIndex; }
+
+        bool operator==(const SlabHandle &) const noexcept = default;
+    };
+
+    /**
+     * @class SlabPool
+     * @brief 按块（ChunkSize 个槽位）分配的对象池
+     *
+     * - 块只增不减，对象构造后地址不变，可以被其他对象以裸指针引用；
+     * - 释放的槽位进入空闲链表，优先复用，槽位按下标连续存放便于顺序遍历；
+     * - 槽位代数用于校验句柄，代数从 1 开始，0 表示无效。
+     *
+     * @note 非线程安全，并发分配需要调用方加锁。
+     */
+    template<class T, std::size_t ChunkSize = 256>
+    class SlabPool {
+    public:
+        SlabPool() = default;
+
+        SlabPool(const SlabPool &) = delete;
+        SlabPool &operator=(const SlabPool &) = delete;
+
+        ~SlabPool() { clear(); }
+
+        /**
+         * @brief 在空闲槽位中构造对象
+         * @return 新对象的句柄
+         */
+        template<class... Args>
+        SlabHandle emplace(Args &&... args) {
+            if (free_head_ == SlabHandle::kInvalidIndex) {
+                grow();
+            }
+            auto index = free_head_;
+            auto &slot = slot_at(index);
+            free_head_ = slot.next_free;
+            ::new(static_cast<void *>(slot.storage)) T(std::forward<Args>(args)...);
+            slot.live = true;
+            slot.next_free = SlabHandle::kInvalidIndex;
+            ++size_;
+            return {index, slot.generation};
+        }
+
+        /**
+         * @brief 析构对象并回收槽位
+         * @return 句柄无效或已过期时返回 false
+         */
+        bool erase(SlabHandle handle) {
+            if (get(handle) == nullptr) {
+                return false;
+            }
+            auto &slot = slot_at(handle.index);
+            object(slot)->~T();
+            slot.live = false;
+            if (++slot.generation == 0) {
+                slot.generation = 1;
+            }
+            slot.next_free = free_head_;
+            free_head_ = handle.index;
+            --size_;
+            return true;
+        }
+
+        /**
+         * @brief 通过句柄获取对象
+         * @return 句柄无效或已过期时返回 nullptr
+         */
+        [[nodiscard]] T *get(SlabHandle handle) const noexcept {
+            if (handle.index >= capacity()) {
+                return nullptr;
+            }
+            auto &slot = slot_at(handle.index);
+            if (!slot.live || slot.generation != handle.generation) {
+                return nullptr;
+            }
+            return object(slot);
+        }
+
+        /**
+         * @brief 获取槽位上的对象和当前句柄
+         * @return 槽位空闲时返回 nullptr
+         */
+        [[nodiscard]] T *at(std::uint32_t index) const noexcept {
+            if (index >= capacity()) {
+                return nullptr;
+            }
+            auto &slot = slot_at(index);
+            return slot.live ? object(slot) : nullptr;
+        }
+
+        [[nodiscard]] SlabHandle handle_at(std::uint32_t index) const noexcept {
+            if (index >= capacity() || !slot_at(index).live) {
+                return {};
+            }
+            return {index, slot_at(index).generation};
+        }
+
+        /**
+         * @brief 按槽位顺序遍历存活对象
+         * @param f 以 (SlabHandle, T &) 调用
+         */
+        template<class F>
+        void for_each(F &&f) const {
+            for (std::size_t c = 0; c < chunks_.size(); ++c) {
+                auto *slots = chunks_[c].get();
+                for (std::size_t i = 0; i < ChunkSize; ++i) {
+                    if (slots[i].live) {
+                        f(SlabHandle{static_cast<std::uint32_t>(c * ChunkSize + i), slots[i].generation},
+                          *object(slots[i]));
+                    }
+                }
+            }
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+        [[nodiscard]] std::size_t capacity() const noexcept { return chunks_.size() * ChunkSize; }
+
+        /**
+         * @brief 析构所有对象，保留已分配的块
+         */
+        void clear() {
+            for (std::size_t c = 0; c < chunks_.size(); ++c) {
+                for (std::size_t i = 0; i < ChunkSize; ++i) {
+                    auto &slot = chunks_[c][i];
+                    if (slot.live) {
+                        erase({static_cast<std::uint32_t>(c * ChunkSize + i), slot.generation});
+                    }
+                }
+            }
+        }
+
+    private:
+        struct Slot {
+            alignas(T) std::byte storage[sizeof(T)];
+            std::uint32_t generation = 1;
+            std::uint32_t next_free = SlabHandle::kInvalidIndex;
+            bool live = false;
+        };
+
+        static T *object(const Slot &slot) noexcept {
+            return std::launder(reinterpret_cast<T *>(const_cast<std::byte *>(slot.storage)));
+        }
+
+        Slot &slot_at(std::uint32_t index) const noexcept {
+            return chunks_[index / ChunkSize][index % ChunkSize];
+        }
+
+        // 新增一块，槽位按下标顺序挂到空闲链表
+        void grow() {
+            auto base = static_cast<std::uint32_t>(capacity());
+            chunks_.emplace_back(std::make_unique<Slot[]>(ChunkSize));
+            auto &slots = chunks_.back();
+            for (std::size_t i = ChunkSize; i-- > 0;) {
+                slots[i].next_free = free_head_;
+                free_head_ = base + static_cast<std::uint32_t>(i);
+            }
+        }
+
+        std::vector<std::unique_ptr<Slot[]>> chunks_;
+        std::uint32_t free_head_ = SlabHandle::kInvalidIndex;
+        std::size_t size_ = 0;
+    };
+
+} // namespace cfl
@@ -1,10 +1,48 @@
 #include "static_data.h"
 #include "cfl/db/db_mysql.h"
+#include "cfl/db/db_row.h"
 #include "cfl/db/db_sqlite.h"
 #include "cfl/tools/common.h"
 #include "pugixml.hpp"
 #include <fstream>
 
+CFL_ROW(cfl::StActionInfo,
+        CFL_COL(action_id, "Id"),
+        CFL_COL(max_value, "Max"),
+        CFL_COL(unit_time, "UnitTime"));
+
+CFL_ROW(cfl::StCarrerInfo,
+        CFL_COL(id, "Carrer"),
+        CFL_COL(actor_id, "ActorID"),
+        CFL_COL(born_city, "BornCity"),
+        CFL_COL(name, "CarrerName"));
+
+CFL_ROW(cfl::StActorInfo,
+        CFL_COL(id, "Id"),
+        CFL_COL(init_level, "Level"),
+        CFL_COL(default_speed, "DefSpeed"),
+        CFL_COL(radius, "Radius"),
+        CFL_COL(type, "Type"),
+        CFL_COL(ai_id, "AiId"),
+        CFL_COL(properties, "P1"));
+
+CFL_ROW(cfl::StActorSkillInfo,
+        CFL_COL(actor_id, "Id"),
+        CFL_COL(normal_id, "Normal1"),
+        CFL_COL_AT(specials, 0, "Special1"),
+        CFL_COL_AT(specials, 1, "Special2"),
+        CFL_COL_AT(specials, 2, "Special3"),
+        CFL_COL_AT(specials, 3, "Special4"),
+        CFL_COL_AT(specials, 4, "Special5"));
+
+CFL_ROW(cfl::StCopyInfo,
+        CFL_COL(copy_id, "Id"),
+        CFL_COL(copy_type, "CopyType"),
+        CFL_COL(cost_act_id, "CostActionId"),
+        CFL_COL(cost_act_num, "CostActionNum"),
+        CFL_COL(get_money_id, "GetMoneyId"),
+        CFL_COL(get_money_ratio, "GetMoneyRatio"));
+
 namespace cfl {
     StaticData::StaticData() {
         carrer_levels.resize(4);
@@ -96,13 +134,9 @@ namespace cfl {
 
     bool StaticData::read_action_config(db::SqlData &query) {
         action_map.clear();
-        while (query.next()) {
-            StActionInfo info;
-            info.action_id = query.get_int32("Id");
-            info.max_value = query.get_int32("Max");
-            info.unit_time = query.get_int32("UnitTime");
+        db::read_rows<StActionInfo>(query, [this](StActionInfo &&info) {
             action_map.emplace(info.action_id, info);
-        }
+        });
         return true;
     }
 
@@ -124,15 +158,9 @@ namespace cfl {
 
     bool StaticData::read_carrer(db::SqlData &query) {
         carrer_map.clear();
-        while (query.next()) {
-            StCarrerInfo info;
-            info.id = query.get_int32("Carrer");
-            info.actor_id = query.get_int32("ActorID");
-            info.born_city = query.get_int32("BornCity");
-            info.name = query.get_string("CarrerName");
-
-            carrer_map.emplace(info.id, info);
-        }
+        db::read_rows<StCarrerInfo>(query, [this](StCarrerInfo &&info) {
+            carrer_map.emplace(info.id, std::move(info));
+        });
 
         return true;
     }
@@ -169,21 +197,9 @@ namespace cfl {
 
     bool StaticData::read_actor(db::SqlData &query) {
         actor_map.clear();
-        while (query.next()) {
-            StActorInfo info;
-            info.id = query.get_int32("Id");
-            info.init_level = query.get_int32("Level");
-            info.default_speed = query.get_float("DefSpeed");
-            info.radius = query.get_float("Radius");
-            info.type = query.get_int32("Type");
-            info.ai_id = query.get_int32("AiId");
-            int idx = query.column_index("P1");
-            for (int i = 0; i < PropertyNum; i++) {
-                info.properties[i] = query.get_int32(idx + i);
-            }
-
-            actor_map.emplace(info.id, info);
-        }
+        db::read_rows<StActorInfo>(query, [this](StActorInfo &&info) {
+            actor_map.emplace(info.id, std::move(info));
+        });
         return true;
     }
 
@@ -196,17 +212,9 @@ namespace cfl {
 
     bool StaticData::read_actor_skill_info(db::SqlData &query) {
         actor_skill_map.clear();
-        while (query.next()) {
-            StActorSkillInfo info;
-            info.actor_id = query.get_int32("Id");
-            info.normal_id = query.get_int32("Normal1");
-            info.specials[0] = query.get_int32("Special1");
-            info.specials[1] = query.get_int32("Special2");
-            info.specials[2] = query.get_int32("Special3");
-            info.specials[3] = query.get_int32("Special4");
-            info.specials[4] = query.get_int32("Special5");
+        db::read_rows<StActorSkillInfo>(query, [this](StActorSkillInfo &&info) {
             actor_skill_map.emplace(info.actor_id, info);
-        }
+        });
         return true;
     }
 
@@ -219,16 +227,9 @@ namespace cfl {
 
     bool StaticData::read_copy_info(db::SqlData &query) {
         copy_info_map.clear();
-        while (query.next()) {
-            StCopyInfo info;
-            info.copy_id = query.get_int32("Id");
-            info.copy_type = query.get_int32("CopyType");
-            info.cost_act_id = query.get_int32("CostActionId");
-            info.cost_act_num = query.get_int32("CostActionNum");
-            info.get_money_id = query.get_int32("GetMoneyId");
-            info.get_money_ratio = query.get_int32("GetMoneyRatio");
+        db::read_rows<StCopyInfo>(query, [this](StCopyInfo &&info) {
             copy_info_map.emplace(info.copy_id, info);
-        }
+        });
         return true;
     }
 
@@ -4,6 +4,8 @@
 #include <chrono>
 #include <format>
 #include <random>
+#include <cstring>
+#include <algorithm>
 
 namespace cfl {
     inline std::string escape_sql_string(std::string_view input) {
@@ -96,4 +98,15 @@ namespace cfl {
         if (max_len == 0) return {};
         return std::string(src.substr(0, max_len - 1));
     }
+
+    /**
+     * @brief 拷贝字符串到定长缓冲区，超长截断并保证以 '\0' 结尾
+     */
+    template<std::size_t N>
+    inline void str_copy(char (&dst)[N], std::string_view src) {
+        static_assert(N > 0);
+        auto len = std::min(src.size(), N - 1);
+        std::memcpy(dst, src.data(), len);
+        dst[len] = '\0';
+    }
 }
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <thread>
+#include <vector>
+#include "cfl/db/db_async.h"
+#include "cfl/db/db_sqlite.h"
+
+using namespace cfl::db;
+
+int main() {
+    // 每个工作线程一个独立的内存数据库
+    auto factory = [](const std::string &) -> Database::Ptr {
+        auto db = std::make_shared<SQLite>(std::unordered_map<std::string, std::string>{{"dbname", ":memory:"}});
+        if (!db->connect() || db->execute("CREATE TABLE t (k INTEGER, v INTEGER);") < 0) {
+            return nullptr;
+        }
+        return db;
+    };
+
+    AsyncDb async;
+    if (!async.add_datasource("async_test", 4, factory, 0)) {
+        std::cerr << "[AsyncDb] add datasource failed" << std::endl;
+        return 1;
+    }
+    if (async.add_datasource("async_test", 4, factory, 0)) {
+        std::cerr << "[AsyncDb] duplicated datasource accepted" << std::endl;
+        return 1;
+    }
+    const auto main_thread = std::this_thread::get_id();
+
+    // 模拟一次 200ms 的数据库卡顿，提交和 poll 都不等待
+    auto begin = std::chrono::steady_clock::now();
+    bool slow_done = false;
+    async.submit<int>("async_test", 1, [](const Database::Ptr &) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        return 1;
+    }, [&](int) { slow_done = true; });
+    async.poll();
+    auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+    assert(cost.count() < 100 && !slow_done);
+
+    // 相同 key 按提交顺序执行和完成
+    const int keys = 8;
+    const int per_key = 100;
+    std::map<int, std::vector<int>> order;
+    for (int v = 0; v < per_key; ++v) {
+        for (int k = 1; k <= keys; ++k) {
+            async.execute_prepared("async_test", k, "INSERT INTO t (k, v) VALUES (?, ?);", [&, k, v](int rows) {
+                assert(std::this_thread::get_id() == main_thread);
+                assert(rows >= 0);
+                order[k].push_back(v);
+            }, k, v);
+        }
+    }
+    std::map<int, int> counts;
+    for (int k = 1; k <= keys; ++k) {
+        async.query_prepared("async_test", k, "SELECT COUNT(*) FROM t WHERE k = ?;", [&, k](SqlData::Ptr data) {
+            counts[k] = data && data->next() ? data->get_int32(0) : -1;
+        }, k);
+    }
+
+    while (async.pending() > 0 || async.completed() > 0) {
+        async.poll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(slow_done);
+    for (int k = 1; k <= keys; ++k) {
+        assert(order[k].size() == per_key);
+        for (int v = 0; v < per_key; ++v) {
+            assert(order[k][v] == v);
+        }
+        assert(counts[k] == per_key);
+    }
+
+    // 连接已断开时丢弃，下一个任务重新创建；语句失败但连接可用时保留连接
+    {
+        int created = 0;
+        AsyncDb reconnect;
+        reconnect.add_datasource("reconnect_test", 1, [&created](const std::string &) -> Database::Ptr {
+            auto db = std::make_shared<SQLite>(std::unordered_map<std::string, std::string>{{"dbname", ":memory:"}});
+            // 第一个连接不打开，ping 失败，模拟断开的连接
+            if (++created > 1 && !db->connect()) {
+                return nullptr;
+            }
+            return db;
+        }, 0);
+        auto run = [&reconnect](std::function<int(const Database::Ptr &)> work) {
+            int result = 0;
+            reconnect.submit<int>("reconnect_test", 1, std::move(work), [&result](int rows) { result = rows; });
+            while (reconnect.pending() > 0 || reconnect.completed() > 0) {
+                reconnect.poll();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return result;
+        };
+        auto select = [](const Database::Ptr &db) { return db ? db->execute("SELECT 1;") : -1; };
+
+        int rows = run([](const Database::Ptr &) { return -1; });
+        assert(rows < 0);
+        rows = run(select);
+        assert(rows >= 0 && created == 2);
+        rows = run([](const Database::Ptr &db) { return db ? db->execute("INSERT INTO missing VALUES (1);") : -1; });
+        assert(rows < 0);
+        rows = run(select);
+        assert(rows >= 0);
+        if (created != 2) {
+            std::cerr << "[AsyncDb] connection dropped after a statement error" << std::endl;
+            return 1;
+        }
+    }
+
+    async.stop();
+    if (async.execute("async_test", 1, "SELECT 1;", {})) {
+        std::cerr << "[AsyncDb] execute accepted after stop" << std::endl;
+        return 1;
+    }
+    std::cout << "[AsyncDb] Done." << std::endl;
+    return 0;
+}
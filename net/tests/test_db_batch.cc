@@ -0,0 +1,100 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include "cfl/db/db_batch.h"
+#include "cfl/db/db_sqlite.h"
+
+using namespace cfl::db;
+
+namespace {
+    std::shared_ptr<SQLite> open_memory_db() {
+        auto db = std::make_shared<SQLite>(std::unordered_map<std::string, std::string>{{"dbname", ":memory:"}});
+        if (!db->connect() ||
+            db->execute("CREATE TABLE role (id INTEGER PRIMARY KEY, name TEXT, level INTEGER, exp INTEGER);") < 0) {
+            std::cerr << "[Batch] open memory db failed" << std::endl;
+            return nullptr;
+        }
+        return db;
+    }
+
+    int count_rows(const std::shared_ptr<SQLite> &db, std::string_view where = "1 = 1") {
+        auto data = db->query("SELECT COUNT(*) FROM role WHERE " + std::string(where) + ";");
+        if (!data || !data->next()) {
+            return -1;
+        }
+        return data->get_int32(0);
+    }
+}
+
+int main() {
+    const int rows = 20000;
+
+    auto db = open_memory_db();
+    if (!db) {
+        return 1;
+    }
+    {
+        BatchWriter writer(db, SqlDialect::SQLite, "role", {"id", "name", "level", "exp"});
+        for (int i = 1; i <= rows; ++i) {
+            auto name = "role_" + std::to_string(i);
+            if (!writer.add_row(i, name, 1, int64_t{0})) {
+                std::cerr << "[Batch] add_row " << i << " failed" << std::endl;
+                return 1;
+            }
+        }
+        if (!writer.commit()) {
+            std::cerr << "[Batch] commit failed" << std::endl;
+            return 1;
+        }
+        // 4 列受 SQLite 999 个占位符限制，每条语句 249 行
+        assert(writer.rows_per_statement() == 249);
+        assert(writer.statement_count() == (rows + 248) / 249);
+        assert(count_rows(db) == rows);
+    }
+
+    // Upsert 只更新非主键列
+    {
+        BatchOptions options;
+        options.mode = BatchMode::Upsert;
+        options.max_rows = 7;
+        BatchWriter writer(db, SqlDialect::SQLite, "role", {"id", "level", "exp"}, options);
+        for (int i = 1; i <= 100; ++i) {
+            if (!writer.add_row(i, 10, int64_t{1000})) {
+                std::cerr << "[Batch] upsert add_row " << i << " failed" << std::endl;
+                return 1;
+            }
+        }
+        if (!writer.commit()) {
+            std::cerr << "[Batch] upsert commit failed" << std::endl;
+            return 1;
+        }
+        assert(count_rows(db) == rows);
+        assert(count_rows(db, "level = 10 AND exp = 1000 AND name IS NOT NULL") == 100);
+    }
+
+    // 任意一条语句失败时整个事务回滚
+    {
+        BatchOptions options;
+        options.max_rows = 10;
+        BatchWriter writer(db, SqlDialect::SQLite, "role", {"id", "name", "level", "exp"}, options);
+        for (int i = rows + 1; i <= rows + 15; ++i) {
+            if (!writer.add_row(i, "new", 1, 0)) {
+                std::cerr << "[Batch] add_row " << i << " failed" << std::endl;
+                return 1;
+            }
+        }
+        assert(writer.statement_count() == 1);
+        if (writer.add_row(rows + 100, "bad", 1)) {  // 列数不一致
+            std::cerr << "[Batch] row with missing columns accepted" << std::endl;
+            return 1;
+        }
+        if (writer.commit()) {
+            std::cerr << "[Batch] commit after a failed row succeeded" << std::endl;
+            return 1;
+        }
+        assert(count_rows(db) == rows);
+    }
+
+    std::cout << "[Batch] Done." << std::endl;
+    return 0;
+}
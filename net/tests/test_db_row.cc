@@ -0,0 +1,120 @@
+#include <iostream>
+#include <cassert>
+#include <array>
+#include <string>
+#include <vector>
+#include "cfl/db/db_row.h"
+#include "cfl/db/db_sqlite.h"
+
+using namespace cfl::db;
+
+enum class Quality : std::uint8_t { White, Green, Blue };
+
+struct ItemRow {
+    std::uint32_t id = 0;
+    std::int64_t price = 0;
+    float weight = 0.0f;
+    bool bind = false;
+    Quality quality = Quality::White;
+    std::string name;
+    std::array<std::int32_t, 3> props{};
+    std::array<std::int32_t, 2> skills{};
+    std::uint32_t missing = 7;
+};
+
+CFL_ROW(ItemRow,
+        CFL_COL(id, "Id"),
+        CFL_COL(price, "Price"),
+        CFL_COL(weight, "Weight"),
+        CFL_COL(bind, "Bind"),
+        CFL_COL(quality, "Quality"),
+        CFL_COL(name, "Name"),
+        CFL_COL(props, "P1"),
+        CFL_COL_AT(skills, 0, "SkillA"),
+        CFL_COL_AT(skills, 1, "SkillB"),
+        CFL_COL(missing, "NoSuchColumn"));
+
+struct RoleRow {
+    std::uint64_t id = 0;
+    std::uint32_t level = 0;
+    std::int64_t exp = 0;
+    std::string name;
+};
+
+CFL_ROW(RoleRow, CFL_COL(id, "id"), CFL_COL(level, "level"), CFL_COL(exp, "exp"), CFL_COL(name, "name"));
+
+int main() {
+    auto db = std::make_shared<SQLite>(std::unordered_map<std::string, std::string>{{"dbname", ":memory:"}});
+    if (!db->connect()) {
+        std::cerr << "[Row] connect failed" << std::endl;
+        return 1;
+    }
+    if (db->execute("CREATE TABLE item (SkillB INTEGER, Id INTEGER, Price INTEGER, Weight REAL, Bind INTEGER, "
+                    "Quality INTEGER, Name TEXT, P1 INTEGER, P2 INTEGER, P3 INTEGER, SkillA INTEGER);") < 0) {
+        std::cerr << "[Row] create table failed" << std::endl;
+        return 1;
+    }
+    if (db->execute("INSERT INTO item VALUES (22, 1, 9000000000, 1.5, 1, 2, 'sword', 10, 20, 30, 11);") < 0) {
+        std::cerr << "[Row] insert item failed" << std::endl;
+        return 1;
+    }
+    if (db->execute("INSERT INTO item VALUES (NULL, 2, 5, 0.25, 0, 1, NULL, 1, NULL, 3, 12);") < 0) {
+        std::cerr << "[Row] insert item failed" << std::endl;
+        return 1;
+    }
+
+    {
+        auto data = db->query("SELECT * FROM item ORDER BY Id;");
+        RowReader<ItemRow> reader(*data);
+        assert(!reader.complete() && reader.missing() == 1);
+
+        std::vector<ItemRow> items;
+        while (data->next()) {
+            ItemRow row;
+            reader.read(*data, row);
+            items.push_back(row);
+        }
+        assert(items.size() == 2);
+        assert(items[0].id == 1 && items[0].price == 9000000000LL && items[0].weight == 1.5f && items[0].bind);
+        assert(items[0].quality == Quality::Blue && items[0].name == "sword");
+        assert((items[0].props == std::array<std::int32_t, 3>{10, 20, 30}));
+        assert(items[0].skills[0] == 11 && items[0].skills[1] == 22);
+        assert(items[0].missing == 7);
+        // NULL 保留默认值
+        assert(items[1].name.empty() && items[1].props[1] == 0 && items[1].props[2] == 3 && items[1].skills[1] == 0);
+        assert(items[1].quality == Quality::Green && !items[1].bind);
+    }
+
+    // 按名字逐字段读取与绑定读取结果一致
+    const int rows = 1000;
+    if (db->execute("CREATE TABLE role (id INTEGER, level INTEGER, exp INTEGER, name TEXT);") < 0) {
+        std::cerr << "[Row] create table failed" << std::endl;
+        return 1;
+    }
+    for (int i = 0; i < rows; ++i) {
+        auto name = "role_" + std::to_string(i);
+        if (db->execStmt("INSERT INTO role VALUES (?, ?, ?, ?);", i, i % 100, int64_t{i} * 10, std::string_view(name)) < 0) {
+            std::cerr << "[Row] insert role failed" << std::endl;
+            return 1;
+        }
+    }
+
+    auto data = db->query("SELECT * FROM role;");
+    std::int64_t by_name = 0;
+    while (data->next()) {
+        by_name += data->get_int64("exp") + data->get_uint32("level");
+    }
+
+    data = db->query("SELECT * FROM role ORDER BY id;");
+    std::int64_t bound = 0;
+    std::vector<RoleRow> roles;
+    auto count = read_rows<RoleRow>(*data, [&](RoleRow &&row) {
+        bound += row.exp + row.level;
+        roles.push_back(std::move(row));
+    });
+    assert(count == rows && bound == by_name);
+    assert(roles[rows - 1].id == rows - 1 && roles[rows - 1].name == "role_" + std::to_string(rows - 1));
+
+    std::cout << "test_db_row passed" << std::endl;
+    return 0;
+}
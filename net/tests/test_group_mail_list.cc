@@ -0,0 +1,98 @@
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include <vector>
+#include "cfl/mail/group_mail_list.h"
+
+using namespace cfl::shm;
+
+static GroupMailList::MailPtr make_mail(std::uint64_t guid, std::uint64_t time) {
+    auto mail = std::make_shared<GroupMailDataObject>();
+    mail->guid = guid;
+    mail->time = time;
+    return mail;
+}
+
+static std::vector<std::uint64_t> guids_after(GroupMailList &list, std::uint64_t time) {
+    std::vector<std::uint64_t> guids;
+    list.for_each_after(time, [&guids](const GroupMailList::MailPtr &mail) { guids.push_back(mail->guid); });
+    return guids;
+}
+
+int main() {
+    // 乱序加入（从数据库/共享内存恢复）后按时间顺序查询
+    {
+        GroupMailList list;
+        if (!list.add(make_mail(3, 300))) {
+            std::cerr << "[GroupMail] add failed" << std::endl;
+            return 1;
+        }
+        if (!list.add(make_mail(1, 100))) {
+            std::cerr << "[GroupMail] add failed" << std::endl;
+            return 1;
+        }
+        if (!list.add(make_mail(2, 200))) {
+            std::cerr << "[GroupMail] add failed" << std::endl;
+            return 1;
+        }
+        if (!list.add(make_mail(4, 200))) {  // 同一时间按 GUID 排序
+            std::cerr << "[GroupMail] add failed" << std::endl;
+            return 1;
+        }
+        if (list.add(make_mail(2, 999))) {  // GUID 重复
+            std::cerr << "[GroupMail] duplicated guid accepted" << std::endl;
+            return 1;
+        }
+        if (list.add(nullptr)) {
+            std::cerr << "[GroupMail] null mail accepted" << std::endl;
+            return 1;
+        }
+        assert(list.size() == 4);
+
+        assert((guids_after(list, 0) == std::vector<std::uint64_t>{1, 2, 4, 3}));
+        assert((guids_after(list, 100) == std::vector<std::uint64_t>{2, 4, 3}));
+        assert((guids_after(list, 200) == std::vector<std::uint64_t>{3}));
+        assert(guids_after(list, 300).empty());
+
+        // 新邮件的时间严格递增
+        assert(list.next_time(50) == 301 && list.next_time(1000) == 1000);
+
+        // 删除为墓碑
+        if (!list.remove(4)) {
+            std::cerr << "[GroupMail] remove failed" << std::endl;
+            return 1;
+        }
+        if (list.remove(4)) {
+            std::cerr << "[GroupMail] removed twice" << std::endl;
+            return 1;
+        }
+        assert(list.find(4) == nullptr && list.find(2)->time == 200);
+        assert((guids_after(list, 100) == std::vector<std::uint64_t>{2, 3}));
+        assert(list.size() == 3 && list.tombstones() == 1);
+    }
+
+    // 大量删除后压缩，GUID 索引仍然正确
+    {
+        GroupMailList list;
+        for (std::uint64_t i = 1; i <= 1000; ++i) {
+            list.add(make_mail(i, i * 10));
+        }
+        for (std::uint64_t i = 1; i <= 1000; ++i) {
+            if (i % 4 != 0) {
+                list.remove(i);
+            }
+        }
+        assert(list.tombstones() == 750);
+        assert(guids_after(list, 0).size() == 250);
+        assert(list.tombstones() == 0 && list.size() == 250);
+        for (std::uint64_t i = 4; i <= 1000; i += 4) {
+            assert(list.find(i) && list.find(i)->guid == i);
+        }
+        assert((guids_after(list, 9950) == std::vector<std::uint64_t>{996, 1000}));
+        list.add(make_mail(2000, list.next_time(0)));
+        assert(guids_after(list, 10000).size() == 1);
+    }
+
+    std::cout << "test_group_mail_list passed" << std::endl;
+    return 0;
+}
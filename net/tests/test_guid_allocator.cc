@@ -0,0 +1,116 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "cfl/guid_allocator.h"
+
+using namespace cfl;
+
+int main() {
+    const std::uint64_t base = std::uint64_t{1} << 48;
+
+    // 多线程分配：全局唯一、线程内递增、不超过已持久化的水位
+    std::atomic<std::uint64_t> stored{0};   // 模拟存储中的水位
+    std::uint64_t last_id = 0;
+    {
+        GuidAllocator alloc([&stored](std::uint64_t watermark) {
+            assert(watermark > stored.load());  // 水位只增不减
+            std::this_thread::sleep_for(std::chrono::microseconds(200));  // 模拟写库耗时
+            stored = watermark;
+            return true;
+        }, 1000, 16);
+        if (alloc.next() != 0) {  // 未启动
+            std::cerr << "[Guid] id issued before start" << std::endl;
+            return 1;
+        }
+        if (!alloc.start(base)) {
+            std::cerr << "[Guid] start failed" << std::endl;
+            return 1;
+        }
+        assert(stored == base + 1000);
+
+        const int threads = 8;
+        const int per_thread = 50000;
+        std::vector<std::vector<std::uint64_t>> ids(threads);
+        {
+            std::vector<std::jthread> workers;
+            for (int t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t]() {
+                    auto &out = ids[t];
+                    out.reserve(per_thread);
+                    for (int i = 0; i < per_thread; ++i) {
+                        auto id = alloc.next();
+                        assert(id > base && id <= stored.load());
+                        out.push_back(id);
+                    }
+                    assert(std::is_sorted(out.begin(), out.end()));
+                });
+            }
+        }
+        std::vector<std::uint64_t> all;
+        for (auto &v: ids) {
+            all.insert(all.end(), v.begin(), v.end());
+        }
+        std::sort(all.begin(), all.end());
+        assert(std::adjacent_find(all.begin(), all.end()) == all.end());
+        last_id = all.back();
+        assert(alloc.watermark() == stored && last_id <= alloc.watermark());
+        std::cout << "persists: " << alloc.persist_count() << ", stalls: " << alloc.stall_count() << std::endl;
+    }
+
+    // 从存储中的水位重启：不会重复发出旧的 ID
+    {
+        std::uint64_t restored = stored;
+        GuidAllocator alloc([&stored](std::uint64_t watermark) {
+            stored = watermark;
+            return true;
+        }, 1000, 16);
+        if (!alloc.start(restored)) {
+            std::cerr << "[Guid] restart failed" << std::endl;
+            return 1;
+        }
+        if (alloc.next() != restored + 1) {
+            std::cerr << "[Guid] restart did not continue from the watermark" << std::endl;
+            return 1;
+        }
+        assert(restored + 1 > last_id);
+    }
+
+    // 存储不可写：不发出水位之外的 ID
+    {
+        std::atomic<bool> writable{true};
+        std::atomic<std::uint64_t> durable{0};
+        GuidAllocator alloc([&](std::uint64_t watermark) {
+            if (!writable) {
+                return false;
+            }
+            durable = watermark;
+            return true;
+        }, 100, 10);
+        if (!alloc.start(0)) {
+            std::cerr << "[Guid] start failed" << std::endl;
+            return 1;
+        }
+        writable = false;
+        std::uint64_t id = 0;
+        std::uint64_t count = 0;
+        while ((id = alloc.next()) != 0) {
+            assert(id <= durable);
+            ++count;
+        }
+        assert(count <= 100);
+        if (alloc.next() != 0) {
+            std::cerr << "[Guid] id issued beyond the durable watermark" << std::endl;
+            return 1;
+        }
+        writable = true;                        // 恢复后继续分配
+        id = alloc.next();
+        assert(id > 0 && id <= durable);
+    }
+
+    std::cout << "test_guid_allocator passed" << std::endl;
+    return 0;
+}
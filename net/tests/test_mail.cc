@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cassert>
 #include <vector>
 #include <memory>
 #include "cfl/mail/mail_manager.h"
@@ -79,6 +80,22 @@ int main() {
 
     ok = mail_mgr.process_role_login(player);
     std::cout << "process_role_login result: " << ok << std::endl;
+    assert(ok);
+
+    // 群发邮件只生成引用记录，内容从群邮件解析
+    std::cout << "[Test] group mail reference" << std::endl;
+    static_assert(sizeof(GroupMailStateObject) < sizeof(MailDataObject), "group mail reference must stay small");
+    auto mail_module = std::dynamic_pointer_cast<MailModule>(player->get_module_by_type(ModuleType::Mail));
+    assert(mail_module);
+    std::size_t references = 0;
+    mail_mgr.group_mail_data_.for_each([&](const GroupMailList::MailPtr &group_mail) {
+        auto state = mail_module->get_group_mail_state(group_mail->guid);
+        assert(state != nullptr && state->group_guid == group_mail->guid && state->role_id == test_role_id);
+        assert(state->status == mail_new);
+        ++references;
+    });
+    assert(references == mail_mgr.group_mail_data_.size());
+    mail_module->notify_change();
 
 //    std::cout << "=== MailManager Unit Test Finished ===" << std::endl;
     return 0;
@@ -0,0 +1,128 @@
+#include <iostream>
+#include <cassert>
+#include <unordered_map>
+#include <vector>
+#include "cfl/mail/mail_expiry_index.h"
+
+using namespace cfl::shm;
+using Kind = MailExpiryIndex::Kind;
+
+static std::vector<std::uint64_t> sweep_guids(MailExpiryIndex &index, std::uint64_t now, std::size_t budget) {
+    std::vector<std::uint64_t> guids;
+    index.sweep(now, budget, [&guids](const MailExpiryIndex::Entry &entry) { guids.push_back(entry.guid); });
+    return guids;
+}
+
+int main() {
+    // 按到期时间顺序处理，不处理未到期的项
+    {
+        MailExpiryIndex index(100);
+        index.add(Kind::Personal, 1, 10, 250);
+        index.add(Kind::Personal, 2, 10, 120);
+        index.add(Kind::Group, 3, 0, 180);
+        index.add(Kind::Personal, 4, 11, 510);
+        // 重复登记（如玩家再次登录）被忽略
+        bool duplicated = index.add(Kind::Personal, 1, 10, 250);
+        assert(!duplicated && index.contains(1));
+        assert(index.size() == 4 && index.bucket_count() == 3);
+        assert(index.next_expire_time() == 120);
+
+        if (!sweep_guids(index, 100, 10).empty()) {
+            std::cerr << "[Expiry] sweep at 100 returned mails" << std::endl;
+            return 1;
+        }
+        if (sweep_guids(index, 200, 10) != std::vector<std::uint64_t>{2, 3}) {
+            std::cerr << "[Expiry] sweep at 200 returned wrong mails" << std::endl;
+            return 1;
+        }
+        if (sweep_guids(index, 300, 10) != std::vector<std::uint64_t>{1}) {
+            std::cerr << "[Expiry] sweep at 300 returned wrong mails" << std::endl;
+            return 1;
+        }
+        assert(index.size() == 1 && index.next_expire_time() == 510 && !index.contains(1));
+
+        // 当前桶内只处理已到期的项
+        index.add(Kind::Personal, 5, 11, 550);
+        if (sweep_guids(index, 520, 10) != std::vector<std::uint64_t>{4}) {
+            std::cerr << "[Expiry] sweep at 520 returned wrong mails" << std::endl;
+            return 1;
+        }
+        assert(index.size() == 1 && index.bucket_count() == 1);
+        if (sweep_guids(index, 600, 10) != std::vector<std::uint64_t>{5}) {
+            std::cerr << "[Expiry] sweep at 600 returned wrong mails" << std::endl;
+            return 1;
+        }
+        assert(index.empty() && index.bucket_count() == 0);
+    }
+
+    // 每次最多处理 budget 项，剩余的下次继续
+    {
+        MailExpiryIndex index(1000);
+        for (std::uint64_t i = 1; i <= 100; ++i) {
+            index.add(Kind::Personal, i, i, 5000 - i);
+        }
+        std::size_t total = 0;
+        std::uint64_t last = 0;
+        while (!index.empty()) {
+            std::size_t count = 0;
+            index.sweep(10000, 16, [&](const MailExpiryIndex::Entry &entry) {
+                assert(entry.expire_time >= last);
+                last = entry.expire_time;
+                ++count;
+            });
+            assert(count <= 16);
+            total += count;
+        }
+        assert(total == 100);
+    }
+
+    // 修改桶跨度后重新分桶
+    {
+        MailExpiryIndex index(1000);
+        for (std::uint64_t i = 0; i < 10; ++i) {
+            index.add(Kind::Group, i, 0, i * 1000 + 10);
+        }
+        assert(index.bucket_count() == 10);
+        index.set_bucket_ms(5000);
+        assert(index.bucket_count() == 2 && index.size() == 10);
+        if (sweep_guids(index, 4010, 100).size() != 5) {
+            std::cerr << "[Expiry] sweep after rebucket returned wrong mails" << std::endl;
+            return 1;
+        }
+    }
+
+    // 稳定收发：每帧新增的邮件与过期的邮件相当，存活邮件数保持平稳
+    {
+        const std::uint64_t frame_ms = 50;
+        const std::uint64_t expire_ms = 60 * 1000;
+        const std::size_t per_frame = 20;
+        MailExpiryIndex index(10 * 1000);
+        std::unordered_map<std::uint64_t, std::uint64_t> live;   // guid -> 到期时间
+        std::uint64_t guid = 0;
+        std::size_t peak = 0;
+        std::size_t max_frame_work = 0;
+        for (std::uint64_t now = 0; now < 10 * expire_ms; now += frame_ms) {
+            for (std::size_t i = 0; i < per_frame; ++i) {
+                ++guid;
+                live.emplace(guid, now + expire_ms);
+                index.add(Kind::Personal, guid, 1, now + expire_ms);
+            }
+            auto work = index.sweep(now, 64, [&](const MailExpiryIndex::Entry &entry) {
+                assert(entry.expire_time <= now);
+                live.erase(entry.guid);
+            });
+            max_frame_work = std::max(max_frame_work, work);
+            peak = std::max(peak, live.size());
+        }
+        // 存活邮件不超过一个有效期内发送的数量
+        const auto steady = expire_ms / frame_ms * per_frame;
+        assert(peak <= steady + per_frame);
+        assert(max_frame_work <= 64);
+        for (auto &[id, expire_time]: live) {
+            assert(expire_time > 10 * expire_ms - frame_ms);   // 到期的都已处理
+        }
+    }
+
+    std::cout << "test_mail_expiry_index passed" << std::endl;
+    return 0;
+}
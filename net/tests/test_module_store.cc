@@ -0,0 +1,60 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "cfl/modules/module_store.h"
+
+using namespace cfl;
+
+namespace {
+    // 批量处理的热数据直接存放在状态数组中
+    struct DayState {
+        std::uint64_t role_id = 0;
+        std::uint64_t logoff_time = 0;
+    };
+
+    // 模拟模块：保存在 ModuleStore 中的下标
+    struct FakeModule {
+        std::uint32_t slot = ModuleStore<DayState>::kNoSlot;
+        std::uint64_t role_id = 0;
+    };
+}
+
+int main() {
+    // 交换删除后被移动模块的下标随之更新
+    {
+        ModuleStore<DayState> store;
+        std::vector<std::unique_ptr<FakeModule>> modules;
+        for (int i = 0; i < 5; ++i) {
+            modules.push_back(std::make_unique<FakeModule>());
+            modules.back()->role_id = 1000 + i;
+            store.add(modules.back()->slot, {modules.back()->role_id, 0});
+        }
+        assert(store.size() == 5 && modules[4]->slot == 4);
+        store.add(modules[0]->slot, {modules[0]->role_id, 0});      // 重复加入被忽略
+        assert(store.size() == 5);
+
+        store.remove(modules[1]->slot);
+        assert(modules[1]->slot == ModuleStore<DayState>::kNoSlot);
+        assert(modules[4]->slot == 1 && store.at(1).role_id == modules[4]->role_id);
+        store.remove(modules[1]->slot);                             // 重复删除被忽略
+        store.remove(modules[4]->slot);
+        assert(store.size() == 3 && modules[3]->slot == 1);
+
+        for (auto &state: store.states()) {
+            state.logoff_time = 100;
+        }
+        for (int i: {0, 2, 3}) {
+            auto &state = store.at(modules[i]->slot);
+            assert(state.role_id == modules[i]->role_id && state.logoff_time == 100);
+        }
+        for (auto &module: modules) {
+            store.remove(module->slot);
+        }
+        assert(store.empty());
+    }
+
+    std::cout << "test_module_store passed" << std::endl;
+    return 0;
+}
@@ -157,8 +157,17 @@ int main() {
             }
         }
 
-        // 测试9: 清理数据
-        spdlog::info("=== 测试9: 清理数据 ===");
+        // 测试9: 连接池统计（连续查询复用刚归还的连接，不再逐次心跳）
+        spdlog::info("=== 测试9: 连接池统计 ===");
+        for (int i = 0; i < 10; ++i) {
+            (void) MySQLUtil::query("test", "SELECT 1");
+        }
+        auto stats = MySQLMgr::instance()->stats();
+        spdlog::info("checkouts: {}, pings: {}, ping_skips: {}, dropped: {}, reconnects: {}, retries: {}",
+                     stats.checkouts, stats.pings, stats.ping_skips, stats.dropped, stats.reconnects, stats.retries);
+
+        // 测试10: 清理数据
+        spdlog::info("=== 测试10: 清理数据 ===");
         affected = MySQLUtil::execute("test", "DROP TABLE IF EXISTS test_users");
         spdlog::info("删除表 affected rows: {}", affected);
 
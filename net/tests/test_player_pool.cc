@@ -0,0 +1,162 @@
+#include <iostream>
+#include <cassert>
+#include <array>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "cfl/id_table.h"
+#include "cfl/slab_pool.h"
+
+using namespace cfl;
+
+namespace {
+    // 模拟玩家对象：若干属性加一个需要析构的成员
+    struct FakePlayer {
+        std::uint64_t role_id = 0;
+        std::array<std::int64_t, 16> properties{};
+        std::vector<int> modules;
+
+        explicit FakePlayer(std::uint64_t id) : role_id(id), modules(4, 1) {}
+    };
+
+    int g_live = 0;
+
+    struct Counted {
+        Counted() { ++g_live; }
+        ~Counted() { --g_live; }
+    };
+}
+
+int main() {
+    // 对象池：地址稳定、句柄代数校验、槽位复用
+    {
+        SlabPool<Counted, 4> pool;
+        std::vector<SlabHandle> handles;
+        std::vector<Counted *> addresses;
+        for (int i = 0; i < 10; ++i) {
+            handles.push_back(pool.emplace());
+            addresses.push_back(pool.get(handles.back()));
+        }
+        assert(pool.size() == 10 && pool.capacity() == 12 && g_live == 10);
+        for (int i = 0; i < 10; ++i) {
+            assert(pool.get(handles[i]) == addresses[i]);   // 扩容后地址不变
+        }
+
+        auto old = handles[3];
+        bool erased = pool.erase(old);
+        bool erased_again = pool.erase(old);
+        assert(erased && !erased_again);
+        assert(pool.get(old) == nullptr && g_live == 9);
+        auto reused = pool.emplace();
+        assert(reused.index == old.index && reused.generation != old.generation);
+        assert(pool.get(old) == nullptr && pool.get(reused) != nullptr);
+        assert(pool.handle_at(old.index) == reused);
+
+        std::size_t visited = 0;
+        pool.for_each([&visited](SlabHandle, Counted &) { ++visited; });
+        assert(visited == 10);
+        assert(pool.get(SlabHandle{}) == nullptr);
+
+        pool.clear();
+        assert(pool.empty() && g_live == 0 && pool.get(reused) == nullptr);
+    }
+    assert(g_live == 0);
+
+    // 开放寻址表：随机插入删除与 unordered_map 对照
+    {
+        IdTable table;
+        std::unordered_map<std::uint64_t, std::uint32_t> expect;
+        std::mt19937_64 rng(7);
+        for (int i = 0; i < 200000; ++i) {
+            auto id = rng() % 5000 + 1;
+            auto value = static_cast<std::uint32_t>(rng());
+            switch (rng() % 3) {
+                case 0: {
+                    bool inserted = table.insert(id, value);
+                    bool expected = expect.emplace(id, value).second;
+                    assert(inserted == expected);
+                    break;
+                }
+                case 1:
+                    table.assign(id, value);
+                    expect[id] = value;
+                    break;
+                default: {
+                    bool erased = table.erase(id);
+                    bool expected = expect.erase(id) == 1;
+                    assert(erased == expected);
+                    break;
+                }
+            }
+        }
+        assert(table.size() == expect.size());
+        for (std::uint64_t id = 1; id <= 5000; ++id) {
+            auto it = expect.find(id);
+            assert(table.find(id) == (it == expect.end() ? IdTable::kNotFound : it->second));
+        }
+        bool zero_inserted = table.insert(0, 1);
+        assert(!zero_inserted && table.find(0) == IdTable::kNotFound);
+        table.clear();
+        assert(table.empty() && !table.contains(1));
+    }
+
+    // 查找与遍历：对象池 + 开放寻址表 + 在线数组，与 unordered_map<id, shared_ptr> 结果一致
+    {
+        const std::uint64_t players = 20000;
+        const std::uint64_t base = std::uint64_t{1} << 48;
+        std::unordered_map<std::uint64_t, std::shared_ptr<FakePlayer>> map;
+        SlabPool<FakePlayer> pool;
+        IdTable table;
+        std::vector<FakePlayer *> online;
+        for (std::uint64_t i = 0; i < players; ++i) {
+            auto id = base + i * 7;
+            map.emplace(id, std::make_shared<FakePlayer>(id));
+            auto handle = pool.emplace(id);
+            table.insert(id, handle.index);
+            if (i % 2 == 0) {
+                online.push_back(pool.get(handle));
+            }
+        }
+
+        std::mt19937_64 rng(11);
+        std::vector<std::uint64_t> lookups(100000);
+        for (auto &id: lookups) {
+            id = base + (rng() % players) * 7;
+        }
+
+        std::int64_t sum_map = 0;
+        for (auto id: lookups) {
+            sum_map += map.find(id)->second->properties[0] + 1;
+        }
+
+        std::int64_t sum_pool = 0;
+        for (auto id: lookups) {
+            sum_pool += pool.at(table.find(id))->properties[0] + 1;
+        }
+        assert(sum_map == sum_pool);
+
+        const int rounds = 2;
+        std::uint64_t visited_map = 0;
+        for (int r = 0; r < rounds; ++r) {
+            for (auto &[id, player]: map) {
+                if (id % 14 == base % 14) {   // 与在线数组相同的一半玩家
+                    player->properties[1] += 1;
+                    ++visited_map;
+                }
+            }
+        }
+
+        std::uint64_t visited_online = 0;
+        for (int r = 0; r < rounds; ++r) {
+            for (auto player: online) {
+                player->properties[1] += 1;
+                ++visited_online;
+            }
+        }
+        assert(visited_map == visited_online && visited_online == players / 2 * rounds);
+    }
+
+    std::cout << "test_player_pool passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "cfl/rank_list.h"
+
+using namespace cfl;
+
+// 与暴力排序的结果逐名次比较
+static void check(const RankList &list, const std::unordered_map<std::uint64_t, std::uint64_t> &scores) {
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> expected(scores.begin(), scores.end());
+    std::sort(expected.begin(), expected.end(), [](auto &a, auto &b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    assert(list.size() == expected.size());
+
+    std::vector<RankEntry> all;
+    list.top(expected.size() + 10, all);
+    assert(all.size() == expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        assert(all[i].role_id == expected[i].first && all[i].score == expected[i].second);
+        assert(all[i].rank == i + 1);
+        assert(list.rank(expected[i].first) == i + 1);
+        assert(list.at(static_cast<std::uint32_t>(i + 1)).role_id == expected[i].first);
+    }
+}
+
+int main() {
+    // 基本顺序：分数降序，同分按角色ID升序
+    {
+        RankList list(3);
+        list.update(1, 1, 100);
+        list.update(2, 2, 300);
+        list.update(3, 3, 200);
+        list.update(4, 4, 300);
+        assert(list.rank(2) == 1 && list.rank(4) == 2 && list.rank(3) == 3 && list.rank(1) == 4);
+        assert(list.rank(5) == 0);
+        assert(list.at(0).role_id == 0 && list.at(5).role_id == 0);
+
+        if (list.update(3, 3, 200)) {  // 分数不变
+            std::cerr << "[Rank] unchanged score reported as update" << std::endl;
+            return 1;
+        }
+        if (!list.update(3, 3, 250)) {  // 原地修改
+            std::cerr << "[Rank] update failed" << std::endl;
+            return 1;
+        }
+        assert(list.rank(3) == 3);
+        if (!list.update(1, 1, 1000)) {  // 移动到榜首
+            std::cerr << "[Rank] update failed" << std::endl;
+            return 1;
+        }
+        assert(list.rank(1) == 1 && list.rank(2) == 2);
+
+        if (!list.erase(2)) {
+            std::cerr << "[Rank] erase failed" << std::endl;
+            return 1;
+        }
+        if (list.erase(2)) {
+            std::cerr << "[Rank] erased twice" << std::endl;
+            return 1;
+        }
+        assert(list.size() == 3 && list.rank(4) == 2);
+
+        std::vector<RankEntry> entries;
+        list.range(2, 10, entries);
+        assert(entries.size() == 2 && entries[0].role_id == 4 && entries[1].role_id == 3 && entries[1].rank == 3);
+    }
+
+    // 随机增删改后与暴力排序一致
+    {
+        RankList list;
+        std::unordered_map<std::uint64_t, std::uint64_t> scores;
+        std::mt19937_64 rng(42);
+        for (int round = 0; round < 20; ++round) {
+            for (int i = 0; i < 500; ++i) {
+                auto id = rng() % 2000 + 1;
+                auto op = rng() % 10;
+                if (op < 7) {
+                    auto score = rng() % 300;           // 制造大量同分
+                    list.update(id, id, score);
+                    scores[id] = score;
+                } else {
+                    bool erased = list.erase(id);
+                    bool expected = scores.erase(id) == 1;
+                    assert(erased == expected);
+                }
+            }
+            check(list, scores);
+        }
+        list.clear();
+        assert(list.size() == 0 && list.rank(1) == 0);
+    }
+
+    // 批量建表与逐个插入的结果一致，建表后的增删改仍然正确
+    {
+        RankList list;
+        std::unordered_map<std::uint64_t, std::uint64_t> scores;
+        std::vector<RankItem> items;
+        std::mt19937_64 rng(11);
+        for (std::uint32_t key = 0; key < 3000; key += 1 + rng() % 3) {
+            auto score = rng() % 500;
+            items.push_back({key, key, score});
+            scores[key] = score;
+        }
+        list.update(7, 7, 1);                   // 建表前的内容被替换
+        list.assign(items);
+        check(list, scores);
+        for (int i = 0; i < 2000; ++i) {
+            auto id = rng() % 3500;
+            if (rng() % 4 != 0) {
+                auto score = rng() % 500;
+                list.update(static_cast<RankList::Key>(id), id, score);
+                scores[id] = score;
+            } else {
+                assert(list.erase(static_cast<RankList::Key>(id)) == (scores.erase(id) == 1));
+            }
+        }
+        check(list, scores);
+        list.assign({});
+        assert(list.size() == 0 && list.rank(0) == 0);
+    }
+
+    // 页面快照：版本不变时复用，变化后在刷新周期内仍复用
+    {
+        RankList list(10, std::chrono::milliseconds(50));
+        for (std::uint64_t id = 1; id <= 95; ++id) {
+            list.update(id, id, id * 10);
+        }
+        auto page0 = list.page(0);
+        assert(page0->entries.size() == 10 && page0->entries.front().role_id == 95 && page0->total == 95);
+        assert(list.page(0) == page0);
+        auto last = list.page(9);
+        assert(last->entries.size() == 5 && last->entries.back().rank == 95);
+        assert(list.page(10)->entries.empty());
+
+        list.update(1, 1, 100000);
+        assert(list.page(0) == page0);          // 刷新周期内仍是旧快照
+        auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(60)) {
+        }
+        auto fresh = list.page(0);
+        assert(fresh != page0 && fresh->entries.front().role_id == 1 && fresh->version == list.version());
+        assert(page0->entries.front().role_id == 95);  // 已返回的快照不受影响
+    }
+
+    std::cout << "test_rank_list passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include "cfl/shm/obj/role_data_obj.h"
+#include "cfl/db/db_sqlite.h"
+
+using namespace cfl::shm;
+
+namespace {
+    std::int64_t column(const std::string &name) {
+        auto data = cfl::db::SQLiteUtil::query("gameserver", "SELECT " + name + " FROM role WHERE id = 1001;");
+        return data && data->next() ? data->get_int64(0) : -1;
+    }
+}
+
+int main() {
+    cfl::db::SQLiteMgr::instance()->register_sqlite("gameserver", {{"dbname", ":memory:"}});
+    int created = cfl::db::SQLiteUtil::execute("gameserver",
+            "CREATE TABLE role (id INTEGER PRIMARY KEY, accountid INTEGER, name TEXT, carrerid INTEGER, "
+            "level INTEGER, citycopyid INTEGER, exp INTEGER, langid INTEGER, viplevel INTEGER, vipexp INTEGER, "
+            "action1 INTEGER, action2 INTEGER, action3 INTEGER, action4 INTEGER, "
+            "actime1 INTEGER, actime2 INTEGER, actime3 INTEGER, actime4 INTEGER, "
+            "createtime INTEGER, logontime INTEGER, logofftime INTEGER, grouptime INTEGER, "
+            "fightvalue INTEGER, guildid INTEGER, isdelete INTEGER DEFAULT 0);");
+    if (created < 0) {
+        std::cerr << "[RoleDirty] create table failed" << std::endl;
+        return 1;
+    }
+
+    RoleDataObject role;
+    role.roleId = 1001;
+    role.level = 10;
+    role.exp = 5;
+    cfl::str_copy(role.name, "dirty");
+    if (!role.SaveSQLite()) {
+        std::cerr << "[RoleDirty] save failed" << std::endl;
+        return 1;
+    }
+    assert(!role.is_dirty());
+    cfl::db::SQLiteUtil::execute("gameserver", "UPDATE role SET isdelete = 1 WHERE id = 1001;");
+
+    // 只写入标记过的列：exp 被修改但没有标记，level 和 action2 标记后写入
+    role.set<RoleField::Level>(20);
+    role.action[1] = 7;
+    role.mark_dirty(RoleField::Action2);
+    role.exp = 99;
+    assert(role.dirty_mask() == (RoleDataObject::field_bit(RoleField::Level) |
+                                 RoleDataObject::field_bit(RoleField::Action2)));
+    if (!role.UpdateSQLite()) {
+        std::cerr << "[RoleDirty] update failed" << std::endl;
+        return 1;
+    }
+    assert(!role.is_dirty());
+    assert(column("level") == 20 && column("action2") == 7);
+    assert(column("exp") == 5 && column("isdelete") == 1);
+
+    // 没有脏字段时不访问数据库
+    bool updated = role.UpdateSQLite();
+    assert(updated);
+
+    // 写库失败时脏位被还原，表恢复后重试写入
+    cfl::db::SQLiteUtil::execute("gameserver", "ALTER TABLE role RENAME TO role_bak;");
+    role.set<RoleField::Exp>(123);
+    auto mask = role.dirty_mask();
+    bool saved = role.SaveSQLite();
+    assert(!saved && role.dirty_mask() == mask);
+    role.set<RoleField::GuildId>(3);
+    mask = role.dirty_mask();
+    updated = role.UpdateSQLite();
+    assert(!updated && role.dirty_mask() == mask);
+
+    cfl::db::SQLiteUtil::execute("gameserver", "ALTER TABLE role_bak RENAME TO role;");
+    updated = role.UpdateSQLite();
+    assert(updated && !role.is_dirty());
+    assert(column("exp") == 123 && column("guildid") == 3 && column("level") == 20);
+
+    std::cout << "test_role_dirty passed" << std::endl;
+    return 0;
+}
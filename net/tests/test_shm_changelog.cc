@@ -0,0 +1,114 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "cfl/shm/shmpage.h"
+#include "cfl/shm/shmobj.h"
+#include "cfl/shm/shmchangelog.h"
+
+using namespace cfl::shm;
+
+/// 测试用对象
+struct ChangeObject : public SharedObject {
+    std::uint64_t id{0};
+    std::uint64_t value{0};
+};
+
+int main() {
+    const std::size_t pool_id = 2;
+    SharedMemoryManager<ChangeObject> pool(1004, 64);
+    pool.initialize_block_map();
+
+    std::vector<ChangeObject *> objects;
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        objects.push_back(pool.allocate_object(true).value());
+    }
+
+    ShmChangeLog producer(1005, 1000);
+    assert(producer.valid() && producer.capacity() == 1024);
+    ShmChangeLog consumer(1005, 0, true);
+    assert(consumer.valid() && consumer.capacity() == 1024);
+    assert(consumer.need_full_scan());  // 消费者刚启动
+    assert(!consumer.need_full_scan());
+
+    // 未登记的池不发布
+    ShmChangeLog::install(&producer);
+    objects[0]->lock();
+    objects[0]->unlock();
+    assert(consumer.pending() == 0);
+
+    // 登记后每次 unlock 追加一条记录
+    producer.watch(pool_id, pool);
+    objects[3]->lock();
+    objects[3]->value = 3;
+    objects[3]->mark_dirty(1);
+    objects[3]->unlock();
+    auto header = pool.find_used_block_header(objects[3]);
+    std::size_t count = consumer.consume([&](const ShmChangeRecord &record) {
+        assert(record.pool == pool_id);
+        assert(record.index == header->index && record.generation == header->generation);
+        assert(record.dirty_mask == 0x2 && record.sequence == objects[3]->sequence());
+    });
+    assert(count == 1 && consumer.pending() == 0);
+
+    // 其他线程的写入不发布，序号照常前进
+    auto before = objects[5]->sequence();
+    objects[5]->lock();
+    objects[5]->value = 5;
+    objects[5]->unlock_unpublished();
+    assert(consumer.pending() == 0 && objects[5]->sequence() == before + 2);
+
+    // 生产者与消费者并发
+    const std::size_t writes = 200000;
+    std::atomic<bool> done{false};
+    std::vector<std::uint64_t> seen(pool.total_count(), 0);
+    std::size_t consumed = 0;
+    std::size_t full_scans = 0;
+    std::jthread reader([&] {
+        while (true) {
+            bool finished = done.load(std::memory_order_acquire);
+            if (consumer.need_full_scan()) {
+                ++full_scans;
+            }
+            consumed += consumer.consume([&](const ShmChangeRecord &record) {
+                assert(record.pool == pool_id && record.index < seen.size());
+                assert(record.sequence % 2 == 0 && record.sequence > seen[record.index]);
+                seen[record.index] = record.sequence;
+            });
+            if (finished && consumer.pending() == 0) {
+                break;
+            }
+        }
+    });
+    for (std::size_t i = 0; i < writes; ++i) {
+        auto object = objects[i % objects.size()];
+        object->lock();
+        object->value = i;
+        object->unlock();
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+    assert(consumed + producer.dropped() == writes);
+    assert((full_scans > 0) == (producer.dropped() > 0));
+    std::cout << "[ChangeLog] " << writes << " unlocks, consumed " << consumed
+              << ", dropped " << producer.dropped() << ", full scans " << full_scans << std::endl;
+
+    // 写满后丢弃记录，消费者退化为全量扫描
+    ShmChangeLog::install(nullptr);
+    auto dropped = producer.dropped();
+    for (std::size_t i = 0; i < producer.capacity() + 10; ++i) {
+        producer.push({static_cast<std::uint32_t>(pool_id), 0, i, 0, 0});
+    }
+    assert(producer.dropped() == dropped + 10);
+    assert(consumer.need_full_scan());
+    if (consumer.consume([](const ShmChangeRecord &) {}) != producer.capacity()) {
+        std::cerr << "[ChangeLog] full scan consumed wrong count" << std::endl;
+        return 1;
+    }
+    assert(!consumer.need_full_scan());
+
+    std::cout << "[ChangeLog] Done." << std::endl;
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include "cfl/shm/shmpage.h"
+#include "cfl/shm/shmobj.h"
+#include "cfl/shm/shmcheckpoint.h"
+
+using namespace cfl::shm;
+
+/// 测试用对象
+struct CheckpointObject : public SharedObject {
+    std::uint64_t id{0};
+    std::uint64_t value{0};
+};
+
+int main() {
+    const std::size_t module_id = 1002;
+    const std::string path = "test_shm_checkpoint.ckpt";
+    std::remove(path.c_str());
+
+    ShmCheckpointStats stats;
+    std::map<std::size_t, std::uint64_t> expected; ///< 块索引 -> value
+    std::size_t busy_index = 0;
+    {
+        SharedMemoryManager<CheckpointObject> pool(module_id, 8);
+        pool.initialize_block_map();
+        assert(pool.is_first_created());
+        CheckpointObject *first = nullptr;
+        for (std::uint64_t i = 1; i <= 10; ++i) {
+            auto obj = pool.allocate_object(true);
+            assert(obj.has_value());
+            auto object = obj.value();
+            object->lock();
+            object->id = i;
+            object->value = i * 100;
+            object->unlock();
+            if (first == nullptr) {
+                first = object;
+            }
+        }
+        std::cout << "[Checkpoint] pages: " << pool.page_count() << ", used: " << pool.used_count() << std::endl;
+
+        ShmCheckpoint checkpoint(path);
+        if (!checkpoint.write(pool, &stats)) {
+            std::cerr << "[Checkpoint] write failed" << std::endl;
+            return 1;
+        }
+        assert(stats.dirty_blocks == 10);
+        std::cout << "[Checkpoint] first: " << stats.dirty_pages << " pages, " << stats.bytes << " bytes" << std::endl;
+
+        // 第二次写入另一个槽，同样是整份写入
+        if (!checkpoint.write(pool, &stats)) {
+            std::cerr << "[Checkpoint] write failed" << std::endl;
+            return 1;
+        }
+        assert(stats.dirty_blocks == 10);
+
+        // 没有修改时不写入任何块
+        if (!checkpoint.write(pool, &stats)) {
+            std::cerr << "[Checkpoint] write failed" << std::endl;
+            return 1;
+        }
+        assert(stats.dirty_pages == 0 && stats.dirty_blocks == 0);
+
+        // 只写入修改过的块
+        first->lock();
+        first->value = 4242;
+        first->unlock();
+        if (!checkpoint.write(pool, &stats)) {
+            std::cerr << "[Checkpoint] write failed" << std::endl;
+            return 1;
+        }
+        assert(stats.dirty_blocks == 1 && stats.dirty_pages == 1);
+        std::cout << "[Checkpoint] incremental: " << stats.dirty_blocks << " blocks, " << stats.bytes << " bytes"
+                  << std::endl;
+
+        for (std::size_t i = 0; i < pool.total_count(); ++i) {
+            if (pool.get_block_header(i)->in_use) {
+                expected[i] = pool.get_object_by_index(static_cast<std::int32_t>(i))->value;
+            }
+        }
+
+        // 写入中的对象被跳过：镜像中已有同一对象的旧版本时沿用旧版本，否则在镜像中标记为未使用
+        auto busy = pool.allocate_object(true).value();
+        busy_index = pool.find_used_block_header(busy)->index;
+        busy->lock();
+        busy->id = 11;
+        first->lock();
+        first->value = 9999;
+        if (!checkpoint.write(pool, &stats)) {
+            std::cerr << "[Checkpoint] write failed" << std::endl;
+            return 1;
+        }
+        assert(stats.skipped_blocks == 2);
+
+        // 下一次检查点写到一半崩溃：该槽未完整写入，恢复时使用上一次检查点
+        busy->unlock();
+        first->value = 7777;
+        first->unlock();
+        if (!checkpoint.write(pool, &stats)) {
+            std::cerr << "[Checkpoint] write failed" << std::endl;
+            return 1;
+        }
+        assert(stats.skipped_blocks == 0);
+        std::FILE *file = std::fopen(path.c_str(), "r+b");
+        assert(file != nullptr);
+        ShmCheckpointHeader heads[kShmCheckpointSlots];
+        assert(std::fread(heads, sizeof(heads), 1, file) == 1);
+        auto newest = heads[0].sequence > heads[1].sequence ? 0 : 1;
+        assert(heads[newest].sequence == heads[1 - newest].sequence + 1);
+        heads[newest].complete = 0;
+        std::fseek(file, 0, SEEK_SET);
+        std::fwrite(heads, sizeof(heads), 1, file);
+        std::fclose(file);
+    } // 析构时删除共享内存，模拟主机重启
+
+    {
+        SharedMemoryManager<CheckpointObject> pool(module_id, 8);
+        assert(pool.is_first_created());
+        ShmCheckpoint checkpoint(path);
+        if (!checkpoint.restore(pool)) {
+            std::cerr << "[Checkpoint] restore failed" << std::endl;
+            return 1;
+        }
+        pool.initialize_block_map();
+        assert(!pool.is_first_created());
+        assert(pool.used_count() == 10);
+        for (auto &[index, value]: expected) {
+            assert(pool.get_block_header(index)->in_use);
+            assert(pool.get_object_by_index(static_cast<std::int32_t>(index))->value == value);
+        }
+        assert(expected.size() == 10);
+        assert(!pool.get_block_header(busy_index)->in_use);
+        std::cout << "[Checkpoint] restored used: " << pool.used_count() << std::endl;
+    }
+
+    std::remove(path.c_str());
+    std::cout << "[Checkpoint] Done." << std::endl;
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "cfl/shm/crc32c.h"
+#include "cfl/shm/shmpage.h"
+#include "cfl/shm/shmobj.h"
+
+using namespace cfl::shm;
+
+/// 测试用对象
+struct CrcObject : public SharedObject {
+    std::uint64_t id{0};
+    char payload[200]{};
+};
+
+int main() {
+    // 标准测试向量
+    assert(crc32c("123456789", 9) == 0xE3069283u);
+    assert(crc32c("", 0) == 0);
+    // 分段计算与整体计算一致
+    const char *text = "The quick brown fox jumps over the lazy dog";
+    auto whole = crc32c(text, std::strlen(text));
+    assert(crc32c(text + 10, std::strlen(text) - 10, crc32c(text, 10)) == whole);
+    std::cout << "[Crc] hardware: " << crc32c_hardware() << std::endl;
+
+    {
+        SharedMemoryManager<CrcObject> pool(1003, 64);
+        pool.initialize_block_map();
+
+        std::vector<CrcObject *> objects;
+        for (std::uint64_t i = 0; i < 100; ++i) {
+            auto object = pool.allocate_object(true).value();
+            object->lock();
+            object->id = i;
+            std::memset(object->payload, static_cast<int>(i), sizeof(object->payload));
+            object->mark_dirty(0);
+            object->unlock();
+            // 写入后不封存，持久化取走脏位图时才计算校验码
+            assert(!object->is_sealed() && object->verify());
+            object->take_dirty_mask();
+            assert(object->is_sealed() && object->verify());
+            objects.push_back(object);
+        }
+
+        // 再次修改后不再参与校验
+        objects[1]->id = 1000;
+        objects[1]->mark_dirty(0);
+        assert(!objects[1]->is_sealed() && objects[1]->verify());
+        objects[1]->take_dirty_mask();
+        assert(objects[1]->is_sealed() && objects[1]->verify());
+
+        // 模拟内存损坏
+        objects[7]->payload[3] ^= 0x1;
+        objects[42]->id ^= 0x100;
+        assert(!objects[7]->verify());
+
+        auto corrupt = pool.verify_blocks(4);
+        assert(corrupt.size() == 2);
+
+        auto used = pool.used_count();
+        pool.quarantine_blocks(corrupt);
+        assert(pool.used_count() == used - 2);
+        assert(pool.quarantined_count() == 2);
+        // 隔离只做标记，内容和状态保留
+        assert(objects[7]->is_in_use() && objects[42]->is_in_use());
+        std::size_t marked = 0;
+        for (std::size_t i = 0; i < pool.total_count(); ++i) {
+            auto header = pool.get_block_header(i);
+            if (header->quarantined) {
+                assert(header->in_use);
+                ++marked;
+            }
+        }
+        assert(marked == 2);
+        assert(pool.verify_blocks(4).empty());
+
+        // 隔离的块不会被再次分配
+        for (int i = 0; i < 200; ++i) {
+            auto object = pool.allocate_object(true).value();
+            assert(object != objects[7] && object != objects[42]);
+        }
+
+        // 重启后附加到同一块共享内存：上次隔离的块被回收，可以再次分配
+        SharedMemoryManager<CrcObject> restarted(1003, 64);
+        restarted.initialize_block_map();
+        assert(!restarted.is_first_created());
+        assert(restarted.quarantined_count() == 0);
+        assert(!objects[7]->is_in_use() && !objects[42]->is_in_use());
+        for (std::size_t i = 0; i < restarted.total_count(); ++i) {
+            assert(!restarted.get_block_header(i)->quarantined);
+        }
+        assert(restarted.used_count() == pool.used_count());
+    }
+
+    std::cout << "[Crc] Done." << std::endl;
+    return 0;
+}
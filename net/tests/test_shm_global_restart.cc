@@ -0,0 +1,60 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include "cfl/shm/shmpool.h"
+#include "cfl/shm/obj/global_data_obj.h"
+
+using namespace cfl::shm;
+
+int main() {
+    const std::size_t module_id = 1004;
+    auto pool = std::make_shared<SharedMemoryManager<GlobalDataObject>>(module_id, 4);
+    pool->initialize_block_map();
+    assert(pool->is_first_created());
+    assert(attach_used_objects<GlobalDataObject>(pool).empty());
+
+    // 上一次运行：当前的全局数据对象，以及旧版本启动时遗留的一个对象
+    auto current = construct_object<GlobalDataObject>(*pool, pool->allocate_object(true).value());
+    current->lock();
+    current->server_id = 7;
+    current->guid = (std::uint64_t{7} << 48) + 20000;
+    current->max_online = 321;
+    current->extra_data[3] = 99;
+    current->unlock();
+    auto stale = construct_object<GlobalDataObject>(*pool, pool->allocate_object(true).value());
+    stale->lock();
+    stale->guid = (std::uint64_t{7} << 48) + 10000;
+    stale->unlock();
+    // 进程在写入过程中退出
+    current->lock();
+
+    {
+        // 重启：附加到同一块共享内存
+        auto restarted = std::make_shared<SharedMemoryManager<GlobalDataObject>>(module_id, 4);
+        restarted->initialize_block_map();
+        assert(!restarted->is_first_created());
+        assert(restarted->used_count() == 2);
+
+        auto objects = attach_used_objects<GlobalDataObject>(restarted);
+        assert(objects.size() == 2);
+        std::shared_ptr<GlobalDataObject> newest;
+        for (auto &object: objects) {
+            if (!newest || object->guid > newest->guid) {
+                newest = object;
+            }
+        }
+        assert(!newest->is_locked());
+        assert(newest->server_id == 7 && newest->guid == (std::uint64_t{7} << 48) + 20000);
+        assert(newest->max_online == 321 && newest->extra_data[3] == 99);
+
+        // 不需要的对象释放后归还给池
+        objects.clear();
+        assert(restarted->used_count() == 1);
+        assert(newest->is_in_use() && !stale->is_in_use());
+        std::cout << "[GlobalRestart] watermark " << newest->guid << std::endl;
+    }
+
+    std::cout << "[GlobalRestart] Done." << std::endl;
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include "cfl/shm/shmobj.h"
+
+using namespace cfl::shm;
+
+/// 测试用对象：写端总是保证 a == b == c
+struct PairObject : public SharedObject {
+    std::uint64_t a{0};
+    std::uint64_t b{0};
+    std::uint64_t c{0};
+};
+
+int main() {
+    PairObject obj;
+    obj.use();
+
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        for (std::uint64_t i = 1; !stop.load(std::memory_order_relaxed); ++i) {
+            obj.lock();
+            obj.a = i;
+            obj.b = i;
+            obj.c = i;
+            obj.unlock();
+        }
+    });
+
+    // 等待写线程开始写入
+    while (obj.sequence() == 0) {
+        std::this_thread::yield();
+    }
+
+    std::size_t ok = 0;
+    std::size_t retried_out = 0;
+    for (int i = 0; i < 200000; ++i) {
+        auto snap = obj.snapshot<PairObject>();
+        if (!snap) {
+            ++retried_out;
+            continue;
+        }
+        const PairObject &copy = **snap;
+        assert(copy.a == copy.b && copy.b == copy.c);
+        assert((snap->sequence() & 1) == 0);
+        ++ok;
+    }
+    stop = true;
+    writer.join();
+
+    std::cout << "[Snapshot] consistent snapshots: " << ok
+              << ", retries exhausted: " << retried_out
+              << ", final sequence: " << obj.sequence() << std::endl;
+
+    // 写入中的对象无法得到快照
+    obj.lock();
+    assert(!obj.snapshot<PairObject>(8).has_value());
+    obj.unlock();
+    assert(obj.snapshot<PairObject>().has_value());
+
+    std::cout << "[Snapshot] Done." << std::endl;
+    return 0;
+}
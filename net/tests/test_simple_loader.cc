@@ -0,0 +1,87 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include "cfl/simple_manager.h"
+#include "cfl/db/db_sqlite.h"
+
+using namespace cfl;
+
+int main() {
+    const std::string path = "test_simple_loader.db";
+    std::remove(path.c_str());
+
+    // 准备 player 表，ID 不连续（模拟合服后的 ID 分布）
+    const int rows = 20000;
+    {
+        auto db = std::make_shared<db::SQLite>(std::unordered_map<std::string, std::string>{{"dbname", path}});
+        if (!db->connect()) {
+            std::cerr << "[Loader] connect failed" << std::endl;
+            return 1;
+        }
+        if (db->execute("CREATE TABLE player (id INTEGER PRIMARY KEY, accountid INTEGER, name TEXT, carrerid INTEGER, "
+                        "createtime INTEGER, logontime INTEGER, logofftime INTEGER, guildid INTEGER, "
+                        "level INTEGER, viplevel INTEGER);") < 0) {
+            std::cerr << "[Loader] create table failed" << std::endl;
+            return 1;
+        }
+        if (db->execute("BEGIN;") < 0) {
+            std::cerr << "[Loader] begin failed" << std::endl;
+            return 1;
+        }
+        for (int i = 0; i < rows; ++i) {
+            auto id = static_cast<int64_t>(i < rows / 2 ? 1000 + i : 5000000 + i * 3);
+            auto name = "role_" + std::to_string(id);
+            if (db->execStmt("INSERT INTO player VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);", id, int64_t{id / 2},
+                             std::string_view(name), i % 4 + 1, int64_t{1700000000}, int64_t{1700000100},
+                             int64_t{1700000200}, int64_t{0}, i % 150 + 1, i % 10) < 0) {
+                std::cerr << "[Loader] insert failed" << std::endl;
+                return 1;
+            }
+        }
+        if (db->execute("COMMIT;") < 0) {
+            std::cerr << "[Loader] commit failed" << std::endl;
+            return 1;
+        }
+    }
+
+    // 每个加载线程独占一个连接
+    db::ConnectionFactory factory = [&path](const std::string &) -> db::Database::Ptr {
+        auto db = std::make_shared<db::SQLite>(std::unordered_map<std::string, std::string>{{"dbname", path}});
+        return db->connect() ? db : nullptr;
+    };
+
+    auto &mgr = SimpleManager::instance();
+    if (!mgr.load_data(4, factory)) {
+        std::cerr << "[Loader] load_data failed" << std::endl;
+        return 1;
+    }
+
+    assert(mgr.get_total_count() == rows);
+    auto info = mgr.get_simple_info_by_id(1000 + 7);
+    assert(info && info->account_id == 503 && info->name == "role_1007" && info->career_id == 4 && info->level == 8);
+    assert(info->logoff_time == 1700000200 && info->vip_level == 7);
+    assert(mgr.get_role_id_by_name("role_" + std::to_string(5000000 + (rows - 1) * 3)) == 5000000 + (rows - 1) * 3);
+    assert(mgr.get_role_id_by_name("role_999") == 0);
+
+    // 加载时建立排行榜：同等级按角色ID升序
+    assert(mgr.rank_list(RankType::Level).size() == rows);
+    assert(mgr.get_rank(RankType::Level, 1000 + 149) == 1);
+    if (!mgr.set_fight_value(1007, 999999, 8)) {
+        std::cerr << "[Loader] set_fight_value failed" << std::endl;
+        return 1;
+    }
+    assert(mgr.get_rank(RankType::FightValue, 1007) == 1);
+    std::vector<RankEntry> top;
+    mgr.get_top(RankType::FightValue, 10, top);
+    assert(top.size() == 10 && top[0].role_id == 1007 && top[0].score == 999999);
+    if (!mgr.set_role_deleted(1007, true)) {
+        std::cerr << "[Loader] set_role_deleted failed" << std::endl;
+        return 1;
+    }
+    assert(mgr.get_rank(RankType::FightValue, 1007) == 0);
+
+    std::remove(path.c_str());
+    std::cout << "test_simple_loader passed" << std::endl;
+    return 0;
+}
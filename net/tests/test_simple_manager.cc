@@ -28,19 +28,19 @@ void test_create_and_modify()
     const uint32_t career = 2;
 
     // 创建角色
-    SimpleInfo *info = mgr.create_simple_info(roleId, accountId, name, career);
-    assert(info != nullptr);
+    auto info = mgr.create_simple_info(roleId, accountId, name, career);
+    assert(info.has_value());
     assert(info->name == name);
 
     // 测试 getSimpleInfoById
-    SimpleInfo *found = mgr.get_simple_info_by_id(roleId);
-    assert(found != nullptr);
+    auto found = mgr.get_simple_info_by_id(roleId);
+    assert(found.has_value());
     assert(found->role_id == roleId);
 
     // 测试 setFightValue / getFightValue
     mgr.set_fight_value(roleId, 987654, 15);
     assert(mgr.get_fight_value(roleId) == 987654);
-    assert(found->level == 15);
+    assert(mgr.get_simple_info_by_id(roleId)->level == 15);
 
     // 测试 setName / getRoleIdByName
     mgr.set_name(roleId, "RenamedHero");
@@ -53,10 +53,11 @@ void test_create_and_modify()
 
     // 测试 VIP 等级修改
     mgr.set_vip_level(roleId, 7);
-    assert(found->vip_level == 7);
+    assert(mgr.get_simple_info_by_id(roleId)->vip_level == 7);
 
     // 测试删除标志
     mgr.set_role_deleted(roleId, true);
+    found = mgr.get_simple_info_by_id(roleId);
     assert(found->is_deleted == true);
 
     std::cout << "Role " << found->name << " modified successfully.\n";
@@ -0,0 +1,165 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cfl/simple_store.h"
+
+using namespace cfl;
+
+// 统计旧的 map + unique_ptr 存储分配的字节数
+static std::size_t g_allocated = 0;
+
+template<class T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template<class U>
+    CountingAllocator(const CountingAllocator<U> &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        g_allocated += n * sizeof(T);
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        g_allocated -= n * sizeof(T);
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template<class U>
+    bool operator==(const CountingAllocator<U> &) const noexcept { return true; }
+};
+
+static SimpleInfo make_info(std::uint64_t id) {
+    SimpleInfo info;
+    info.role_id = id;
+    info.account_id = 100000 + id / 3;          // 每个账号 3 个角色
+    info.guild_id = id % 7 == 0 ? 0 : id % 50;  // 部分角色无公会
+    info.level = static_cast<std::uint32_t>(id % 150);
+    info.name = "player_name_" + std::to_string(id);
+    return info;
+}
+
+int main() {
+    // 基本索引
+    {
+        SimpleStore store;
+        for (std::uint64_t id = 1; id <= 1000; ++id) {
+            if (store.insert(make_info(id)) == SimpleStore::npos) {
+                std::cerr << "[Store] insert failed" << std::endl;
+                return 1;
+            }
+        }
+        if (store.insert(make_info(5)) != SimpleStore::npos) {  // 重复ID
+            std::cerr << "[Store] duplicated id accepted" << std::endl;
+            return 1;
+        }
+        assert(store.size() == 1000);
+
+        auto slot = store.find(42);
+        assert(slot != SimpleStore::npos && store.role_id(slot) == 42 && store.name(slot) == "player_name_42");
+        assert(store.find(100001) == SimpleStore::npos);
+        assert(store.find_by_name(std::string_view("player_name_777")) == store.find(777));
+
+        std::vector<std::uint64_t> roles;
+        store.account_roles(100000 + 300, roles);
+        std::sort(roles.begin(), roles.end());
+        assert((roles == std::vector<std::uint64_t>{900, 901, 902}));
+
+        roles.clear();
+        store.guild_roles(49, roles);
+        assert(!roles.empty() && std::all_of(roles.begin(), roles.end(), [](auto id) { return id % 50 == 49; }));
+        auto guild_size = roles.size();
+
+        // 换公会
+        store.set_guild_id(store.find(99), 3);
+        roles.clear();
+        store.guild_roles(49, roles);
+        assert(roles.size() == guild_size - 1);
+        roles.clear();
+        store.guild_roles(3, roles);
+        assert(std::find(roles.begin(), roles.end(), 99) != roles.end());
+
+        // 改名：旧名称释放，新名称不能与他人重复
+        if (!store.set_name(store.find(10), "renamed")) {
+            std::cerr << "[Store] rename failed" << std::endl;
+            return 1;
+        }
+        assert(store.find_by_name("player_name_10") == SimpleStore::npos);
+        assert(store.find_by_name("renamed") == store.find(10));
+        if (store.set_name(store.find(11), "renamed")) {
+            std::cerr << "[Store] duplicated name accepted" << std::endl;
+            return 1;
+        }
+        assert(store.name(store.find(11)) == "player_name_11");
+
+        // 大量改名后探测链仍然完整
+        for (std::uint64_t id = 1; id <= 1000; id += 2) {
+            if (!store.set_name(store.find(id), "odd_" + std::to_string(id))) {
+                std::cerr << "[Store] rename failed" << std::endl;
+                return 1;
+            }
+        }
+        for (std::uint64_t id = 1; id <= 1000; ++id) {
+            auto expected = id % 2 ? "odd_" + std::to_string(id) : "player_name_" + std::to_string(id);
+            if (id == 10) {
+                expected = "renamed";
+            }
+            assert(store.find_by_name(expected) == store.find(id));
+        }
+    }
+
+    // 列式存储比 map 存储占用更少内存，按账号索引与全量扫描结果一致
+    const std::uint64_t count = 20000;
+    std::size_t old_bytes = 0;
+    std::size_t new_bytes = 0;
+    {
+        // 旧布局：map 节点和桶由 CountingAllocator 统计，SimpleInfo 与超出 SSO 的名称按对象大小累加
+        using Name = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+        std::unordered_map<std::uint64_t, std::unique_ptr<SimpleInfo>, std::hash<std::uint64_t>,
+                std::equal_to<>, CountingAllocator<std::pair<const std::uint64_t, std::unique_ptr<SimpleInfo>>>> id_to_info;
+        std::unordered_map<Name, std::uint64_t, std::hash<std::string_view>, std::equal_to<>,
+                CountingAllocator<std::pair<const Name, std::uint64_t>>> name_to_id;
+        std::size_t info_bytes = 0;
+        for (std::uint64_t id = 1; id <= count; ++id) {
+            auto info = std::make_unique<SimpleInfo>(make_info(id));
+            info_bytes += sizeof(SimpleInfo) + (info->name.capacity() > 15 ? info->name.capacity() + 1 : 0);
+            name_to_id.emplace(Name(info->name), id);
+            id_to_info.emplace(id, std::move(info));
+        }
+        old_bytes = g_allocated + info_bytes;
+
+        std::size_t found = 0;
+        for (std::uint64_t account = 100000; account < 100000 + 100; ++account) {
+            for (auto &[id, info]: id_to_info) {
+                found += info->account_id == account;
+            }
+        }
+        assert(found == 299);
+    }
+    {
+        SimpleStore store;
+        for (std::uint64_t id = 1; id <= count; ++id) {
+            store.insert(make_info(id));
+        }
+        new_bytes = store.memory_bytes();
+
+        std::vector<std::uint64_t> roles;
+        std::size_t found = 0;
+        for (std::uint64_t account = 100000; account < 100000 + 100; ++account) {
+            roles.clear();
+            store.account_roles(account, roles);
+            found += roles.size();
+        }
+        assert(found == 299);
+    }
+
+    assert(new_bytes < old_bytes);
+    std::cout << "test_simple_store passed" << std::endl;
+    return 0;
+}
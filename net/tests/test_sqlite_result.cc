@@ -0,0 +1,102 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include "cfl/db/db_sqlite.h"
+
+using namespace cfl::db;
+
+int main() {
+    auto db = std::make_shared<SQLite>(std::unordered_map<std::string, std::string>{{"dbname", ":memory:"}});
+    if (!db->connect()) {
+        std::cerr << "[SQLite] connect failed" << std::endl;
+        return 1;
+    }
+    if (db->execute("CREATE TABLE cfg (id INTEGER, ratio REAL, name TEXT, data BLOB, note TEXT);") < 0) {
+        std::cerr << "[SQLite] create table failed" << std::endl;
+        return 1;
+    }
+    if (db->execute("INSERT INTO cfg VALUES (1, 0.5, 'sword', x'00ff00', NULL);") < 0) {
+        std::cerr << "[SQLite] insert failed" << std::endl;
+        return 1;
+    }
+    if (db->execute("INSERT INTO cfg VALUES (9000000000, 2, '', x'', '42');") < 0) {
+        std::cerr << "[SQLite] insert failed" << std::endl;
+        return 1;
+    }
+
+    // 物化结果：原生类型，字符串/BLOB 为视图
+    {
+        auto data = std::dynamic_pointer_cast<SQLiteResult>(db->query("SELECT * FROM cfg ORDER BY id;"));
+        assert(data && data->error_code() == 0 && data->row_count() == 2 && data->column_count() == 5);
+        if (!data->next()) {
+            std::cerr << "[SQLite] missing first row" << std::endl;
+            return 1;
+        }
+        assert(data->column_type(0) == SQLITE_INTEGER && data->get_int32(0) == 1);
+        assert(data->column_type(1) == SQLITE_FLOAT && data->get_double("ratio") == 0.5);
+        assert(data->get_string_view(2) == "sword");
+        auto blob = data->get_blob_view(3);
+        assert(blob.size() == 3 && blob[0] == std::byte{0} && blob[1] == std::byte{0xff});
+        assert(data->is_null(4) && data->get_int32(4) == 0);
+        if (!data->next()) {
+            std::cerr << "[SQLite] missing second row" << std::endl;
+            return 1;
+        }
+        assert(data->get_int64(0) == 9000000000LL);
+        assert(data->get_string(1) == "2");
+        assert(!data->is_null(2) && data->get_string_view(2).empty());
+        assert(data->get_int32("note") == 42);   // 文本按需转换
+        if (data->next()) {
+            std::cerr << "[SQLite] unexpected extra row" << std::endl;
+            return 1;
+        }
+    }
+
+    // 流式游标：语句重置后可以重新绑定
+    {
+        auto stmt = std::dynamic_pointer_cast<SQLiteStatement>(db->prepare("SELECT name, id FROM cfg WHERE id >= ? ORDER BY id;"));
+        for (int round = 0; round < 2; ++round) {
+            if (stmt->bind(0, int64_t{round == 0 ? 0 : 2}) != 0) {
+                std::cerr << "[SQLite] bind failed" << std::endl;
+                return 1;
+            }
+            auto cursor = std::dynamic_pointer_cast<SQLiteCursor>(stmt->cursor());
+            assert(cursor && cursor->column_count() == 2);
+            int rows = 0;
+            while (cursor->next()) {
+                assert(cursor->get_int64("id") > 0);
+                ++rows;
+            }
+            assert(rows == (round == 0 ? 2 : 1) && cursor->row_count() == rows && cursor->error_code() == 0);
+        }
+    }
+
+    // 物化结果与流式游标读到的内容一致
+    const int rows = 1000;
+    if (db->execute("CREATE TABLE role (id INTEGER, level INTEGER, exp INTEGER, name TEXT);") < 0) {
+        std::cerr << "[SQLite] create table failed" << std::endl;
+        return 1;
+    }
+    for (int i = 0; i < rows; ++i) {
+        auto name = "role_" + std::to_string(i);
+        if (db->execStmt("INSERT INTO role VALUES (?, ?, ?, ?);", i, i % 100, int64_t{i} * 10, std::string_view(name)) < 0) {
+            std::cerr << "[SQLite] insert role failed" << std::endl;
+            return 1;
+        }
+    }
+    int64_t sum = 0;
+    auto data = db->query("SELECT id, level, exp, name FROM role;");
+    while (data->next()) {
+        sum += data->get_int32(0) + data->get_int32(1) + data->get_int64(2);
+    }
+    int64_t cursor_sum = 0;
+    auto cursor = db->query_cursor("SELECT id, level, exp, name FROM role;");
+    while (cursor->next()) {
+        cursor_sum += cursor->get_int32(0) + cursor->get_int32(1) + cursor->get_int64(2);
+    }
+    assert(sum == cursor_sum && cursor->row_count() == rows && data->row_count() == rows);
+
+    std::cout << "[SQLiteResult] Done." << std::endl;
+    return 0;
+}
@@ -0,0 +1,282 @@
+/**
+ * @file shm_inspect.cc
+ * @brief 共享内存只读检查工具
+ *
+ * @details
+ * 以 attach_only 方式附加到各个 SHMTYPE 对应的共享内存池，输出占用情况和对象统计，
+ * 共享内存以只读方式映射，不创建、不迁移、不修改也不删除共享内存，可以在线上服务器运行时使用。
+ *
+ * 用法：
+ * @code
+ * shm_inspect                 # 所有池的统计
+ * shm_inspect <pool>          # 单个池的统计，pool 取 role / global / mail / groupmail / groupmailstate
+ * shm_inspect <pool> <index>  # 输出单个对象块的内容
+ * @endcode
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include "cfl/shm/shmpage.h"
+#include "cfl/shm/shmpool.h"
+#include "cfl/shm/obj/role_data_obj.h"
+#include "cfl/shm/obj/global_data_obj.h"
+#include "cfl/shm/obj/mail_data_obj.h"
+
+using namespace cfl::shm;
+
+namespace {
+
+    constexpr std::array<std::string_view, 5> kStateNames = {"Idle", "Locked", "Released", "Destroyed", "InUse"};
+
+    /// last_update 年龄分桶的上限（秒）
+    constexpr std::array<std::int64_t, 5> kAgeBuckets = {60, 600, 3600, 86400, std::numeric_limits<std::int64_t>::max()};
+    constexpr std::array<std::string_view, 5> kAgeNames = {"<1m", "<10m", "<1h", "<1d", ">=1d"};
+
+    std::string_view state_name(ObjectState state) {
+        auto idx = static_cast<std::size_t>(state);
+        return idx < kStateNames.size() ? kStateNames[idx] : "Unknown";
+    }
+
+    std::int64_t age_seconds(const SharedObject &object) {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now() - object.last_update_time()).count();
+    }
+
+    /**
+     * @brief 单个池的统计
+     */
+    struct PoolStats {
+        std::size_t used = 0;           ///< 块头标记为使用中
+        std::size_t free = 0;           ///< 空闲块
+        std::size_t quarantined = 0;    ///< 校验失败被隔离
+        std::size_t dirty = 0;          ///< 有未落地修改（dirty_mask 非 0）
+        std::size_t unsealed = 0;       ///< 未加锁修改后尚未重新计算校验码
+        std::size_t corrupt = 0;        ///< 校验码不一致
+        std::size_t leaked = 0;         ///< 块头使用中但对象已释放/销毁，等待回收
+        std::array<std::size_t, kStateNames.size()> states{};
+        std::array<std::size_t, kAgeBuckets.size()> ages{};
+        std::int64_t oldest = 0;        ///< 最久未更新的对象年龄（秒）
+    };
+
+    template<class T>
+    PoolStats collect(SharedMemoryManager<T> &pool) {
+        PoolStats stats;
+        for (std::size_t i = 0; i < pool.total_count(); ++i) {
+            auto header = pool.get_block_header(i);
+            auto object = pool.get_object(i);
+            if (header->quarantined) {
+                ++stats.quarantined;
+                continue;
+            }
+            if (!header->in_use) {
+                ++stats.free;
+                continue;
+            }
+            ++stats.used;
+            auto state = object->state();
+            auto idx = static_cast<std::size_t>(state);
+            if (idx < stats.states.size()) {
+                ++stats.states[idx];
+            }
+            if (state == ObjectState::Released || state == ObjectState::Destroyed || state == ObjectState::Idle) {
+                ++stats.leaked;
+            }
+            if (object->is_dirty()) {
+                ++stats.dirty;
+            }
+            if (!object->is_sealed()) {
+                ++stats.unsealed;
+            } else if (!object->verify()) {
+                ++stats.corrupt;
+            }
+            auto age = age_seconds(*object);
+            stats.oldest = std::max(stats.oldest, age);
+            for (std::size_t b = 0; b < kAgeBuckets.size(); ++b) {
+                if (age < kAgeBuckets[b]) {
+                    ++stats.ages[b];
+                    break;
+                }
+            }
+        }
+        return stats;
+    }
+
+    void print_stats(std::string_view name, const SharedMemoryManagerBase &pool, const PoolStats &stats) {
+        auto total = pool.total_count();
+        std::cout << "== " << name << " (module " << pool.module_id() << ")\n"
+                  << "  pages " << pool.page_count() << " x " << pool.blocks_per_page() << " blocks, "
+                  << pool.page_size() << " bytes/page, block " << pool.raw_block_size() << " bytes\n"
+                  << "  blocks total " << total << ", used " << stats.used << ", free " << stats.free
+                  << ", quarantined " << stats.quarantined;
+        if (total > 0) {
+            std::cout << ", occupancy " << std::fixed << std::setprecision(1)
+                      << 100.0 * static_cast<double>(stats.used) / static_cast<double>(total) << "%";
+        }
+        std::cout << "\n  states";
+        for (std::size_t i = 0; i < kStateNames.size(); ++i) {
+            std::cout << " " << kStateNames[i] << "=" << stats.states[i];
+        }
+        std::cout << "\n  last_update";
+        for (std::size_t i = 0; i < kAgeNames.size(); ++i) {
+            std::cout << " " << kAgeNames[i] << "=" << stats.ages[i];
+        }
+        std::cout << ", oldest " << stats.oldest << "s\n"
+                  << "  dirty " << stats.dirty << ", unsealed " << stats.unsealed << ", corrupt " << stats.corrupt
+                  << ", released but not reclaimed " << stats.leaked << "\n";
+    }
+
+    // ---------- 对象字段输出 ----------
+    template<std::size_t N>
+    void print_value(const char (&value)[N]) {
+        std::cout << std::string_view(value, strnlen(value, N));
+    }
+
+    template<class V>
+    void print_value(const V &value) {
+        std::cout << value;
+    }
+
+    void print_items(const std::array<StMailItem, MAIL_ITEM_COUNT> &items) {
+        for (auto &item: items) {
+            if (item.item_id == 0) {
+                break;
+            }
+            std::cout << " " << item.item_id << "x" << item.item_count;
+        }
+    }
+
+    void print_fields(const RoleDataObject &role) {
+        std::cout << "  roleId: " << role.roleId << "\n";
+#define CFL_INSPECT_ROLE_FIELD(field, column, member) \
+        std::cout << "  " column ": ";                 \
+        print_value(role.member);                      \
+        std::cout << "\n";
+        CFL_ROLE_DATA_FIELDS(CFL_INSPECT_ROLE_FIELD)
+#undef CFL_INSPECT_ROLE_FIELD
+    }
+
+    void print_fields(const GlobalDataObject &global) {
+        std::cout << "  server_id: " << global.server_id << "\n"
+                  << "  guid: " << global.guid << "\n"
+                  << "  max_online: " << global.max_online << "\n";
+    }
+
+    void print_fields(const MailDataObject &mail) {
+        std::cout << "  guid: " << mail.guid << "\n"
+                  << "  role_id: " << mail.role_id << "\n"
+                  << "  group_guid: " << mail.group_guid << "\n"
+                  << "  time: " << mail.time << "\n"
+                  << "  sender_id: " << mail.sender_id << "\n"
+                  << "  mail_type: " << mail.mail_type << "\n"
+                  << "  status: " << mail.status << "\n"
+                  << "  sender: ";
+        print_value(mail.sender);
+        std::cout << "\n  title: ";
+        print_value(mail.title);
+        std::cout << "\n  items:";
+        print_items(mail.items);
+        std::cout << "\n";
+    }
+
+    void print_fields(const GroupMailDataObject &mail) {
+        std::cout << "  guid: " << mail.guid << "\n"
+                  << "  time: " << mail.time << "\n"
+                  << "  mail_type: " << mail.mail_type << "\n"
+                  << "  channel: " << mail.channel << "\n"
+                  << "  group_type: " << mail.group_type << "\n"
+                  << "  sender: ";
+        print_value(mail.sender);
+        std::cout << "\n  title: ";
+        print_value(mail.title);
+        std::cout << "\n  items:";
+        print_items(mail.items);
+        std::cout << "\n";
+    }
+
+    void print_fields(const GroupMailStateObject &state) {
+        std::cout << "  guid: " << state.guid << "\n"
+                  << "  role_id: " << state.role_id << "\n"
+                  << "  group_guid: " << state.group_guid << "\n"
+                  << "  time: " << state.time << "\n"
+                  << "  mail_type: " << state.mail_type << "\n"
+                  << "  status: " << state.status << "\n";
+    }
+
+    template<class T>
+    int dump(SharedMemoryManager<T> &pool, std::size_t index) {
+        auto header = pool.get_block_header(index);
+        auto object = pool.get_object(index);
+        if (header == nullptr || object == nullptr) {
+            std::cerr << "block " << index << " out of range, total " << pool.total_count() << "\n";
+            return 1;
+        }
+        std::cout << "== block " << index << "\n"
+                  << "  in_use " << header->in_use << ", quarantined " << header->quarantined
+                  << ", generation " << header->generation << ", is_new " << header->is_new << "\n";
+
+        // 按 seqlock 读取一致性副本，不影响写端
+        auto snapshot = object->template snapshot<T>();
+        if (!snapshot) {
+            std::cout << "  object is being written, showing live memory\n";
+        }
+        const T &copy = snapshot ? **snapshot : *static_cast<const T *>(object);
+        std::cout << "  state " << state_name(copy.state()) << ", seq " << copy.sequence()
+                  << ", dirty_mask 0x" << std::hex << copy.dirty_mask()
+                  << ", check_code 0x" << copy.check_code() << std::dec
+                  << ", sealed " << copy.is_sealed() << ", verify " << copy.verify()
+                  << ", last_update " << age_seconds(copy) << "s ago\n";
+        print_fields(copy);
+        return 0;
+    }
+
+    template<class T>
+    int inspect(SHMTYPE type, std::string_view name, const char *index) {
+        SharedMemoryManager<T> pool(static_cast<std::size_t>(type), 1, true);
+        if (pool.layout_refused()) {
+            std::cout << "== " << name << ": layout does not match this build, not attached\n";
+            return 1;
+        }
+        if (pool.page_count() == 0) {
+            std::cout << "== " << name << ": not present\n";
+            return 0;
+        }
+        pool.initialize_block_map();
+        if (index != nullptr) {
+            return dump(pool, static_cast<std::size_t>(std::strtoull(index, nullptr, 10)));
+        }
+        print_stats(name, pool, collect(pool));
+        return 0;
+    }
+
+    int inspect(std::string_view pool, const char *index) {
+        if (pool == "role") return inspect<RoleDataObject>(SHMTYPE::RoleData, pool, index);
+        if (pool == "global") return inspect<GlobalDataObject>(SHMTYPE::Global, pool, index);
+        if (pool == "mail") return inspect<MailDataObject>(SHMTYPE::Mail, pool, index);
+        if (pool == "groupmail") return inspect<GroupMailDataObject>(SHMTYPE::GroupMail, pool, index);
+        if (pool == "groupmailstate") return inspect<GroupMailStateObject>(SHMTYPE::GroupMailState, pool, index);
+        std::cerr << "unknown pool " << pool << ", expected role / global / mail / groupmail / groupmailstate\n";
+        return 1;
+    }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    spdlog::set_level(spdlog::level::warn);
+    if (argc >= 2) {
+        return inspect(argv[1], argc >= 3 ? argv[2] : nullptr);
+    }
+    int result = 0;
+    for (auto pool: {"role", "global", "mail", "groupmail", "groupmailstate"}) {
+        result |= inspect(pool, nullptr);
+    }
+    return result;
+}